@@ -89,13 +89,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "CPU.h"
 #include "Core.h"
 #include "CardManager.h"
+#include "Keyboard.h"
 #include "Memory.h"
 #include "Mockingboard.h"
 #include "MouseInterface.h"
+#include "Movie.h"
+#include "PerfCounters.h"
 #ifdef USE_SPEECH_API
 #include "Speech.h"
 #endif
 #include "SynchronousEventManager.h"
+#include "Tape.h"
 #include "NTSC.h"
 #include "Log.h"
 
@@ -352,6 +356,31 @@ static void DebugHddEntrypoint(const USHORT PC)
 }
 #endif
 
+// Turbo disk: RWTS/ProDOS driver entry point to trap (refreshed for each CpuExecute() batch)
+static UINT g_uTurboDiskTrapPC = Disk2CardManager::kNoTrapAddress;
+
+static void TurboDiskTrap(BYTE& iOpcode)
+{
+	bool error = false;
+	if (!GetCardMgr().GetDisk2CardMgr().TurboDiskTrap(regs.pc, error))
+		return;
+
+	// Serviced: regs.pc is now the caller's return address (less 1), so replace the opcode with one that returns the status
+	iOpcode = error ? 0x38 : 0x18;	// SEC : CLC
+}
+
+// Tape instant load: Monitor READ entry point to trap (refreshed for each CpuExecute() batch)
+static UINT g_uTapeTrapPC = 0x10000;
+
+static void TapeInstantLoadTrap(BYTE& iOpcode, ULONG uExecutedCycles)
+{
+	if (!TapeTrap(uExecutedCycles))
+		return;
+
+	// Serviced: regs.pc is now the caller's return address (less 1)
+	iOpcode = 0xEA;	// NOP
+}
+
 static __forceinline void Fetch(BYTE& iOpcode, ULONG uExecutedCycles)
 {
 	const USHORT PC = regs.pc;
@@ -369,6 +398,11 @@ static __forceinline void Fetch(BYTE& iOpcode, ULONG uExecutedCycles)
 		CaptureCOUT();
 #endif
 
+	if (PC == g_uTurboDiskTrapPC)
+		TurboDiskTrap(iOpcode);
+	else if (PC == g_uTapeTrapPC)
+		TapeInstantLoadTrap(iOpcode, uExecutedCycles);
+
 	regs.pc++;
 }
 
@@ -454,76 +488,98 @@ static __forceinline bool IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 
 //===========================================================================
 
-#define READ _READ_WITH_IO_F8xx
-#define WRITE(value) _WRITE_WITH_IO_F8xx(value)
-#define HEATMAP_X(address)
-
-#include "CPU/cpu6502.h"  // MOS 6502
-
-#undef READ
-#undef WRITE
-
-//-------
-
-#define READ _READ
-#define WRITE(value) _WRITE(value)
+#include "CPU/cpu_idleloop.inl"
 
-#include "CPU/cpu65C02.h" // WDC 65C02
+//===========================================================================
 
-#undef READ
-#undef WRITE
-#undef HEATMAP_X
+// Memory access policies of the CPU loops, resolved at compile time
 
-//-----------------
+struct MemoryAccess
+{
+	static __forceinline BYTE Read(WORD addr, ULONG uExecutedCycles) { return _READ; }
+	static __forceinline void Write(WORD addr, BYTE value, ULONG uExecutedCycles) { _WRITE(value); }
+};
 
-#define READ Heatmap_ReadByte_With_IO_F8xx(addr, uExecutedCycles)
-#define WRITE(value) Heatmap_WriteByte_With_IO_F8xx(addr, value, uExecutedCycles);
+// 6502 (and Z80): also decodes the $F8xx I/O space
+struct MemoryAccess_With_IO_F8xx
+{
+	static __forceinline BYTE Read(WORD addr, ULONG uExecutedCycles) { return _READ_WITH_IO_F8xx; }
+	static __forceinline void Write(WORD addr, BYTE value, ULONG uExecutedCycles) { _WRITE_WITH_IO_F8xx(value); }
+};
 
-#define HEATMAP_X(address) Heatmap_X(address)
+// Emulation outside the debugger (at any speed): skips the idle loops
+template <class Memory>
+struct RunAccess : public Memory
+{
+	static __forceinline void Execute(WORD pc) {}
+	static __forceinline void IdleLoop(WORD pc, ULONG& uExecutedCycles, const DWORD uTotalCycles, const bool bVideoUpdate)
+	{
+		if (pc == g_uIdleLoopPC)
+			IdleLoopSkip(uExecutedCycles, uTotalCycles, bVideoUpdate);
+	}
+};
 
 #include "CPU/cpu_heatmap.inl"
 
-#define Cpu6502 Cpu6502_debug
-#include "CPU/cpu6502.h"  // MOS 6502
-#undef Cpu6502
-
-#undef READ
-#undef WRITE
-
-//-------
+// Debugger: updates the heatmap, and the debugger sees every iteration of the idle loops
+template <class Memory>
+struct HeatmapAccess
+{
+	static __forceinline BYTE Read(WORD addr, ULONG uExecutedCycles) { Heatmap_R(addr); return Memory::Read(addr, uExecutedCycles); }
+	static __forceinline void Write(WORD addr, BYTE value, ULONG uExecutedCycles) { Heatmap_W(addr); Memory::Write(addr, value, uExecutedCycles); }
+	static __forceinline void Execute(WORD pc) { Heatmap_X(pc); }
+	static __forceinline void IdleLoop(WORD pc, ULONG& uExecutedCycles, const DWORD uTotalCycles, const bool bVideoUpdate) {}
+};
 
-#define READ Heatmap_ReadByte(addr, uExecutedCycles)
-#define WRITE(value) Heatmap_WriteByte(addr, value, uExecutedCycles);
+#define READ Access::Read(addr, uExecutedCycles)
+#define WRITE(value) Access::Write(addr, (BYTE)(value), uExecutedCycles);
+#define HEATMAP_X(address) Access::Execute(address)
+#define IDLE_LOOP_X(address) Access::IdleLoop(address, uExecutedCycles, uTotalCycles, bVideoUpdate)
 
-#define Cpu65C02 Cpu65C02_debug
+#include "CPU/cpu6502.h"  // MOS 6502
 #include "CPU/cpu65C02.h" // WDC 65C02
-#undef Cpu65C02
 
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef IDLE_LOOP_X
 
 //===========================================================================
 
-static DWORD InternalCpuExecute(const DWORD uTotalCycles, const bool bVideoUpdate)
+template <bool bVideoUpdate, bool bZ80>
+static DWORD CpuExecuteLoop(const DWORD uTotalCycles, const bool bDebug)
 {
-	if (g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK)
+	if (GetMainCpu() == CPU_6502)	// Apple ][, ][+, //e, Clones
 	{
-		if (GetMainCpu() == CPU_6502)
-			return Cpu6502(uTotalCycles, bVideoUpdate);		// Apple ][, ][+, //e, Clones
+		if (!bDebug)
+			return Cpu6502<RunAccess<MemoryAccess_With_IO_F8xx>, bVideoUpdate, bZ80>(uTotalCycles);
 		else
-			return Cpu65C02(uTotalCycles, bVideoUpdate);	// Enhanced Apple //e
+			return Cpu6502<HeatmapAccess<MemoryAccess_With_IO_F8xx>, bVideoUpdate, bZ80>(uTotalCycles);
 	}
-	else
+	else							// Enhanced Apple //e
 	{
-		_ASSERT(g_nAppMode == MODE_STEPPING || g_nAppMode == MODE_DEBUG);
-		if (GetMainCpu() == CPU_6502)
-			return Cpu6502_debug(uTotalCycles, bVideoUpdate);	// Apple ][, ][+, //e, Clones
+		if (!bDebug)
+			return Cpu65C02<RunAccess<MemoryAccess>, bVideoUpdate, bZ80>(uTotalCycles);
 		else
-			return Cpu65C02_debug(uTotalCycles, bVideoUpdate);	// Enhanced Apple //e
+			return Cpu65C02<HeatmapAccess<MemoryAccess>, bVideoUpdate, bZ80>(uTotalCycles);
 	}
 }
 
+// The configuration is fixed for the whole batch: pick the loop once, nothing of it is tested per opcode
+static DWORD InternalCpuExecute(const DWORD uTotalCycles, const bool bVideoUpdate)
+{
+	const bool bDebug = !(g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_BENCHMARK);
+	_ASSERT(!bDebug || g_nAppMode == MODE_STEPPING || g_nAppMode == MODE_DEBUG);
+
+	// Only a Z80 card switches to the Z80 (see CPMZ80_IOWrite()), and it may have been removed since
+	const bool bZ80 = GetCardMgr().IsZ80CardInstalled() || GetActiveCpu() == CPU_Z80;
+
+	if (bVideoUpdate)
+		return bZ80 ? CpuExecuteLoop<true, true>(uTotalCycles, bDebug) : CpuExecuteLoop<true, false>(uTotalCycles, bDebug);
+	else
+		return bZ80 ? CpuExecuteLoop<false, true>(uTotalCycles, bDebug) : CpuExecuteLoop<false, false>(uTotalCycles, bDebug);
+}
+
 //
 // ----- ALL GLOBALLY ACCESSIBLE FUNCTIONS ARE BELOW THIS LINE -----
 //
@@ -535,10 +591,10 @@ BYTE CpuRead(USHORT addr, ULONG uExecutedCycles)
 {
 	if (g_nAppMode == MODE_RUNNING)
 	{
-		return _READ_WITH_IO_F8xx;	// Superset of _READ
+		return MemoryAccess_With_IO_F8xx::Read(addr, uExecutedCycles);	// Superset of MemoryAccess
 	}
 
-	return Heatmap_ReadByte_With_IO_F8xx(addr, uExecutedCycles);
+	return HeatmapAccess<MemoryAccess_With_IO_F8xx>::Read(addr, uExecutedCycles);
 }
 
 // Called by z80_WRMEM()
@@ -546,11 +602,31 @@ void CpuWrite(USHORT addr, BYTE value, ULONG uExecutedCycles)
 {
 	if (g_nAppMode == MODE_RUNNING)
 	{
-		_WRITE_WITH_IO_F8xx(value);	// Superset of _WRITE
+		MemoryAccess_With_IO_F8xx::Write(addr, value, uExecutedCycles);	// Superset of MemoryAccess
 		return;
 	}
 
-	Heatmap_WriteByte_With_IO_F8xx(addr, value, uExecutedCycles);
+	HeatmapAccess<MemoryAccess_With_IO_F8xx>::Write(addr, value, uExecutedCycles);
+}
+
+//===========================================================================
+
+static bool g_bIdleLoopSkip = true;
+
+// Called when the keyboard is read
+// . pc: address of the instruction following the read
+void CpuIdleLoopCandidate(const WORD pc)
+{
+	if (!g_bIdleLoopSkip)
+		return;
+
+	IdleLoopCandidate(pc - 3);
+}
+
+void CpuSetIdleLoopSkip(const bool enable)
+{
+	g_bIdleLoopSkip = enable;
+	g_uIdleLoopPC = kNoIdleLoopPC;
 }
 
 //===========================================================================
@@ -601,10 +677,7 @@ ULONG CpuGetCyclesThisVideoFrame(const ULONG nExecutedCycles)
 
 DWORD CpuExecute(const DWORD uCycles, const bool bVideoUpdate)
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeCpu;
-	PerfMarker perfMarker(g_timeCpu);
-#endif
+	PerfMarker perfMarker(PERF_CPU);
 
 	g_nCyclesExecuted =	0;
 	g_interruptInLastExecutionBatch = false;
@@ -613,10 +686,14 @@ DWORD CpuExecute(const DWORD uCycles, const bool bVideoUpdate)
 	MB_CheckCumulativeCycles();
 #endif
 
+	g_uTurboDiskTrapPC = GetCardMgr().GetDisk2CardMgr().GetTurboDiskTrapAddress();
+	g_uTapeTrapPC = TapeGetTrapAddress();
+
 	// uCycles:
 	//  =0  : Do single step
 	//  >0  : Do multi-opcode emulation
-	const DWORD uExecutedCycles = InternalCpuExecute(uCycles, bVideoUpdate);
+	// . When replaying a movie, the batch stops on the next event's cycle
+	const DWORD uExecutedCycles = InternalCpuExecute(MovieClipCycles(uCycles), bVideoUpdate);
 
 	// Update 6522s (NB. Do this before updating g_nCumulativeCycles below)
 	// . Ensures that 6522 regs are up-to-date for any potential save-state
@@ -626,6 +703,8 @@ DWORD CpuExecute(const DWORD uCycles, const bool bVideoUpdate)
 	const UINT nRemainingCycles = uExecutedCycles - g_nCyclesExecuted;
 	g_nCumulativeCycles	+= nRemainingCycles;
 
+	MovieUpdate();
+
 	return uExecutedCycles;
 }
 
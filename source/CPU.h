@@ -48,6 +48,9 @@ void    CpuLoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT version);
 BYTE	CpuRead(USHORT addr, ULONG uExecutedCycles);
 void	CpuWrite(USHORT addr, BYTE value, ULONG uExecutedCycles);
 
+void	CpuIdleLoopCandidate(const WORD pc);
+void	CpuSetIdleLoopSkip(const bool enable);
+
 enum eCpuType {CPU_UNKNOWN=0, CPU_6502=1, CPU_65C02, CPU_Z80};	// Don't change! Persisted to Registry
 
 eCpuType GetMainCpu(void);
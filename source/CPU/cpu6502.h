@@ -23,7 +23,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 //===========================================================================
 
-static DWORD Cpu6502(DWORD uTotalCycles, const bool bVideoUpdate)
+template <class Access, bool bVideoUpdate, bool bZ80>
+static DWORD Cpu6502(DWORD uTotalCycles)
 {
 	WORD addr;
 	BOOL flagc; // must always be 0 or 1, no other values allowed
@@ -46,7 +47,7 @@ static DWORD Cpu6502(DWORD uTotalCycles, const bool bVideoUpdate)
 		ULONG uPreviousCycles = uExecutedCycles;
 // NTSC_END
 
-		if (GetActiveCpu() == CPU_Z80)
+		if (bZ80 && GetActiveCpu() == CPU_Z80)
 		{
 			const UINT uZ80Cycles = z80_mainloop(uTotalCycles, uExecutedCycles); CYC(uZ80Cycles)
 		}
@@ -56,6 +57,8 @@ static DWORD Cpu6502(DWORD uTotalCycles, const bool bVideoUpdate)
 		}
 		else
 		{
+			IDLE_LOOP_X( regs.pc );
+			uPreviousCycles = uExecutedCycles;	// cycles skipped by the idle loop are already accounted for
 			HEATMAP_X( regs.pc );
 			Fetch(iOpcode, uExecutedCycles);
 
@@ -0,0 +1,195 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2020, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// Idle loop: a tight loop polling the keyboard, which is skipped over in whole iterations
+// . Candidate loops are found when the keyboard is read (see CpuIdleLoopCandidate()), then skipped at the loop's start
+// . Only loops whose iterations all leave the machine in the same state (apart from a counter) qualify:
+//   (a) start: LDA/LDX/LDY/BIT $C00x ; BPL/BMI start
+//   (b) start: INC zp ; BNE +2 ; INC zp+1 ; LDA/LDX/LDY/BIT $C00x ; BPL/BMI start	(eg. Monitor's KEYIN at $FD1B)
+// . The skip stops short of the end of the batch and of the next SyncEvent, so the result is cycle-exact
+static const UINT kNoIdleLoopPC = 0x10000;	// never matches a 16-bit PC
+static UINT g_uIdleLoopPC = kNoIdleLoopPC;
+static WORD g_uIdleLoopReadPC = 0;
+
+struct IdleLoop
+{
+	WORD readPC;			// the keyboard read
+	bool hasCounter;		// (b)
+	BYTE counterZP;
+	UINT cycles;			// per iteration, (b) when the counter doesn't carry
+	UINT carryCycles;		// (b) when the counter carries into zp+1
+};
+
+static bool IdleLoopIsCode(const WORD addr, const UINT len)
+{
+	// Not in I/O space (where mem[] isn't what the CPU sees), nor wrapping
+	return (addr & 0xF000) != 0xC000 && ((addr + len - 1) & 0xF000) != 0xC000 && addr + len <= 0x10000;
+}
+
+// Match the code around a keyboard read instruction against the loops above
+// Returns the loop's start, or kNoIdleLoopPC
+static UINT IdleLoopMatch(const WORD readPC, IdleLoop& loop)
+{
+	if (!IdleLoopIsCode(readPC, 5))
+		return kNoIdleLoopPC;
+
+	const BYTE opcode = mem[readPC];
+	if (opcode != 0xAD && opcode != 0xAE && opcode != 0xAC && opcode != 0x2C)	// LDA/LDX/LDY/BIT abs
+		return kNoIdleLoopPC;
+	if (mem[readPC+2] != 0xC0 || (mem[readPC+1] & 0xF0) != 0x00)
+		return kNoIdleLoopPC;
+
+	const BYTE branch = mem[readPC+3];
+	if (branch != 0x10 && branch != 0x30)	// BPL/BMI
+		return kNoIdleLoopPC;
+
+	const WORD branchNext = readPC + 5;
+	const WORD target = branchNext + (signed char)mem[readPC+4];
+	const UINT branchCycles = ((branchNext ^ target) & 0xFF00) ? 4 : 3;
+
+	loop.readPC = readPC;
+
+	if (target == readPC)
+	{
+		loop.hasCounter = false;
+		loop.counterZP = 0;
+		loop.cycles = loop.carryCycles = 4 + branchCycles;
+		return target;
+	}
+
+	if (target == (WORD)(readPC - 6) && IdleLoopIsCode(target, 6)
+		&& mem[target] == 0xE6 && mem[target+2] == 0xD0 && mem[target+3] == 0x02
+		&& mem[target+4] == 0xE6 && mem[target+5] == (BYTE)(mem[target+1] + 1))
+	{
+		const UINT bneCycles = (((target + 4) ^ readPC) & 0xFF00) ? 4 : 3;
+		loop.hasCounter = true;
+		loop.counterZP = mem[target+1];
+		loop.cycles = 5 + bneCycles + 4 + branchCycles;
+		loop.carryCycles = 5 + 2 + 5 + 4 + branchCycles;
+		return target;
+	}
+
+	return kNoIdleLoopPC;
+}
+
+static bool IdleLoopIsPolling(const IdleLoop& loop, const BYTE value)
+{
+	// The loop continues while the read keeps setting N the same way (for all 4 opcodes, N = bit7 of the value read)
+	const bool branchOnMinus = mem[loop.readPC+3] == 0x30;
+	return ((value & 0x80) != 0) == branchOnMinus;
+}
+
+// Called at the start of a candidate loop: skip whole iterations, leaving the last one (before the end of the batch) to be
+// executed, so the registers & flags end up as if every iteration had been executed.
+// The skipped cycles are given to the SyncEvents and to the video here (less than a frame at a time):
+// the CPU loops start counting the instruction's cycles after the skip (see IDLE_LOOP_X).
+static void IdleLoopSkip(ULONG& uExecutedCycles, const ULONG uTotalCycles, const bool bVideoUpdate)
+{
+	IdleLoop loop;
+	if (IdleLoopMatch(g_uIdleLoopReadPC, loop) != regs.pc	// code has changed
+		|| !IdleLoopIsPolling(loop, KeybReadData()))		// key pressed
+	{
+		g_uIdleLoopPC = kNoIdleLoopPC;
+		return;
+	}
+
+	// A pending IRQ/NMI must be taken on time
+	if ((g_bmIRQ && !(regs.ps & AF_INTERRUPT)) || g_bmNMI)
+		return;
+
+	if (uExecutedCycles >= uTotalCycles)
+		return;
+
+	UINT budget = uTotalCycles - uExecutedCycles;
+	const SyncEvent* pSyncEvent = g_SynchronousEventMgr.GetHead();
+	if (pSyncEvent && pSyncEvent->m_cyclesRemaining > 0)
+		budget = MIN(budget, (UINT)pSyncEvent->m_cyclesRemaining);
+
+	// Keep (at least) one iteration, which is executed normally
+	if (budget <= loop.carryCycles)
+		return;
+	budget -= loop.carryCycles;
+
+	UINT skippedCycles = 0;
+	if (!loop.hasCounter)
+	{
+		skippedCycles = (budget / loop.cycles) * loop.cycles;
+	}
+	else
+	{
+		// 16-bit counter: the iteration that wraps the low byte takes carryCycles
+		BYTE lo = mem[loop.counterZP];
+		BYTE hi = mem[(BYTE)(loop.counterZP + 1)];
+		while (true)
+		{
+			const UINT iterationsToCarry = 0x100 - lo;	// including the carrying one
+			const UINT cyclesToCarry = (iterationsToCarry - 1) * loop.cycles + loop.carryCycles;
+			if (skippedCycles + cyclesToCarry <= budget)
+			{
+				skippedCycles += cyclesToCarry;
+				lo = 0;
+				hi++;
+			}
+			else
+			{
+				const UINT iterations = MIN((budget - skippedCycles) / loop.cycles, iterationsToCarry - 1);
+				skippedCycles += iterations * loop.cycles;
+				lo += iterations;
+				break;
+			}
+		}
+
+		memdirty[0] = 0xFF;
+		*(memwrite[0] + loop.counterZP) = lo;
+		*(memwrite[0] + (BYTE)(loop.counterZP + 1)) = hi;
+	}
+
+	if (!skippedCycles)
+		return;
+
+	uExecutedCycles += skippedCycles;
+	CheckSynchronousInterruptSources(skippedCycles, uExecutedCycles);
+
+	if (bVideoUpdate)
+	{
+		const UINT maxVideoCycles = NTSC_GetCyclesPerFrame() - 1;
+		for (UINT cycles = skippedCycles; cycles; )
+		{
+			const UINT videoCycles = MIN(cycles, maxVideoCycles);
+			NTSC_VideoUpdateCycles(videoCycles);
+			cycles -= videoCycles;
+		}
+	}
+}
+
+// readPC: address of the keyboard read
+static void IdleLoopCandidate(const WORD readPC)
+{
+	IdleLoop loop;
+	const UINT start = IdleLoopMatch(readPC, loop);
+	if (start == kNoIdleLoopPC)
+		return;
+
+	g_uIdleLoopPC = start;
+	g_uIdleLoopReadPC = readPC;
+}
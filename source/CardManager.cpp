@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "CardManager.h"
 #include "Core.h"
+#include "PerfCounters.h"
 #include "Registry.h"
 
 #include "Disk.h"
@@ -82,6 +83,7 @@ void CardManager::InsertInternal(UINT slot, SS_CARDTYPE type)
 		break;
 	case CT_Z80:
 		m_slot[slot] = new DummyCard(type, slot);
+		m_numZ80Cards++;
 		break;
 	case CT_Phasor:
 		m_slot[slot] = new DummyCard(type, slot);
@@ -153,6 +155,9 @@ void CardManager::RemoveInternal(UINT slot)
 		case CT_SSC:
 			m_pSSC = NULL;
 			break;
+		case CT_Z80:
+			m_numZ80Cards--;
+			break;
 		case CT_LanguageCard:
 		case CT_Saturn128K:
 		case CT_LanguageCardIIe:
@@ -232,6 +237,8 @@ void CardManager::InitializeIO(LPBYTE pCxRomPeripheral)
 
 void CardManager::Update(const ULONG nExecutedCycles)
 {
+	PerfMarker perfMarker(PERF_CARDS);
+
 	for (UINT i = SLOT0; i < NUM_SLOTS; ++i)
 	{
 		if (m_slot[i])
@@ -10,7 +10,8 @@ public:
 	CardManager(void) :
 		m_pMouseCard(NULL),
 		m_pSSC(NULL),
-		m_pLanguageCard(NULL)
+		m_pLanguageCard(NULL),
+		m_numZ80Cards(0)
 	{
 		InsertInternal(SLOT0, CT_Empty);
 		InsertInternal(SLOT1, CT_GenericPrinter);
@@ -54,6 +55,7 @@ public:
 	bool IsMouseCardInstalled(void) { return m_pMouseCard != NULL; }
 	class CSuperSerialCard* GetSSC(void) { return m_pSSC; }
 	bool IsSSCInstalled(void) { return m_pSSC != NULL; }
+	bool IsZ80CardInstalled(void) { return m_numZ80Cards != 0; }
 
 	class LanguageCardUnit* GetLanguageCard(void) { return m_pLanguageCard; }
 
@@ -75,4 +77,5 @@ private:
 	class CMouseInterface* m_pMouseCard;
 	class CSuperSerialCard* m_pSSC;
 	class LanguageCardUnit* m_pLanguageCard;
+	UINT m_numZ80Cards;
 };
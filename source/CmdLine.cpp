@@ -31,12 +31,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "CmdLine.h"
 #include "Log.h"
 #include "Core.h"
+#include "CPU.h"
 #include "Memory.h"
 #include "LanguageCard.h"
 #include "Keyboard.h"
 #include "Joystick.h"
 #include "SoundCore.h"
 #include "ParallelPrinter.h"
+#include "PerfCounters.h"
 #include "Interface.h"
 
 CmdLine g_cmdLine;
@@ -108,6 +110,10 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 		{
 			LogInit();
 		}
+		else if (strcmp(lpCmdLine, "-log-async") == 0)
+		{
+			LogSetAsync(true);
+		}
 		else if (strcmp(lpCmdLine, "-noreg") == 0)
 		{
 			g_bRegisterFileTypes = false;
@@ -518,6 +524,20 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 			lpNextArg = GetNextArg(lpNextArg);
 			g_cmdLine.strCurrentDir = lpCmdLine;
 		}
+		else if (strcmp(lpCmdLine, "-perf") == 0)
+		{
+			PerfEnable(true);	// Stats are logged on exit
+		}
+		else if (strcmp(lpCmdLine, "-perf-trace") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			PerfStartTrace(lpCmdLine);	// Chrome trace-event JSON, written on exit
+		}
+		else if (strcmp(lpCmdLine, "-no-idle-skip") == 0)
+		{
+			CpuSetIdleLoopSkip(false);	// Interpret every iteration of keyboard polling loops
+		}
 		else if (strcmp(lpCmdLine, "-no-nsc") == 0)
 		{
 			g_cmdLine.bRemoveNoSlotClock = true;
@@ -92,51 +92,11 @@ CSpeech		g_Speech;
 
 //===========================================================================
 
-#ifdef LOG_PERF_TIMINGS
-static UINT64 g_timeTotal = 0;
-UINT64 g_timeCpu = 0;
-UINT64 g_timeVideo = 0;			// part of timeCpu
-UINT64 g_timeMB_Timer = 0;		// part of timeCpu
-UINT64 g_timeMB_NoTimer = 0;
-UINT64 g_timeSpeaker = 0;
-static UINT64 g_timeVideoRefresh = 0;
-
-void LogPerfTimings(void)
-{
-	if (g_timeTotal)
-	{
-		UINT64 cpu = g_timeCpu - g_timeVideo - g_timeMB_Timer;
-		UINT64 video = g_timeVideo + g_timeVideoRefresh;
-		UINT64 spkr = g_timeSpeaker;
-		UINT64 mb = g_timeMB_Timer + g_timeMB_NoTimer;
-		UINT64 audio = spkr + mb;
-		UINT64 other = g_timeTotal - g_timeCpu - g_timeSpeaker - g_timeMB_NoTimer - g_timeVideoRefresh;
-
-		LogOutput("Perf breakdown:\n");
-		LogOutput(". CPU %%        = %6.2f\n", (double)cpu / (double)g_timeTotal * 100.0);
-		LogOutput(". Video %%      = %6.2f\n", (double)video / (double)g_timeTotal * 100.0);
-		LogOutput("... NTSC %%     = %6.2f\n", (double)g_timeVideo / (double)g_timeTotal * 100.0);
-		LogOutput("... refresh %%  = %6.2f\n", (double)g_timeVideoRefresh / (double)g_timeTotal * 100.0);
-		LogOutput(". Audio %%      = %6.2f\n", (double)audio / (double)g_timeTotal * 100.0);
-		LogOutput("... Speaker %%  = %6.2f\n", (double)spkr / (double)g_timeTotal * 100.0);
-		LogOutput("... MB %%       = %6.2f\n", (double)mb / (double)g_timeTotal * 100.0);
-		LogOutput(". Other %%      = %6.2f\n", (double)other / (double)g_timeTotal * 100.0);
-		LogOutput(". TOTAL %%      = %6.2f\n", (double)(cpu+video+audio+other) / (double)g_timeTotal * 100.0);
-	}
-}
-#endif
-
-//===========================================================================
-
 static DWORD dwLogKeyReadTickStart;
 static bool bLogKeyReadDone = false;
 
 void LogFileTimeUntilFirstKeyReadReset(void)
 {
-#ifdef LOG_PERF_TIMINGS
-	LogPerfTimings();
-#endif
-
 	if (!g_fh)
 		return;
 
@@ -70,25 +70,3 @@ extern bool       g_bDisableDirectSound;				// Cmd line switch: don't init DS (s
 extern bool       g_bDisableDirectSoundMockingboard;	// Cmd line switch: don't init MB support
 
 class Pravets& GetPravets(void);
-
-//#define LOG_PERF_TIMINGS
-#ifdef LOG_PERF_TIMINGS
-class PerfMarker
-{
-public:
-	PerfMarker(UINT64& globalCounter)
-		: counter(globalCounter)
-	{
-		QueryPerformanceCounter(&timeStart);
-	}
-	~PerfMarker()
-	{
-		QueryPerformanceCounter(&timeEnd);
-		counter += (UINT64)timeEnd.QuadPart - (UINT64)timeStart.QuadPart;
-	}
-private:
-	UINT64& counter;
-	LARGE_INTEGER timeStart;
-	LARGE_INTEGER timeEnd;
-};
-#endif
@@ -222,6 +222,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	// Made global so operator @# can be used with other commands.
 	MemorySearchResults_t g_vMemorySearchResults;
 
+	// SX, CHEAT: all banks can hold a lot of matches
+	const int MAX_MEMORY_SEARCH_MATCHES = 256;
+	const int MAX_CHEAT_DISPLAY         = 64;
+
 
 // Profile
 	const int NUM_PROFILE_LINES = NUM_OPCODES + NUM_OPMODES + 16;
@@ -1589,6 +1593,49 @@ void _BWZ_RemoveAll( Breakpoint_t *aBreakWatchZero, const int nMax, int & nTotal
 	}
 }
 
+// For external debuggers (e.g. GDB stub): breakpoints [nAddress,nAddress+nLength) with no console output
+//===========================================================================
+bool DebugBreakpointAdd ( BreakpointSource_t eSource, WORD nAddress, UINT nLength )
+{
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[ iBreakpoint ];
+		if (!pBP->bSet)
+		{
+			_CmdBreakpointAddReg( pBP, eSource, BP_OP_EQUAL, nAddress, nLength ? nLength : 1, false );
+			g_nBreakpoints++;
+			return true;
+		}
+	}
+
+	return false; // all slots in use
+}
+
+//===========================================================================
+bool DebugBreakpointRemove ( BreakpointSource_t eSource, WORD nAddress, UINT nLength )
+{
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		const Breakpoint_t & bp = g_aBreakpoints[ iBreakpoint ];
+		if (bp.bSet && bp.eSource == eSource && bp.eOperator == BP_OP_EQUAL &&
+			bp.nAddress == nAddress && bp.nLength == (nLength ? nLength : 1))
+		{
+			_BWZ_RemoveOne( g_aBreakpoints, iBreakpoint, g_nBreakpoints );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// @return BreakpointHit_t flags of the last stop, and the address of a memory breakpoint
+//===========================================================================
+int DebugGetBreakpointHit ( WORD & nAddress_ )
+{
+	nAddress_ = g_uBreakMemoryAddress;
+	return g_bDebugBreakpointHit;
+}
+
 // called by BreakpointsClear, WatchesClear, ZeroPagePointersClear
 //===========================================================================
 void _BWZ_ClearViaArgs( int nArgs, Breakpoint_t * aBreakWatchZero, const int nMax, int & nTotal )
@@ -5227,6 +5274,8 @@ Update_t CmdNTSC (int nArgs)
 				else
 					Swizzle32::RGBAswapBGRA( g_nChromaSize, pSwizzled, (uint8_t*) pChromaTable );
 
+				NTSC_VideoChromaTableChanged();
+
 _error:
 				fclose( pFile );
 				delete [] pSwizzled;
@@ -5315,98 +5364,15 @@ int _SearchMemoryFind(
 	WORD nAddressStart,
 	WORD nAddressEnd )
 {
-	int nFound = 0;
-
 	g_vMemorySearchResults.clear();
 	g_vMemorySearchResults.push_back( NO_6502_TARGET );
 
-	WORD nAddress;
-	for( nAddress = nAddressStart; nAddress < nAddressEnd; nAddress++ )
-	{
-		bool bMatchAll = true;
-
-		WORD nAddress2 = nAddress;
-
-		int nMemBlocks = vMemorySearchValues.size();
-		for (int iBlock = 0; iBlock < nMemBlocks; iBlock++, nAddress2++ )
-		{
-			MemorySearch_t ms = vMemorySearchValues.at( iBlock );
-			ms.m_bFound = false;
-		
-			if ((ms.m_iType == MEM_SEARCH_BYTE_EXACT    ) || 
-				(ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT) ||
-				(ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT ))
-			{
-				BYTE nTarget = *(mem + nAddress2);
-	
-				if (ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT)
-					nTarget &= 0x0F;
-
-				if (ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT)
-					nTarget &= 0xF0;
-				
-				if (ms.m_nValue == nTarget)
-				{ // ms.m_nAddress = nAddress2;
-					ms.m_bFound = true;
-					continue;
-				}
-				else
-				{
-					bMatchAll = false;
-					break;
-				}
-			}
-			else
-			if (ms.m_iType == MEM_SEARCH_BYTE_1_WILD)
-			{
-				// match by definition
-			}
-			else
-			{
-				// start 2ndary search
-				// if next block matches, then this block matches (since we are wild)
-				if ((iBlock + 1) == nMemBlocks) // there is no next block, hence we match
-					continue;
-
-				WORD nAddress3 = nAddress2;
-				for (nAddress3 = nAddress2; nAddress3 < nAddressEnd; nAddress3++ )
-				{
-					if ((ms.m_iType == MEM_SEARCH_BYTE_EXACT    ) || 
-						(ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT) ||
-						(ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT ))
-					{
-						BYTE nTarget = *(mem + nAddress3);
-			
-						if (ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT)
-							nTarget &= 0x0F;
-
-						if (ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT)
-							nTarget &= 0xF0;
-						
-						if (ms.m_nValue == nTarget)
-						{
-							nAddress2 = nAddress3;
-							continue;
-						}
-						else
-						{
-							bMatchAll = false;
-							break;
-						}
-					}
-
-				}
-			}
-		}
+	std::vector<UINT> vOffsets;
+	int nFound = MemorySearchPattern( vMemorySearchValues, mem, _6502_MEM_LEN, nAddressStart, nAddressEnd, vOffsets, _6502_MEM_LEN );
 
-		if (bMatchAll)
-		{
-			nFound++;
-
-			// Save the search result
-			g_vMemorySearchResults.push_back( nAddress );
-		}
-	}
+	// Save the search results
+	for (int iFound = 0; iFound < nFound; iFound++)
+		g_vMemorySearchResults.push_back( vOffsets[ iFound ] );
 
 	return nFound;
 }
@@ -5507,25 +5473,12 @@ Update_t _SearchMemoryDisplay (int nArgs)
 }
 
 
+// Returns false if a value is invalid
 //===========================================================================
-Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true )
+bool _SearchMemoryGetValues (int nArgs, int iArgFirstByte, MemorySearchValues_t & vMemorySearchValues )
 {
-	WORD nAddressStart = 0;
-	WORD nAddress2   = 0;
-	WORD nAddressEnd = 0;
-	int  nAddressLen = 0;
-
-	RangeType_t eRange;
-	eRange = Range_Get( nAddressStart, nAddress2 );
-
-//	if (eRange == RANGE_MISSING_ARG_2)
-	if (! Range_CalcEndLen( eRange, nAddressStart, nAddress2, nAddressEnd, nAddressLen))
-		return ConsoleDisplayError( "Error: Missing address seperator (comma or colon)" );
-
-	int iArgFirstByte = 4;
 	int iArg;
 
-	MemorySearchValues_t vMemorySearchValues;
 	MemorySearch_e       tLastType = MEM_SEARCH_BYTE_N_WILD;
 	
 	// Get search "string"
@@ -5615,7 +5568,7 @@ Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true )
 				if (pArg->nArgLen > 2)
 				{
 					vMemorySearchValues.clear();
-					return HelpLastCommand();
+					return false;
 				}
 
 				if (pArg->nArgLen == 1)
@@ -5660,6 +5613,29 @@ Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true )
 		tLastType = ms.m_iType;
 	}
 
+	return true;
+}
+
+
+//===========================================================================
+Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true )
+{
+	WORD nAddressStart = 0;
+	WORD nAddress2   = 0;
+	WORD nAddressEnd = 0;
+	int  nAddressLen = 0;
+
+	RangeType_t eRange;
+	eRange = Range_Get( nAddressStart, nAddress2 );
+
+//	if (eRange == RANGE_MISSING_ARG_2)
+	if (! Range_CalcEndLen( eRange, nAddressStart, nAddress2, nAddressEnd, nAddressLen))
+		return ConsoleDisplayError( "Error: Missing address seperator (comma or colon)" );
+
+	MemorySearchValues_t vMemorySearchValues;
+	if (! _SearchMemoryGetValues( nArgs, 4, vMemorySearchValues ))
+		return HelpLastCommand();
+
 	_SearchMemoryFind( vMemorySearchValues, nAddressStart, nAddressEnd );
 	vMemorySearchValues.clear();
 
@@ -5709,6 +5685,151 @@ Update_t CmdMemorySearchHex (int nArgs)
 	return _CmdMemorySearch( nArgs, true );
 }
 
+// Cheat matches also show the value at the last scan > now
+//===========================================================================
+static int _SearchMemoryMatchValues ( const MemoryMatch_t & match, std::string & sResult_ )
+{
+	return 0;
+}
+
+static int _SearchMemoryMatchValues ( const CheatMatch_t & match, std::string & sResult_ )
+{
+	sResult_ += StrFormat( "%s%02X%s>%s%02X ", CHC_NUM_HEX, match.m_nPrevious, CHC_ARG_SEP, CHC_NUM_HEX, match.m_nValue );
+	return 6;
+}
+
+
+// Prints bank:address of each match, as many as fit on a line
+//===========================================================================
+template <class Match>
+static void _SearchMemoryDisplayMatches ( const std::vector<Match> & vMatches )
+{
+	const std::vector<MemoryRegion_t> & aRegions = MemorySearchGetRegions();
+
+	std::string sLine;
+	int nLineLen = 0;
+
+	for (size_t iMatch = 0; iMatch < vMatches.size(); iMatch++)
+	{
+		const Match & match = vMatches[ iMatch ];
+		const std::string & sRegion = aRegions[ match.m_iRegion ].m_sName;
+
+		std::string sResult = StrFormat( "%s%s%s:%s%04X ", CHC_NUM_HEX, sRegion.c_str(), CHC_ARG_SEP, CHC_ADDRESS, match.m_nAddress );
+		int nLen = (int) sRegion.size() + 6;
+		nLen += _SearchMemoryMatchValues( match, sResult );
+
+		// Fit on same line?
+		if ((nLineLen + nLen) > (g_nConsoleDisplayWidth - 1))
+		{
+			ConsolePrint( sLine.c_str() );
+			sLine.clear();
+			nLineLen = 0;
+		}
+
+		sLine += sResult;
+		nLineLen += nLen;
+	}
+
+	if (nLineLen)
+		ConsolePrint( sLine.c_str() );
+}
+
+
+// Search all banks: main, aux, RamWorks & language card
+//===========================================================================
+Update_t CmdMemorySearchAll (int nArgs)
+{
+	if (nArgs < 1)
+		return HelpLastCommand();
+
+	MemorySearchValues_t vMemorySearchValues;
+	if (! _SearchMemoryGetValues( nArgs, 1, vMemorySearchValues ))
+		return HelpLastCommand();
+
+	std::vector<MemoryMatch_t> vMatches;
+	MemorySearchAll( vMemorySearchValues, vMatches, MAX_MEMORY_SEARCH_MATCHES );
+
+	_SearchMemoryDisplayMatches( vMatches );
+
+	if (vMatches.size() >= (size_t) MAX_MEMORY_SEARCH_MATCHES)
+		ConsolePrintFormat( "%sStopped after %d matches", CHC_WARNING, MAX_MEMORY_SEARCH_MATCHES );
+	else
+		ConsolePrintFormat( "%sTotal%s: %s%d", CHC_USAGE, CHC_DEFAULT, CHC_NUM_DEC, (int) vMatches.size() );
+
+	return ConsoleUpdate();
+}
+
+
+//===========================================================================
+Update_t CmdMemoryCheat (int nArgs)
+{
+	int  iParam;
+	bool bList = false;
+
+	if (nArgs >= 1)
+	{
+		if (FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END ))
+		{
+			if (nArgs > 1)
+				return HelpLastCommand();
+
+			if (iParam == PARAM_RESET)
+			{
+				CheatReset();
+			}
+			else
+			if (iParam == PARAM_CLEAR)
+			{
+				CheatClear();
+				ConsoleBufferPush( "Cheat search cleared" );
+				return ConsoleUpdate();
+			}
+			else
+			if (iParam == PARAM_LIST)
+				bList = true;
+			else
+				return HelpLastCommand();
+		}
+		else
+		if (FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_CHEAT_BEGIN, _PARAM_CHEAT_END ))
+		{
+			const CheatCompare_e eCompare = (CheatCompare_e)(iParam - _PARAM_CHEAT_BEGIN);
+			const bool bValue = (eCompare == CHEAT_EQUAL) || (eCompare == CHEAT_NOT_EQUAL);
+
+			if (nArgs != (bValue ? 2 : 1))
+				return HelpLastCommand();
+
+			if (bValue && (g_aArgs[ 2 ].nValue > 0xFF))
+				return ConsoleDisplayError( "Error: value must be a byte" );
+
+			if (CheatFilter( eCompare, bValue ? (BYTE) g_aArgs[ 2 ].nValue : 0 ) == CHEAT_NOT_STARTED)
+				return ConsoleDisplayErrorFormat( "Error: no search in progress, start one with: %s %s",
+					g_aCommands[ CMD_MEMORY_CHEAT ].m_sName, g_aParameters[ PARAM_RESET ].m_sName );
+		}
+		else
+			return HelpLastCommand();
+	}
+
+	const int nCandidates = CheatGetCount();
+	if (nCandidates == CHEAT_NOT_STARTED)
+	{
+		ConsoleBufferPush( "No cheat search in progress" );
+		return ConsoleUpdate();
+	}
+
+	// Listing the whole memory is pointless: wait for the first comparison, unless asked for
+	if ((nCandidates <= MAX_CHEAT_DISPLAY) || bList)
+	{
+		std::vector<CheatMatch_t> vMatches;
+		CheatGetMatches( vMatches, MAX_CHEAT_DISPLAY );
+		_SearchMemoryDisplayMatches( vMatches );
+	}
+
+	ConsolePrintFormat( "%sCandidates%s: %s%d", CHC_USAGE, CHC_DEFAULT, CHC_NUM_DEC, nCandidates );
+
+	return ConsoleUpdate();
+}
+
 
 // Registers ______________________________________________________________________________________
 
@@ -6315,7 +6436,7 @@ bool ParseAssemblyListing( bool bBytesToMemory, bool bAddSymbols )
 					{
 						char *pAddressEnd;
 						nAddress = (DWORD) strtol( pAddress, &pAddressEnd, 16 );
-						g_aSymbols[ SYMBOLS_SRC_2 ][ (WORD) nAddress] = sName;
+						g_aSymbols[ SYMBOLS_SRC_2 ].Set( (WORD) nAddress, sName );
 						g_nSourceAssemblySymbols++;
 					}
 				}
@@ -8204,6 +8325,7 @@ void DebugBegin ()
 		g_aOpmodes[ AM_2 ].m_nBytes = 2;
 		g_aOpmodes[ AM_3 ].m_nBytes = 3;
 	}
+	DisasmCacheInvalidate();
 
 	InitDisasm();
 
@@ -8810,6 +8932,9 @@ Update_t DebuggerProcessCommand ( const bool bEchoConsoleInput )
 		}
 	}
 
+	// Any command can change the symbols, the data disassembly or the disassembly options
+	DisasmCacheInvalidate();
+
 	return bUpdateDisplay;
 }
 
@@ -13,6 +13,7 @@
 #include "Debugger_Help.h"
 #include "Debugger_Display.h"
 #include "Debugger_Symbols.h"
+#include "Debugger_Search.h"
 #include "Util_MemoryTextFile.h"
 
 // Globals __________________________________________________________________
@@ -151,6 +152,10 @@
 
 	bool GetBreakpointInfo ( WORD nOffset, bool & bBreakpointActive_, bool & bBreakpointEnable_ );
 
+	bool DebugBreakpointAdd    ( BreakpointSource_t eSource, WORD nAddress, UINT nLength );
+	bool DebugBreakpointRemove ( BreakpointSource_t eSource, WORD nAddress, UINT nLength );
+	int  DebugGetBreakpointHit ( WORD & nAddress_ );
+
 // Source Level Debugging
 	int FindSourceLine( WORD nAddress );
 
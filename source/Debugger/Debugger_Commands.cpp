@@ -208,6 +208,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //		{TEXT("SA")          , CmdMemorySearchAscii,  CMD_MEMORY_SEARCH_ASCII  , "Search ASCII text"            },
 //		{TEXT("ST")          , CmdMemorySearchApple , CMD_MEMORY_SEARCH_APPLE  , "Search Apple text (hi-bit)"   },
 		{TEXT("SH")          , CmdMemorySearchHex   , CMD_MEMORY_SEARCH_HEX    , "Search memory for hex values" },
+		{TEXT("SX")          , CmdMemorySearchAll   , CMD_MEMORY_SEARCH_ALL    , "Search all memory banks for text / hex values" },
+		{TEXT("CHEAT")       , CmdMemoryCheat       , CMD_MEMORY_CHEAT         , "Narrow down the bytes changing with the game state" },
 		{TEXT("F")           , CmdMemoryFill        , CMD_MEMORY_FILL          , "Memory fill"                  },
 
 		{TEXT("NTSC")        , CmdNTSC              , CMD_NTSC                 , "Save/Load the NTSC palette"   },
@@ -484,6 +486,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // Memory
 		{TEXT("?")          , NULL, PARAM_MEM_SEARCH_WILD },
 //		{TEXT("*")          , NULL, PARAM_MEM_SEARCH_BYTE },
+// Cheat
+		{TEXT("EQ")         , NULL, PARAM_CHEAT_EQUAL     },
+		{TEXT("NE")         , NULL, PARAM_CHEAT_NOT_EQUAL },
+		{TEXT("CHANGED")    , NULL, PARAM_CHEAT_CHANGED   },
+		{TEXT("SAME")       , NULL, PARAM_CHEAT_UNCHANGED },
+		{TEXT("INC")        , NULL, PARAM_CHEAT_INCREASED },
+		{TEXT("DEC")        , NULL, PARAM_CHEAT_DECREASED },
 // Source level debugging
 		{TEXT("MEM")        , NULL, PARAM_SRC_MEMORY      },
 		{TEXT("MEMORY")     , NULL, PARAM_SRC_MEMORY      },
@@ -158,17 +158,17 @@ void GetTargets_IgnoreDirectJSRJMP(const BYTE iOpcode, int& nTargetPointer)
 }
 
 
-// Get the data needed to disassemble one line of opcodes. Fills in the DisasmLine info.
-// Disassembly formatting flags returned
-//	@parama sTargetValue_ indirect/indexed final value
+// Everything that only depends on the bytes of the line (and on the symbols, data disassembly & options)
+// bTargets_ is set if GetDisassemblyTargets() must then be called
 //===========================================================================
-int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
+static int GetDisassemblyLineBytes(WORD nBaseAddress, DisasmLine_t& line_, bool& bTargets_)
 //	char *sAddress_, char *sOpCodes_,
 //	char *sTarget_, char *sTargetOffset_, int & nTargetOffset_,
 //	char *sTargetPointer_, char *sTargetValue_,
 //	char *sImmediate_, char & nImmediate_, char *sBranch_ )
 {
 	line_.Clear();
+	bTargets_ = false;
 
 	int iOpcode;
 	int iOpmode;
@@ -334,53 +334,8 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 			}
 			strncpy_s(line_.sTarget, pTarget->c_str(), _TRUNCATE);
 
-			// Indirect / Indexed
-			int nTargetPartial;
-			int nTargetPartial2;
-			int nTargetPointer;
-			WORD nTargetValue = 0; // de-ref
-			_6502_GetTargets(nBaseAddress, &nTargetPartial, &nTargetPartial2, &nTargetPointer, NULL);
-			GetTargets_IgnoreDirectJSRJMP(iOpcode, nTargetPointer);	// For *direct* JSR/JMP, don't show 'addr16:byte char'
-
-			if (nTargetPointer != NO_6502_TARGET)
-			{
-				bDisasmFormatFlags |= DISASM_FORMAT_TARGET_POINTER;
-
-				nTargetValue = *(mem + nTargetPointer) | (*(mem + ((nTargetPointer + 1) & 0xffff)) << 8);
-
-				//				if (((iOpmode >= AM_A) && (iOpmode <= AM_NZ)) && (iOpmode != AM_R))
-				//					sprintf( sTargetValue_, "%04X", nTargetValue ); // & 0xFFFF
-
-				if (g_iConfigDisasmTargets & DISASM_TARGET_ADDR)
-					sprintf(line_.sTargetPointer, "%04X", nTargetPointer & 0xFFFF);
-
-				if (iOpcode != OPCODE_JMP_NA && iOpcode != OPCODE_JMP_IAX)
-				{
-					bDisasmFormatFlags |= DISASM_FORMAT_TARGET_VALUE;
-					if (g_iConfigDisasmTargets & DISASM_TARGET_VAL)
-						sprintf(line_.sTargetValue, "%02X", nTargetValue & 0xFF);
-
-					bDisasmFormatFlags |= DISASM_FORMAT_CHAR;
-					line_.nImmediate = (BYTE)nTargetValue;
-
-					unsigned _char = FormatCharTxtCtrl(FormatCharTxtHigh(line_.nImmediate, NULL), NULL);
-					sprintf(line_.sImmediate, "%c", _char);
-
-					//					if (ConsoleColorIsEscapeMeta( nImmediate_ ))
-#if OLD_CONSOLE_COLOR
-					if (ConsoleColorIsEscapeMeta(_char))
-						sprintf(line_.sImmediate, "%c%c", _char, _char);
-					else
-						sprintf(line_.sImmediate, "%c", _char);
-#endif
-				}
-
-				//				if (iOpmode == AM_NA ) // Indirect Absolute
-				//					sprintf( sTargetValue_, "%04X", nTargetPointer & 0xFFFF );
-				//				else
-				// //					sprintf( sTargetValue_, "%02X", nTargetValue & 0xFF );
-				//					sprintf( sTargetValue_, "%04X:%02X", nTargetPointer & 0xFFFF, nTargetValue & 0xFF );
-			}
+			// Indirect / Indexed: see GetDisassemblyTargets()
+			bTargets_ = true;
 		}
 		else
 			if (iOpmode == AM_M)
@@ -439,6 +394,132 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 	return bDisasmFormatFlags;
 }
 
+// Indirect / indexed operands: depend on the registers & on the rest of memory, so they are never cached
+//	@parama sTargetValue_ indirect/indexed final value
+//===========================================================================
+static int GetDisassemblyTargets(WORD nBaseAddress, DisasmLine_t& line_, int bDisasmFormatFlags)
+{
+	const int iOpcode = line_.iOpcode;
+
+	int nTargetPartial;
+	int nTargetPartial2;
+	int nTargetPointer;
+	WORD nTargetValue = 0; // de-ref
+	_6502_GetTargets(nBaseAddress, &nTargetPartial, &nTargetPartial2, &nTargetPointer, NULL);
+	GetTargets_IgnoreDirectJSRJMP(iOpcode, nTargetPointer);	// For *direct* JSR/JMP, don't show 'addr16:byte char'
+
+	if (nTargetPointer != NO_6502_TARGET)
+	{
+		bDisasmFormatFlags |= DISASM_FORMAT_TARGET_POINTER;
+
+		nTargetValue = *(mem + nTargetPointer) | (*(mem + ((nTargetPointer + 1) & 0xffff)) << 8);
+
+		//				if (((iOpmode >= AM_A) && (iOpmode <= AM_NZ)) && (iOpmode != AM_R))
+		//					sprintf( sTargetValue_, "%04X", nTargetValue ); // & 0xFFFF
+
+		if (g_iConfigDisasmTargets & DISASM_TARGET_ADDR)
+			sprintf(line_.sTargetPointer, "%04X", nTargetPointer & 0xFFFF);
+
+		if (iOpcode != OPCODE_JMP_NA && iOpcode != OPCODE_JMP_IAX)
+		{
+			bDisasmFormatFlags |= DISASM_FORMAT_TARGET_VALUE;
+			if (g_iConfigDisasmTargets & DISASM_TARGET_VAL)
+				sprintf(line_.sTargetValue, "%02X", nTargetValue & 0xFF);
+
+			bDisasmFormatFlags |= DISASM_FORMAT_CHAR;
+			line_.nImmediate = (BYTE)nTargetValue;
+
+			unsigned _char = FormatCharTxtCtrl(FormatCharTxtHigh(line_.nImmediate, NULL), NULL);
+			sprintf(line_.sImmediate, "%c", _char);
+
+			//					if (ConsoleColorIsEscapeMeta( nImmediate_ ))
+#if OLD_CONSOLE_COLOR
+			if (ConsoleColorIsEscapeMeta(_char))
+				sprintf(line_.sImmediate, "%c%c", _char, _char);
+			else
+				sprintf(line_.sImmediate, "%c", _char);
+#endif
+		}
+
+		//				if (iOpmode == AM_NA ) // Indirect Absolute
+		//					sprintf( sTargetValue_, "%04X", nTargetPointer & 0xFFFF );
+		//				else
+		// //					sprintf( sTargetValue_, "%02X", nTargetValue & 0xFF );
+		//					sprintf( sTargetValue_, "%04X:%02X", nTargetPointer & 0xFFFF, nTargetValue & 0xFF );
+	}
+
+	return bDisasmFormatFlags;
+}
+
+// Disassembly cache
+// . Lines are looked up by address, and are only valid for the bytes they were disassembled from:
+//   any write (or change of memory bank) is noticed on the next lookup, and only these lines are disassembled again
+// . Debugger commands can change the symbols, the data disassembly and the disassembly options, so they invalidate everything
+static const UINT DISASM_CACHE_SIZE = 1024;	// direct mapped, more than the lines of any view
+static const int DISASM_CACHE_MAX_BYTES = 8;	// longer (data) lines are not cached
+
+struct DisasmCacheEntry_t
+{
+	bool         bValid;
+	WORD         nAddress;
+	UINT         nGeneration;
+	BYTE         aBytes[ DISASM_CACHE_MAX_BYTES ];
+	int          bDisasmFormatFlags;
+	bool         bTargets;
+	DisasmLine_t line;
+};
+
+static std::vector<DisasmCacheEntry_t> g_aDisasmCache;
+static UINT g_nDisasmCacheGeneration = 0;
+
+//===========================================================================
+void DisasmCacheInvalidate()
+{
+	g_nDisasmCacheGeneration++;
+}
+
+//===========================================================================
+static bool DisasmCacheIsValid(const DisasmCacheEntry_t& entry, const WORD nBaseAddress)
+{
+	if (!entry.bValid || entry.nAddress != nBaseAddress || entry.nGeneration != g_nDisasmCacheGeneration)
+		return false;
+
+	for (int i = 0; i < entry.line.nOpbyte; i++)
+	{
+		if (mem[(nBaseAddress + i) & 0xFFFF] != entry.aBytes[i])
+			return false;
+	}
+
+	return true;
+}
+
+// Get the data needed to disassemble one line of opcodes. Fills in the DisasmLine info.
+// Disassembly formatting flags returned
+//===========================================================================
+int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
+{
+	if (g_aDisasmCache.empty())
+		g_aDisasmCache.resize(DISASM_CACHE_SIZE);
+
+	DisasmCacheEntry_t& entry = g_aDisasmCache[nBaseAddress % DISASM_CACHE_SIZE];
+	if (!DisasmCacheIsValid(entry, nBaseAddress))
+	{
+		entry.bDisasmFormatFlags = GetDisassemblyLineBytes(nBaseAddress, entry.line, entry.bTargets);
+		entry.nAddress = nBaseAddress;
+		entry.nGeneration = g_nDisasmCacheGeneration;
+		entry.bValid = entry.line.nOpbyte <= DISASM_CACHE_MAX_BYTES;
+		for (int i = 0; entry.bValid && i < entry.line.nOpbyte; i++)
+			entry.aBytes[i] = mem[(nBaseAddress + i) & 0xFFFF];
+	}
+
+	line_ = entry.line;
+	int bDisasmFormatFlags = entry.bDisasmFormatFlags;
+	if (entry.bTargets)
+		bDisasmFormatFlags = GetDisassemblyTargets(nBaseAddress, line_, bDisasmFormatFlags);
+
+	return bDisasmFormatFlags;
+}
+
 //===========================================================================
 void FormatOpcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 {
@@ -1,6 +1,7 @@
 #pragma once
 
 int GetDisassemblyLine(const WORD nOffset, DisasmLine_t& line_);
+void DisasmCacheInvalidate();
 //		, int iOpcode, int iOpmode, int nOpbytes
 //		char *sAddress_, char *sOpCodes_,
 //		char *sTarget_, char *sTargetOffset_, int & nTargetOffset_, char *sTargetValue_,
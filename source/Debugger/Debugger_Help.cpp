@@ -1277,6 +1277,30 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsolePrintFormat( "%s   %s F000:FFFF C030"   , CHC_EXAMPLE, pCommand->m_sName );
 			ConsolePrintFormat( "%s   U @1 - 1"            , CHC_EXAMPLE                    );
 			break;
+		case CMD_MEMORY_SEARCH_ALL:
+			ConsoleColorizePrint( " Usage: <\"ASCII text\" | 'apple text' | hex>" );
+			ConsoleBufferPush( "  Searches main, aux, RamWorks and language card banks" );
+			ConsoleBufferPush( "  Values are as for SH, ?? matches any number of bytes" );
+			ConsoleBufferPush( "  Matches are shown as bank:address" );
+			Help_Examples();
+			ConsolePrintFormat( "%s   %s 'PRESS'"          , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( "%s   %s A9 ? 8D ?? 60"    , CHC_EXAMPLE, pCommand->m_sName );
+			break;
+		case CMD_MEMORY_CHEAT:
+			ConsoleColorizePrint( " Usage: [RESET | EQ ## | NE ## | CHANGED | SAME | INC | DEC | LIST | CLEAR]" );
+			ConsoleBufferPush( "  Finds the byte(s) holding a game value (lives, energy, ...) in all banks" );
+			ConsoleBufferPush( "  RESET starts a new search: every byte is a candidate" );
+			ConsoleBufferPush( "  Each comparison keeps the candidates whose value now is:" );
+			ConsoleBufferPush( "    EQ/NE ##     equal/not equal to ##" );
+			ConsoleBufferPush( "    CHANGED/SAME different/equal to the previous scan" );
+			ConsoleBufferPush( "    INC/DEC      greater/less than the previous scan" );
+			ConsoleBufferPush( "  Candidates are shown as bank:address previous>now" );
+			Help_Examples();
+			ConsolePrintFormat( "%s   %s RESET   // 3 lives"       , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( "%s   %s EQ 3"                     , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( "%s   %s DEC     // lost a life"   , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( "%s   %s SAME    // nothing happened", CHC_EXAMPLE, pCommand->m_sName );
+			break;
 //		case CMD_MEMORY_SEARCH_APPLE:
 //			ConsoleBufferPushFormat( "Deprecated.  Use: %s", g_aCommands[ CMD_MEMORY_SEARCH ].m_sName );
 //			break;
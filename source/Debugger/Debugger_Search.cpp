@@ -0,0 +1,580 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2010, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Memory Search & Cheat Finder
+ *
+ * The pattern search skips to the next exact byte of the pattern with memchr(),
+ * which the C runtime implements with SIMD.
+ * The cheat finder compares a whole bank at once into a mask (a branch-free loop the compiler vectorises),
+ * then only keeps the offsets of the candidates: later scans just walk the candidate list.
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+#include "DebugDefs.h"
+
+#include "../Core.h"
+#include "../CardManager.h"
+#include "../LanguageCard.h"
+#include "../Memory.h"
+
+// Memory Search __________________________________________________________________________________
+
+	// A pattern is a list of segments separated by "??"
+	struct PatternByte_t
+	{
+		BYTE m_nValue;
+		BYTE m_nMask; // xx = FF, x? = F0, ?x = 0F, ? = 00
+	};
+
+	struct PatternSegment_t
+	{
+		std::vector<PatternByte_t> m_aBytes;
+		int                        m_iAnchor; // first exact byte, -1 if none
+	};
+
+	static std::vector<MemoryRegion_t> g_aMemoryRegions;
+
+
+//===========================================================================
+static void _PatternCompile( const MemorySearchValues_t & vValues, std::vector<PatternSegment_t> & vSegments_ )
+{
+	vSegments_.clear();
+
+	PatternSegment_t segment;
+	segment.m_iAnchor = -1;
+
+	for (size_t iValue = 0; iValue <= vValues.size(); iValue++)
+	{
+		if ((iValue == vValues.size()) || (vValues[ iValue ].m_iType == MEM_SEARCH_BYTE_N_WILD))
+		{
+			// leading, trailing and repeated "??" are redundant
+			if (! segment.m_aBytes.empty())
+			{
+				vSegments_.push_back( segment );
+				segment.m_aBytes.clear();
+				segment.m_iAnchor = -1;
+			}
+			continue;
+		}
+
+		const MemorySearch_t & ms = vValues[ iValue ];
+
+		PatternByte_t pb;
+		pb.m_nValue = ms.m_nValue;
+		switch (ms.m_iType)
+		{
+			case MEM_SEARCH_NIB_LOW_EXACT : pb.m_nMask = 0x0F; break;
+			case MEM_SEARCH_NIB_HIGH_EXACT: pb.m_nMask = 0xF0; break;
+			case MEM_SEARCH_BYTE_1_WILD   : pb.m_nMask = 0x00; break;
+			default                       : pb.m_nMask = 0xFF; break;
+		}
+		pb.m_nValue &= pb.m_nMask;
+
+		if ((segment.m_iAnchor < 0) && (pb.m_nMask == 0xFF))
+			segment.m_iAnchor = (int) segment.m_aBytes.size();
+
+		segment.m_aBytes.push_back( pb );
+	}
+}
+
+
+//===========================================================================
+static inline bool _SegmentMatch( const PatternSegment_t & segment, const BYTE * pMemory )
+{
+	const size_t nLen = segment.m_aBytes.size();
+	for (size_t i = 0; i < nLen; i++)
+	{
+		if ((pMemory[ i ] & segment.m_aBytes[ i ].m_nMask) != segment.m_aBytes[ i ].m_nValue)
+			return false;
+	}
+	return true;
+}
+
+
+// Returns the first offset in [nFrom,nTo) where the segment matches, or nSize
+//===========================================================================
+static UINT _SegmentFind( const PatternSegment_t & segment, const BYTE * pMemory, UINT nSize, UINT nFrom, UINT nTo )
+{
+	const UINT nLen = (UINT) segment.m_aBytes.size();
+	if ((nLen > nSize) || (nTo == 0))
+		return nSize;
+
+	UINT nLast = nSize - nLen; // last possible start
+	if (nTo <= nLast)
+		nLast = nTo - 1;
+
+	UINT nOffset = nFrom;
+	if (segment.m_iAnchor < 0)
+	{
+		// all wild or nibbles: nothing to skip to
+		for ( ; nOffset <= nLast; nOffset++ )
+		{
+			if (_SegmentMatch( segment, pMemory + nOffset ))
+				return nOffset;
+		}
+		return nSize;
+	}
+
+	const UINT nAnchor = segment.m_iAnchor;
+	const BYTE nValue  = segment.m_aBytes[ nAnchor ].m_nValue;
+
+	while (nOffset <= nLast)
+	{
+		const BYTE *pFound = (const BYTE*) memchr( pMemory + nOffset + nAnchor, nValue, nLast - nOffset + 1 );
+		if (! pFound)
+			break;
+
+		nOffset = (UINT)(pFound - pMemory) - nAnchor;
+		if (_SegmentMatch( segment, pMemory + nOffset ))
+			return nOffset;
+
+		nOffset++;
+	}
+
+	return nSize;
+}
+
+
+//===========================================================================
+bool MemorySearchParse ( const char * pPattern, MemorySearchValues_t & vValues_ )
+{
+	vValues_.clear();
+
+	MemorySearch_t ms;
+	ms.m_bFound = false;
+
+	const char *p = pPattern;
+	while (*p)
+	{
+		if (isspace( (unsigned char) *p ))
+		{
+			p++;
+			continue;
+		}
+
+		// "ASCII text" (hi-bit clear) or 'Apple text' (hi-bit set)
+		if ((*p == '"') || (*p == '\''))
+		{
+			const char cQuote = *p++;
+			const BYTE nHighBit = (cQuote == '\'') ? 0x80 : 0x00;
+			for ( ; *p && (*p != cQuote); p++ )
+			{
+				ms.m_iType  = MEM_SEARCH_BYTE_EXACT;
+				ms.m_nValue = (*p & 0x7F) | nHighBit;
+				vValues_.push_back( ms );
+			}
+			if (! *p)
+				return false;
+			p++;
+			continue;
+		}
+
+		const char *pToken = p;
+		while (*p && ! isspace( (unsigned char) *p ))
+			p++;
+		const std::string sToken( pToken, p );
+
+		if (sToken == "?")
+		{
+			ms.m_iType  = MEM_SEARCH_BYTE_1_WILD;
+			ms.m_nValue = 0;
+		}
+		else
+		if (sToken == "??")
+		{
+			ms.m_iType  = MEM_SEARCH_BYTE_N_WILD;
+			ms.m_nValue = 0;
+		}
+		else
+		if ((sToken.size() == 2) && (sToken[0] == '?') && isxdigit( (unsigned char) sToken[1] ))
+		{
+			ms.m_iType  = MEM_SEARCH_NIB_LOW_EXACT;
+			ms.m_nValue = (BYTE) strtoul( sToken.c_str() + 1, NULL, 16 );
+		}
+		else
+		if ((sToken.size() == 2) && (sToken[1] == '?') && isxdigit( (unsigned char) sToken[0] ))
+		{
+			ms.m_iType  = MEM_SEARCH_NIB_HIGH_EXACT;
+			ms.m_nValue = (BYTE)(strtoul( sToken.substr( 0, 1 ).c_str(), NULL, 16 ) << 4);
+		}
+		else
+		{
+			char *pEnd;
+			const unsigned long nValue = strtoul( sToken.c_str(), &pEnd, 16 );
+			if (*pEnd || (sToken.size() > 4))
+				return false;
+
+			ms.m_iType = MEM_SEARCH_BYTE_EXACT;
+			if (sToken.size() > 2)
+			{
+				// 16-bit value, little endian
+				ms.m_nValue = (BYTE)(nValue & 0xFF);
+				vValues_.push_back( ms );
+				ms.m_nValue = (BYTE)(nValue >> 8);
+			}
+			else
+			{
+				ms.m_nValue = (BYTE) nValue;
+			}
+		}
+
+		vValues_.push_back( ms );
+	}
+
+	return ! vValues_.empty();
+}
+
+
+//===========================================================================
+int MemorySearchPattern( const MemorySearchValues_t & vValues, const BYTE * pMemory, UINT nSize, UINT nStart, UINT nEnd, std::vector<UINT> & vOffsets_, size_t nMaxMatches )
+{
+	std::vector<PatternSegment_t> vSegments;
+	_PatternCompile( vValues, vSegments );
+
+	if (vSegments.empty())
+		return 0;
+
+	if (nEnd > nSize)
+		nEnd = nSize;
+
+	int nFound = 0;
+
+	UINT nOffset = nStart;
+	while ((nOffset < nEnd) && (vOffsets_.size() < nMaxMatches))
+	{
+		nOffset = _SegmentFind( vSegments[0], pMemory, nSize, nOffset, nEnd );
+		if (nOffset >= nSize)
+			break;
+
+		// the other segments follow at any distance
+		bool bMatchAll = true;
+		UINT nNext = nOffset + (UINT) vSegments[0].m_aBytes.size();
+		for (size_t iSegment = 1; iSegment < vSegments.size(); iSegment++)
+		{
+			const UINT nMatch = _SegmentFind( vSegments[ iSegment ], pMemory, nSize, nNext, nSize );
+			if (nMatch >= nSize)
+			{
+				bMatchAll = false;
+				break;
+			}
+
+			nNext = nMatch + (UINT) vSegments[ iSegment ].m_aBytes.size();
+		}
+
+		// If a segment isn't found after this match, it won't be after a later one either
+		if (! bMatchAll)
+			break;
+
+		vOffsets_.push_back( nOffset );
+		nFound++;
+		nOffset++;
+	}
+
+	return nFound;
+}
+
+
+//===========================================================================
+const std::vector<MemoryRegion_t> & MemorySearchGetRegions()
+{
+	g_aMemoryRegions.clear();
+
+	MemoryRegion_t region;
+
+	// MemGetBankPtr() writes back the dirty pages of the 64K view
+	const UINT nBanks = IsAppleIIeOrAbove( GetApple2Type() ) ? (kMaxExMemoryBanks + 1) : 1;
+	for (UINT iBank = 0; iBank < nBanks; iBank++)
+	{
+		BYTE *pBank = MemGetBankPtr( iBank );
+		if (! pBank)
+			break;
+
+		region.m_sName    = StrFormat( "%02X", iBank );
+		region.m_nBank    = (int) iBank;
+		region.m_pMemory  = pBank;
+		region.m_nSize    = _6502_MEM_LEN;
+		region.m_nAddress = 0;
+		g_aMemoryRegions.push_back( region );
+	}
+
+	LanguageCardUnit *pLanguageCard = GetCardMgr().GetLanguageCard();
+	if (pLanguageCard)
+	{
+		for (UINT iBank = 0; iBank < Saturn128K::kMaxSaturnBanks; iBank++)
+		{
+			BYTE *pBank = pLanguageCard->GetBankPtr( iBank );
+			if (! pBank)
+				break;
+
+			region.m_sName    = StrFormat( "LC%d", iBank );
+			region.m_nBank    = -1;
+			region.m_pMemory  = pBank;
+			region.m_nSize    = LanguageCardSlot0::kMemBankSize;
+			region.m_nAddress = _6502_IO_BEGIN;
+			g_aMemoryRegions.push_back( region );
+		}
+	}
+
+	return g_aMemoryRegions;
+}
+
+
+//===========================================================================
+int MemorySearchAll( const MemorySearchValues_t & vValues, std::vector<MemoryMatch_t> & vMatches_, size_t nMaxMatches )
+{
+	vMatches_.clear();
+
+	const std::vector<MemoryRegion_t> & aRegions = MemorySearchGetRegions();
+
+	std::vector<UINT> vOffsets;
+	for (size_t iRegion = 0; iRegion < aRegions.size(); iRegion++)
+	{
+		const MemoryRegion_t & region = aRegions[ iRegion ];
+
+		vOffsets.clear();
+		MemorySearchPattern( vValues, region.m_pMemory, region.m_nSize, 0, region.m_nSize, vOffsets, nMaxMatches - vMatches_.size() );
+
+		for (size_t iOffset = 0; iOffset < vOffsets.size(); iOffset++)
+		{
+			MemoryMatch_t match;
+			match.m_iRegion  = (int) iRegion;
+			match.m_nAddress = (WORD)(region.m_nAddress + vOffsets[ iOffset ]);
+			vMatches_.push_back( match );
+		}
+
+		if (vMatches_.size() >= nMaxMatches)
+			break;
+	}
+
+	return (int) vMatches_.size();
+}
+
+
+// Cheat Finder ___________________________________________________________________________________
+
+	struct CheatRegion_t
+	{
+		std::string       m_sName;
+		UINT              m_nSize;
+		std::vector<BYTE> m_aSnapshot;   // at the last scan
+		std::vector<WORD> m_aCandidates; // offsets, unused while g_bCheatAll
+	};
+
+	static std::vector<CheatRegion_t> g_aCheatRegions;
+	static bool g_bCheatStarted = false;
+	static bool g_bCheatAll     = false; // every byte is still a candidate
+
+
+// The candidates are only valid for the memory configuration they were taken from
+//===========================================================================
+static bool _CheatSameRegions( const std::vector<MemoryRegion_t> & aRegions )
+{
+	if (aRegions.size() != g_aCheatRegions.size())
+		return false;
+
+	for (size_t iRegion = 0; iRegion < aRegions.size(); iRegion++)
+	{
+		if ((aRegions[ iRegion ].m_sName != g_aCheatRegions[ iRegion ].m_sName) ||
+			(aRegions[ iRegion ].m_nSize != g_aCheatRegions[ iRegion ].m_nSize))
+			return false;
+	}
+
+	return true;
+}
+
+
+//===========================================================================
+template <class Compare>
+static void _CheatFilterRegion( CheatRegion_t & region, const BYTE * pNow, std::vector<BYTE> & aMask, Compare compare )
+{
+	const BYTE *pOld = &region.m_aSnapshot[0];
+
+	if (g_bCheatAll)
+	{
+		const UINT nSize = region.m_nSize;
+		aMask.resize( nSize );
+		BYTE *pMask = &aMask[0];
+
+		// No branch: vectorised
+		for (UINT i = 0; i < nSize; i++)
+			pMask[ i ] = compare( pNow[ i ], pOld[ i ] ) ? 0xFF : 0x00;
+
+		// Most of the mask is usually clear: test 8 bytes at a time
+		region.m_aCandidates.clear();
+		for (UINT i = 0; i < nSize; i += 8)
+		{
+			uint64_t nMask8;
+			memcpy( &nMask8, pMask + i, sizeof(nMask8) );
+			if (! nMask8)
+				continue;
+
+			for (UINT j = i; j < i + 8; j++)
+			{
+				if (pMask[ j ])
+					region.m_aCandidates.push_back( (WORD) j );
+			}
+		}
+	}
+	else
+	{
+		size_t nKeep = 0;
+		const size_t nCandidates = region.m_aCandidates.size();
+		for (size_t i = 0; i < nCandidates; i++)
+		{
+			const WORD nOffset = region.m_aCandidates[ i ];
+			if (compare( pNow[ nOffset ], pOld[ nOffset ] ))
+				region.m_aCandidates[ nKeep++ ] = nOffset;
+		}
+		region.m_aCandidates.resize( nKeep );
+	}
+}
+
+
+//===========================================================================
+void CheatReset ()
+{
+	const std::vector<MemoryRegion_t> & aRegions = MemorySearchGetRegions();
+
+	g_aCheatRegions.resize( aRegions.size() );
+	for (size_t iRegion = 0; iRegion < aRegions.size(); iRegion++)
+	{
+		const MemoryRegion_t & region = aRegions[ iRegion ];
+		CheatRegion_t & cheat = g_aCheatRegions[ iRegion ];
+
+		cheat.m_sName = region.m_sName;
+		cheat.m_nSize = region.m_nSize;
+		cheat.m_aSnapshot.assign( region.m_pMemory, region.m_pMemory + region.m_nSize );
+		cheat.m_aCandidates.clear();
+		cheat.m_aCandidates.shrink_to_fit();
+	}
+
+	g_bCheatStarted = true;
+	g_bCheatAll     = true;
+}
+
+
+//===========================================================================
+int CheatFilter ( CheatCompare_e eCompare, BYTE nValue )
+{
+	if (! g_bCheatStarted)
+		return CHEAT_NOT_STARTED;
+
+	const std::vector<MemoryRegion_t> & aRegions = MemorySearchGetRegions();
+	if (! _CheatSameRegions( aRegions ))
+	{
+		CheatClear();
+		return CHEAT_NOT_STARTED;
+	}
+
+	std::vector<BYTE> aMask;
+	int nCandidates = 0;
+
+	for (size_t iRegion = 0; iRegion < aRegions.size(); iRegion++)
+	{
+		CheatRegion_t & cheat = g_aCheatRegions[ iRegion ];
+		const BYTE *pNow = aRegions[ iRegion ].m_pMemory;
+
+		switch (eCompare)
+		{
+			case CHEAT_EQUAL    : _CheatFilterRegion( cheat, pNow, aMask, [nValue]( BYTE nNow, BYTE ) { return nNow == nValue; } ); break;
+			case CHEAT_NOT_EQUAL: _CheatFilterRegion( cheat, pNow, aMask, [nValue]( BYTE nNow, BYTE ) { return nNow != nValue; } ); break;
+			case CHEAT_CHANGED  : _CheatFilterRegion( cheat, pNow, aMask, []( BYTE nNow, BYTE nOld ) { return nNow != nOld; } ); break;
+			case CHEAT_UNCHANGED: _CheatFilterRegion( cheat, pNow, aMask, []( BYTE nNow, BYTE nOld ) { return nNow == nOld; } ); break;
+			case CHEAT_INCREASED: _CheatFilterRegion( cheat, pNow, aMask, []( BYTE nNow, BYTE nOld ) { return nNow >  nOld; } ); break;
+			case CHEAT_DECREASED: _CheatFilterRegion( cheat, pNow, aMask, []( BYTE nNow, BYTE nOld ) { return nNow <  nOld; } ); break;
+			default:
+				_ASSERT(0);
+				break;
+		}
+
+		memcpy( &cheat.m_aSnapshot[0], pNow, cheat.m_nSize );
+		nCandidates += (int) cheat.m_aCandidates.size();
+	}
+
+	g_bCheatAll = false;
+	return nCandidates;
+}
+
+
+//===========================================================================
+int CheatGetCount ()
+{
+	if (! g_bCheatStarted)
+		return CHEAT_NOT_STARTED;
+
+	int nCandidates = 0;
+	for (size_t iRegion = 0; iRegion < g_aCheatRegions.size(); iRegion++)
+	{
+		nCandidates += g_bCheatAll
+			? (int) g_aCheatRegions[ iRegion ].m_nSize
+			: (int) g_aCheatRegions[ iRegion ].m_aCandidates.size();
+	}
+
+	return nCandidates;
+}
+
+
+//===========================================================================
+size_t CheatGetMatches ( std::vector<CheatMatch_t> & vMatches_, size_t nMaxMatches )
+{
+	vMatches_.clear();
+
+	if (! g_bCheatStarted)
+		return 0;
+
+	const std::vector<MemoryRegion_t> & aRegions = MemorySearchGetRegions();
+	if (! _CheatSameRegions( aRegions ))
+		return 0;
+
+	for (size_t iRegion = 0; (iRegion < aRegions.size()) && (vMatches_.size() < nMaxMatches); iRegion++)
+	{
+		const MemoryRegion_t & region = aRegions[ iRegion ];
+		const CheatRegion_t  & cheat  = g_aCheatRegions[ iRegion ];
+
+		const size_t nCandidates = g_bCheatAll ? cheat.m_nSize : cheat.m_aCandidates.size();
+		for (size_t i = 0; (i < nCandidates) && (vMatches_.size() < nMaxMatches); i++)
+		{
+			const WORD nOffset = g_bCheatAll ? (WORD) i : cheat.m_aCandidates[ i ];
+
+			CheatMatch_t match;
+			match.m_iRegion   = (int) iRegion;
+			match.m_nAddress  = (WORD)(region.m_nAddress + nOffset);
+			match.m_nPrevious = cheat.m_aSnapshot[ nOffset ];
+			match.m_nValue    = region.m_pMemory[ nOffset ];
+			vMatches_.push_back( match );
+		}
+	}
+
+	return vMatches_.size();
+}
+
+
+//===========================================================================
+void CheatClear ()
+{
+	g_aCheatRegions.clear();
+	g_bCheatStarted = false;
+	g_bCheatAll     = false;
+}
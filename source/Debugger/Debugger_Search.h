@@ -0,0 +1,64 @@
+#pragma once
+
+// Memory Search & Cheat Finder
+//
+// Regions cover all of the emulated RAM, not only the mapped 64K view:
+// . bank 00 = main, 01 = aux, 02.. = RamWorks (the address is the offset in the bank)
+// . LC0..LC7 = language card / Saturn banks of a ][ or ][+ (addresses $C000..$FFFF, same layout as main)
+
+	struct MemoryRegion_t
+	{
+		std::string m_sName;
+		int         m_nBank;    // for MemGetBankPtr(), -1 for the language card
+		BYTE      * m_pMemory;
+		UINT        m_nSize;
+		WORD        m_nAddress; // of m_pMemory[0]
+	};
+
+	struct MemoryMatch_t
+	{
+		int  m_iRegion;
+		WORD m_nAddress;
+	};
+
+	struct CheatMatch_t : public MemoryMatch_t
+	{
+		BYTE m_nPrevious; // at the last scan
+		BYTE m_nValue;    // now
+	};
+
+	enum CheatCompare_e
+	{
+		CHEAT_EQUAL      , // == value
+		CHEAT_NOT_EQUAL  , // != value
+		CHEAT_CHANGED    , // != last scan
+		CHEAT_UNCHANGED  , // == last scan
+		CHEAT_INCREASED  , // >  last scan
+		CHEAT_DECREASED  , // <  last scan
+		NUM_CHEAT_COMPARE
+	};
+
+	enum
+	{
+		CHEAT_NOT_STARTED = -1, // CheatReset() not called, or the memory configuration changed since
+	};
+
+// Prototypes
+
+	// Refreshed at each call (flushes the dirty pages of the 64K view first)
+	const std::vector<MemoryRegion_t> & MemorySearchGetRegions();
+
+	// Pattern: see MemorySearch_e, "??" matches any number of bytes
+	// Parse the same syntax as the console, from a string: A9 ? 8D ?? 60 "text" 'apple text'
+	bool MemorySearchParse  ( const char * pPattern, MemorySearchValues_t & vValues_ );
+	// Matches start in [nStart,nEnd), the pattern itself may extend up to nSize
+	int  MemorySearchPattern( const MemorySearchValues_t & vValues, const BYTE * pMemory, UINT nSize, UINT nStart, UINT nEnd, std::vector<UINT> & vOffsets_, size_t nMaxMatches );
+	int  MemorySearchAll    ( const MemorySearchValues_t & vValues, std::vector<MemoryMatch_t> & vMatches_, size_t nMaxMatches );
+
+	// Snapshot all regions, every byte is a candidate
+	void   CheatReset ();
+	// Keep the candidates satisfying the comparison, then take a new snapshot
+	int    CheatFilter( CheatCompare_e eCompare, BYTE nValue = 0 );
+	int    CheatGetCount ();
+	size_t CheatGetMatches( std::vector<CheatMatch_t> & vMatches_, size_t nMaxMatches );
+	void   CheatClear ();
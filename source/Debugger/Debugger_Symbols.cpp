@@ -121,6 +121,82 @@ Update_t _PrintSymbolInvalidTable()
 }
 
 
+// SymbolTable_t __________________________________________________________________________________
+
+//===========================================================================
+static std::string _SymbolNameKey( const char* pName )
+{
+	std::string sKey( pName );
+	for (size_t i = 0; i < sKey.size(); i++)
+		sKey[i] = (char) toupper( (unsigned char) sKey[i] );
+	return sKey;
+}
+
+//===========================================================================
+void SymbolTable_t::Clear()
+{
+	m_mapSymbols.clear();
+	m_aAddressIndex.clear();
+	m_mapNameIndex.clear();
+}
+
+//===========================================================================
+void SymbolTable_t::Set( WORD nAddress, const std::string & sName )
+{
+	Erase( nAddress );
+
+	if (m_aAddressIndex.empty())
+		m_aAddressIndex.resize( _6502_MEM_LEN, NULL );
+
+	std::string & sSymbol = m_mapSymbols[ nAddress ];
+	sSymbol = sName;
+	m_aAddressIndex[ nAddress ] = &sSymbol; // map nodes don't move
+	m_mapNameIndex.insert( std::make_pair( _SymbolNameKey( sName.c_str() ), nAddress ) );
+}
+
+//===========================================================================
+void SymbolTable_t::Erase( WORD nAddress )
+{
+	std::map<WORD, std::string>::iterator iSymbol = m_mapSymbols.find( nAddress );
+	if (iSymbol == m_mapSymbols.end())
+		return;
+
+	typedef std::unordered_multimap<std::string, WORD>::iterator NameIterator_t;
+	std::pair<NameIterator_t, NameIterator_t> range = m_mapNameIndex.equal_range( _SymbolNameKey( iSymbol->second.c_str() ) );
+	for (NameIterator_t iName = range.first; iName != range.second; ++iName)
+	{
+		if (iName->second == nAddress)
+		{
+			m_mapNameIndex.erase( iName );
+			break;
+		}
+	}
+
+	m_aAddressIndex[ nAddress ] = NULL;
+	m_mapSymbols.erase( iSymbol );
+}
+
+//===========================================================================
+std::string const* SymbolTable_t::Find( WORD nAddress ) const
+{
+	return m_aAddressIndex.empty() ? NULL : m_aAddressIndex[ nAddress ];
+}
+
+//===========================================================================
+bool SymbolTable_t::FindAddress( const char* pName, WORD & nAddress_ ) const
+{
+	typedef std::unordered_multimap<std::string, WORD>::const_iterator NameIterator_t;
+	std::pair<NameIterator_t, NameIterator_t> range = m_mapNameIndex.equal_range( _SymbolNameKey( pName ) );
+	if (range.first == range.second)
+		return false;
+
+	nAddress_ = range.first->second;
+	for (NameIterator_t iName = range.first; iName != range.second; ++iName)
+		nAddress_ = MIN( nAddress_, iName->second );
+	return true;
+}
+
+
 // Public _________________________________________________________________________________________
 
 
@@ -159,14 +235,14 @@ std::string const* FindSymbolFromAddress (WORD nAddress, int * iTable_ )
 		if (! (g_bDisplaySymbolTables & (1 << iTable)))
 			continue;
 
-		std::map<WORD, std::string>::iterator iSymbols = g_aSymbols[iTable].find(nAddress);
-		if(g_aSymbols[iTable].find(nAddress) != g_aSymbols[iTable].end())
+		std::string const* pSymbol = g_aSymbols[iTable].Find(nAddress);
+		if (pSymbol)
 		{
 			if (iTable_)
 			{
 				*iTable_ = iTable;
 			}
-			return &iSymbols->second;
+			return pSymbol;
 		}
 	}	
 	return NULL;
@@ -184,22 +260,18 @@ bool FindAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable
 		if (! (g_bDisplaySymbolTables & (1 << iTable)))
 			continue;
 
-		SymbolTable_t :: iterator  iSymbol = g_aSymbols[iTable].begin();
-		while (iSymbol != g_aSymbols[iTable].end())
+		WORD nAddress;
+		if (g_aSymbols[iTable].FindAddress( pSymbol, nAddress ))
 		{
-			if (!_tcsicmp( iSymbol->second.c_str(), pSymbol))
+			if (pAddress_)
 			{
-				if (pAddress_)
-				{
-					*pAddress_ = iSymbol->first;
-				}
-				if (iTable_)
-				{
-					*iTable_ = iTable;
-				}
-				return true;
+				*pAddress_ = nAddress;
 			}
-			iSymbol++;
+			if (iTable_)
+			{
+				*iTable_ = iTable;
+			}
+			return true;
 		}
 	}
 	return false;
@@ -498,7 +570,7 @@ Update_t _CmdSymbolsListTables (int nArgs, int bSymbolTables )
 					int nSymbols = g_aSymbols[iTable].size();
 					if (nSymbols)
 					{
-						SymbolTable_t :: iterator  iSymbol = g_aSymbols[iTable].begin();
+						SymbolTable_t :: const_iterator  iSymbol = g_aSymbols[iTable].begin();
 						while (iSymbol != g_aSymbols[iTable].end())
 						{
 							const char *pSymbol = iSymbol->second.c_str();
@@ -552,6 +624,104 @@ Update_t _CmdSymbolsListTables (int nArgs, int bSymbolTables )
 }
 
 
+//===========================================================================
+static bool _ReadSymbolFile( const std::string & pPathFileName, std::vector<char> & aFile_ )
+{
+	// The whole file is read at once, and parsed in place
+	FILE *hFile = fopen( pPathFileName.c_str(), "rb" );
+	if (!hFile)
+		return false;
+
+	fseek( hFile, 0, SEEK_END );
+	const long nSize = ftell( hFile );
+	fseek( hFile, 0, SEEK_SET );
+
+	aFile_.resize( nSize > 0 ? nSize : 0 );
+	const bool bRead = aFile_.empty() || fread( aFile_.data(), aFile_.size(), 1, hFile ) == 1;
+	fclose( hFile );
+	return bRead;
+}
+
+//===========================================================================
+static inline bool _IsSymbolSpace( const char c )
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+//===========================================================================
+static const char* _ParseSymbolHex( const char* p, const char* pEnd, DWORD & nValue_ )
+{
+	DWORD nValue = 0;
+	const char* pStart = p;
+	for (; p < pEnd && isxdigit( (unsigned char) *p ); p++)
+	{
+		const char c = (char) toupper( (unsigned char) *p );
+		nValue = (nValue << 4) | ((c <= '9') ? (c - '0') : (c - 'A' + 10));
+	}
+	if (p != pStart)
+		nValue_ = nValue;
+	return p;
+}
+
+//===========================================================================
+static const char* _ParseSymbolName( const char* p, const char* pEnd, char* sName_, const char* pDelimiters )
+{
+	int nLen = 0;
+	for (; p < pEnd && !_IsSymbolSpace( *p ) && !strchr( pDelimiters, *p ); p++)
+	{
+		if (nLen < MAX_SYMBOLS_LEN)
+			sName_[ nLen++ ] = *p;
+	}
+	sName_[ nLen ] = 0;
+	return p;
+}
+
+// Support 3 types of symbols files:
+// 1) AppleWin:
+//    . 0000 SYMBOL
+//    . FFFF SYMBOL
+// 2) ACME:
+//    . SYMBOL  =$0000; Comment
+//    . SYMBOL  =$FFFF; Comment
+// 3) Merlin:
+//    . SYMBOL  EQU $0000
+// nAddress_ & sName_ are left unchanged if the line has no symbol
+//===========================================================================
+static void _ParseSymbolLine( const char* p, const char* pEnd, DWORD & nAddress_, char* sName_ )
+{
+	if (!memchr( p, '$', pEnd - p ))
+	{
+		while (p < pEnd && _IsSymbolSpace( *p ))
+			p++;
+		p = _ParseSymbolHex( p, pEnd, nAddress_ );
+		while (p < pEnd && _IsSymbolSpace( *p ))
+			p++;
+		_ParseSymbolName( p, pEnd, sName_, "" );
+		return;
+	}
+
+	const char* pComment = (const char*) memchr( p, ';', pEnd - p );	// Optional
+	if (pComment)
+		pEnd = pComment;
+
+	while (p < pEnd && _IsSymbolSpace( *p ))
+		p++;
+	p = _ParseSymbolName( p, pEnd, sName_, "=$" );
+
+	while (p < pEnd && (_IsSymbolSpace( *p ) || *p == '='))
+		p++;
+	if (pEnd - p > 3 && _SymbolNameKey( std::string( p, 3 ).c_str() ) == "EQU" && _IsSymbolSpace( p[3] ))
+		p += 3;
+	while (p < pEnd && (_IsSymbolSpace( *p ) || *p == '$'))
+		p++;
+
+	DWORD nAddress = _6502_MEM_END + 1;
+	_ParseSymbolHex( p, pEnd, nAddress );
+	if (nAddress > _6502_MEM_END)
+		sName_[0] = 0;
+	nAddress_ = nAddress;
+}
+
 //===========================================================================
 int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSymbolTableWrite, int nSymbolOffset )
 {
@@ -564,12 +734,10 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	if (pPathFileName.empty())
 		return nSymbolsLoaded;
 
-	std::string strFormat1 = StrFormat( "%%x %%%ds", MAX_SYMBOLS_LEN ); // i.e. "%x %13s"
-	std::string strFormat2 = StrFormat( "%%%ds %%x", MAX_SYMBOLS_LEN ); // i.e. "%13s %x"
-
-	FILE *hFile = fopen( pPathFileName.c_str(), "rt" );
+	std::vector<char> aFile;
+	const bool bFileRead = _ReadSymbolFile( pPathFileName, aFile );
 
-	if( !hFile && g_bSymbolsDisplayMissingFile )
+	if( !bFileRead && g_bSymbolsDisplayMissingFile )
 	{
 		// TODO: print filename! Bug #242 Help file (.chm) description for "Symbols" #242
 		ConsoleDisplayError( "Symbol File not found:" );
@@ -578,53 +746,20 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	}
 	
 	bool bDupSymbolHeader = false;
-	if( hFile )
+	if( bFileRead )
 	{
-		while( !feof(hFile) )
+		const char* pLine = aFile.data();
+		const char* pFileEnd = pLine + aFile.size();
+		while( pLine < pFileEnd )
 		{
-			// Support 2 types of symbols files:
-			// 1) AppleWin:
-			//    . 0000 SYMBOL
-			//    . FFFF SYMBOL
-			// 2) ACME:
-			//    . SYMBOL  =$0000; Comment
-			//    . SYMBOL  =$FFFF; Comment
-			//
+			const char* pLineEnd = (const char*) memchr( pLine, '\n', pFileEnd - pLine );
+			if (!pLineEnd)
+				pLineEnd = pFileEnd;
+
 			DWORD nAddress = _6502_MEM_END + 1; // default to invalid address
 			char  sName[ MAX_SYMBOLS_LEN+1 ]  = "";
-
-			const int MAX_LINE = 256;
-			char  szLine[ MAX_LINE ] = "";
-
-			if( !fgets(szLine, MAX_LINE-1, hFile) )	// Get next line
-			{
-				//ConsolePrint("<<EOF");
-				break;
-			}
-
-			if(strstr(szLine, "$") == NULL)
-			{
-				sscanf(szLine, strFormat1.c_str(), &nAddress, sName);
-			}
-			else
-			{
-				char* p = strstr(szLine, "=");	// Optional
-				if(p) *p = ' ';
-				p = strstr(szLine, "$");
-				if(p) *p = ' ';
-				p = strstr(szLine, ";");		// Optional
-				if(p) *p = 0;
-				p = strstr(szLine, " ");		// 1st space between name & value
-				if (p)
-				{
-					int nLen = p - szLine;
-					if (nLen > MAX_SYMBOLS_LEN)
-					{
-						memset(&szLine[MAX_SYMBOLS_LEN], ' ', nLen - MAX_SYMBOLS_LEN);	// sscanf fails for nAddress if string too long
-					}
-				}
-				sscanf(szLine, strFormat2.c_str(), sName, &nAddress);
-			}
+			_ParseSymbolLine( pLine, pLineEnd, nAddress, sName );
+			pLine = pLineEnd + 1;
 
 			// SymbolOffset
 			nAddress += nSymbolOffset;
@@ -739,10 +874,9 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	
 			// else // It is not a bug to have duplicate addresses by different names
 
-			g_aSymbols[ eSymbolTableWrite ] [ (WORD) nAddress ] = sName;
+			g_aSymbols[ eSymbolTableWrite ].Set( (WORD) nAddress, sName );
 			nSymbolsLoaded++; // TODO: FIXME: BUG: This is the total symbols read, not added
 		}
-		fclose(hFile);
 	}
 
 	return nSymbolsLoaded;
@@ -824,7 +958,7 @@ Update_t CmdSymbolsLoad (int nArgs)
 //===========================================================================
 Update_t _CmdSymbolsClear( SymbolTable_Index_e eSymbolTable )
 {
-	g_aSymbols[ eSymbolTable ].clear();
+	g_aSymbols[ eSymbolTable ].Clear();
 	
 	return UPDATE_SYMBOLS;
 }
@@ -851,7 +985,7 @@ void SymbolUpdate( SymbolTable_Index_e eSymbolTable, const char *pSymbolName, WO
 					ConsoleBufferPush( TEXT(" Removing symbol." ) );
 				}
 
-				g_aSymbols[ eSymbolTable ].erase( nAddressPrev );
+				g_aSymbols[ eSymbolTable ].Erase( nAddressPrev );
 
 				if (bUpdateSymbol)
 				{
@@ -882,7 +1016,7 @@ void SymbolUpdate( SymbolTable_Index_e eSymbolTable, const char *pSymbolName, WO
 				// TODO: Probably should check if same name?
 			}
 #endif
-			g_aSymbols[ eSymbolTable ][ nAddress ] = pSymbolName;
+			g_aSymbols[ eSymbolTable ].Set( nAddress, pSymbolName );
 
 			// Tell user symbol was added
 			ConsolePrintFormat( " Added symbol: %s%s%s %s$%s%04X%s"
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+
 // use the new Debugger Font (Apple Font)
 #define USE_APPLE_FONT   1
 
@@ -458,6 +460,8 @@
 //		, CMD_MEMORY_SEARCH_ASCII   // Ascii Text
 //		, CMD_MEMORY_SEARCH_APPLE   // Flashing Chars, Hi-Bit Set
 		, CMD_MEMORY_SEARCH_HEX
+		, CMD_MEMORY_SEARCH_ALL     // All banks
+		, CMD_MEMORY_CHEAT
 		, CMD_MEMORY_FILL
 		, CMD_NTSC
 		, CMD_TEXT_SAVE
@@ -723,6 +727,8 @@
 	Update_t CmdMemorySearchAscii  (int nArgs);
 	Update_t CmdMemorySearchApple  (int nArgs);
 	Update_t CmdMemorySearchHex    (int nArgs);
+	Update_t CmdMemorySearchAll    (int nArgs);
+	Update_t CmdMemoryCheat        (int nArgs);
 // Output/Scripts
 	Update_t CmdOutputCalc         (int nArgs);
 	Update_t CmdOutputEcho         (int nArgs);
@@ -1451,7 +1457,17 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 	, _PARAM_MEM_SEARCH_END
 	,  PARAM_MEM_SEARCH_NUM = _PARAM_MEM_SEARCH_END - _PARAM_MEM_SEARCH_BEGIN
 
-	, _PARAM_SOURCE_BEGIN = _PARAM_MEM_SEARCH_END  // Daisy Chain
+	, _PARAM_CHEAT_BEGIN = _PARAM_MEM_SEARCH_END  // Daisy Chain
+		, PARAM_CHEAT_EQUAL = _PARAM_CHEAT_BEGIN // same order as CheatCompare_e
+		, PARAM_CHEAT_NOT_EQUAL
+		, PARAM_CHEAT_CHANGED
+		, PARAM_CHEAT_UNCHANGED
+		, PARAM_CHEAT_INCREASED
+		, PARAM_CHEAT_DECREASED
+	, _PARAM_CHEAT_END
+	,  PARAM_CHEAT_NUM = _PARAM_CHEAT_END - _PARAM_CHEAT_BEGIN
+
+	, _PARAM_SOURCE_BEGIN = _PARAM_CHEAT_END  // Daisy Chain
 		, PARAM_SRC_MEMORY = _PARAM_SOURCE_BEGIN
 		,_PARAM_SRC_MEMORY  // alias MEM = MEMORY
 		, PARAM_SRC_SYMBOLS
@@ -1539,7 +1555,34 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 		SYMBOL_TABLE_PRODOS    = (1 << 8),
 	};
 
-	typedef std::map<WORD, std::string> SymbolTable_t;
+	// Symbols of one table
+	// . Kept in address order (for listing), with a flat 64K address index and a hash index of the names,
+	//   so lookups in either direction don't depend on the number of symbols
+	class SymbolTable_t
+	{
+	public:
+		typedef std::map<WORD, std::string>::const_iterator const_iterator;
+
+		SymbolTable_t() {}
+
+		const_iterator begin() const { return m_mapSymbols.begin(); }
+		const_iterator end  () const { return m_mapSymbols.end(); }
+		size_t         size () const { return m_mapSymbols.size(); }
+
+		void Clear();
+		void Set( WORD nAddress, const std::string & sName );
+		void Erase( WORD nAddress );
+		std::string const* Find( WORD nAddress ) const;
+		bool FindAddress( const char* pName, WORD & nAddress_ ) const; // case insensitive, lowest address if aliased
+
+	private:
+		SymbolTable_t( const SymbolTable_t & ); // the indexes point into m_mapSymbols
+		SymbolTable_t & operator= ( const SymbolTable_t & );
+
+		std::map<WORD, std::string> m_mapSymbols;
+		std::vector<std::string const*> m_aAddressIndex; // 64K, allocated with the first symbol
+		std::unordered_multimap<std::string, WORD> m_mapNameIndex; // upper case name -> address
+	};
 
 
 // Watches ________________________________________________________________________________________
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "DiskImage.h"
 #include "Log.h"
 #include "Memory.h"
+#include "Movie.h"
 #include "Registry.h"
 #include "SaveState.h"
 #include "YamlHelper.h"
@@ -336,6 +337,9 @@ void Disk2InterfaceCard::ReadTrack(const int drive, ULONG uExecutedCycles)
 		}
 
 		pFloppy->m_trackimagedata = (pFloppy->m_nibbles != 0);
+
+		if (ImageIsWOZ(pFloppy->m_imagehandle))
+			BuildWozNibbleIndex(*pFloppy);
 	}
 }
 
@@ -372,6 +376,7 @@ void Disk2InterfaceCard::EjectDisk(const int drive)
 
 	EjectDiskInternal(drive);
 	Snapshot_UpdatePath();
+	MovieRecordDiskEject(m_slot, drive);
 
 	SaveLastDiskImage(drive);
 	GetFrame().Video_ResetScreenshotCounter("");
@@ -734,6 +739,7 @@ ImageError_e Disk2InterfaceCard::InsertDisk(const int drive, const std::string&
 	{
 		GetImageTitle(pathname.c_str(), pFloppy->m_imagename, pFloppy->m_fullname);
 		Snapshot_UpdatePath();
+		MovieRecordDiskInsert(m_slot, drive, pathname, bForceWriteProtected);
 
 		GetFrame().Video_ResetScreenshotCounter(pFloppy->m_imagename);
 
@@ -871,6 +877,40 @@ bool Disk2InterfaceCard::IsWozImageInDrive(const int drive)
 
 //===========================================================================
 
+// Sector-level access for turbo disk (see Disk2CardManager::TurboDiskTrap())
+// . The drive's head position, motor & latch are not affected
+
+bool Disk2InterfaceCard::ReadSector(const int drive, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer)
+{
+	if (IsDriveEmpty(drive))
+		return false;
+
+	FlushCurrentTrack(drive);	// so that the image has any pending (nibble-level) writes
+	return ImageReadSector(m_floppyDrive[drive].m_disk.m_imagehandle, track, physicalSector, pSectorBuffer);
+}
+
+bool Disk2InterfaceCard::WriteSector(const int drive, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer)
+{
+	if (IsDriveEmpty(drive))
+		return false;
+
+	FloppyDisk& floppy = m_floppyDrive[drive].m_disk;
+	FlushCurrentTrack(drive);
+
+	if (!ImageWriteSector(floppy.m_imagehandle, track, physicalSector, pSectorBuffer))
+		return false;
+
+	floppy.m_trackimagedata = false;	// Re-read the current track from the image on next access
+	return true;
+}
+
+BYTE Disk2InterfaceCard::GetVolumeNumber(const int drive)
+{
+	return ImageGetVolumeNumber(m_floppyDrive[drive].m_disk.m_imagehandle);
+}
+
+//===========================================================================
+
 #if LOG_DISK_NIBBLES_WRITE
 bool Disk2InterfaceCard::LogWriteCheckSyncFF(ULONG& uCycleDelta)
 {
@@ -1116,6 +1156,123 @@ __forceinline void Disk2InterfaceCard::IncBitStream(FloppyDisk& floppy)
 	}
 }
 
+// Run the LSS (read sequencing) over the track to find the bit offsets where a nibble gets latched.
+// From such a mark, and until the next weak bitcell, the LSS output only depends on the track's bitcells,
+// so AdvanceWholeNibblesWOZ() can skip from one mark to the next instead of shifting one bitcell at a time.
+void Disk2InterfaceCard::BuildWozNibbleIndex(FloppyDisk& floppy)
+{
+	std::vector<WozNibbleMark>& index = floppy.m_wozNibbleIndex;
+	index.clear();
+
+	const UINT bitCount = floppy.m_bitCount;
+	if (!floppy.m_trackimagedata || bitCount == 0)
+		return;
+
+	BYTE shiftReg = 0;
+	int latchDelay = 0;
+	BYTE headWindow = 0;
+	bool chained = false;
+
+	// 1st revolution: sync the LSS; 2nd revolution: add marks; 3rd revolution: link the last mark to the first
+	for (UINT n = 0; n < bitCount * 3; n++)
+	{
+		const UINT bitOffset = n % bitCount;
+		const BYTE bit = (floppy.m_trackimage[bitOffset / 8] >> (7 - (bitOffset & 7))) & 1;
+
+		headWindow = ((headWindow << 1) | bit) & 0xf;
+		if (headWindow == 0)
+		{
+			// Weak bitcell: LSS output is random, so restart from a cleared LSS
+			shiftReg = 0;
+			latchDelay = 0;
+			chained = false;
+			continue;
+		}
+
+		shiftReg <<= 1;
+		shiftReg |= (headWindow >> 1) & 1;
+
+		if (latchDelay)
+		{
+			latchDelay -= 4;
+			if (latchDelay < 0)
+				latchDelay = 0;
+
+			if (shiftReg == 0)
+				latchDelay += 4;
+		}
+
+		if (latchDelay || (shiftReg & 0x80) == 0)
+			continue;
+
+		const WozNibbleMark mark = { (n + 1) % bitCount, shiftReg, headWindow, false };
+		latchDelay = 7;
+		shiftReg = 0;
+
+		if (n + 1 >= bitCount * 2)
+		{
+			if (!index.empty() && chained)
+			{
+				const WozNibbleMark& first = index.front();
+				index.back().chained = first.bitOffset == mark.bitOffset && first.nibble == mark.nibble && first.headWindow == mark.headWindow;
+			}
+			break;
+		}
+
+		if (n + 1 >= bitCount)
+		{
+			if (!index.empty())
+				index.back().chained = chained;
+			index.push_back(mark);
+		}
+
+		chained = true;
+	}
+}
+
+// Pre: LSS is idle after latching a nibble (m_shiftReg=0, m_latchDelay=7)
+// Returns the number of bitcells advanced (only whole nibbles, up to bitCells)
+UINT Disk2InterfaceCard::AdvanceWholeNibblesWOZ(FloppyDrive& drive, const UINT bitCells)
+{
+	FloppyDisk& floppy = drive.m_disk;
+	const std::vector<WozNibbleMark>& index = floppy.m_wozNibbleIndex;
+	if (index.empty())
+		return 0;
+
+	std::vector<WozNibbleMark>::const_iterator it = std::lower_bound(index.begin(), index.end(), floppy.m_bitOffset,
+		[](const WozNibbleMark& mark, const UINT bitOffset) { return mark.bitOffset < bitOffset; });
+
+	if (it == index.end() || it->bitOffset != floppy.m_bitOffset || it->headWindow != (drive.m_headWindow & 0xf))
+		return 0;
+
+	size_t k = it - index.begin();
+	UINT advanced = 0;
+	while (index[k].chained)
+	{
+		const size_t next = (k + 1) % index.size();
+		UINT distance = (index[next].bitOffset + floppy.m_bitCount - index[k].bitOffset) % floppy.m_bitCount;
+		if (distance == 0)
+			distance = floppy.m_bitCount;	// only 1 mark on the track
+
+		if (advanced + distance > bitCells)
+			break;
+
+		advanced += distance;
+		k = next;
+	}
+
+	if (advanced == 0)
+		return 0;
+
+	floppy.m_bitOffset = index[k].bitOffset;
+	UpdateBitStreamOffsets(floppy);
+	drive.m_headWindow = index[k].headWindow;
+	m_floppyLatch = index[k].nibble;
+	m_dbgLatchDelayedCnt = 0;
+
+	return advanced;
+}
+
 void Disk2InterfaceCard::PreJitterCheck(int phase, BYTE latch)
 {
 	if (phase != 0 || (latch & 0x80) == 0)
@@ -1251,6 +1408,17 @@ void Disk2InterfaceCard::DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemain
 
 	for (UINT i = 0; i < bitCellRemainder; i++)
 	{
+#if !LOG_DISK_NIBBLES_READ
+		// Whole nibbles can be skipped when the LSS is idle at a nibble mark (and enough bitcells remain)
+		const UINT kMinBitCellsPerNibble = 8;
+		if (m_latchDelay == 7 && m_shiftReg == 0 && !m_resetSequencer && (bitCellRemainder - i) >= kMinBitCellsPerNibble)
+		{
+			i += AdvanceWholeNibblesWOZ(drive, bitCellRemainder - i);
+			if (i == bitCellRemainder)
+				break;
+		}
+#endif
+
 		BYTE n = floppy.m_trackimage[floppy.m_byte];
 
 		drive.m_headWindow <<= 1;
@@ -1390,6 +1558,7 @@ void Disk2InterfaceCard::DataShiftWriteWOZ(WORD pc, WORD addr, ULONG uExecutedCy
 	}
 
 	floppy.m_trackimagedirty = true;
+	floppy.m_wozNibbleIndex.clear();	// Rebuilt on next ReadTrack()
 }
 
 //===========================================================================
@@ -40,6 +40,15 @@ const bool IMAGE_FORCE_WRITE_PROTECTED = true;
 const bool IMAGE_DONT_CREATE = false;
 const bool IMAGE_CREATE = true;
 
+// WOZ: a bit offset where the LSS has just latched a complete nibble (so shiftReg=0, latchDelay=7)
+struct WozNibbleMark
+{
+	UINT bitOffset;		// next bitcell to be read
+	BYTE nibble;		// latch value
+	BYTE headWindow;	// last 4 bitcells
+	bool chained;		// no weak bitcells until the next mark
+};
+
 class FloppyDisk
 {
 public:
@@ -67,6 +76,7 @@ public:
 		m_trackimage = NULL;
 		m_trackimagedata = false;
 		m_trackimagedirty = false;
+		m_wozNibbleIndex.clear();
 	}
 
 public:
@@ -84,6 +94,7 @@ public:
 	LPBYTE m_trackimage;
 	bool m_trackimagedata;
 	bool m_trackimagedirty;
+	std::vector<WozNibbleMark> m_wozNibbleIndex;	// Init'd by ReadTrack() for WOZ / Cleared on write
 };
 
 class FloppyDrive
@@ -181,6 +192,11 @@ public:
 	bool GetEnhanceDisk(void);
 	void SetEnhanceDisk(bool bEnhanceDisk);
 
+	// Sector-level access for turbo disk (DO & PO images only)
+	bool ReadSector(const int drive, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer);
+	bool WriteSector(const int drive, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer);
+	BYTE GetVolumeNumber(const int drive);
+
 	static BYTE __stdcall IORead(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 	static BYTE __stdcall IOWrite(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 
@@ -198,6 +214,8 @@ private:
 	void UpdateBitStreamPosition(FloppyDisk& floppy, const ULONG bitCellDelta);
 	void UpdateBitStreamOffsets(FloppyDisk& floppy);
 	__forceinline void IncBitStream(FloppyDisk& floppy);
+	void BuildWozNibbleIndex(FloppyDisk& floppy);
+	UINT AdvanceWholeNibblesWOZ(FloppyDrive& drive, const UINT bitCells);
 	void DataLatchReadWOZ(WORD pc, WORD addr, UINT bitCellRemainder);
 	void DataLoadWriteWOZ(WORD pc, WORD addr, UINT bitCellRemainder);
 	void DataShiftWriteWOZ(WORD pc, WORD addr, ULONG uExecutedCycles);
@@ -32,7 +32,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Disk2CardManager.h"
 #include "Core.h"
 #include "CardManager.h"
+#include "CPU.h"
 #include "Disk.h"
+#include "Memory.h"
 
 bool Disk2CardManager::IsConditionForFullSpeed(void)
 {
@@ -143,3 +145,235 @@ void Disk2CardManager::GetFilenameAndPathForSaveState(std::string& filename, std
 		}
 	}
 }
+
+//===========================================================================
+
+// Turbo disk
+// . DOS 3.3 RWTS calls and ProDOS Disk II driver calls are trapped on opcode fetch (see CPU.cpp's Fetch()),
+//   and the sector(s) are transferred directly between the disk image and memory.
+// . The emulated drive's head, motor & latch are left untouched, so the RWTS/driver's notion of the current track
+//   remains consistent with the drive for any subsequent (non-trapped) access.
+// . Only DO & PO images support sector-level access - other images (NIB, WOZ) use the real RWTS/driver.
+// . Anything not understood (eg. RWTS format, out of range tracks) falls through to the real RWTS/driver.
+
+// DOS 3.3 RWTS: entry point and the first instructions at it (STY $48 : STA $49)
+static const WORD RWTS_ENTRY = 0xBD00;
+static const BYTE g_RWTSSignature[] = {0x84,0x48,0x85,0x49};
+
+enum RWTS_IOB {IOB_SLOT=0x01, IOB_DRIVE=0x02, IOB_VOLUME_EXPECTED=0x03, IOB_TRACK=0x04, IOB_SECTOR=0x05,
+	IOB_BUFFER=0x08, IOB_COMMAND=0x0C, IOB_RETURN_CODE=0x0D, IOB_VOLUME_FOUND=0x0E, IOB_PREV_SLOT=0x0F, IOB_PREV_DRIVE=0x10};
+enum RWTS_COMMAND {RWTS_SEEK=0, RWTS_READ=1, RWTS_WRITE=2};
+enum RWTS_ERROR {RWTS_OK=0x00, RWTS_WRITE_PROTECTED=0x10, RWTS_VOLUME_MISMATCH=0x20, RWTS_DRIVE_ERROR=0x40};
+
+// RWTS logical sector -> physical sector (DOS 3.3 interleave)
+static const BYTE g_RWTSPhysicalSector[NUM_SECTORS] = {0x0,0xD,0xB,0x9,0x7,0x5,0x3,0x1,0xE,0xC,0xA,0x8,0x6,0x4,0x2,0xF};
+
+// ProDOS: MLI entry point, device driver vector table & the driver's zero-page parameters
+static const WORD PRODOS_MLI = 0xBF00;
+static const WORD PRODOS_DEVADR = 0xBF10;
+enum PRODOS_ZP {PRODOS_ZP_COMMAND=0x42, PRODOS_ZP_UNIT=0x43, PRODOS_ZP_BUFFER=0x44, PRODOS_ZP_BLOCK=0x46};
+enum PRODOS_COMMAND {PRODOS_STATUS=0, PRODOS_READ=1, PRODOS_WRITE=2};
+enum PRODOS_ERROR {PRODOS_OK=0x00, PRODOS_IO_ERROR=0x27, PRODOS_WRITE_PROTECTED=0x2B};
+static const UINT PRODOS_DISK2_BLOCKS = 280;
+
+// ProDOS 512-byte block half (0-15 within a track) -> physical sector
+static const BYTE g_ProDOSPhysicalSector[NUM_SECTORS] = {0x0,0x2,0x4,0x6,0x8,0xA,0xC,0xE,0x1,0x3,0x5,0x7,0x9,0xB,0xD,0xF};
+
+static WORD ReadWord(const WORD addr)
+{
+	return mem[addr] | (mem[(WORD)(addr+1)] << 8);
+}
+
+static void WriteByte(const WORD addr, const BYTE value)
+{
+	memdirty[addr >> 8] = 0xFF;
+	LPBYTE page = memwrite[addr >> 8];
+	if (page)
+		*(page + (addr & 0xFF)) = value;
+}
+
+static void CopyToMemory(const WORD addr, const BYTE* pSrc, const UINT size)
+{
+	for (UINT i = 0; i < size; i++)
+		WriteByte((WORD)(addr + i), pSrc[i]);
+}
+
+static void CopyFromMemory(BYTE* pDst, const WORD addr, const UINT size)
+{
+	for (UINT i = 0; i < size; i++)
+		pDst[i] = mem[(WORD)(addr + i)];
+}
+
+Disk2InterfaceCard* Disk2CardManager::GetDisk2Card(const UINT slot)
+{
+	if (slot >= NUM_SLOTS || GetCardMgr().QuerySlot(slot) != CT_Disk2)
+		return NULL;
+
+	return dynamic_cast<Disk2InterfaceCard*>(&GetCardMgr().GetRef(slot));
+}
+
+// Called once per CpuExecute() batch: returns the address to trap, or kNoTrapAddress
+UINT Disk2CardManager::GetTurboDiskTrapAddress(void)
+{
+	if (!m_turboDisk)
+		return kNoTrapAddress;
+
+	if (memcmp(mem + RWTS_ENTRY, g_RWTSSignature, sizeof(g_RWTSSignature)) == 0)
+		return RWTS_ENTRY;
+
+	if (mem[PRODOS_MLI] == 0x4C)	// JMP
+	{
+		for (UINT slot = 1; slot < NUM_SLOTS; slot++)
+		{
+			if (GetCardMgr().QuerySlot(slot) == CT_Disk2)
+				return ReadWord(PRODOS_DEVADR + slot*2);	// The same driver services all Disk II units
+		}
+	}
+
+	return kNoTrapAddress;
+}
+
+// Returns true if the call was serviced: regs.pc is then the address pushed by the caller's JSR,
+// and the caller should set the carry according to 'error'.
+bool Disk2CardManager::TurboDiskTrap(const WORD pc, bool& error)
+{
+	const bool serviced = (pc == RWTS_ENTRY) ? TrapRWTS(error) : TrapProDOS(pc, error);
+	if (!serviced)
+		return false;
+
+	// Return to the caller, as RTS would (less the final increment, which is done by the opcode fetch)
+	regs.sp = 0x100 | ((regs.sp + 1) & 0xFF);
+	WORD returnAddr = mem[regs.sp];
+	regs.sp = 0x100 | ((regs.sp + 1) & 0xFF);
+	returnAddr |= mem[regs.sp] << 8;
+	regs.pc = returnAddr;
+
+	return true;
+}
+
+bool Disk2CardManager::TrapRWTS(bool& error)
+{
+	if (memcmp(mem + RWTS_ENTRY, g_RWTSSignature, sizeof(g_RWTSSignature)) != 0)
+		return false;
+
+	const WORD iob = regs.y | (regs.a << 8);
+	const BYTE command = mem[(WORD)(iob + IOB_COMMAND)];
+	const UINT slot = mem[(WORD)(iob + IOB_SLOT)] >> 4;
+	const int drive = mem[(WORD)(iob + IOB_DRIVE)] - 1;
+	const UINT track = mem[(WORD)(iob + IOB_TRACK)];
+	const UINT sector = mem[(WORD)(iob + IOB_SECTOR)];
+
+	if (command > RWTS_WRITE || drive < DRIVE_1 || drive > DRIVE_2 || sector >= NUM_SECTORS)
+		return false;
+
+	Disk2InterfaceCard* pCard = GetDisk2Card(slot);
+	if (!pCard)
+		return false;
+
+	// Also checks that the image supports sector-level access & that the track is in range
+	BYTE sectorBuffer[SECTOR_SIZE];
+	const UINT physicalSector = g_RWTSPhysicalSector[sector];
+	if (!pCard->ReadSector(drive, track, physicalSector, sectorBuffer))
+		return false;
+
+	const BYTE volume = pCard->GetVolumeNumber(drive);
+	const BYTE expectedVolume = mem[(WORD)(iob + IOB_VOLUME_EXPECTED)];
+	const WORD buffer = ReadWord((WORD)(iob + IOB_BUFFER));
+
+	BYTE result = RWTS_OK;
+	if (expectedVolume != 0 && expectedVolume != volume)
+	{
+		result = RWTS_VOLUME_MISMATCH;
+	}
+	else if (command == RWTS_READ)
+	{
+		CopyToMemory(buffer, sectorBuffer, SECTOR_SIZE);
+	}
+	else if (command == RWTS_WRITE)
+	{
+		if (pCard->GetProtect(drive))
+		{
+			result = RWTS_WRITE_PROTECTED;
+		}
+		else
+		{
+			CopyFromMemory(sectorBuffer, buffer, SECTOR_SIZE);
+			if (!pCard->WriteSector(drive, track, physicalSector, sectorBuffer))
+				result = RWTS_DRIVE_ERROR;
+		}
+	}
+
+	WriteByte((WORD)(iob + IOB_VOLUME_FOUND), volume);
+	WriteByte((WORD)(iob + IOB_RETURN_CODE), result);
+	WriteByte((WORD)(iob + IOB_PREV_SLOT), slot << 4);
+	WriteByte((WORD)(iob + IOB_PREV_DRIVE), drive + 1);
+	regs.a = result;
+	error = (result != RWTS_OK);
+	return true;
+}
+
+bool Disk2CardManager::TrapProDOS(const WORD pc, bool& error)
+{
+	if (mem[PRODOS_MLI] != 0x4C)
+		return false;
+
+	// The driver is in the language card
+	if (pc >= 0xD000 && !(GetMemMode() & MF_HIGHRAM))
+		return false;
+
+	const BYTE unit = mem[PRODOS_ZP_UNIT];	// DSSS0000
+	const UINT slot = (unit >> 4) & 7;
+	const int drive = (unit & 0x80) ? DRIVE_2 : DRIVE_1;
+	if (ReadWord(PRODOS_DEVADR + ((unit >> 3) & 0x1E)) != pc)
+		return false;
+
+	Disk2InterfaceCard* pCard = GetDisk2Card(slot);
+	if (!pCard)
+		return false;
+
+	const BYTE command = mem[PRODOS_ZP_COMMAND];
+	const UINT block = ReadWord(PRODOS_ZP_BLOCK);
+	const WORD buffer = ReadWord(PRODOS_ZP_BUFFER);
+
+	if (command > PRODOS_WRITE)
+		return false;
+
+	// Also checks that the image supports sector-level access & that the track is in range
+	const UINT track = (command == PRODOS_STATUS) ? 0 : block / 8;
+	const UINT blockHalf = (block % 8) * 2;
+	BYTE blockBuffer[SECTOR_SIZE*2];
+	if (!pCard->ReadSector(drive, track, g_ProDOSPhysicalSector[blockHalf], blockBuffer) ||
+		!pCard->ReadSector(drive, track, g_ProDOSPhysicalSector[blockHalf+1], blockBuffer+SECTOR_SIZE))
+		return false;
+
+	BYTE result = PRODOS_OK;
+	if (command == PRODOS_STATUS)
+	{
+		if (pCard->GetProtect(drive))
+			result = PRODOS_WRITE_PROTECTED;
+		regs.x = PRODOS_DISK2_BLOCKS & 0xFF;
+		regs.y = PRODOS_DISK2_BLOCKS >> 8;
+	}
+	else if (command == PRODOS_READ)
+	{
+		CopyToMemory(buffer, blockBuffer, SECTOR_SIZE*2);
+	}
+	else if (command == PRODOS_WRITE)
+	{
+		if (pCard->GetProtect(drive))
+		{
+			result = PRODOS_WRITE_PROTECTED;
+		}
+		else
+		{
+			CopyFromMemory(blockBuffer, buffer, SECTOR_SIZE*2);
+			if (!pCard->WriteSector(drive, track, g_ProDOSPhysicalSector[blockHalf], blockBuffer) ||
+				!pCard->WriteSector(drive, track, g_ProDOSPhysicalSector[blockHalf+1], blockBuffer+SECTOR_SIZE))
+				result = PRODOS_IO_ERROR;
+		}
+	}
+
+	regs.a = result;
+	error = (result != PRODOS_OK);
+	return true;
+}
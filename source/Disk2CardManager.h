@@ -1,9 +1,11 @@
 #pragma once
 
+class Disk2InterfaceCard;
+
 class Disk2CardManager
 {
 public:
-	Disk2CardManager(void) {}
+	Disk2CardManager(void) : m_turboDisk(false) {}
 	~Disk2CardManager(void) {}
 
 	bool IsConditionForFullSpeed(void);
@@ -15,4 +17,19 @@ public:
 	void Destroy(void);
 	bool IsAnyFirmware13Sector(void);
 	void GetFilenameAndPathForSaveState(std::string& filename, std::string& path);
+
+	// Turbo disk: service DOS 3.3 RWTS & ProDOS Disk II driver calls directly from the disk image
+	bool GetTurboDisk(void) { return m_turboDisk; }
+	void SetTurboDisk(bool turboDisk) { m_turboDisk = turboDisk; }
+	UINT GetTurboDiskTrapAddress(void);
+	bool TurboDiskTrap(const WORD pc, bool& error);
+
+	static const UINT kNoTrapAddress = 0x10000;	// never matches a 16-bit PC
+
+private:
+	Disk2InterfaceCard* GetDisk2Card(const UINT slot);
+	bool TrapRWTS(bool& error);
+	bool TrapProDOS(const WORD pc, bool& error);
+
+	bool m_turboDisk;
 };
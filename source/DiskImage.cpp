@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "DiskImage.h"
 #include "Common.h"
 #include "DiskImageHelper.h"
+#include "PerfCounters.h"
 
 
 static CDiskImageHelper sg_DiskImageHelper;
@@ -80,6 +81,9 @@ ImageError_e ImageOpen(	const std::string & pszImageFilename,
 
 	_ASSERT(pImageInfo->uNumTracks);
 
+	// NB. Must be done now, as the volume number is a property of the image type (not of the image)
+	pImageInfo->pImageType->NibblizeAllTracks(pImageInfo);
+
 	*pWriteProtected = pImageInfo->bWriteProtected;
 
 	return eIMAGE_ERROR_NONE;
@@ -118,6 +122,8 @@ void ImageReadTrack(	ImageInfo* const pImageInfo,
 						UINT* pBitCount,
 						bool enhanceDisk)
 {
+	PerfMarker perfMarker(PERF_DISK_IO);
+
 	_ASSERT(phase >= 0);
 	if (phase < 0)
 		phase = 0;
@@ -143,6 +149,8 @@ void ImageWriteTrack(	ImageInfo* const pImageInfo,
 						LPBYTE pTrackImageBuffer,
 						const int nNibbles)
 {
+	PerfMarker perfMarker(PERF_DISK_IO);
+
 	_ASSERT(phase >= 0);
 	if (phase < 0)
 		phase = 0;
@@ -169,6 +177,8 @@ bool ImageReadBlock(	ImageInfo* const pImageInfo,
 						UINT nBlock,
 						LPBYTE pBlockBuffer)
 {
+	PerfMarker perfMarker(PERF_DISK_IO);
+
 	bool bRes = false;
 	if (pImageInfo->pImageType->AllowRW())
 		bRes = pImageInfo->pImageType->Read(pImageInfo, nBlock, pBlockBuffer);
@@ -182,6 +192,8 @@ bool ImageWriteBlock(	ImageInfo* const pImageInfo,
 						UINT nBlock,
 						LPBYTE pBlockBuffer)
 {
+	PerfMarker perfMarker(PERF_DISK_IO);
+
 	bool bRes = false;
 	if (pImageInfo->pImageType->AllowRW() && !pImageInfo->bWriteProtected)
 		bRes = pImageInfo->pImageType->Write(pImageInfo, nBlock, pBlockBuffer);
@@ -191,6 +203,40 @@ bool ImageWriteBlock(	ImageInfo* const pImageInfo,
 
 //===========================================================================
 
+// Sector-level access (bypassing the nibble stream) - only supported by DO & PO images
+bool ImageReadSector(	ImageInfo* const pImageInfo,
+						UINT track,
+						UINT physicalSector,
+						LPBYTE pSectorBuffer)
+{
+	PerfMarker perfMarker(PERF_DISK_IO);
+
+	if (!pImageInfo->pImageType->AllowRW())
+		return false;
+
+	return pImageInfo->pImageType->ReadSector(pImageInfo, track, physicalSector, pSectorBuffer);
+}
+
+bool ImageWriteSector(	ImageInfo* const pImageInfo,
+						UINT track,
+						UINT physicalSector,
+						LPBYTE pSectorBuffer)
+{
+	PerfMarker perfMarker(PERF_DISK_IO);
+
+	if (!pImageInfo->pImageType->AllowRW() || pImageInfo->bWriteProtected)
+		return false;
+
+	return pImageInfo->pImageType->WriteSector(pImageInfo, track, physicalSector, pSectorBuffer);
+}
+
+BYTE ImageGetVolumeNumber(ImageInfo* const pImageInfo)
+{
+	return pImageInfo ? pImageInfo->pImageType->GetVolumeNumber() : DEFAULT_VOLUME_NUMBER;
+}
+
+//===========================================================================
+
 UINT ImageGetNumTracks(ImageInfo* const pImageInfo)
 {
 	return pImageInfo ? pImageInfo->uNumTracks : 0;
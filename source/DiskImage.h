@@ -37,7 +37,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #endif
 
 
-	#define TRACK_DENIBBLIZED_SIZE (16 * 256)	// #Sectors x Sector-size
+	#define SECTOR_SIZE 256
+	#define TRACK_DENIBBLIZED_SIZE (16 * SECTOR_SIZE)	// #Sectors x Sector-size
 
 	#define	TRACKS_STANDARD	35
 	#define	TRACKS_EXTRA	5		// Allow up to a 40-track .dsk image (160KB)
@@ -84,6 +85,9 @@ void ImageReadTrack(ImageInfo* const pImageInfo, float phase, LPBYTE pTrackImage
 void ImageWriteTrack(ImageInfo* const pImageInfo, float phase, LPBYTE pTrackImageBuffer, int nNibbles);
 bool ImageReadBlock(ImageInfo* const pImageInfo, UINT nBlock, LPBYTE pBlockBuffer);
 bool ImageWriteBlock(ImageInfo* const pImageInfo, UINT nBlock, LPBYTE pBlockBuffer);
+bool ImageReadSector(ImageInfo* const pImageInfo, UINT track, UINT physicalSector, LPBYTE pSectorBuffer);
+bool ImageWriteSector(ImageInfo* const pImageInfo, UINT track, UINT physicalSector, LPBYTE pSectorBuffer);
+BYTE ImageGetVolumeNumber(ImageInfo* const pImageInfo);
 
 UINT ImageGetNumTracks(ImageInfo* const pImageInfo);
 bool ImageIsMultiFileZip(ImageInfo* const pImageInfo);
@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "StdAfx.h"
 #include "Core.h"
 #include "DiskImageHelper.h"
+#include "DiskImageWriteBack.h"
 
 #include "Common.h"
 
@@ -141,12 +142,25 @@ bool CImageBase::ReadBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBloc
 		if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
 			return false;
 
+		// Serialise with the write-back thread, and apply any of its pending writes to this block
+		std::lock_guard<std::mutex> lock(GetDiskImageWriteBack().GetFileMutex());
+
 		SetFilePointer(pImageInfo->hFile, Offset, NULL, FILE_BEGIN);
 
 		DWORD dwBytesRead;
 		BOOL bRes = ReadFile(pImageInfo->hFile, pBlockBuffer, HD_BLOCK_SIZE, &dwBytesRead, NULL);
-		if (!bRes || dwBytesRead != HD_BLOCK_SIZE)
+		if (!bRes)
 			return false;
+
+		if (dwBytesRead != HD_BLOCK_SIZE)
+		{
+			// Only valid if this block extends the image, and that write is still pending
+			if ((UINT)Offset + HD_BLOCK_SIZE > pImageInfo->uImageSize)
+				return false;
+			memset(pBlockBuffer + dwBytesRead, 0, HD_BLOCK_SIZE - dwBytesRead);
+		}
+
+		GetDiskImageWriteBack().ReadOverlay(pImageInfo, pBlockBuffer, HD_BLOCK_SIZE, Offset);
 	}
 	else if ((pImageInfo->FileType == eFileGZip) || (pImageInfo->FileType == eFileZip))
 	{
@@ -204,7 +218,36 @@ bool CImageBase::WriteBlock(ImageInfo* pImageInfo, const int nBlock, LPBYTE pBlo
 
 //-----------------------------------------------------------------------------
 
+// The image buffer is always updated synchronously (by the caller), but the host file is written by the write-back thread
+// . Returns false if an earlier write to the host file failed (see DiskImageWriteBack)
 bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const UINT uSrcSize, const long offset)
+{
+	if (pImageInfo->FileType == eFileNormal)
+	{
+		if (pImageInfo->hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		return GetDiskImageWriteBack().Write(pImageInfo, pSrcBuffer, uSrcSize, offset);
+	}
+	else if (pImageInfo->FileType == eFileGZip || pImageInfo->FileType == eFileZip)
+	{
+		// Write entire compressed image each time, so queue a copy of the whole image buffer
+		_ASSERT(pImageInfo->FileType == eFileGZip || pImageInfo->uNumEntriesInZip == 1);	// Multi-file zips are write-protected in CheckZipFile()
+		if (pImageInfo->FileType == eFileZip && pImageInfo->uNumEntriesInZip > 1)
+			return false;
+
+		return GetDiskImageWriteBack().Write(pImageInfo, pImageInfo->pImageBuffer, pImageInfo->uImageSize, DiskImageWriteBack::WHOLE_IMAGE);
+	}
+	else
+	{
+		_ASSERT(0);
+		return false;
+	}
+}
+
+// Called by the write-back thread
+// . For gzip & zip images, pSrcBuffer is a copy of the whole image buffer
+bool CImageBase::WriteImageDataToFile(ImageInfo* pImageInfo, const BYTE* pSrcBuffer, const UINT uSrcSize, const long offset)
 {
 	if (pImageInfo->FileType == eFileNormal)
 	{
@@ -230,11 +273,11 @@ bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const
 		if (hGZFile == NULL)
 			return false;
 
-		int nLen = gzwrite(hGZFile, pImageInfo->pImageBuffer, pImageInfo->uImageSize);
+		int nLen = gzwrite(hGZFile, pSrcBuffer, uSrcSize);
 		int nRes = gzclose(hGZFile);	// close before returning (due to error) to avoid resource leak
 		hGZFile = NULL;
 
-		if (nLen != pImageInfo->uImageSize)
+		if (nLen != uSrcSize)
 			return false;
 
 		if (nRes != Z_OK)
@@ -261,7 +304,7 @@ bool CImageBase::WriteImageData(ImageInfo* pImageInfo, LPBYTE pSrcBuffer, const
 			if (nOpenedFileInZip != ZIP_OK)
 				throw false;
 
-			int nRes = zipWriteInFileInZip(hZipFile, pImageInfo->pImageBuffer, pImageInfo->uImageSize);
+			int nRes = zipWriteInFileInZip(hZipFile, pSrcBuffer, uSrcSize);
 			if (nRes != ZIP_OK)
 				throw false;
 
@@ -583,6 +626,88 @@ void CImageBase::SkewTrack(const int nTrack, const int nNumNibbles, const LPBYTE
 
 //-------------------------------------
 
+// Nibblize every track of the image up-front, so that a head move to a new track is just a copy (plus skew)
+void CImageBase::NibblizeAllTracks(ImageInfo* pImageInfo, SectorOrder_e SectorOrder)
+{
+	const UINT numTracks = MIN(pImageInfo->uNumTracks, TRACKS_MAX);
+	for (UINT track = 0; track < numTracks; track++)
+	{
+		std::vector<BYTE>& nibblizedTrack = pImageInfo->nibblizedTracks[track];
+		if (!nibblizedTrack.empty())
+			continue;
+
+		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		nibblizedTrack.resize(NIBBLES_PER_TRACK);
+		nibblizedTrack.resize( NibblizeTrack(&nibblizedTrack[0], SectorOrder, track) );
+	}
+}
+
+void CImageBase::ReadNibblizedTrack(ImageInfo* pImageInfo, const UINT track, SectorOrder_e SectorOrder, LPBYTE pTrackImageBuffer, int* pNibbles, bool enhanceDisk)
+{
+	if (track >= TRACKS_MAX)
+	{
+		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		*pNibbles = NibblizeTrack(pTrackImageBuffer, SectorOrder, track);
+		if (!enhanceDisk)
+			SkewTrack(track, *pNibbles, pTrackImageBuffer);
+		return;
+	}
+
+	std::vector<BYTE>& nibblizedTrack = pImageInfo->nibblizedTracks[track];
+	if (nibblizedTrack.empty())		// Not cached, or written since
+	{
+		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		nibblizedTrack.resize(NIBBLES_PER_TRACK);
+		nibblizedTrack.resize( NibblizeTrack(&nibblizedTrack[0], SectorOrder, track) );
+	}
+
+	const int nNumNibbles = (int)nibblizedTrack.size();
+	*pNibbles = nNumNibbles;
+
+	// Same as SkewTrack(), but directly from the cached track
+	const int nSkewBytes = enhanceDisk ? 0 : (track*768) % nNumNibbles;
+	memcpy(pTrackImageBuffer, &nibblizedTrack[nSkewBytes], nNumNibbles-nSkewBytes);
+	memcpy(pTrackImageBuffer+nNumNibbles-nSkewBytes, &nibblizedTrack[0], nSkewBytes);
+}
+
+void CImageBase::WriteNibblizedTrack(ImageInfo* pImageInfo, const UINT track, SectorOrder_e SectorOrder, LPBYTE pTrackImageBuffer, int nNibbles)
+{
+	DenibblizeTrack(pTrackImageBuffer, SectorOrder, nNibbles);
+	WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+
+	if (track < TRACKS_MAX)
+		pImageInfo->nibblizedTracks[track].clear();	// Re-nibblized from the image on next read
+}
+
+//-------------------------------------
+
+bool CImageBase::ReadSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, SectorOrder_e SectorOrder, LPBYTE pSectorBuffer)
+{
+	if (track >= pImageInfo->uNumTracks || physicalSector >= NUM_SECTORS)
+		return false;
+
+	const long offset = pImageInfo->uOffset + track * TRACK_DENIBBLIZED_SIZE + (ms_SectorNumber[SectorOrder][physicalSector] << 8);
+	memcpy(pSectorBuffer, &pImageInfo->pImageBuffer[offset], SECTOR_SIZE);
+
+	return true;
+}
+
+bool CImageBase::WriteSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, SectorOrder_e SectorOrder, LPBYTE pSectorBuffer)
+{
+	if (track >= pImageInfo->uNumTracks || physicalSector >= NUM_SECTORS)
+		return false;
+
+	const long offset = pImageInfo->uOffset + track * TRACK_DENIBBLIZED_SIZE + (ms_SectorNumber[SectorOrder][physicalSector] << 8);
+	memcpy(&pImageInfo->pImageBuffer[offset], pSectorBuffer, SECTOR_SIZE);
+
+	if (track < TRACKS_MAX)
+		pImageInfo->nibblizedTracks[track].clear();	// Re-nibblized from the image on next read
+
+	return WriteImageData(pImageInfo, pSectorBuffer, SECTOR_SIZE, offset);
+}
+
+//-------------------------------------
+
 bool CImageBase::IsValidImageSize(const DWORD uImageSize)
 {
 	m_uNumTracksInImage = 0;
@@ -659,18 +784,27 @@ public:
 
 	virtual void Read(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int* pNibbles, UINT* pBitCount, bool enhanceDisk)
 	{
-		const UINT track = PhaseToTrack(phase);
-		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
-		*pNibbles = NibblizeTrack(pTrackImageBuffer, eDOSOrder, track);
-		if (!enhanceDisk)
-			SkewTrack(track, *pNibbles, pTrackImageBuffer);
+		ReadNibblizedTrack(pImageInfo, PhaseToTrack(phase), eDOSOrder, pTrackImageBuffer, pNibbles, enhanceDisk);
 	}
 
 	virtual void Write(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int nNibbles)
 	{
-		const UINT track = PhaseToTrack(phase);
-		DenibblizeTrack(pTrackImageBuffer, eDOSOrder, nNibbles);
-		WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		WriteNibblizedTrack(pImageInfo, PhaseToTrack(phase), eDOSOrder, pTrackImageBuffer, nNibbles);
+	}
+
+	virtual void NibblizeAllTracks(ImageInfo* pImageInfo)
+	{
+		CImageBase::NibblizeAllTracks(pImageInfo, eDOSOrder);
+	}
+
+	virtual bool ReadSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer)
+	{
+		return CImageBase::ReadSector(pImageInfo, track, physicalSector, eDOSOrder, pSectorBuffer);
+	}
+
+	virtual bool WriteSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer)
+	{
+		return CImageBase::WriteSector(pImageInfo, track, physicalSector, eDOSOrder, pSectorBuffer);
 	}
 
 	virtual bool AllowCreate(void) { return true; }
@@ -727,18 +861,27 @@ public:
 
 	virtual void Read(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int* pNibbles, UINT* pBitCount, bool enhanceDisk)
 	{
-		const UINT track = PhaseToTrack(phase);
-		ReadTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
-		*pNibbles = NibblizeTrack(pTrackImageBuffer, eProDOSOrder, track);
-		if (!enhanceDisk)
-			SkewTrack(track, *pNibbles, pTrackImageBuffer);
+		ReadNibblizedTrack(pImageInfo, PhaseToTrack(phase), eProDOSOrder, pTrackImageBuffer, pNibbles, enhanceDisk);
 	}
 
 	virtual void Write(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int nNibbles)
 	{
-		const UINT track = PhaseToTrack(phase);
-		DenibblizeTrack(pTrackImageBuffer, eProDOSOrder, nNibbles);
-		WriteTrack(pImageInfo, track, m_pWorkBuffer, TRACK_DENIBBLIZED_SIZE);
+		WriteNibblizedTrack(pImageInfo, PhaseToTrack(phase), eProDOSOrder, pTrackImageBuffer, nNibbles);
+	}
+
+	virtual void NibblizeAllTracks(ImageInfo* pImageInfo)
+	{
+		CImageBase::NibblizeAllTracks(pImageInfo, eProDOSOrder);
+	}
+
+	virtual bool ReadSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer)
+	{
+		return CImageBase::ReadSector(pImageInfo, track, physicalSector, eProDOSOrder, pSectorBuffer);
+	}
+
+	virtual bool WriteSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer)
+	{
+		return CImageBase::WriteSector(pImageInfo, track, physicalSector, eProDOSOrder, pSectorBuffer);
 	}
 
 	virtual eImageType GetType(void) { return eImagePO; }
@@ -1948,6 +2091,18 @@ ImageError_e CImageHelperBase::Open(	LPCTSTR pszImageFilename,
 
 void CImageHelperBase::Close(ImageInfo* pImageInfo)
 {
+	// Complete any pending writes before closing the file
+	// . The write-back thread only logs a failed write, so report it now (eg. on eject)
+	if (!GetDiskImageWriteBack().Flush(pImageInfo))
+	{
+		std::string strText = StrFormat("Unable to write to the disk image: %s\n\nRecent changes to this disk may have been lost.",
+										pImageInfo->szFilename.c_str());
+		GetFrame().FrameMessageBox(strText.c_str(),
+								   g_pAppTitle.c_str(),
+								   MB_ICONEXCLAMATION | MB_SETFOREGROUND);
+	}
+	GetDiskImageWriteBack().Forget(pImageInfo);
+
 	if (pImageInfo->hFile != INVALID_HANDLE_VALUE)
 	{
 		CloseHandle(pImageInfo->hFile);
@@ -40,6 +40,7 @@ struct ImageInfo
 	BYTE			optimalBitTiming;	// WOZ only
 	BYTE			bootSectorFormat;	// WOZ only
 	UINT			maxNibblesPerTrack;
+	std::vector<BYTE> nibblizedTracks[TRACKS_MAX];	// DO & PO only: unskewed nibblized tracks (empty if not cached)
 
 	ImageInfo();
 };
@@ -65,6 +66,9 @@ public:
 	virtual bool Read(ImageInfo* pImageInfo, UINT nBlock, LPBYTE pBlockBuffer) { return false; }
 	virtual void Write(ImageInfo* pImageInfo, const float phase, LPBYTE pTrackImageBuffer, int nNibbles) { }
 	virtual bool Write(ImageInfo* pImageInfo, UINT nBlock, LPBYTE pBlockBuffer) { return false; }
+	virtual void NibblizeAllTracks(ImageInfo* pImageInfo) { }
+	virtual bool ReadSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer) { return false; }
+	virtual bool WriteSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, LPBYTE pSectorBuffer) { return false; }
 
 	virtual bool AllowBoot(void) { return false; }		// Only:    APL and PRG
 	virtual bool AllowRW(void) { return true; }			// All but: APL and PRG
@@ -76,7 +80,9 @@ public:
 	virtual const char* GetRejectExtensions(void) = 0;
 
 	bool WriteImageHeader(ImageInfo* pImageInfo, LPBYTE pHdr, const UINT hdrSize);
+	static bool WriteImageDataToFile(ImageInfo* pImageInfo, const BYTE* pSrcBuffer, const UINT uSrcSize, const long offset);
 	void SetVolumeNumber(const BYTE uVolumeNumber) { m_uVolumeNumber = uVolumeNumber; }
+	BYTE GetVolumeNumber(void) { return m_uVolumeNumber; }
 	bool IsValidImageSize(const DWORD uImageSize);
 
 	// To accurately convert a half phase (quarter track) back to a track (round half tracks down), use: ceil(phase)/2, eg:
@@ -98,6 +104,11 @@ protected:
 	void DenibblizeTrack (LPBYTE trackimage, SectorOrder_e SectorOrder, int nibbles);
 	DWORD NibblizeTrack (LPBYTE trackimagebuffer, SectorOrder_e SectorOrder, int track);
 	void SkewTrack (const int nTrack, const int nNumNibbles, const LPBYTE pTrackImageBuffer);
+	void NibblizeAllTracks(ImageInfo* pImageInfo, SectorOrder_e SectorOrder);
+	void ReadNibblizedTrack(ImageInfo* pImageInfo, const UINT track, SectorOrder_e SectorOrder, LPBYTE pTrackImageBuffer, int* pNibbles, bool enhanceDisk);
+	void WriteNibblizedTrack(ImageInfo* pImageInfo, const UINT track, SectorOrder_e SectorOrder, LPBYTE pTrackImageBuffer, int nNibbles);
+	bool ReadSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, SectorOrder_e SectorOrder, LPBYTE pSectorBuffer);
+	bool WriteSector(ImageInfo* pImageInfo, const UINT track, const UINT physicalSector, SectorOrder_e SectorOrder, LPBYTE pSectorBuffer);
 
 public:
 	UINT m_uNumTracksInImage;	// Init'd by CDiskImageHelper.Detect()/GetImageForCreation() & possibly updated by IsValidImageSize()
@@ -0,0 +1,184 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Asynchronous write-back of disk image data
+ *
+ * Author: Various
+ *
+ */
+
+#include "StdAfx.h"
+
+#include "DiskImageWriteBack.h"
+#include "DiskImageHelper.h"
+#include "Log.h"
+
+DiskImageWriteBack& GetDiskImageWriteBack(void)
+{
+	static DiskImageWriteBack writeBack;
+	return writeBack;
+}
+
+//===========================================================================
+
+DiskImageWriteBack::DiskImageWriteBack(void)
+	: m_frontInFlight(false)
+	, m_quit(false)
+{
+}
+
+DiskImageWriteBack::~DiskImageWriteBack(void)
+{
+	Stop();
+}
+
+void DiskImageWriteBack::Start(void)
+{
+	// NB. m_mutex is held by caller
+	if (!m_thread.joinable())
+	{
+		m_quit = false;
+		m_thread = std::thread(&DiskImageWriteBack::ThreadFunc, this);
+	}
+}
+
+void DiskImageWriteBack::Stop(void)
+{
+	Flush();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_cvWork.notify_one();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+//===========================================================================
+
+// Returns false if an earlier write to this image failed (this one is still queued)
+bool DiskImageWriteBack::Write(ImageInfo* pImageInfo, const BYTE* pSrcBuffer, const UINT uSrcSize, const long offset)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	Start();
+
+	// Remove any pending write to the same range (unless it's already being written): the new one supersedes it.
+	// NB. The new write goes to the back of the queue, so overlapping writes to different ranges still complete in order.
+	for (std::list<PendingWrite>::iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+	{
+		if (m_frontInFlight && it == m_pending.begin())
+			continue;
+
+		if (it->pImageInfo == pImageInfo && it->offset == offset && it->data.size() == uSrcSize)
+		{
+			m_pending.erase(it);
+			break;
+		}
+	}
+
+	m_cvDone.wait(lock, [this] { return m_pending.size() < MAX_PENDING_WRITES; });
+
+	m_pending.push_back(PendingWrite());
+	PendingWrite& write = m_pending.back();
+	write.pImageInfo = pImageInfo;
+	write.offset = offset;
+	write.data.assign(pSrcBuffer, pSrcBuffer + uSrcSize);
+
+	const bool res = m_failed.find(pImageInfo) == m_failed.end();
+
+	lock.unlock();
+	m_cvWork.notify_one();
+	return res;
+}
+
+// Apply any pending writes to data just read directly from the image file
+// . Caller must hold the file mutex while reading the file and calling this
+void DiskImageWriteBack::ReadOverlay(ImageInfo* pImageInfo, LPBYTE pDstBuffer, const UINT uDstSize, const long offset)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (std::list<PendingWrite>::const_iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+	{
+		if (it->pImageInfo != pImageInfo || it->offset == WHOLE_IMAGE)
+			continue;
+
+		const long start = std::max(offset, it->offset);
+		const long end = std::min(offset + (long)uDstSize, it->offset + (long)it->data.size());
+		if (start < end)
+			memcpy(pDstBuffer + (start - offset), &it->data[start - it->offset], end - start);
+	}
+}
+
+// Wait for all pending writes
+// . Returns false if a write to pImageInfo (if not NULL) has failed
+bool DiskImageWriteBack::Flush(ImageInfo* pImageInfo /*= NULL*/)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cvDone.wait(lock, [this] { return m_pending.empty(); });
+	return !pImageInfo || m_failed.find(pImageInfo) == m_failed.end();
+}
+
+// The image is closed: its ImageInfo may be reused for another image
+void DiskImageWriteBack::Forget(ImageInfo* pImageInfo)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_failed.erase(pImageInfo);
+}
+
+//===========================================================================
+
+void DiskImageWriteBack::ThreadFunc(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_cvWork.wait(lock, [this] { return m_quit || !m_pending.empty(); });
+		if (m_pending.empty())
+			break;	// m_quit
+
+		// Write the front entry with m_mutex released, so that emulation can keep queuing writes
+		PendingWrite& write = m_pending.front();
+		m_frontInFlight = true;
+		lock.unlock();
+
+		bool res;
+		{
+			std::lock_guard<std::mutex> fileLock(m_fileMutex);
+			res = CImageBase::WriteImageDataToFile(write.pImageInfo, &write.data[0], (UINT)write.data.size(), write.offset);
+		}
+
+		if (!res)
+			LogFileOutput("DiskImageWriteBack: failed to write %u bytes at offset %ld to %s\n", (UINT)write.data.size(), write.offset, write.pImageInfo->szFilename.c_str());
+
+		lock.lock();
+		if (!res)
+			m_failed.insert(write.pImageInfo);
+		m_pending.pop_front();
+		m_frontInFlight = false;
+		m_cvDone.notify_all();
+	}
+}
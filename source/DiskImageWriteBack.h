@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct ImageInfo;
+
+// Writes image data (floppy tracks & sectors, HDD blocks, WOZ headers, whole gzip/zip images) to the host file
+// on a dedicated I/O thread, so that host filesystem latency doesn't stall emulation.
+// . Writes are queued in order; a repeated write to the same range of an image replaces the pending one.
+// . The queue is bounded: Write() blocks while it's full.
+// . ImageClose() and save-state flush the queue.
+// . A failed write is sticky for its image: the next Write() and Flush(image) return false, until Forget().
+class DiskImageWriteBack
+{
+public:
+	DiskImageWriteBack(void);
+	~DiskImageWriteBack(void);
+
+	static const long WHOLE_IMAGE = -1;	// offset for gzip/zip images, which are re-written in full
+
+	bool Write(ImageInfo* pImageInfo, const BYTE* pSrcBuffer, const UINT uSrcSize, const long offset);
+	void ReadOverlay(ImageInfo* pImageInfo, LPBYTE pDstBuffer, const UINT uDstSize, const long offset);
+	bool Flush(ImageInfo* pImageInfo = NULL);
+	void Forget(ImageInfo* pImageInfo);
+
+	std::mutex& GetFileMutex(void) { return m_fileMutex; }
+
+private:
+	struct PendingWrite
+	{
+		ImageInfo* pImageInfo;
+		long offset;
+		std::vector<BYTE> data;
+	};
+
+	void Start(void);
+	void Stop(void);
+	void ThreadFunc(void);
+
+	static const UINT MAX_PENDING_WRITES = 64;
+
+	std::list<PendingWrite> m_pending;	// oldest first; the front may be in flight
+	std::set<ImageInfo*> m_failed;		// images with a failed write
+	bool m_frontInFlight;
+	bool m_quit;
+
+	std::mutex m_mutex;					// protects the above
+	std::condition_variable m_cvWork;	// signalled when a write is queued, or on quit
+	std::condition_variable m_cvDone;	// signalled when a write completes
+
+	std::mutex m_fileMutex;				// serialises file access between the I/O thread and direct reads (HDD)
+	std::thread m_thread;
+};
+
+DiskImageWriteBack& GetDiskImageWriteBack(void);
@@ -43,6 +43,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Windows/AppleWin.h"
 #include "CPU.h"
 #include "Memory.h"
+#include "Movie.h"
 #include "YamlHelper.h"
 #include "Interface.h"
 
@@ -602,6 +603,8 @@ BYTE __stdcall JoyReadButton(WORD pc, WORD address, BYTE, BYTE, ULONG nExecutedC
 			break;
 	}
 
+	pressed = MovieFilterButton(address - 0x61, pressed, nExecutedCycles);
+
 	return MemReadFloatingBus(pressed, nExecutedCycles);
 }
 
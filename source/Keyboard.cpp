@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Tape.h"
 #include "YamlHelper.h"
 #include "Log.h"
+#include "Movie.h"
 
 static BYTE asciicode[3][10] = {
 	// VK_LEFT/UP/RIGHT/DOWN/SELECT, VK_PRINT/EXECUTE/SNAPSHOT/INSERT/DELETE
@@ -117,6 +118,9 @@ static bool IsVirtualKeyAnAppleIIKey(WPARAM wparam);
 
 void KeybQueueKeypress (WPARAM key, Keystroke_e bASCII)
 {
+	if (MovieIsPlaying())
+		return;	// Replayed keys are queued by KeybQueueKeycode()
+
 	if (bASCII == ASCII)	// WM_CHAR
 	{
 		if (GetFrame().g_bFreshReset && key == VK_CANCEL) // OLD HACK: 0x03
@@ -253,6 +257,15 @@ void KeybQueueKeypress (WPARAM key, Keystroke_e bASCII)
 		}
 	}
 
+	MovieFilterKey(keycode);
+	keywaiting = 1;
+}
+
+//===========================================================================
+// Queue an Apple keycode directly (eg. replayed from a movie)
+void KeybQueueKeycode (BYTE key)
+{
+	keycode = key & 0x7F;
 	keywaiting = 1;
 }
 
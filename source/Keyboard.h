@@ -13,6 +13,7 @@ bool    KeybGetShiftStatus();
 void    KeybUpdateCtrlShiftStatus();
 BYTE    KeybGetKeycode ();
 void    KeybQueueKeypress(WPARAM key, Keystroke_e bASCII);
+void    KeybQueueKeycode(BYTE key);
 void    KeybToggleCapsLock ();
 void    KeybToggleP8ACapsLock ();
 void    KeybAnyKeyDown(UINT message, WPARAM wparam, bool bIsExtended);
@@ -21,6 +21,7 @@ public:
 
 	virtual void InitializeIO(LPBYTE pCxRomPeripheral);
 	virtual UINT GetActiveBank(void) { return 0; }	// Always 0 as only 1x 16K bank
+	virtual LPBYTE GetBankPtr(UINT uBank) { return NULL; }	// NULL as the 16K is part of main (and aux) memory
 	virtual void SaveSnapshot(YamlSaveHelper& yamlSaveHelper) { } // A no-op for //e - called from CardManager::SaveSnapshot()
 	virtual bool LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version) { _ASSERT(0); return false; } // Not used for //e
 
@@ -55,6 +56,7 @@ public:
 
 	virtual void SaveSnapshot(YamlSaveHelper& yamlSaveHelper);
 	virtual bool LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version);
+	virtual LPBYTE GetBankPtr(UINT uBank) { return (uBank == 0) ? m_pMemory : NULL; }
 
 	static const UINT kMemBankSize = 16*1024;
 	static const std::string& GetSnapshotCardName(void);
@@ -82,6 +84,7 @@ public:
 
 	virtual void InitializeIO(LPBYTE pCxRomPeripheral);
 	virtual UINT GetActiveBank(void);
+	virtual LPBYTE GetBankPtr(UINT uBank) { return (uBank < m_uSaturnTotalBanks) ? m_aSaturnBanks[uBank] : NULL; }
 	virtual void SaveSnapshot(YamlSaveHelper& yamlSaveHelper);
 	virtual bool LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version);
 
@@ -29,9 +29,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "StdAfx.h"
 
 #include "Log.h"
+#include "CPU.h"
 
 #include <time.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 FILE* g_fh = NULL;
 
 #ifdef _MSC_VER
@@ -42,6 +51,16 @@ FILE* g_fh = NULL;
 #define LOG_FILENAME "/tmp/AppleWin.log"
 #endif
 
+static std::atomic<bool> g_logAsync(false);
+static bool g_logStructured = false;
+static UINT g_logRateLimit = 0;
+
+static std::atomic<UINT64> g_logSequence(0);
+static std::atomic<UINT64> g_logDropped(0);
+static std::atomic<UINT64> g_logRateLimited(0);
+static const std::chrono::steady_clock::time_point g_logStart = std::chrono::steady_clock::now();
+
+static void LogStopWriter(void);
 
 //---------------------------------------------------------------------------
 
@@ -73,27 +92,418 @@ void LogInit(void)
 
 	setvbuf(g_fh, NULL, _IONBF, 0);			// No buffering (so implicit fflush after every fprintf)
 
-	fprintf(g_fh, "*** Logging started: %s\n", GetTimeStamp().c_str());
+	LogFileOutput("*** Logging started: %s\n", GetTimeStamp().c_str());
 }
 
 void LogDone(void)
 {
+	g_logAsync = false;
+	LogStopWriter();	// write what is still queued
+
 	if (!g_fh)
 		return;
 
-	fprintf(g_fh,"*** Logging ended\n\n");
+	LogStats stats;
+	LogGetStats(stats);
+	if (stats.dropped || stats.rateLimited)
+		LogFileOutput("*** Log records dropped: %llu (queue full), %llu (rate limit)\n", (unsigned long long)stats.dropped, (unsigned long long)stats.rateLimited);
+
+	LogFileOutput("*** Logging ended\n\n");
 	fclose(g_fh);
 	g_fh = NULL;
 }
 
 //---------------------------------------------------------------------------
 
+enum LogTarget_e
+{
+	LOG_TARGET_DEBUG,	// LogOutput()
+	LOG_TARGET_FILE,	// LogFileOutput()
+};
+
+struct LogRecordHeader
+{
+	UINT64 sequence;	// global order
+	UINT64 time;		// ns, since startup
+	UINT64 cycle;		// g_nCumulativeCycles
+	UINT thread;
+	UINT size;
+	LogTarget_e target;
+};
+
+// Single producer (the owning thread), single consumer (the writer thread)
+class LogRing
+{
+public:
+	LogRing(const UINT thread) : m_thread(thread), m_head(0), m_tail(0), m_closed(false) {}
+
+	UINT GetThread(void) const { return m_thread; }
+	bool IsClosed(void) const { return m_closed.load(std::memory_order_acquire); }
+	void Close(void) { m_closed.store(true, std::memory_order_release); }
+
+	bool Push(const LogRecordHeader& header, const char* message)
+	{
+		const UINT64 head = m_head.load(std::memory_order_relaxed);
+		const size_t size = sizeof(header) + header.size;
+		if (kSize - (head - m_tail.load(std::memory_order_acquire)) < size)
+			return false;
+
+		Copy(head, &header, sizeof(header));
+		Copy(head + sizeof(header), message, header.size);
+		m_head.store(head + size, std::memory_order_release);
+		return true;
+	}
+
+	template <typename F>
+	void Pop(F f)
+	{
+		UINT64 tail = m_tail.load(std::memory_order_relaxed);
+		const UINT64 head = m_head.load(std::memory_order_acquire);
+		char message[LOG_MAX_RECORD];
+		while (tail != head)
+		{
+			LogRecordHeader header;
+			Paste(tail, &header, sizeof(header));
+			Paste(tail + sizeof(header), message, header.size);
+			f(header, message);
+			tail += sizeof(header) + header.size;
+		}
+		m_tail.store(tail, std::memory_order_release);
+	}
+
+private:
+	static const size_t kSize = 1 << 16;	// power of 2
+
+	void Copy(const UINT64 pos, const void* src, const size_t size)
+	{
+		const size_t offset = pos & (kSize - 1);
+		const size_t first = std::min(size, kSize - offset);
+		memcpy(m_buffer + offset, src, first);
+		memcpy(m_buffer, (const char*)src + first, size - first);
+	}
+
+	void Paste(const UINT64 pos, void* dst, const size_t size) const
+	{
+		const size_t offset = pos & (kSize - 1);
+		const size_t first = std::min(size, kSize - offset);
+		memcpy(dst, m_buffer + offset, first);
+		memcpy((char*)dst + first, m_buffer, size - first);
+	}
+
+	const UINT m_thread;
+	std::atomic<UINT64> m_head;	// bytes written
+	std::atomic<UINT64> m_tail;	// bytes read
+	std::atomic<bool> m_closed;	// the thread has exited
+	char m_buffer[kSize];
+};
+
+struct LogSite
+{
+	const char* format;
+	UINT64 second;
+	UINT count;
+	UINT suppressed;
+};
+
+static const UINT kLogSites = 64;	// per thread, indexed by a hash of the format string
+
+struct LogThread
+{
+	std::shared_ptr<LogRing> ring;
+	LogSite sites[kLogSites];
+	char buffer[LOG_MAX_RECORD];
+
+	LogThread() : sites() {}
+	~LogThread()
+	{
+		if (ring)
+			ring->Close();	// the writer frees it once it is empty
+	}
+};
+
+static thread_local LogThread g_logThread;
+
+static std::mutex g_logRingsMutex;
+static std::vector<std::shared_ptr<LogRing>> g_logRings;
+static UINT g_logNextThread = 0;
+
+static std::thread g_logWriter;
+static std::mutex g_logWriterMutex;
+static std::condition_variable g_logWriterCV;
+static bool g_logWriterStop = false;
+
+static void AppendJsonString(std::string& out, const char* str, size_t size)
+{
+	out += '"';
+	for (size_t i = 0; i < size; i++)
+	{
+		const unsigned char c = str[i];
+		switch (c)
+		{
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if (c < 0x20)
+				out += StrFormat("\\u%04x", c);
+			else
+				out += c;
+		}
+	}
+	out += '"';
+}
+
+// Appends the LOG_TARGET_FILE records to 'out', writes the others straight away
+static void LogFormatRecord(const LogRecordHeader& header, const char* message, std::string& out)
+{
+	if (header.target == LOG_TARGET_DEBUG)
+	{
+		OutputDebugString(std::string(message, header.size).c_str());
+		return;
+	}
+
+	if (!g_logStructured)
+	{
+		out.append(message, header.size);
+		return;
+	}
+
+	size_t size = header.size;
+	while (size && (message[size - 1] == '\n' || message[size - 1] == '\r'))
+		size--;
+
+	out += StrFormat("{\"seq\":%llu,\"time\":%.6f,\"cycle\":%llu,\"thread\":%u,\"msg\":",
+		(unsigned long long)header.sequence, header.time / 1.0e9, (unsigned long long)header.cycle, header.thread);
+	AppendJsonString(out, message, size);
+	out += "}\n";
+}
+
+static void LogDrain(void)
+{
+	struct Pending
+	{
+		LogRecordHeader header;
+		std::string message;
+	};
+	std::vector<Pending> pending;
+
+	std::vector<std::shared_ptr<LogRing>> rings;
+	{
+		std::lock_guard<std::mutex> lock(g_logRingsMutex);
+		rings = g_logRings;
+	}
+
+	for (const std::shared_ptr<LogRing>& ring : rings)
+	{
+		const bool closed = ring->IsClosed();	// before Pop(), so nothing pushed before closing is lost
+		ring->Pop([&pending](const LogRecordHeader& header, const char* message) {
+			pending.push_back({ header, std::string(message, header.size) });
+		});
+
+		if (closed)
+		{
+			std::lock_guard<std::mutex> lock(g_logRingsMutex);
+			g_logRings.erase(std::remove(g_logRings.begin(), g_logRings.end(), ring), g_logRings.end());
+		}
+	}
+
+	// Restore the global order
+	std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+		return a.header.sequence < b.header.sequence;
+	});
+
+	std::string out;
+	for (const Pending& record : pending)
+		LogFormatRecord(record.header, record.message.data(), out);
+
+	if (g_fh && !out.empty())
+		fwrite(out.data(), 1, out.size(), g_fh);
+}
+
+static void LogWriterThread(void)
+{
+	bool stop = false;
+	while (!stop)
+	{
+		{
+			std::unique_lock<std::mutex> lock(g_logWriterMutex);
+			stop = g_logWriterCV.wait_for(lock, std::chrono::milliseconds(10), [] { return g_logWriterStop; });
+		}
+		LogDrain();
+	}
+}
+
+static void LogStartWriter(void)
+{
+	if (g_logWriter.joinable())
+		return;
+
+	g_logWriterStop = false;
+	g_logWriter = std::thread(LogWriterThread);
+}
+
+static void LogStopWriter(void)
+{
+	if (!g_logWriter.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(g_logWriterMutex);
+		g_logWriterStop = true;
+	}
+	g_logWriterCV.notify_one();
+	g_logWriter.join();
+}
+
+// In case LogDone() is not called: a joinable std::thread must not be destroyed
+static struct LogWriterGuard
+{
+	~LogWriterGuard() { LogStopWriter(); }
+} g_logWriterGuard;
+
+//---------------------------------------------------------------------------
+
+static UINT64 LogGetTime(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_logStart).count();
+}
+
+static void LogEmit(const LogTarget_e target, const char* message, const size_t size, const UINT64 time)
+{
+	LogRecordHeader header;
+	header.sequence = g_logSequence.fetch_add(1, std::memory_order_relaxed);
+	header.time = time;
+	header.cycle = g_nCumulativeCycles;
+	header.size = (UINT)std::min<size_t>(size, LOG_MAX_RECORD - 1);
+	header.target = target;
+
+	if (g_logAsync.load(std::memory_order_relaxed))
+	{
+		std::shared_ptr<LogRing>& ring = g_logThread.ring;
+		if (!ring)
+		{
+			// Once per thread
+			std::lock_guard<std::mutex> lock(g_logRingsMutex);
+			ring = std::make_shared<LogRing>(g_logNextThread++);
+			g_logRings.push_back(ring);
+		}
+
+		header.thread = ring->GetThread();
+		if (!ring->Push(header, message))
+			g_logDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		header.thread = 0;
+		std::string out;
+		LogFormatRecord(header, message, out);
+		if (g_fh && !out.empty())
+			fwrite(out.data(), 1, out.size(), g_fh);
+	}
+}
+
+// Returns false if the record must be dropped
+static bool LogRateLimit(const char* format, const UINT64 time)
+{
+	LogSite& site = g_logThread.sites[((uintptr_t)format >> 4) % kLogSites];
+	const UINT64 second = time / 1000000000;
+
+	if (site.format != format || site.second != second)
+	{
+		if (site.suppressed)
+		{
+			std::string note = StrFormat("*** %u records suppressed (rate limit): %s", site.suppressed, site.format);
+			if (note.empty() || note.back() != '\n')
+				note += '\n';
+			LogEmit(LOG_TARGET_FILE, note.data(), note.size(), time);
+		}
+		site.format = format;
+		site.second = second;
+		site.count = 0;
+		site.suppressed = 0;
+	}
+
+	if (site.count >= g_logRateLimit)
+	{
+		site.suppressed++;
+		g_logRateLimited.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	site.count++;
+	return true;
+}
+
+static void LogRecordV(const LogTarget_e target, const char* format, va_list args)
+{
+	const UINT64 time = LogGetTime();
+	if (g_logRateLimit && !LogRateLimit(format, time))
+		return;
+
+	char* buffer = g_logThread.buffer;
+	const int size = vsnprintf(buffer, LOG_MAX_RECORD, format, args);
+	if (size < 0)
+		return;
+
+	LogEmit(target, buffer, std::min<size_t>(size, LOG_MAX_RECORD - 1), time);
+}
+
+static bool LogIsDirect(void)
+{
+	return !g_logAsync.load(std::memory_order_relaxed) && !g_logStructured && !g_logRateLimit;
+}
+
+//---------------------------------------------------------------------------
+
+void LogSetAsync(const bool async)
+{
+	if (async)
+	{
+		LogStartWriter();
+		g_logAsync = true;
+	}
+	else
+	{
+		g_logAsync = false;
+		LogStopWriter();
+	}
+}
+
+bool LogIsAsync(void)
+{
+	return g_logAsync;
+}
+
+void LogSetRateLimit(const UINT recordsPerSecond)
+{
+	g_logRateLimit = recordsPerSecond;
+}
+
+void LogSetStructured(const bool structured)
+{
+	g_logStructured = structured;
+}
+
+void LogGetStats(LogStats& stats)
+{
+	stats.records = g_logSequence;
+	stats.dropped = g_logDropped;
+	stats.rateLimited = g_logRateLimited;
+}
+
+//---------------------------------------------------------------------------
+
 void LogOutput(const char* format, ...)
 {
 	va_list args;
 	va_start(args, format);
 
-	OutputDebugString(StrFormatV(format, args).c_str());
+	if (LogIsDirect())
+		OutputDebugString(StrFormatV(format, args).c_str());
+	else
+		LogRecordV(LOG_TARGET_DEBUG, format, args);
 
 	va_end(args);
 }
@@ -108,7 +518,10 @@ void LogFileOutput(const char* format, ...)
 	va_list args;
 	va_start(args, format);
 
-	vfprintf(g_fh, format, args);
+	if (LogIsDirect())
+		vfprintf(g_fh, format, args);
+	else
+		LogRecordV(LOG_TARGET_FILE, format, args);
 
 	va_end(args);
 }
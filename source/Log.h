@@ -19,3 +19,28 @@ void LogDone(void);
 
 void LogOutput(const char* format, ...) ATTRIBUTE_FORMAT_PRINTF(1, 2);
 void LogFileOutput(const char* format, ...) ATTRIBUTE_FORMAT_PRINTF(1, 2);
+
+// Asynchronous mode
+// . LogOutput() & LogFileOutput() format the record into a ring buffer owned by the calling thread (lock-free, single producer)
+//   and a background thread writes them out: callers never wait for the file or the console
+// . If a ring is full, the record is dropped (and counted) rather than stalling the emulation
+// . Records longer than LOG_MAX_RECORD are truncated
+#define LOG_MAX_RECORD 1024
+
+void LogSetAsync(const bool async);
+bool LogIsAsync(void);
+
+// At most this many records per second from each call site (ie. format string), the others are counted & reported. 0 = no limit
+void LogSetRateLimit(const UINT recordsPerSecond);
+
+// Structured: one JSON object per line (sequence, time, emulated cycle, thread & message), for LogFileOutput() only
+void LogSetStructured(const bool structured);
+
+struct LogStats
+{
+	UINT64 records;
+	UINT64 dropped;			// ring full
+	UINT64 rateLimited;
+};
+
+void LogGetStats(LogStats& stats);
@@ -410,6 +410,7 @@ LPBYTE GetCxRomPeripheral(void)
 
 static BYTE __stdcall IORead_C00x(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles)
 {
+	CpuIdleLoopCandidate(pc);
 	return KeybReadData();
 }
 
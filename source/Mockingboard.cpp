@@ -86,6 +86,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "CPU.h"
 #include "Log.h"
 #include "Memory.h"
+#include "PerfCounters.h"
 #include "SoundCore.h"
 #include "SynchronousEventManager.h"
 #include "YamlHelper.h"
@@ -180,6 +181,11 @@ static VOICE MockingboardVoice;
 
 static UINT g_cyclesThisAudioFrame = 0;
 
+static bool g_bFullSpeedAudio = false;	// Keep rendering the AY8913s when g_bFullSpeed
+static double g_fCyclesSampleRemainder = 0.0;	// Fraction of a sample carried over by MB_UpdateIntFromCycles()
+static MB_AudioCaptureCallback g_pfnAudioCapture = NULL;
+static void* g_pAudioCaptureContext = NULL;
+
 //---------------------------------------------------------------------------
 
 // Forward refs:
@@ -359,12 +365,230 @@ void MB_UpdateIRQ(void)
 //#define DBG_MB_UPDATE
 static UINT64 g_uLastMBUpdateCycle = 0;
 
+// Mix all AY8913 voices from ppAYVoiceBuffer[] into the stereo g_nMixBuffer[]
+static void MB_MixVoices(const int nNumSamples)
+{
+	const double fAttenuation = g_bPhasorEnable ? 2.0/3.0 : 1.0;
+
+	for(int i=0; i<nNumSamples; i++)
+	{
+		// Mockingboard stereo (all voices on an AY8910 wire-or'ed together)
+		// L = Address.b7=0, R = Address.b7=1
+		int nDataL = 0, nDataR = 0;
+
+		for(UINT j=0; j<NUM_VOICES_PER_AY8910; j++)
+		{
+			// Slot4
+			nDataL += (int) ((double)ppAYVoiceBuffer[0*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+			nDataR += (int) ((double)ppAYVoiceBuffer[1*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+
+			// Slot5
+			nDataL += (int) ((double)ppAYVoiceBuffer[2*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+			nDataR += (int) ((double)ppAYVoiceBuffer[3*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
+		}
+
+		// Cap the superpositioned output
+		if(nDataL < nWaveDataMin)
+			nDataL = nWaveDataMin;
+		else if(nDataL > nWaveDataMax)
+			nDataL = nWaveDataMax;
+
+		if(nDataR < nWaveDataMin)
+			nDataR = nWaveDataMin;
+		else if(nDataR > nWaveDataMax)
+			nDataR = nWaveDataMax;
+
+		g_nMixBuffer[i*g_nMB_NumChannels+0] = (short)nDataL;	// L
+		g_nMixBuffer[i*g_nMB_NumChannels+1] = (short)nDataR;	// R
+	}
+}
+
+// Where the next samples go in the DirectSound ring-buffer
+static DWORD g_dwMBByteOffset = (DWORD)-1;
+static int g_nMBNumSamplesError = 0;	// Correction so that the ring-buffer doesn't under/overflow
+
+// Keep the write offset out of the Play..Write region, and update the correction for the next period
+static bool MB_DSUpdateCursors(const int nNumSamples)
+{
+	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
+	HRESULT hr = MockingboardVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
+	if(FAILED(hr))
+		return false;
+
+	if(g_dwMBByteOffset == (DWORD)-1)
+	{
+		// First time in this func
+
+		g_dwMBByteOffset = dwCurrentWriteCursor;
+	}
+	else
+	{
+		// Check that our offset isn't between Play & Write positions
+
+		if(dwCurrentWriteCursor > dwCurrentPlayCursor)
+		{
+			// |-----PxxxxxW-----|
+			if((g_dwMBByteOffset > dwCurrentPlayCursor) && (g_dwMBByteOffset < dwCurrentWriteCursor))
+			{
+#ifdef DBG_MB_UPDATE
+				double fTicksSecs = (double)GetTickCount() / 1000.0;
+				LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X xxx\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, g_dwMBByteOffset, nNumSamples);
+#endif
+				g_dwMBByteOffset = dwCurrentWriteCursor;
+				g_nMBNumSamplesError = 0;
+			}
+		}
+		else
+		{
+			// |xxW----------Pxxx|
+			if((g_dwMBByteOffset > dwCurrentPlayCursor) || (g_dwMBByteOffset < dwCurrentWriteCursor))
+			{
+#ifdef DBG_MB_UPDATE
+				double fTicksSecs = (double)GetTickCount() / 1000.0;
+				LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X XXX\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, g_dwMBByteOffset, nNumSamples);
+#endif
+				g_dwMBByteOffset = dwCurrentWriteCursor;
+				g_nMBNumSamplesError = 0;
+			}
+		}
+	}
+
+	int nBytesRemaining = g_dwMBByteOffset - dwCurrentPlayCursor;
+	if(nBytesRemaining < 0)
+		nBytesRemaining += g_dwDSBufferSize;
+
+	// Calc correction factor so that play-buffer doesn't under/overflow
+	const int nErrorInc = SoundCore_GetErrorInc();
+	if(nBytesRemaining < g_dwDSBufferSize / 4)
+		g_nMBNumSamplesError += nErrorInc;				// < 0.25 of buffer remaining
+	else if(nBytesRemaining > g_dwDSBufferSize / 2)
+		g_nMBNumSamplesError -= nErrorInc;				// > 0.50 of buffer remaining
+	else
+		g_nMBNumSamplesError = 0;						// Acceptable amount of data in buffer
+
+#ifdef DBG_MB_UPDATE
+	double fTicksSecs = (double)GetTickCount() / 1000.0;
+	LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X, NSE=%08X\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor - dwCurrentPlayCursor, g_dwMBByteOffset, nNumSamples, g_nMBNumSamplesError);
+#endif
+
+	return true;
+}
+
+// Copy the mixed samples to the DirectSound ring-buffer
+static void MB_DSWrite(const int nNumSamples)
+{
+	DWORD dwDSLockedBufferSize0, dwDSLockedBufferSize1;
+	SHORT *pDSLockedBuffer0, *pDSLockedBuffer1;
+
+	HRESULT hr = DSGetLock(MockingboardVoice.lpDSBvoice,
+		g_dwMBByteOffset, (DWORD)nNumSamples * sizeof(short) * g_nMB_NumChannels,
+		&pDSLockedBuffer0, &dwDSLockedBufferSize0,
+		&pDSLockedBuffer1, &dwDSLockedBufferSize1);
+	if (FAILED(hr))
+		return;
+
+	memcpy(pDSLockedBuffer0, &g_nMixBuffer[0], dwDSLockedBufferSize0);
+	if(pDSLockedBuffer1)
+		memcpy(pDSLockedBuffer1, &g_nMixBuffer[dwDSLockedBufferSize0/sizeof(short)], dwDSLockedBufferSize1);
+
+	// Commit sound buffer
+	hr = MockingboardVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
+											  (void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
+
+	g_dwMBByteOffset = (g_dwMBByteOffset + (DWORD)nNumSamples*sizeof(short)*g_nMB_NumChannels) % g_dwDSBufferSize;
+
+#ifdef RIFF_MB
+	RiffPutSamples(&g_nMixBuffer[0], nNumSamples);
+#endif
+}
+
+// Play the samples rendered by MB_UpdateIntFromCycles(), applying the DirectSound correction to the played copy only
+// . The capture callback has already had the exact samples, so the mix is just truncated, or padded with its last sample
+static void MB_DSWriteCorrected(const int nNumSamples)
+{
+	if (!MockingboardVoice.bActive || nNumSamples == 0)
+		return;
+
+	int nNumSamplesPlayed = nNumSamples + g_nMBNumSamplesError;	// Apply correction
+	if (nNumSamplesPlayed <= 0)
+		nNumSamplesPlayed = 0;
+	if (nNumSamplesPlayed > 2*nNumSamples)
+		nNumSamplesPlayed = 2*nNumSamples;
+
+	if (nNumSamplesPlayed > MAX_SAMPLES)
+		nNumSamplesPlayed = MAX_SAMPLES;	// Clamp to prevent buffer overflow
+
+	if (!MB_DSUpdateCursors(nNumSamplesPlayed))
+		return;
+
+	if (nNumSamplesPlayed == 0)
+		return;
+
+	for (int i = nNumSamples; i < nNumSamplesPlayed; i++)
+	{
+		g_nMixBuffer[i*g_nMB_NumChannels+0] = g_nMixBuffer[(nNumSamples-1)*g_nMB_NumChannels+0];	// L
+		g_nMixBuffer[i*g_nMB_NumChannels+1] = g_nMixBuffer[(nNumSamples-1)*g_nMB_NumChannels+1];	// R
+	}
+
+	MB_DSWrite(nNumSamplesPlayed);
+}
+
+// Render the AY8913s in emulated time, rather than at the pace of the DirectSound ring-buffer
+// . The number of samples is derived only from the elapsed 6502 cycles (not the DirectSound cursors),
+//   so for a given sequence of AY writes the captured stream is deterministic
+// . Used at full-speed (g_bFullSpeedAudio) and whenever there's a capture callback
+// . Long intervals are rendered in chunks of MAX_SAMPLES, so no emulated time is dropped
+//   (NB. AY reg writes beyond the 1st chunk take effect at the end of that chunk)
+// . If bPlay, each chunk is also written to the DirectSound ring-buffer
+static void MB_UpdateIntFromCycles(const bool bPlay)
+{
+	if (!ppAYVoiceBuffer[0])
+		return;	// DirectSound disabled: the AY8913s aren't initialised
+
+	if (g_uLastMBUpdateCycle == 0)
+		g_uLastMBUpdateCycle = g_uLastCumulativeCycles;
+
+	_ASSERT(g_uLastCumulativeCycles >= g_uLastMBUpdateCycle);
+	const UINT64 updateInterval = g_uLastCumulativeCycles - g_uLastMBUpdateCycle;
+	g_uLastMBUpdateCycle = g_uLastCumulativeCycles;
+
+	const double fNumSamples = (double)updateInterval * SAMPLE_RATE / g_fCurrentCLK6502 + g_fCyclesSampleRemainder;
+	int nNumSamples = (int)fNumSamples;
+	g_fCyclesSampleRemainder = fNumSamples - nNumSamples;
+
+	// If nNumSamples == 0, then any pending AY reg writes remain relative to the last AY8910Update()
+	while (nNumSamples > 0)
+	{
+		const int nNumSamplesChunk = nNumSamples > MAX_SAMPLES ? MAX_SAMPLES : nNumSamples;	// Prevent buffer overflow
+		nNumSamples -= nNumSamplesChunk;
+
+		for (int nChip=0; nChip<NUM_AY8910; nChip++)
+			AY8910Update(nChip, &ppAYVoiceBuffer[nChip*NUM_VOICES_PER_AY8910], nNumSamplesChunk);
+
+		MB_MixVoices(nNumSamplesChunk);
+
+		if (g_pfnAudioCapture)
+			g_pfnAudioCapture(&g_nMixBuffer[0], (UINT)nNumSamplesChunk, g_pAudioCaptureContext);
+
+		if (bPlay)
+			MB_DSWriteCorrected(nNumSamplesChunk);
+	}
+}
+
 // Called by:
 // . MB_SyncEventCallback() on a TIMER1 (not TIMER2) underflow - when IsAnyTimer1Active() == true
 // . MB_PeriodicUpdate()                                       - when IsAnyTimer1Active() == false
 static void MB_UpdateInt(void)
 {
-	if (!MockingboardVoice.bActive)
+	if (g_bFullSpeed && g_bFullSpeedAudio)
+	{
+		// Push any AY reg changes out to the AY chips, and render them in emulated time
+		// . Even without a DirectSound voice, as the stream only goes to the capture callback
+		MB_UpdateIntFromCycles(false);
+		return;
+	}
+
+	if (!MockingboardVoice.bActive && !g_pfnAudioCapture)
 		return;
 
 	if (g_bFullSpeed)
@@ -375,11 +599,8 @@ static void MB_UpdateInt(void)
 		//   . g_bFullSpeed:=true (disk-spinning) for ~50 frames
 		//   . U3 sets AY_ENABLE:=0xFF (as a side-effect, this sets g_bFullSpeed:=false)
 		//   o Without this, the write to AY_ENABLE gets ignored (since AY8910's /g_uLastCumulativeCycles/ was last set 50 frame ago)
-		AY8910UpdateSetCycles();
-
-		// TODO:
-		// If any AY regs have changed then push them out to the AY chip
-
+		if (ppAYVoiceBuffer[0])
+			AY8910UpdateSetCycles();
 		return;
 	}
 
@@ -406,6 +627,16 @@ static void MB_UpdateInt(void)
 
 	//
 
+	if (g_pfnAudioCapture)
+	{
+		// Capturing: the samples come from the elapsed cycles, whether or not anything drains the DirectSound ring-buffer
+		// . They're also played, with the DirectSound correction applied only to the played copy
+		MB_UpdateIntFromCycles(true);
+		return;
+	}
+
+	g_fCyclesSampleRemainder = 0.0;
+
 	// For small timer periods, wait for a period of 500cy before updating DirectSound ring-buffer.
 	// NB. A timer period of less than 24cy will yield nNumSamplesPerPeriod=0.
 	const double kMinimumUpdateInterval = 500.0;	// Arbitary (500 cycles = 21 samples)
@@ -426,8 +657,7 @@ static void MB_UpdateInt(void)
 	const double nIrqFreq = g_fCurrentCLK6502 / updateInterval + 0.5;			// Round-up
 	const int nNumSamplesPerPeriod = (int) ((double)SAMPLE_RATE / nIrqFreq);	// Eg. For 60Hz this is 735
 
-	static int nNumSamplesError = 0;
-	int nNumSamples = nNumSamplesPerPeriod + nNumSamplesError;					// Apply correction
+	int nNumSamples = nNumSamplesPerPeriod + g_nMBNumSamplesError;				// Apply correction
 	if(nNumSamples <= 0)
 		nNumSamples = 0;
 	if(nNumSamples > 2*nNumSamplesPerPeriod)
@@ -442,141 +672,21 @@ static void MB_UpdateInt(void)
 
 	//
 
-	DWORD dwCurrentPlayCursor, dwCurrentWriteCursor;
-	HRESULT hr = MockingboardVoice.lpDSBvoice->GetCurrentPosition(&dwCurrentPlayCursor, &dwCurrentWriteCursor);
-	if(FAILED(hr))
+	if (!MB_DSUpdateCursors(nNumSamples))
 		return;
 
-	static DWORD dwByteOffset = (DWORD)-1;
-	if(dwByteOffset == (DWORD)-1)
-	{
-		// First time in this func
-
-		dwByteOffset = dwCurrentWriteCursor;
-	}
-	else
-	{
-		// Check that our offset isn't between Play & Write positions
-
-		if(dwCurrentWriteCursor > dwCurrentPlayCursor)
-		{
-			// |-----PxxxxxW-----|
-			if((dwByteOffset > dwCurrentPlayCursor) && (dwByteOffset < dwCurrentWriteCursor))
-			{
-#ifdef DBG_MB_UPDATE
-				double fTicksSecs = (double)GetTickCount() / 1000.0;
-				LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X xxx\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, dwByteOffset, nNumSamples);
-#endif
-				dwByteOffset = dwCurrentWriteCursor;
-				nNumSamplesError = 0;
-			}
-		}
-		else
-		{
-			// |xxW----------Pxxx|
-			if((dwByteOffset > dwCurrentPlayCursor) || (dwByteOffset < dwCurrentWriteCursor))
-			{
-#ifdef DBG_MB_UPDATE
-				double fTicksSecs = (double)GetTickCount() / 1000.0;
-				LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X XXX\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor-dwCurrentPlayCursor, dwByteOffset, nNumSamples);
-#endif
-				dwByteOffset = dwCurrentWriteCursor;
-				nNumSamplesError = 0;
-			}
-		}
-	}
-
-	int nBytesRemaining = dwByteOffset - dwCurrentPlayCursor;
-	if(nBytesRemaining < 0)
-		nBytesRemaining += g_dwDSBufferSize;
-
-	// Calc correction factor so that play-buffer doesn't under/overflow
-	const int nErrorInc = SoundCore_GetErrorInc();
-	if(nBytesRemaining < g_dwDSBufferSize / 4)
-		nNumSamplesError += nErrorInc;				// < 0.25 of buffer remaining
-	else if(nBytesRemaining > g_dwDSBufferSize / 2)
-		nNumSamplesError -= nErrorInc;				// > 0.50 of buffer remaining
-	else
-		nNumSamplesError = 0;						// Acceptable amount of data in buffer
-
-#ifdef DBG_MB_UPDATE
-	double fTicksSecs = (double)GetTickCount() / 1000.0;
-	LogOutput("%010.3f: [MBUpdt]    PC=%08X, WC=%08X, Diff=%08X, Off=%08X, NS=%08X, NSE=%08X, Interval=%f\n", fTicksSecs, dwCurrentPlayCursor, dwCurrentWriteCursor, dwCurrentWriteCursor - dwCurrentPlayCursor, dwByteOffset, nNumSamples, nNumSamplesError, updateInterval);
-#endif
-
 	if(nNumSamples == 0)
 		return;
 
 	//
 
-	const double fAttenuation = g_bPhasorEnable ? 2.0/3.0 : 1.0;
-
-	for(int i=0; i<nNumSamples; i++)
-	{
-		// Mockingboard stereo (all voices on an AY8910 wire-or'ed together)
-		// L = Address.b7=0, R = Address.b7=1
-		int nDataL = 0, nDataR = 0;
-
-		for(UINT j=0; j<NUM_VOICES_PER_AY8910; j++)
-		{
-			// Slot4
-			nDataL += (int) ((double)ppAYVoiceBuffer[0*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-			nDataR += (int) ((double)ppAYVoiceBuffer[1*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-
-			// Slot5
-			nDataL += (int) ((double)ppAYVoiceBuffer[2*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-			nDataR += (int) ((double)ppAYVoiceBuffer[3*NUM_VOICES_PER_AY8910+j][i] * fAttenuation);
-		}
-
-		// Cap the superpositioned output
-		if(nDataL < nWaveDataMin)
-			nDataL = nWaveDataMin;
-		else if(nDataL > nWaveDataMax)
-			nDataL = nWaveDataMax;
-
-		if(nDataR < nWaveDataMin)
-			nDataR = nWaveDataMin;
-		else if(nDataR > nWaveDataMax)
-			nDataR = nWaveDataMax;
-
-		g_nMixBuffer[i*g_nMB_NumChannels+0] = (short)nDataL;	// L
-		g_nMixBuffer[i*g_nMB_NumChannels+1] = (short)nDataR;	// R
-	}
-
-	//
-
-	DWORD dwDSLockedBufferSize0, dwDSLockedBufferSize1;
-	SHORT *pDSLockedBuffer0, *pDSLockedBuffer1;
-
-	hr = DSGetLock(MockingboardVoice.lpDSBvoice,
-		dwByteOffset, (DWORD)nNumSamples * sizeof(short) * g_nMB_NumChannels,
-		&pDSLockedBuffer0, &dwDSLockedBufferSize0,
-		&pDSLockedBuffer1, &dwDSLockedBufferSize1);
-	if (FAILED(hr))
-		return;
-
-	memcpy(pDSLockedBuffer0, &g_nMixBuffer[0], dwDSLockedBufferSize0);
-	if(pDSLockedBuffer1)
-		memcpy(pDSLockedBuffer1, &g_nMixBuffer[dwDSLockedBufferSize0/sizeof(short)], dwDSLockedBufferSize1);
-
-	// Commit sound buffer
-	hr = MockingboardVoice.lpDSBvoice->Unlock((void*)pDSLockedBuffer0, dwDSLockedBufferSize0,
-											  (void*)pDSLockedBuffer1, dwDSLockedBufferSize1);
-
-	dwByteOffset = (dwByteOffset + (DWORD)nNumSamples*sizeof(short)*g_nMB_NumChannels) % g_dwDSBufferSize;
-
-#ifdef RIFF_MB
-	RiffPutSamples(&g_nMixBuffer[0], nNumSamples);
-#endif
+	MB_MixVoices(nNumSamples);
+	MB_DSWrite(nNumSamples);
 }
 
 static void MB_Update(void)
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeMB_NoTimer;
-	extern UINT64 g_timeMB_Timer;
-	PerfMarker perfMarker(!IsAnyTimer1Active() ? g_timeMB_NoTimer : g_timeMB_Timer);
-#endif
+	PerfMarker perfMarker(PERF_MOCKINGBOARD);
 
 	MB_UpdateInt();
 }
@@ -1119,6 +1229,26 @@ void MB_Unmute(void)
 
 //-----------------------------------------------------------------------------
 
+void MB_SetFullSpeedAudio(const bool enable)
+{
+	g_bFullSpeedAudio = enable;
+	g_fCyclesSampleRemainder = 0.0;
+}
+
+bool MB_GetFullSpeedAudio(void)
+{
+	return g_bFullSpeedAudio;
+}
+
+void MB_SetAudioCapture(MB_AudioCaptureCallback callback, void* context)
+{
+	g_pfnAudioCapture = callback;
+	g_pAudioCaptureContext = context;
+	g_fCyclesSampleRemainder = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
 #ifdef _DEBUG
 void MB_CheckCumulativeCycles()
 {
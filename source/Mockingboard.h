@@ -25,6 +25,15 @@ DWORD   MB_GetVolume();
 void    MB_SetVolume(DWORD dwVolume, DWORD dwVolumeMax);
 void MB_Get6522IrqDescription(std::string& desc);
 
+// Full-speed audio: keep rendering the AY8913s (in emulated time) when g_bFullSpeed, instead of dropping their output
+void    MB_SetFullSpeedAudio(const bool enable);
+bool    MB_GetFullSpeedAudio(void);
+
+// Capture: called with every block of mixed 44.1kHz stereo samples (both normal & full-speed)
+// . The number of samples follows the emulated cycles, even with no DirectSound voice or nothing playing it
+typedef void (*MB_AudioCaptureCallback)(const short* pStereoSamples, UINT numSamples, void* context);
+void    MB_SetAudioCapture(MB_AudioCaptureCallback callback, void* context);
+
 void MB_UpdateIRQ(void);
 UINT64 MB_GetLastCumulativeCycles(void);
 void MB_UpdateIFR(BYTE nDevice, BYTE clr_mask, BYTE set_mask);
@@ -52,6 +52,7 @@ Etc.
 #include "Interface.h"	// FrameSetCursorPosByMousePos()
 #include "Log.h"
 #include "Memory.h"
+#include "Movie.h"
 #include "NTSC.h"	// NTSC_GetCyclesUntilVBlank()
 #include "YamlHelper.h"
 
@@ -579,6 +580,12 @@ void CMouseInterface::SetPositionAbs(int x, int y)
 
 void CMouseInterface::SetPositionRel(long dX, long dY, int* pOutOfBoundsX, int* pOutOfBoundsY)
 {
+	if (!MovieFilterMouseMove(dX, dY))
+	{
+		*pOutOfBoundsX = *pOutOfBoundsY = 0;
+		return;
+	}
+
 	m_iX += dX;
 	*pOutOfBoundsX = ClampX();
 
@@ -590,6 +597,9 @@ void CMouseInterface::SetPositionRel(long dX, long dY, int* pOutOfBoundsX, int*
 
 void CMouseInterface::SetButton(eBUTTON Button, eBUTTONSTATE State)
 {
+	if (!MovieFilterMouseButton(Button, State))
+		return;
+
 	m_bButtons[Button] = (State == BUTTON_DOWN);
 	OnMouseEvent();
 }
@@ -0,0 +1,729 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Deterministic input recording & replay
+ *
+ * File format (little-endian):
+ *   Header: "AWMOVIE\0", version (UINT32), start cycle (UINT64), checkpoint interval (UINT32),
+ *           save-state filename length (UINT16) & chars (relative to the movie's directory)
+ *   Events: cycles since the previous event (LEB128), type (BYTE), payload:
+ *           KEY: key | BUTTON: button, state | PADDLE: paddle, pos (zigzag LEB128)
+ *           MOUSE_MOVE: dx, dy (zigzag LEB128) | MOUSE_BUTTON: button, state
+ *           DISK_INSERT: slot, drive, write-protected, pathname length (UINT16) & chars | DISK_EJECT: slot, drive
+ *           CHECKPOINT: framebuffer hash (UINT64) | END
+ *
+ * Author: Various
+ *
+ */
+
+#include "StdAfx.h"
+
+#include "Movie.h"
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Interface.h"
+#include "Keyboard.h"
+#include "Log.h"
+#include "MouseInterface.h"
+#include "NTSC.h"
+#include "SaveState.h"
+
+enum MovieEvent_e
+{
+	MOVIE_EVENT_END = 0,
+	MOVIE_EVENT_KEY,
+	MOVIE_EVENT_BUTTON,
+	MOVIE_EVENT_PADDLE,
+	MOVIE_EVENT_MOUSE_MOVE,
+	MOVIE_EVENT_MOUSE_BUTTON,
+	MOVIE_EVENT_DISK_INSERT,
+	MOVIE_EVENT_DISK_EJECT,
+	MOVIE_EVENT_CHECKPOINT,
+};
+
+enum MovieState_e {MOVIE_IDLE, MOVIE_RECORDING, MOVIE_PLAYING};
+
+static const char g_movieMagic[8] = {'A','W','M','O','V','I','E','\0'};
+static const UINT MOVIE_VERSION = 1;
+static const UINT MOVIE_CHECKPOINT_FRAMES = 60;
+static const UINT MOVIE_NUM_BUTTONS = 3;
+static const UINT MOVIE_NUM_PADDLES = 4;
+static const int MOVIE_PADDLE_NONE = -1;	// as reported by the host when there is no paddle
+
+static MovieState_e g_movieState = MOVIE_IDLE;
+static std::string g_moviePathname;
+static MovieStats g_movieStats;
+static UINT64 g_movieLastCycle = 0;				// of the last event written or read
+static UINT g_movieCheckpointInterval = 0;		// cycles
+
+// Recording
+static FILE* g_movieFile = NULL;
+static UINT64 g_movieNextCheckpoint = 0;
+
+// Playback
+static std::vector<BYTE> g_movieData;
+static size_t g_moviePos = 0;
+static UINT64 g_movieNextEventCycle = 0;
+static bool g_movieInjecting = false;			// live input hooks must let the replayed mouse events through
+
+// Last recorded (or replayed) values of the inputs read by the 6502
+static BOOL g_movieButtons[MOVIE_NUM_BUTTONS];
+static int g_moviePaddles[MOVIE_NUM_PADDLES];
+
+//===========================================================================
+
+static void ResetInputs(void)
+{
+	for (UINT i = 0; i < MOVIE_NUM_BUTTONS; i++)
+		g_movieButtons[i] = FALSE;
+	for (UINT i = 0; i < MOVIE_NUM_PADDLES; i++)
+		g_moviePaddles[i] = MOVIE_PADDLE_NONE;
+}
+
+static UINT64 GetCycle(const ULONG uExecutedCycles)
+{
+	CpuCalcCycles(uExecutedCycles);
+	return g_nCumulativeCycles;
+}
+
+// Hash of the whole screen, redrawn from the current state (so independent of how often the video was updated)
+static UINT64 ComputeFrameHash(void)
+{
+	Video& video = GetVideo();
+	BYTE* pFramebuffer = video.GetFrameBuffer();
+	if (!pFramebuffer)
+		return 0;
+
+	const size_t size = video.GetFrameBufferWidth() * video.GetFrameBufferHeight() * sizeof(bgra_t);
+	const std::vector<BYTE> saved(pFramebuffer, pFramebuffer + size);
+
+	NTSC_VideoRedrawWholeScreenDeterministic();
+
+	UINT64 hash = 0xcbf29ce484222325ULL;	// FNV-1a
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= pFramebuffer[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	memcpy(pFramebuffer, &saved[0], size);
+	return hash;
+}
+
+//===========================================================================
+
+static void PutUint(std::vector<BYTE>& buffer, UINT64 value, const UINT size)
+{
+	for (UINT i = 0; i < size; i++, value >>= 8)
+		buffer.push_back((BYTE)value);
+}
+
+static void PutVarUint(std::vector<BYTE>& buffer, UINT64 value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back((BYTE)(value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((BYTE)value);
+}
+
+static void PutVarInt(std::vector<BYTE>& buffer, const __int64 value)
+{
+	PutVarUint(buffer, ((UINT64)value << 1) ^ (UINT64)(value >> 63));	// zigzag
+}
+
+static void PutString(std::vector<BYTE>& buffer, const std::string& str)
+{
+	PutUint(buffer, str.size(), 2);
+	buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+static bool WriteBuffer(const std::vector<BYTE>& buffer)
+{
+	if (fwrite(&buffer[0], 1, buffer.size(), g_movieFile) == buffer.size())
+		return true;
+
+	LogOutput("Movie: failed to write to %s\n", g_moviePathname.c_str());
+	return false;
+}
+
+// Start an event: the payload is appended by the caller
+static void BeginEvent(std::vector<BYTE>& buffer, UINT64 cycle, const MovieEvent_e type)
+{
+	_ASSERT(cycle >= g_movieLastCycle);
+	if (cycle < g_movieLastCycle)
+		cycle = g_movieLastCycle;
+
+	PutVarUint(buffer, cycle - g_movieLastCycle);
+	buffer.push_back((BYTE)type);
+	g_movieLastCycle = cycle;
+}
+
+static void RecordEvent(const std::vector<BYTE>& buffer)
+{
+	if (!WriteBuffer(buffer))
+	{
+		MovieStop();
+		return;
+	}
+	g_movieStats.events++;
+}
+
+//===========================================================================
+
+static bool GetUint(UINT64& value, const UINT size)
+{
+	if (g_moviePos + size > g_movieData.size())
+		return false;
+
+	value = 0;
+	for (UINT i = 0; i < size; i++)
+		value |= (UINT64)g_movieData[g_moviePos++] << (i * 8);
+	return true;
+}
+
+static bool GetByte(BYTE& value)
+{
+	if (g_moviePos >= g_movieData.size())
+		return false;
+
+	value = g_movieData[g_moviePos++];
+	return true;
+}
+
+static bool GetVarUint(UINT64& value)
+{
+	value = 0;
+	for (UINT shift = 0; shift < 64; shift += 7)
+	{
+		BYTE b;
+		if (!GetByte(b))
+			return false;
+		value |= (UINT64)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+static bool GetVarInt(__int64& value)
+{
+	UINT64 zigzag;
+	if (!GetVarUint(zigzag))
+		return false;
+	value = (__int64)(zigzag >> 1) ^ -(__int64)(zigzag & 1);
+	return true;
+}
+
+static bool GetString(std::string& str)
+{
+	UINT64 size;
+	if (!GetUint(size, 2) || g_moviePos + size > g_movieData.size())
+		return false;
+
+	str.assign((const char*)&g_movieData[g_moviePos], (size_t)size);
+	g_moviePos += (size_t)size;
+	return true;
+}
+
+static void StopPlayback(const char* reason)
+{
+	LogOutput("Movie: %s, replayed %llu events up to cycle %llu, %u/%u checkpoint(s) mismatched\n", reason,
+		(unsigned long long)g_movieStats.events, (unsigned long long)g_movieLastCycle, g_movieStats.mismatches, g_movieStats.checkpoints);
+
+	g_movieState = MOVIE_IDLE;
+	std::vector<BYTE>().swap(g_movieData);
+}
+
+// Read the cycle of the next event
+static void PeekNextEvent(void)
+{
+	UINT64 delta;
+	if (!GetVarUint(delta))
+	{
+		StopPlayback("truncated file");
+		return;
+	}
+	g_movieNextEventCycle = g_movieLastCycle + delta;
+}
+
+static void ApplyDiskEvent(const UINT slot, const int drive, const bool insert, const std::string& pathname, const bool writeProtected)
+{
+	if (slot >= NUM_SLOTS || GetCardMgr().QuerySlot(slot) != CT_Disk2 || (drive != DRIVE_1 && drive != DRIVE_2))
+	{
+		LogOutput("Movie: no Disk II card in slot %u\n", slot);
+		return;
+	}
+
+	Disk2InterfaceCard& card = dynamic_cast<Disk2InterfaceCard&>(GetCardMgr().GetRef(slot));
+	if (!insert)
+	{
+		card.EjectDisk(drive);
+		return;
+	}
+
+	const ImageError_e error = card.InsertDisk(drive, pathname, writeProtected, IMAGE_DONT_CREATE);
+	if (error != eIMAGE_ERROR_NONE)
+		LogOutput("Movie: failed to insert %s in S%u D%d\n", pathname.c_str(), slot, drive + 1);
+}
+
+static bool ApplyEvent(void)
+{
+	BYTE type;
+	if (!GetByte(type))
+		return false;
+
+	g_movieLastCycle = g_movieNextEventCycle;
+
+	switch (type)
+	{
+	case MOVIE_EVENT_END:
+		g_movieStats.endCycle = g_movieLastCycle;
+		StopPlayback("end of movie");
+		return true;
+	case MOVIE_EVENT_KEY:
+		{
+			BYTE key;
+			if (!GetByte(key)) return false;
+			KeybQueueKeycode(key);
+		}
+		break;
+	case MOVIE_EVENT_BUTTON:
+		{
+			BYTE button, state;
+			if (!GetByte(button) || !GetByte(state) || button >= MOVIE_NUM_BUTTONS) return false;
+			g_movieButtons[button] = state ? TRUE : FALSE;
+		}
+		break;
+	case MOVIE_EVENT_PADDLE:
+		{
+			BYTE paddle;
+			__int64 pos;
+			if (!GetByte(paddle) || !GetVarInt(pos) || paddle >= MOVIE_NUM_PADDLES) return false;
+			g_moviePaddles[paddle] = (int)pos;
+		}
+		break;
+	case MOVIE_EVENT_MOUSE_MOVE:
+		{
+			__int64 dx, dy;
+			if (!GetVarInt(dx) || !GetVarInt(dy)) return false;
+			if (GetCardMgr().IsMouseCardInstalled())
+			{
+				int outOfBoundsX, outOfBoundsY;
+				g_movieInjecting = true;
+				GetCardMgr().GetMouseCard()->SetPositionRel((long)dx, (long)dy, &outOfBoundsX, &outOfBoundsY);
+				g_movieInjecting = false;
+			}
+		}
+		break;
+	case MOVIE_EVENT_MOUSE_BUTTON:
+		{
+			BYTE button, state;
+			if (!GetByte(button) || !GetByte(state)) return false;
+			if (GetCardMgr().IsMouseCardInstalled())
+			{
+				g_movieInjecting = true;
+				GetCardMgr().GetMouseCard()->SetButton((eBUTTON)button, (eBUTTONSTATE)state);
+				g_movieInjecting = false;
+			}
+		}
+		break;
+	case MOVIE_EVENT_DISK_INSERT:
+		{
+			BYTE slot, drive, writeProtected;
+			std::string pathname;
+			if (!GetByte(slot) || !GetByte(drive) || !GetByte(writeProtected) || !GetString(pathname)) return false;
+			ApplyDiskEvent(slot, drive, true, pathname, writeProtected != 0);
+		}
+		break;
+	case MOVIE_EVENT_DISK_EJECT:
+		{
+			BYTE slot, drive;
+			if (!GetByte(slot) || !GetByte(drive)) return false;
+			ApplyDiskEvent(slot, drive, false, "", false);
+		}
+		break;
+	case MOVIE_EVENT_CHECKPOINT:
+		{
+			UINT64 hash;
+			if (!GetUint(hash, 8)) return false;
+			g_movieStats.checkpoints++;
+			if (g_nCumulativeCycles != g_movieLastCycle || ComputeFrameHash() != hash)
+			{
+				if (!g_movieStats.mismatches)
+				{
+					g_movieStats.firstMismatchCycle = g_movieLastCycle;
+					LogOutput("Movie: checkpoint mismatch at cycle %llu (now %llu)\n", (unsigned long long)g_movieLastCycle, (unsigned long long)g_nCumulativeCycles);
+				}
+				g_movieStats.mismatches++;
+			}
+		}
+		break;
+	default:
+		return false;
+	}
+
+	g_movieStats.events++;
+	return true;
+}
+
+// Apply all the events up to (and including) the current cycle
+static void ApplyEvents(void)
+{
+	while (g_movieState == MOVIE_PLAYING && g_movieNextEventCycle <= g_nCumulativeCycles)
+	{
+		if (!ApplyEvent())
+		{
+			StopPlayback("corrupt event");
+			return;
+		}
+
+		if (g_movieState == MOVIE_PLAYING)
+			PeekNextEvent();
+	}
+}
+
+//===========================================================================
+
+bool MovieStartRecording(const std::string& pathname)
+{
+	MovieStop();
+
+	g_movieFile = fopen(pathname.c_str(), "wb");
+	if (!g_movieFile)
+	{
+		LogOutput("Movie: failed to create %s\n", pathname.c_str());
+		return false;
+	}
+
+	// The starting state
+	// . Reloaded straight away, so that the recording and its replays start from exactly the same state
+	//   (eg. the keyboard's queue is not saved)
+	const std::string statePathname = pathname + ".yaml";
+	const std::string oldPathname = Snapshot_GetPathname();
+	const UINT64 startCycle = g_nCumulativeCycles;
+	Snapshot_SetFilename(statePathname);
+	Snapshot_SaveState();
+	Snapshot_LoadState();
+	Snapshot_SetFilename(oldPathname);
+
+	if (g_nCumulativeCycles != startCycle)
+	{
+		LogOutput("Movie: failed to save the starting state %s\n", statePathname.c_str());
+		fclose(g_movieFile);
+		g_movieFile = NULL;
+		return false;
+	}
+
+	const size_t pos = statePathname.find_last_of(PATH_SEPARATOR);
+	const std::string stateFilename = pos == std::string::npos ? statePathname : statePathname.substr(pos + 1);
+
+	g_moviePathname = pathname;
+	g_movieCheckpointInterval = NTSC_GetCyclesPerFrame() * MOVIE_CHECKPOINT_FRAMES;
+	g_movieLastCycle = g_nCumulativeCycles;
+	g_movieNextCheckpoint = g_nCumulativeCycles + g_movieCheckpointInterval;
+	memset(&g_movieStats, 0, sizeof(g_movieStats));
+	g_movieStats.startCycle = g_nCumulativeCycles;
+	ResetInputs();
+
+	std::vector<BYTE> header(g_movieMagic, g_movieMagic + sizeof(g_movieMagic));
+	PutUint(header, MOVIE_VERSION, 4);
+	PutUint(header, g_nCumulativeCycles, 8);
+	PutUint(header, g_movieCheckpointInterval, 4);
+	PutString(header, stateFilename);
+	if (!WriteBuffer(header))
+	{
+		fclose(g_movieFile);
+		g_movieFile = NULL;
+		return false;
+	}
+
+	g_movieState = MOVIE_RECORDING;
+	LogOutput("Movie: recording to %s from cycle %llu\n", pathname.c_str(), (unsigned long long)g_nCumulativeCycles);
+	return true;
+}
+
+bool MovieStartPlayback(const std::string& pathname)
+{
+	MovieStop();
+
+	FILE* fp = fopen(pathname.c_str(), "rb");
+	if (!fp)
+	{
+		LogOutput("Movie: failed to open %s\n", pathname.c_str());
+		return false;
+	}
+
+	g_movieData.clear();
+	BYTE buffer[4096];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+		g_movieData.insert(g_movieData.end(), buffer, buffer + size);
+	fclose(fp);
+
+	g_moviePos = 0;
+	UINT64 version, startCycle, checkpointInterval;
+	std::string stateFilename;
+	if (g_movieData.size() < sizeof(g_movieMagic) || memcmp(&g_movieData[0], g_movieMagic, sizeof(g_movieMagic)) != 0
+		|| (g_moviePos = sizeof(g_movieMagic), !GetUint(version, 4)) || version != MOVIE_VERSION
+		|| !GetUint(startCycle, 8) || !GetUint(checkpointInterval, 4) || !GetString(stateFilename))
+	{
+		LogOutput("Movie: %s is not a supported movie file\n", pathname.c_str());
+		std::vector<BYTE>().swap(g_movieData);
+		return false;
+	}
+
+	// The starting state, in the movie's directory
+	const size_t pos = pathname.find_last_of(PATH_SEPARATOR);
+	const std::string statePathname = (pos == std::string::npos ? std::string() : pathname.substr(0, pos + 1)) + stateFilename;
+	const std::string oldPathname = Snapshot_GetPathname();
+	Snapshot_SetFilename(statePathname);
+	Snapshot_LoadState();
+	Snapshot_SetFilename(oldPathname);
+
+	if (g_nCumulativeCycles != startCycle)
+	{
+		LogOutput("Movie: failed to load the starting state %s\n", statePathname.c_str());
+		std::vector<BYTE>().swap(g_movieData);
+		return false;
+	}
+
+	g_moviePathname = pathname;
+	g_movieCheckpointInterval = (UINT)checkpointInterval;
+	g_movieLastCycle = startCycle;
+	memset(&g_movieStats, 0, sizeof(g_movieStats));
+	g_movieStats.startCycle = startCycle;
+	ResetInputs();
+
+	g_movieState = MOVIE_PLAYING;
+	LogOutput("Movie: playing %s from cycle %llu\n", pathname.c_str(), (unsigned long long)startCycle);
+
+	PeekNextEvent();
+	ApplyEvents();
+	return true;
+}
+
+void MovieStop(void)
+{
+	if (g_movieState == MOVIE_RECORDING)
+	{
+		g_movieState = MOVIE_IDLE;	// before writing, as a failed write calls MovieStop()
+
+		std::vector<BYTE> buffer;
+		BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_END);
+		WriteBuffer(buffer);
+		g_movieStats.endCycle = g_nCumulativeCycles;
+
+		fclose(g_movieFile);
+		g_movieFile = NULL;
+
+		LogOutput("Movie: recorded %llu events, %u checkpoint(s) to %s\n",
+			(unsigned long long)g_movieStats.events, g_movieStats.checkpoints, g_moviePathname.c_str());
+	}
+	else if (g_movieState == MOVIE_PLAYING)
+	{
+		StopPlayback("stopped");
+	}
+}
+
+bool MovieIsRecording(void)
+{
+	return g_movieState == MOVIE_RECORDING;
+}
+
+bool MovieIsPlaying(void)
+{
+	return g_movieState == MOVIE_PLAYING;
+}
+
+void MovieGetStats(MovieStats& stats)
+{
+	stats = g_movieStats;
+}
+
+//===========================================================================
+
+// Playback: stop the batch on the next event's cycle
+DWORD MovieClipCycles(const DWORD uCycles)
+{
+	if (g_movieState != MOVIE_PLAYING || g_movieNextEventCycle <= g_nCumulativeCycles)
+		return uCycles;
+
+	const UINT64 cyclesToEvent = g_movieNextEventCycle - g_nCumulativeCycles;
+	return cyclesToEvent < uCycles ? (DWORD)cyclesToEvent : uCycles;
+}
+
+// Called after each CpuExecute() batch
+void MovieUpdate(void)
+{
+	if (g_movieState == MOVIE_RECORDING)
+	{
+		if (g_nCumulativeCycles >= g_movieNextCheckpoint)
+		{
+			std::vector<BYTE> buffer;
+			BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_CHECKPOINT);
+			PutUint(buffer, ComputeFrameHash(), 8);
+			RecordEvent(buffer);
+
+			g_movieStats.checkpoints++;
+			g_movieNextCheckpoint = g_nCumulativeCycles + g_movieCheckpointInterval;
+		}
+	}
+	else if (g_movieState == MOVIE_PLAYING)
+	{
+		ApplyEvents();
+	}
+}
+
+//===========================================================================
+
+bool MovieFilterKey(const BYTE key)
+{
+	if (g_movieState == MOVIE_PLAYING)
+		return false;
+
+	if (g_movieState == MOVIE_RECORDING)
+	{
+		std::vector<BYTE> buffer;
+		BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_KEY);
+		buffer.push_back(key);
+		RecordEvent(buffer);
+	}
+
+	return true;
+}
+
+BOOL MovieFilterButton(const UINT button, const BOOL pressed, const ULONG uExecutedCycles)
+{
+	if (g_movieState == MOVIE_IDLE || button >= MOVIE_NUM_BUTTONS)
+		return pressed;
+
+	if (g_movieState == MOVIE_PLAYING)
+	{
+		GetCycle(uExecutedCycles);
+		ApplyEvents();
+		return g_movieButtons[button];
+	}
+
+	if ((pressed ? TRUE : FALSE) != g_movieButtons[button])
+	{
+		g_movieButtons[button] = pressed ? TRUE : FALSE;
+
+		std::vector<BYTE> buffer;
+		BeginEvent(buffer, GetCycle(uExecutedCycles), MOVIE_EVENT_BUTTON);
+		buffer.push_back((BYTE)button);
+		buffer.push_back((BYTE)g_movieButtons[button]);
+		RecordEvent(buffer);
+	}
+
+	return pressed;
+}
+
+int MovieFilterPaddle(const UINT paddle, const int pos, const ULONG uExecutedCycles)
+{
+	if (g_movieState == MOVIE_IDLE || paddle >= MOVIE_NUM_PADDLES)
+		return pos;
+
+	if (g_movieState == MOVIE_PLAYING)
+	{
+		GetCycle(uExecutedCycles);
+		ApplyEvents();
+		return g_moviePaddles[paddle];
+	}
+
+	if (pos != g_moviePaddles[paddle])
+	{
+		g_moviePaddles[paddle] = pos;
+
+		std::vector<BYTE> buffer;
+		BeginEvent(buffer, GetCycle(uExecutedCycles), MOVIE_EVENT_PADDLE);
+		buffer.push_back((BYTE)paddle);
+		PutVarInt(buffer, pos);
+		RecordEvent(buffer);
+	}
+
+	return pos;
+}
+
+bool MovieFilterMouseMove(const long dx, const long dy)
+{
+	if (g_movieState == MOVIE_PLAYING)
+		return g_movieInjecting;
+
+	if (g_movieState == MOVIE_RECORDING && (dx || dy))
+	{
+		std::vector<BYTE> buffer;
+		BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_MOUSE_MOVE);
+		PutVarInt(buffer, dx);
+		PutVarInt(buffer, dy);
+		RecordEvent(buffer);
+	}
+
+	return true;
+}
+
+bool MovieFilterMouseButton(const int button, const int state)
+{
+	if (g_movieState == MOVIE_PLAYING)
+		return g_movieInjecting;
+
+	if (g_movieState == MOVIE_RECORDING)
+	{
+		std::vector<BYTE> buffer;
+		BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_MOUSE_BUTTON);
+		buffer.push_back((BYTE)button);
+		buffer.push_back((BYTE)state);
+		RecordEvent(buffer);
+	}
+
+	return true;
+}
+
+void MovieRecordDiskInsert(const UINT slot, const int drive, const std::string& pathname, const bool writeProtected)
+{
+	if (g_movieState != MOVIE_RECORDING)
+		return;
+
+	std::vector<BYTE> buffer;
+	BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_DISK_INSERT);
+	buffer.push_back((BYTE)slot);
+	buffer.push_back((BYTE)drive);
+	buffer.push_back(writeProtected ? 1 : 0);
+	PutString(buffer, pathname);
+	RecordEvent(buffer);
+}
+
+void MovieRecordDiskEject(const UINT slot, const int drive)
+{
+	if (g_movieState != MOVIE_RECORDING)
+		return;
+
+	std::vector<BYTE> buffer;
+	BeginEvent(buffer, g_nCumulativeCycles, MOVIE_EVENT_DISK_EJECT);
+	buffer.push_back((BYTE)slot);
+	buffer.push_back((BYTE)drive);
+	RecordEvent(buffer);
+}
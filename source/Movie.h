@@ -0,0 +1,38 @@
+#pragma once
+
+// Deterministic input recording & replay ("movie")
+// . A movie starts from a save-state (saved alongside as <movie>.yaml) and records the host inputs, keyed on g_nCumulativeCycles:
+//   keyboard, pushbuttons & paddles (as read by the 6502), mouse card, Disk II inserts & ejects
+// . A hash of the framebuffer is recorded at regular checkpoints, and verified on replay
+// . On replay the live inputs are ignored, and CpuExecute() stops on each event's cycle so that it's applied exactly
+
+struct MovieStats
+{
+	UINT64 startCycle;
+	UINT64 endCycle;		// 0 while recording (or if the recording was not stopped cleanly)
+	UINT64 events;			// replayed (or recorded) so far
+	UINT checkpoints;		// verified (or recorded) so far
+	UINT mismatches;
+	UINT64 firstMismatchCycle;
+};
+
+bool MovieStartRecording(const std::string& pathname);
+bool MovieStartPlayback(const std::string& pathname);
+void MovieStop(void);
+bool MovieIsRecording(void);
+bool MovieIsPlaying(void);
+void MovieGetStats(MovieStats& stats);
+
+// CPU
+DWORD MovieClipCycles(const DWORD uCycles);
+void MovieUpdate(void);
+
+// Input hooks
+// . Live input (while playing) is dropped when these return false
+bool MovieFilterKey(const BYTE key);
+BOOL MovieFilterButton(const UINT button, const BOOL pressed, const ULONG uExecutedCycles);
+int MovieFilterPaddle(const UINT paddle, const int pos, const ULONG uExecutedCycles);
+bool MovieFilterMouseMove(const long dx, const long dy);
+bool MovieFilterMouseButton(const int button, const int state);
+void MovieRecordDiskInsert(const UINT slot, const int drive, const std::string& pathname, const bool writeProtected);
+void MovieRecordDiskEject(const UINT slot, const int drive);
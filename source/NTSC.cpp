@@ -26,8 +26,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#include "CPU.h"	// CpuGetCyclesThisVideoFrame()
 	#include "Memory.h" // MemGetMainPtr(), MemGetAuxPtr(), MemGetAnnunciator()
 	#include "Interface.h"  // GetFrameBuffer()
+	#include "PerfCounters.h"
 	#include "RGBMonitor.h"
 	#include "VidHD.h"
+	#include "VideoTableCache.h"
 
 	#include "NTSC_CharSet.h"
 
@@ -81,6 +83,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static bool g_bDelayVideoMode = false;	// NB. No need to save to save-state, as it will be done immediately after opcode completes in NTSC_VideoUpdateCycles()
 	static uint32_t g_uNewVideoModeFlags = 0;
 
+	static bool g_bVideoHeadless = false;	// only the video scanner is updated, see NTSC_SetHeadless()
+
 	// Understanding the Apple II, Timing Generation and the Video Scanner, Pg 3-11
 	// Vertical Scanning
 	// Horizontal Scanning
@@ -144,10 +148,24 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static bgra_t   g_aBnwColorTV                 [NTSC_NUM_SEQUENCES];
 	static bgra_t   g_aHueColorTV[NTSC_NUM_PHASES][NTSC_NUM_SEQUENCES];
 
+	// The tables above are only read by the renderer via these smaller and denser copies (see updateRenderTables()):
+	// . the 4 phases of a sequence are in the same 16 bytes: neighbouring pixels often share a cache line
+	// . the B&W tables are normally grey, so they are stored as 8-bit luminance (4KB instead of 16KB each)
+	static bgra_t   g_aHueMonitorPacked[NTSC_NUM_SEQUENCES][NTSC_NUM_PHASES];
+	static bgra_t   g_aHueColorTVPacked[NTSC_NUM_SEQUENCES][NTSC_NUM_PHASES];
+	static uint8_t  g_aBnWMonitorLuma             [NTSC_NUM_SEQUENCES];
+	static uint8_t  g_aBnWColorTVLuma             [NTSC_NUM_SEQUENCES];
+
+	// luminance * g_nMonochromeRGB -> g_aMonochromeCustom
+	static bgra_t g_aMonochromeCustom[256];
+
+	// Fallback for a B&W table that isn't grey (eg. a modified palette), as 8-bit luminance would lose its tint:
 	// g_aBnWMonitor * g_nMonochromeRGB -> g_aBnWMonitorCustom
 	// g_aBnwColorTV * g_nMonochromeRGB -> g_aBnWColorTVCustom
-	static bgra_t g_aBnWMonitorCustom           [NTSC_NUM_SEQUENCES];
-	static bgra_t g_aBnWColorTVCustom           [NTSC_NUM_SEQUENCES];
+	static bool     g_bBnWTablesGrey = true;
+	static uint16_t g_aMonochromeRGB[3] = { 0xFF, 0xFF, 0xFF };	// r, g, b
+	static bgra_t   g_aBnWMonitorCustom           [NTSC_NUM_SEQUENCES];
+	static bgra_t   g_aBnWColorTVCustom           [NTSC_NUM_SEQUENCES];
 
 	#define CHROMA_ZEROS 2
 	#define CHROMA_POLES 2
@@ -170,6 +188,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	#define SIGNAL_0    -0.2718798058f 
 	#define SIGNAL_1     0.7465656072f 
 
+	// 2 zeros & 2 poles: reset by initChromaPhaseTables(), so that the tables don't depend on a previous call
+	struct FilterState_t
+	{
+		real x[3];
+		real y[3];
+	};
+	static FilterState_t g_filterChroma, g_filterLuma0, g_filterLuma1, g_filterSignal;
+
 // Tables
 	// Video scanner tables are now runtime-generated using UTAIIe logic
 	static unsigned short g_aClockVertOffsetsHGR[VIDEO_SCANNER_MAX_VERT_PAL];
@@ -328,8 +354,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static real initFilterLuma0    (real z);
 	static real initFilterLuma1    (real z);
 	static real initFilterSignal(real z);
+	static void initFixedVideoTables(void);
 	static void initPixelDoubleMasks(void);
 	static void updateMonochromeTables( uint16_t r, uint16_t g, uint16_t b );
+	static void updateBnWCustomTables(void);
+	static void updateRenderTables(void);
 
 	static void updatePixelBnWColorTVSingleScanline( uint16_t compositeSignal );
 	static void updatePixelBnWColorTVDoubleScanline( uint16_t compositeSignal );
@@ -401,6 +430,22 @@ inline uint32_t getScanlineColor( const uint16_t signal, const bgra_t *pTable )
 	return *(uint32_t*) &pTable[ g_nSignalBitsNTSC ];
 }
 
+//===========================================================================
+inline uint32_t getScanlineHueColor( const uint16_t signal, const bgra_t (*pTable)[NTSC_NUM_PHASES] )
+{
+	g_nSignalBitsNTSC = ((g_nSignalBitsNTSC << 1) | signal) & 0xFFF; // 12-bit
+	return *(uint32_t*) &pTable[ g_nSignalBitsNTSC ][ g_nColorPhaseNTSC ];
+}
+
+//===========================================================================
+inline uint32_t getScanlineMonoColor( const uint16_t signal, const uint8_t *pLumaTable, const bgra_t *pCustomTable )
+{
+	g_nSignalBitsNTSC = ((g_nSignalBitsNTSC << 1) | signal) & 0xFFF; // 12-bit
+	if (!g_bBnWTablesGrey)
+		return *(uint32_t*) &pCustomTable[ g_nSignalBitsNTSC ];
+	return *(uint32_t*) &g_aMonochromeCustom[ pLumaTable[ g_nSignalBitsNTSC ] ];
+}
+
 //===========================================================================
 inline uint32_t* getScanlineNextInbetween()
 {
@@ -511,12 +556,11 @@ inline void updateFlashRate() // TODO: Flash rate should be constant (regardless
 
 // Original: Prev1(inbetween) = current - 25% of previous AppleII scanline
 // GH#650:   Prev1(inbetween) = 50% of (50% current + 50% of previous AppleII scanline)
-inline void updateFramebufferTVSingleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferTVSingleScanline( const uint32_t color0 )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Prev = getScanlinePreviousInbetween();
 	uint32_t *pLine2Prev = getScanlinePrevious();
-	const uint32_t color0 = getScanlineColor( signal, pTable );
 	const uint32_t color2 = *pLine2Prev;
 	uint32_t color1 = ((color0 & 0x00fefefe) >> 1) + ((color2 & 0x00fefefe) >> 1); // 50% Blend
 	color1 = (color1 & 0x00fefefe) >> 1;	// ... then 50% brightness for inbetween line
@@ -534,12 +578,11 @@ inline void updateFramebufferTVSingleScanline( uint16_t signal, bgra_t *pTable )
 //===========================================================================
 
 // Original: Prev1(inbetween) = 50% current + 50% of previous AppleII scanline
-inline void updateFramebufferTVDoubleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferTVDoubleScanline( const uint32_t color0 )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Prev = getScanlinePreviousInbetween();
 	uint32_t *pLine2Prev = getScanlinePrevious();
-	const uint32_t color0 = getScanlineColor( signal, pTable );
 	const uint32_t color2 = *pLine2Prev;
 	const uint32_t color1 = ((color0 & 0x00fefefe) >> 1) + ((color2 & 0x00fefefe) >> 1); // 50% Blend
 
@@ -554,11 +597,10 @@ inline void updateFramebufferTVDoubleScanline( uint16_t signal, bgra_t *pTable )
 }
 
 //===========================================================================
-inline void updateFramebufferMonitorSingleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferMonitorSingleScanline( const uint32_t color0 )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Next = getScanlineNextInbetween();
-	const uint32_t color0 = getScanlineColor( signal, pTable );
 	const uint32_t color1 = 0;	// Remove blending for consistent DHGR MIX mode (GH#631)
 //	const uint32_t color1 = ((color0 & 0x00fcfcfc) >> 2); // 25% Blend (original)
 
@@ -568,11 +610,10 @@ inline void updateFramebufferMonitorSingleScanline( uint16_t signal, bgra_t *pTa
 }
 
 //===========================================================================
-inline void updateFramebufferMonitorDoubleScanline( uint16_t signal, bgra_t *pTable )
+inline void updateFramebufferMonitorDoubleScanline( const uint32_t color0 )
 {
 	uint32_t *pLine0Curr = getScanlineCurrent();
 	uint32_t *pLine1Next = getScanlineNextInbetween();
-	const uint32_t color0 = getScanlineColor( signal, pTable );
 
 	*pLine1Next = color0;
 	*pLine0Curr = color0;
@@ -679,6 +720,20 @@ inline void updateVideoScannerHorzEOLSimple()
 	}
 }
 
+// Advance by cells, which are all on the current scanline
+inline void updateVideoScannerHorzEOLSimple(const long cells)
+{
+	g_nVideoClockHorz += cells - 1;
+	updateVideoScannerHorzEOLSimple();
+}
+
+// The visible cells from the scanner's position to the end of the scanline, up to cycles6502: rendered by a single call
+inline long getVideoScannerVisibleCells(const long cycles6502)
+{
+	const long cells = VIDEO_SCANNER_MAX_HORZ - g_nVideoClockHorz;
+	return cycles6502 < cells ? cycles6502 : cells;
+}
+
 // NOTE: This writes out-of-bounds for a 560x384 framebuffer
 inline void updateVideoScannerHorzEOL()
 {
@@ -735,6 +790,27 @@ inline void updateVideoScannerHorzEOL_SHR()
 	}
 }
 
+// Headless: the same scanner position as the renderers, in one step
+inline void updateVideoScannerHeadless(UINT cycles)
+{
+	UINT horz = g_nVideoClockHorz + cycles;
+	if (horz < VIDEO_SCANNER_MAX_HORZ)
+	{
+		g_nVideoClockHorz = (uint16_t) horz;
+		return;
+	}
+
+	UINT vert = g_nVideoClockVert + horz / VIDEO_SCANNER_MAX_HORZ;
+	g_nVideoClockHorz = (uint16_t) (horz % VIDEO_SCANNER_MAX_HORZ);
+
+	if (vert >= g_videoScannerMaxVert)	// NB. less than a frame of cycles
+	{
+		vert -= g_videoScannerMaxVert;
+		updateFlashRate();
+	}
+	g_nVideoClockVert = (uint16_t) vert;
+}
+
 //===========================================================================
 inline void updateVideoScannerAddress()
 {
@@ -810,6 +886,11 @@ static void initChromaPhaseTables (void)
 	double r64,g64,b64;
 	float  r32,g32,b32;	
 
+	memset(&g_filterChroma, 0, sizeof(g_filterChroma));
+	memset(&g_filterLuma0, 0, sizeof(g_filterLuma0));
+	memset(&g_filterLuma1, 0, sizeof(g_filterLuma1));
+	memset(&g_filterSignal, 0, sizeof(g_filterSignal));
+
 	for (phase = 0; phase < 4; ++phase)
 	{
 		phi = (phase * RAD_90) + CYCLESTART;
@@ -995,8 +1076,8 @@ double ButterworthLowPass2( double a, double b, double g, double z )
 //===========================================================================
 static real initFilterChroma (real z)
 {
-	static real x[CHROMA_ZEROS + 1] = {0,0,0};
-	static real y[CHROMA_POLES + 1] = {0,0,0};
+	real* const x = g_filterChroma.x;
+	real* const y = g_filterChroma.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / CHROMA_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = -x[0] + x[2] + (CHROMA_0*y[0]) + (CHROMA_1*y[1]); // inverted x[0]
@@ -1009,8 +1090,8 @@ static real initFilterChroma (real z)
 //===========================================================================
 static real initFilterLuma0 (real z)
 {
-	static real x[LUMA_ZEROS + 1] = { 0,0,0 };
-	static real y[LUMA_POLES + 1] = { 0,0,0 };
+	real* const x = g_filterLuma0.x;
+	real* const y = g_filterLuma0.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / LUMA_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = x[0] + x[2] + (2.f*x[1]) + (LUMA_0*y[0]) + (LUMA_1*y[1]);
@@ -1023,8 +1104,8 @@ static real initFilterLuma0 (real z)
 //===========================================================================
 static real initFilterLuma1 (real z)
 {
-	static real x[LUMA_ZEROS + 1] = { 0,0,0};
-	static real y[LUMA_POLES + 1] = { 0,0,0};
+	real* const x = g_filterLuma1.x;
+	real* const y = g_filterLuma1.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / LUMA_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = x[0] + x[2] + (2.f*x[1]) + (LUMA_0*y[0]) + (LUMA_1*y[1]);
@@ -1037,8 +1118,8 @@ static real initFilterLuma1 (real z)
 //===========================================================================
 static real initFilterSignal (real z)
 {
-	static real x[SIGNAL_ZEROS + 1] = { 0,0,0 };
-	static real y[SIGNAL_POLES + 1] = { 0,0,0 };
+	real* const x = g_filterSignal.x;
+	real* const y = g_filterSignal.y;
 
 	x[0] = x[1];   x[1] = x[2];   x[2] = z / SIGNAL_GAIN;
 	y[0] = y[1];   y[1] = y[2];   y[2] = x[0] + x[2] + (2.f*x[1]) + (SIGNAL_0*y[0]) + (SIGNAL_1*y[1]);
@@ -1046,6 +1127,37 @@ static real initFilterSignal (real z)
 	return y[2];
 }
 
+//===========================================================================
+// The chroma tables and the RGB source image only depend on the code:
+// . create them once per process, and load them from the video table cache if possible
+static void initFixedVideoTables (void)
+{
+	static bool bCreated = false;
+	if (bCreated)
+		return;
+
+	VideoTables_t tables;
+	VideoTable_t aChromaTables[] =
+	{
+		{ g_aBnWMonitor, sizeof(g_aBnWMonitor) },
+		{ g_aHueMonitor, sizeof(g_aHueMonitor) },
+		{ g_aBnwColorTV, sizeof(g_aBnwColorTV) },
+		{ g_aHueColorTV, sizeof(g_aHueColorTV) },
+	};
+	tables.assign(aChromaTables, aChromaTables + sizeof(aChromaTables) / sizeof(aChromaTables[0]));
+	RGB_GetVideoTables(tables);
+
+	if (!VideoTableCache_Load(tables))
+	{
+		initChromaPhaseTables();
+		RGB_CreateVideoTables();
+		VideoTableCache_Save(tables);
+	}
+
+	updateRenderTables();
+	bCreated = true;
+}
+
 //===========================================================================
 static void initPixelDoubleMasks (void)
 {
@@ -1071,6 +1183,29 @@ static void initPixelDoubleMasks (void)
 //===========================================================================
 void updateMonochromeTables( uint16_t r, uint16_t g, uint16_t b )
 {
+	for( int iLuma = 0; iLuma < 256; iLuma++ )
+	{
+		g_aMonochromeCustom[ iLuma ].b = (iLuma * b) >> 8;
+		g_aMonochromeCustom[ iLuma ].g = (iLuma * g) >> 8;
+		g_aMonochromeCustom[ iLuma ].r = (iLuma * r) >> 8;
+		g_aMonochromeCustom[ iLuma ].a = 0xFF;
+	}
+
+	g_aMonochromeRGB[0] = r;
+	g_aMonochromeRGB[1] = g;
+	g_aMonochromeRGB[2] = b;
+
+	if (!g_bBnWTablesGrey)
+		updateBnWCustomTables();
+}
+
+//===========================================================================
+static void updateBnWCustomTables (void)
+{
+	const uint16_t r = g_aMonochromeRGB[0];
+	const uint16_t g = g_aMonochromeRGB[1];
+	const uint16_t b = g_aMonochromeRGB[2];
+
 	for( int iSample = 0; iSample < NTSC_NUM_SEQUENCES; iSample++ )
 	{
 		g_aBnWMonitorCustom[ iSample ].b = (g_aBnWMonitor[ iSample ].b * b) >> 8;
@@ -1085,59 +1220,86 @@ void updateMonochromeTables( uint16_t r, uint16_t g, uint16_t b )
 	}
 }
 
+//===========================================================================
+static void updateRenderTables (void)
+{
+	bool bGrey = true;
+
+	for( int iSample = 0; iSample < NTSC_NUM_SEQUENCES; iSample++ )
+	{
+		for( int phase = 0; phase < NTSC_NUM_PHASES; phase++ )
+		{
+			g_aHueMonitorPacked[ iSample ][ phase ] = g_aHueMonitor[ phase ][ iSample ];
+			g_aHueColorTVPacked[ iSample ][ phase ] = g_aHueColorTV[ phase ][ iSample ];
+		}
+
+		const bgra_t &monitor = g_aBnWMonitor[ iSample ];
+		const bgra_t &colorTV = g_aBnwColorTV[ iSample ];
+		if (monitor.r != monitor.b || monitor.g != monitor.b || colorTV.r != colorTV.b || colorTV.g != colorTV.b)
+			bGrey = false;
+
+		g_aBnWMonitorLuma[ iSample ] = monitor.b;
+		g_aBnWColorTVLuma[ iSample ] = colorTV.b;
+	}
+
+	g_bBnWTablesGrey = bGrey;
+	if (!g_bBnWTablesGrey)
+		updateBnWCustomTables();
+}
+
 //===========================================================================
 static void updatePixelBnWMonitorSingleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferMonitorSingleScanline(compositeSignal, g_aBnWMonitorCustom);
+	updateFramebufferMonitorSingleScanline(getScanlineMonoColor(compositeSignal, g_aBnWMonitorLuma, g_aBnWMonitorCustom));
 	updateColorPhase();	// Maintain color-phase, as could be switching graphics/text video modes mid-scanline
 }
 
 //===========================================================================
 static void updatePixelBnWMonitorDoubleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferMonitorDoubleScanline(compositeSignal, g_aBnWMonitorCustom);
+	updateFramebufferMonitorDoubleScanline(getScanlineMonoColor(compositeSignal, g_aBnWMonitorLuma, g_aBnWMonitorCustom));
 	updateColorPhase();	// Maintain color-phase, as could be switching graphics/text video modes mid-scanline
 }
 
 //===========================================================================
 static void updatePixelBnWColorTVSingleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferTVSingleScanline(compositeSignal, g_aBnWColorTVCustom);
+	updateFramebufferTVSingleScanline(getScanlineMonoColor(compositeSignal, g_aBnWColorTVLuma, g_aBnWColorTVCustom));
 	updateColorPhase();	// Maintain color-phase, as could be switching graphics/text video modes mid-scanline
 }
 
 //===========================================================================
 static void updatePixelBnWColorTVDoubleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferTVDoubleScanline(compositeSignal, g_aBnWColorTVCustom);
+	updateFramebufferTVDoubleScanline(getScanlineMonoColor(compositeSignal, g_aBnWColorTVLuma, g_aBnWColorTVCustom));
 	updateColorPhase();	// Maintain color-phase, as could be switching graphics/text video modes mid-scanline
 }
 
 //===========================================================================
 static void updatePixelHueColorTVSingleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferTVSingleScanline(compositeSignal, g_aHueColorTV[g_nColorPhaseNTSC]);
+	updateFramebufferTVSingleScanline(getScanlineHueColor(compositeSignal, g_aHueColorTVPacked));
 	updateColorPhase();
 }
 
 //===========================================================================
 static void updatePixelHueColorTVDoubleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferTVDoubleScanline(compositeSignal, g_aHueColorTV[g_nColorPhaseNTSC]);
+	updateFramebufferTVDoubleScanline(getScanlineHueColor(compositeSignal, g_aHueColorTVPacked));
 	updateColorPhase();
 }
 
 //===========================================================================
 static void updatePixelHueMonitorSingleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferMonitorSingleScanline(compositeSignal, g_aHueMonitor[g_nColorPhaseNTSC]);
+	updateFramebufferMonitorSingleScanline(getScanlineHueColor(compositeSignal, g_aHueMonitorPacked));
 	updateColorPhase();
 }
 
 //===========================================================================
 static void updatePixelHueMonitorDoubleScanline (uint16_t compositeSignal)
 {
-	updateFramebufferMonitorDoubleScanline(compositeSignal, g_aHueMonitor[g_nColorPhaseNTSC]);
+	updateFramebufferMonitorDoubleScanline(getScanlineHueColor(compositeSignal, g_aHueMonitorPacked));
 	updateColorPhase();
 }
 
@@ -1217,9 +1379,9 @@ void updateScreenDoubleHires80RGB (long cycles6502 ) // wsUpdateVideoDblHires
 		return;
 	}
 
-	for (; cycles6502 > 0; --cycles6502)
+	while (cycles6502 > 0)
 	{
-		uint16_t addr = getVideoScannerAddressHGR();
+		long cells = 1;
 
 		if (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY)
 		{
@@ -1230,14 +1392,6 @@ void updateScreenDoubleHires80RGB (long cycles6502 ) // wsUpdateVideoDblHires
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
 				uint16_t addr = getVideoScannerAddressHGR();
-				uint8_t a = *MemGetAuxPtr(addr);
-				uint8_t m = *MemGetMainPtr(addr);
-
-				if (RGB_IsMixModeInvertBit7())	// Invert high bit? (GH#633)
-				{
-					a ^= 0x80;
-					m ^= 0x80;
-				}
 
 				if (RGB_Is160Mode())
 				{
@@ -1246,17 +1400,28 @@ void updateScreenDoubleHires80RGB (long cycles6502 ) // wsUpdateVideoDblHires
 				}
 				else if (RGB_Is560Mode())
 				{
+					uint8_t a = *MemGetAuxPtr(addr);
+					uint8_t m = *MemGetMainPtr(addr);
+
+					if (RGB_IsMixModeInvertBit7())	// Invert high bit? (GH#633)
+					{
+						a ^= 0x80;
+						m ^= 0x80;
+					}
+
 					update7MonoPixels(a);
 					update7MonoPixels(m);
 				}
 				else
 				{
-					UpdateDHiResCellRGB(g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START, g_nVideoClockVert, addr, g_pVideoAddress, RGB_IsMixMode(), RGB_IsMixModeInvertBit7());
-					g_pVideoAddress += 14;
+					cells = getVideoScannerVisibleCells(cycles6502);
+					UpdateDHiResCellsRGB(g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START, g_nVideoClockVert, addr, g_pVideoAddress, cells, RGB_IsMixMode(), RGB_IsMixModeInvertBit7());
+					g_pVideoAddress += 14 * cells;
 				}
 			}
 		}
-		updateVideoScannerHorzEOLSimple();
+		updateVideoScannerHorzEOLSimple(cells);
+		cycles6502 -= cells;
 	}
 }
 
@@ -1402,7 +1567,7 @@ void updateScreenDoubleLores80 (long cycles6502) // wsUpdateVideoDblLores
 
 //===========================================================================
 
-// Handles both the "SingleHires40" & "DoubleHires40" cases, via UpdateHiResCell()
+// Handles both the "SingleHires40" & "DoubleHires40" cases, via UpdateHiResCells()
 static void updateScreenHires40Simplified (long cycles6502)
 {
 	if (g_nVideoMixed && g_nVideoClockVert >= VIDEO_SCANNER_Y_MIXED)
@@ -1411,8 +1576,10 @@ static void updateScreenHires40Simplified (long cycles6502)
 		return;
 	}
 
-	for (; cycles6502 > 0; --cycles6502)
+	while (cycles6502 > 0)
 	{
+		long cells = 1;
+
 		if (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY)
 		{
 			if ((g_nVideoClockHorz < VIDEO_SCANNER_HORZ_COLORBURST_END) && (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_COLORBURST_BEG))
@@ -1421,12 +1588,14 @@ static void updateScreenHires40Simplified (long cycles6502)
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
+				cells = getVideoScannerVisibleCells(cycles6502);
 				uint16_t addr = getVideoScannerAddressHGR();
-				UpdateHiResCell(g_nVideoClockHorz-VIDEO_SCANNER_HORZ_START, g_nVideoClockVert, addr, g_pVideoAddress);
-				g_pVideoAddress += 14;
+				UpdateHiResCells(g_nVideoClockHorz-VIDEO_SCANNER_HORZ_START, g_nVideoClockVert, addr, g_pVideoAddress, cells);
+				g_pVideoAddress += 14 * cells;
 			}
 		}
-		updateVideoScannerHorzEOLSimple();
+		updateVideoScannerHorzEOLSimple(cells);
+		cycles6502 -= cells;
 	}
 }
 
@@ -1468,8 +1637,10 @@ static void updateScreenSingleHires40RGB(long cycles6502)
 		return;
 	}
 
-	for (; cycles6502 > 0; --cycles6502)
+	while (cycles6502 > 0)
 	{
+		long cells = 1;
+
 		if (g_nVideoClockVert < VIDEO_SCANNER_Y_DISPLAY)
 		{
 			if ((g_nVideoClockHorz < VIDEO_SCANNER_HORZ_COLORBURST_END) && (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_COLORBURST_BEG))
@@ -1478,13 +1649,15 @@ static void updateScreenSingleHires40RGB(long cycles6502)
 			}
 			else if (g_nVideoClockHorz >= VIDEO_SCANNER_HORZ_START)
 			{
+				cells = getVideoScannerVisibleCells(cycles6502);
 				uint16_t addr = getVideoScannerAddressHGR();
 
-				UpdateHiResRGBCell(g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START, g_nVideoClockVert, addr, g_pVideoAddress);
-				g_pVideoAddress += 14;
+				UpdateHiResRGBCells(g_nVideoClockHorz - VIDEO_SCANNER_HORZ_START, g_nVideoClockVert, addr, g_pVideoAddress, cells);
+				g_pVideoAddress += 14 * cells;
 			}
 		}
-		updateVideoScannerHorzEOLSimple();
+		updateVideoScannerHorzEOLSimple(cells);
+		cycles6502 -= cells;
 	}
 }
 
@@ -1887,7 +2060,7 @@ void NTSC_SetVideoMode( uint32_t uVideoModeFlags, bool bDelay/*=false*/ )
 		GetVideo().ClearFrameBuffer();
 	}
 
-	if (bDelay && !g_bFullSpeed)
+	if (bDelay && !g_bFullSpeed && !g_bVideoHeadless)
 	{
 		// (GH#670) NB. if g_bFullSpeed then NTSC_VideoUpdateCycles() won't be called on the next 6502 opcode.
 		//  - Instead it's called when !g_bFullSpeed (eg. drive motor off), then the stale g_uNewVideoModeFlags will get used for NTSC_SetVideoMode()!
@@ -2202,7 +2375,7 @@ void NTSC_VideoInit( uint8_t* pFramebuffer ) // wsVideoInit
 	make_csbits();
 	GenerateVideoTables();
 	initPixelDoubleMasks();
-	initChromaPhaseTables();
+	initFixedVideoTables();
 	updateMonochromeTables( 0xFF, 0xFF, 0xFF );
 
 	g_kFrameBufferWidth = GetVideo().GetFrameBufferWidth();
@@ -2316,6 +2489,13 @@ void NTSC_VideoInitAppleType ()
 void NTSC_VideoInitChroma()
 {
 	initChromaPhaseTables();
+	updateRenderTables();
+}
+
+//===========================================================================
+void NTSC_VideoChromaTableChanged()
+{
+	updateRenderTables();
 }
 
 //===========================================================================
@@ -2372,10 +2552,13 @@ static void VideoUpdateCycles( int cyclesLeftToUpdate )
 //===========================================================================
 void NTSC_VideoUpdateCycles( UINT cycles6502 )
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeVideo;
-	PerfMarker perfMarker(g_timeVideo);
-#endif
+	if (g_bVideoHeadless)
+	{
+		updateVideoScannerHeadless(cycles6502);
+		return;
+	}
+
+	PerfMarker perfMarker(PERF_VIDEO);
 
 	_ASSERT(cycles6502 && cycles6502 < g_videoScanner6502Cycles);	// Use NTSC_VideoRedrawWholeScreen() instead
 
@@ -2394,6 +2577,31 @@ void NTSC_VideoUpdateCycles( UINT cycles6502 )
 	VideoUpdateCycles(cycles6502);
 }
 
+//===========================================================================
+// Headless: NTSC_VideoUpdateCycles() only advances the video scanner (g_nVideoClockVert/Horz), so the floating bus,
+// VBL and the text flash stay cycle accurate, but nothing is rendered until NTSC_VideoRedrawWholeScreen()
+void NTSC_SetHeadless(const bool bHeadless)
+{
+	if (g_bVideoHeadless == bHeadless)
+		return;
+
+	if (g_bDelayVideoMode)
+	{
+		g_bDelayVideoMode = false;
+		NTSC_SetVideoMode(g_uNewVideoModeFlags);
+	}
+
+	g_bVideoHeadless = bHeadless;
+
+	if (!bHeadless && g_pVideoAddress)
+		updateVideoScannerAddress();	// resume rendering at the current scanner position
+}
+
+bool NTSC_IsHeadless(void)
+{
+	return g_bVideoHeadless;
+}
+
 //===========================================================================
 void NTSC_VideoRedrawWholeScreen( void )
 {
@@ -2419,6 +2627,22 @@ void NTSC_VideoRedrawWholeScreen( void )
 #endif
 }
 
+//===========================================================================
+// Redraw with the flashing text in its "off" phase, and without advancing the flash rate
+// . For comparing frames regardless of how many redraws (eg. at full-speed) happened before
+void NTSC_VideoRedrawWholeScreenDeterministic( void )
+{
+	const uint8_t textFlashCounter = g_nTextFlashCounter;
+	const uint16_t textFlashMask = g_nTextFlashMask;
+	g_nTextFlashCounter = 0;
+	g_nTextFlashMask = 0;
+
+	NTSC_VideoRedrawWholeScreen();
+
+	g_nTextFlashCounter = textFlashCounter;
+	g_nTextFlashMask = textFlashMask;
+}
+
 //===========================================================================
 
 static bool CheckVideoTables2( eApple2Type type, uint32_t mode )
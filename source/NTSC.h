@@ -20,8 +20,12 @@ void NTSC_VideoInit(uint8_t *pFramebuffer);
 void NTSC_VideoReinitialize(DWORD cyclesThisFrame, bool bInitVideoScannerAddress);
 void NTSC_VideoInitAppleType(void);
 void NTSC_VideoInitChroma(void);
+void NTSC_VideoChromaTableChanged(void);
 void NTSC_VideoUpdateCycles(UINT cycles6502);
 void NTSC_VideoRedrawWholeScreen(void);
+void NTSC_VideoRedrawWholeScreenDeterministic(void);
+void NTSC_SetHeadless(const bool bHeadless);
+bool NTSC_IsHeadless(void);
 
 void NTSC_SetRefreshRate(VideoRefreshRate_e rate);
 UINT NTSC_GetCyclesPerFrame(void);
@@ -0,0 +1,281 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Performance counters
+ *
+ * Author: Various
+ *
+ */
+
+#include "StdAfx.h"
+
+#include "PerfCounters.h"
+#include "Common.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+
+bool g_bPerfEnabled = false;
+
+static const char* const g_perfScopeNames[NUM_PERF_SCOPES] =
+{
+	"Frame",
+	"CPU",
+	"Video",
+	"Disk I/O",
+	"Cards",
+	"Mockingboard",
+	"Speaker",
+	"Present",
+};
+
+static const UINT g_perfScopeDepth[NUM_PERF_SCOPES] =
+{
+	0,	// Frame
+	1,	// CPU
+	2,	// Video
+	2,	// Disk I/O
+	1,	// Cards
+	2,	// Mockingboard
+	1,	// Speaker
+	1,	// Present
+};
+
+static const UINT PERF_HISTORY_FRAMES = 1024;		// for the percentiles
+static const size_t PERF_MAX_TRACE_EVENTS = 1 << 20;	// 24MB
+
+struct PerfCounter
+{
+	UINT64 frameTime;		// ns, current frame
+	UINT64 totalTime;		// ns
+	UINT64 calls;
+	float history[PERF_HISTORY_FRAMES];	// us per frame
+};
+
+static PerfCounter g_perfCounters[NUM_PERF_SCOPES];
+static UINT g_perfNumFrames = 0;
+
+struct PerfTraceEvent
+{
+	UINT64 start;
+	UINT64 duration;
+	PerfScope_e scope;
+};
+
+static std::vector<PerfTraceEvent> g_perfTrace;
+static std::string g_perfTraceFilename;
+static UINT64 g_perfTraceOrigin = 0;
+static bool g_bPerfTracing = false;
+
+//===========================================================================
+
+UINT64 PerfGetTime(void)
+{
+	const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now().time_since_epoch();
+	return (UINT64)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+void PerfRecord(const PerfScope_e scope, const UINT64 start, const UINT64 end)
+{
+	if (!g_bPerfEnabled)
+		return;
+
+	PerfCounter& counter = g_perfCounters[scope];
+	counter.frameTime += end - start;
+	counter.calls++;
+
+	if (g_bPerfTracing && g_perfTrace.size() < PERF_MAX_TRACE_EVENTS)
+	{
+		const PerfTraceEvent event = { start, end - start, scope };
+		g_perfTrace.push_back(event);
+	}
+}
+
+//===========================================================================
+
+void PerfEnable(const bool enable)
+{
+	if (enable && !g_bPerfEnabled)
+		PerfReset();
+
+	g_bPerfEnabled = enable;
+}
+
+void PerfReset(void)
+{
+	memset(g_perfCounters, 0, sizeof(g_perfCounters));
+	g_perfNumFrames = 0;
+}
+
+void PerfFrameEnd(void)
+{
+	if (!g_bPerfEnabled)
+		return;
+
+	const UINT index = g_perfNumFrames % PERF_HISTORY_FRAMES;
+	for (UINT i = 0; i < NUM_PERF_SCOPES; i++)
+	{
+		PerfCounter& counter = g_perfCounters[i];
+		counter.history[index] = (float)(counter.frameTime / 1000.0);
+		counter.totalTime += counter.frameTime;
+		counter.frameTime = 0;
+	}
+
+	g_perfNumFrames++;
+}
+
+UINT PerfGetNumFrames(void)
+{
+	return g_perfNumFrames;
+}
+
+void PerfGetStats(std::vector<PerfStats>& stats)
+{
+	stats.clear();
+
+	const UINT numFrames = MIN(g_perfNumFrames, PERF_HISTORY_FRAMES);
+	const UINT last = (g_perfNumFrames + PERF_HISTORY_FRAMES - 1) % PERF_HISTORY_FRAMES;
+	std::vector<float> sorted(numFrames);
+
+	for (UINT i = 0; i < NUM_PERF_SCOPES; i++)
+	{
+		const PerfCounter& counter = g_perfCounters[i];
+
+		PerfStats s;
+		s.name = g_perfScopeNames[i];
+		s.depth = g_perfScopeDepth[i];
+		s.calls = counter.calls;
+		s.totalMs = counter.totalTime / 1.0e6;
+		s.lastFrameUs = numFrames ? counter.history[last] : 0.0;
+		s.p50Us = s.p95Us = s.p99Us = 0.0;
+
+		if (numFrames)
+		{
+			std::copy(counter.history, counter.history + numFrames, sorted.begin());
+			std::sort(sorted.begin(), sorted.end());
+			s.p50Us = sorted[(numFrames - 1) * 50 / 100];
+			s.p95Us = sorted[(numFrames - 1) * 95 / 100];
+			s.p99Us = sorted[(numFrames - 1) * 99 / 100];
+		}
+
+		stats.push_back(s);
+	}
+}
+
+void PerfGetHistory(const PerfScope_e scope, std::vector<float>& history)
+{
+	history.clear();
+
+	const PerfCounter& counter = g_perfCounters[scope];
+	const UINT numFrames = MIN(g_perfNumFrames, PERF_HISTORY_FRAMES);
+	for (UINT i = g_perfNumFrames - numFrames; i < g_perfNumFrames; i++)
+		history.push_back(counter.history[i % PERF_HISTORY_FRAMES]);
+}
+
+void PerfLogStats(void)
+{
+	if (!g_perfNumFrames)
+		return;
+
+	std::vector<PerfStats> stats;
+	PerfGetStats(stats);
+
+	LogOutput("Perf counters: %u frames (percentiles over the last %u)\n", g_perfNumFrames, MIN(g_perfNumFrames, PERF_HISTORY_FRAMES));
+	LogOutput("%-16s %10s %10s %10s %10s %10s\n", "scope", "calls", "total ms", "p50 us", "p95 us", "p99 us");
+	for (size_t i = 0; i < stats.size(); i++)
+	{
+		const PerfStats& s = stats[i];
+		const std::string name = std::string(s.depth * 2, ' ') + s.name;
+		LogOutput("%-16s %10llu %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), (unsigned long long)s.calls, s.totalMs, s.p50Us, s.p95Us, s.p99Us);
+	}
+}
+
+//===========================================================================
+
+bool PerfStartTrace(const std::string& filename)
+{
+	if (filename.empty())
+		return false;
+
+	g_perfTrace.clear();
+	g_perfTrace.reserve(PERF_MAX_TRACE_EVENTS);
+	g_perfTraceFilename = filename;
+	g_perfTraceOrigin = PerfGetTime();
+	g_bPerfTracing = true;
+
+	PerfEnable(true);
+	return true;
+}
+
+// Write the trace as Chrome's "trace event" JSON
+bool PerfStopTrace(void)
+{
+	if (!g_bPerfTracing)
+		return false;
+
+	g_bPerfTracing = false;
+
+	FILE* fp = fopen(g_perfTraceFilename.c_str(), "w");
+	if (!fp)
+	{
+		LogFileOutput("PerfStopTrace: failed to create %s\n", g_perfTraceFilename.c_str());
+		return false;
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (size_t i = 0; i < g_perfTrace.size(); i++)
+	{
+		const PerfTraceEvent& event = g_perfTrace[i];
+		const UINT64 start = event.start - MIN(g_perfTraceOrigin, event.start);	// a scope may have started before the trace
+		fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			g_perfScopeNames[event.scope], start / 1000.0, event.duration / 1000.0,
+			i + 1 < g_perfTrace.size() ? "," : "");
+	}
+	fprintf(fp, "]}\n");
+
+	fclose(fp);
+
+	if (g_perfTrace.size() >= PERF_MAX_TRACE_EVENTS)
+		LogOutput("PerfStopTrace: trace truncated to %u events\n", (UINT)PERF_MAX_TRACE_EVENTS);
+
+	std::vector<PerfTraceEvent>().swap(g_perfTrace);
+	return true;
+}
+
+bool PerfIsTracing(void)
+{
+	return g_bPerfTracing;
+}
+
+//===========================================================================
+
+void PerfShutdown(void)
+{
+	PerfStopTrace();
+
+	if (g_bPerfEnabled)
+		PerfLogStats();
+
+	g_bPerfEnabled = false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// Hierarchical performance counters
+// . Always built: when disabled, a PerfMarker costs a test of g_bPerfEnabled
+// . Time is accumulated per scope for the current frame (ie. iteration of the frontend's loop)
+//   PerfFrameEnd() closes the frame and adds it to the rolling history (for the percentiles)
+// . Optionally each scope is also recorded as a Chrome trace event (chrome://tracing or ui.perfetto.dev)
+// . Emulation thread only
+
+enum PerfScope_e
+{
+	PERF_FRAME,			// frontend's loop
+	PERF_CPU,			// . CpuExecute()
+	PERF_VIDEO,			// . . NTSC_VideoUpdateCycles()
+	PERF_DISK_IO,		// . . disk & harddisk image reads & writes
+	PERF_CARDS,			// . CardManager::Update()
+	PERF_MOCKINGBOARD,	// . . MB_Update() (also from CpuExecute(), when a 6522 timer is active)
+	PERF_SPEAKER,		// . SpkrUpdate()
+	PERF_PRESENT,		// . frontend's screen refresh
+	NUM_PERF_SCOPES
+};
+
+struct PerfStats
+{
+	const char* name;
+	UINT depth;			// in the hierarchy above
+	UINT64 calls;
+	double totalMs;
+	double lastFrameUs;
+	double p50Us;		// per frame, over the recent history
+	double p95Us;
+	double p99Us;
+};
+
+extern bool g_bPerfEnabled;
+
+UINT64 PerfGetTime(void);	// ns
+void PerfRecord(const PerfScope_e scope, const UINT64 start, const UINT64 end);
+
+class PerfMarker
+{
+public:
+	PerfMarker(const PerfScope_e scope)
+		: m_scope(scope)
+		, m_start(g_bPerfEnabled ? PerfGetTime() : 0)
+	{
+	}
+	~PerfMarker()
+	{
+		Stop();
+	}
+	void Stop(void)
+	{
+		if (m_start)
+		{
+			PerfRecord(m_scope, m_start, PerfGetTime());
+			m_start = 0;
+		}
+	}
+private:
+	const PerfScope_e m_scope;
+	UINT64 m_start;
+};
+
+void PerfEnable(const bool enable);
+void PerfReset(void);
+void PerfFrameEnd(void);
+UINT PerfGetNumFrames(void);
+void PerfGetStats(std::vector<PerfStats>& stats);
+void PerfGetHistory(const PerfScope_e scope, std::vector<float>& history);	// us per frame, oldest first
+void PerfLogStats(void);
+
+bool PerfStartTrace(const std::string& filename);
+bool PerfStopTrace(void);
+bool PerfIsTracing(void);
+
+void PerfShutdown(void);
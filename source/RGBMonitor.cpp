@@ -508,13 +508,12 @@ static void MixColorsVertical(int matx, int maty, bool isSWMIXED)
 	colormixbuffer[5] = (twoHalfPixel & 0x00FF);
 }
 
-static void CopyMixedSource(int x, int y, int sx, int sy, bgra_t *pVideoAddress)
+static void CopyMixedSource(int x, int y, int sx, int sy, bgra_t *pVideoAddress, const bool isSWMIXED, const bool bIsHalfScanLines, const UINT frameBufferWidth)
 {
 	const BYTE* const pSrc = g_aSourceStartofLine[ sy ] + sx;
 
 	const int matx = x*14;
 	const int maty = HGR_MATRIX_YOFFSET + y;
-	const bool isSWMIXED = GetVideo().VideoGetSWMIXED();
 
 	// transfer 14 pixels (i.e. the visible part of an apple hgr-byte) from row to pixelmatrix
 	for (int nBytes=13; nBytes>=0; nBytes--)
@@ -522,9 +521,6 @@ static void CopyMixedSource(int x, int y, int sx, int sy, bgra_t *pVideoAddress)
 		hgrpixelmatrix[matx+nBytes][maty] = *(pSrc+nBytes);
 	}
 
-	const bool bIsHalfScanLines = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
-	const UINT frameBufferWidth = GetVideo().GetFrameBufferWidth();
-
 	for (int nBytes=13; nBytes>=0; nBytes--)
 	{
 		// color mixing between adjacent scanlines at current x position
@@ -553,62 +549,81 @@ static void CopyMixedSource(int x, int y, int sx, int sy, bgra_t *pVideoAddress)
 
 //===========================================================================
 
+// The second scanline of w pixels: a copy of the first, or black for 50% Half Scan Lines
+// (and SHIFT+PrintScreen saves only the even rows)
+static void CopySecondScanline(bgra_t *pVideoAddress, const int w, const bool bIsHalfScanLines, const UINT frameBufferWidth)
+{
+	const UINT32* pSrc = (const UINT32*) pVideoAddress;
+	UINT32* pDst = (UINT32*) (pVideoAddress - frameBufferWidth);
+
+	if (bIsHalfScanLines)
+		std::fill(pDst, pDst + w, OPAQUE_BLACK);
+	else
+		std::copy(pSrc, pSrc + w, pDst);
+}
+
 // Pre: nSrcAdjustment: for 160-color images, src is +1 compared to dst
-static void CopySource(int w, int h, int sx, int sy, bgra_t *pVideoAddress, const int nSrcAdjustment = 0)
+static void CopySourceLine(int w, int sx, int sy, bgra_t *pVideoAddress, const int nSrcAdjustment = 0)
 {
 	UINT32* pDst = (UINT32*) pVideoAddress;
-	const BYTE* const pSrc = g_aSourceStartofLine[ sy ] + sx;
+	const BYTE* const pSrc = g_aSourceStartofLine[ sy ] + sx + nSrcAdjustment;
+	const UINT32* const pPalette = reinterpret_cast<const UINT32*>(g_pPaletteRGB);
 
-	const bool bIsHalfScanLines = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
-	const UINT frameBufferWidth = GetVideo().GetFrameBufferWidth();
-
-	while (h--)
+	for (int nBytes=0; nBytes<w; ++nBytes)
 	{
-		if (bIsHalfScanLines && !(h & 1))
-		{
-			// 50% Half Scan Line clears every odd scanline (and SHIFT+PrintScreen saves only the even rows)
-			std::fill(pDst, pDst + w, OPAQUE_BLACK);
-		}
-		else
-		{
-			for (int nBytes=0; nBytes<w; ++nBytes)
-			{
-				_ASSERT( *(pSrc+nBytes+nSrcAdjustment) < (sizeof(PaletteRGB_NTSC)/sizeof(PaletteRGB_NTSC[0])) );
-				const RGBQUAD& rRGB = g_pPaletteRGB[ *(pSrc+nBytes+nSrcAdjustment) ];
-				*(pDst+nBytes) = *reinterpret_cast<const UINT32 *>(&rRGB);
-			}
-		}
-
-		pDst -= frameBufferWidth;
+		_ASSERT( pSrc[nBytes] < (sizeof(PaletteRGB_NTSC)/sizeof(PaletteRGB_NTSC[0])) );
+		pDst[nBytes] = pPalette[ pSrc[nBytes] ];
 	}
 }
 
+// Pre: nSrcAdjustment: for 160-color images, src is +1 compared to dst
+static void CopySource(int w, int h, int sx, int sy, bgra_t *pVideoAddress, const int nSrcAdjustment = 0)
+{
+	_ASSERT(h == 2);	// both scanlines come from the same source line
+	CopySourceLine(w, sx, sy, pVideoAddress, nSrcAdjustment);
+	CopySecondScanline(pVideoAddress, w, GetVideo().IsVideoStyle(VS_HALF_SCANLINES), GetVideo().GetFrameBufferWidth());
+}
+
 //===========================================================================
 
 #define HIRES_COLUMN_OFFSET (((byteval1 & 0xE0) << 2) | ((byteval3 & 0x03) << 5))	// (prevHighBit | last 2 pixels | next 2 pixels) * HIRES_COLUMN_UNIT_SIZE
 
-void UpdateHiResCell (int x, int y, uint16_t addr, bgra_t *pVideoAddress)
+// Renders nCells consecutive cells of a scanline, from cell x at addr
+void UpdateHiResCells (int x, int y, uint16_t addr, bgra_t *pVideoAddress, const int nCells)
 {
-	uint8_t *pMain = MemGetMainPtr(addr);
-	BYTE byteval1 = (x >  0) ? *(pMain-1) : 0;
-	BYTE byteval2 =            *(pMain);
-	BYTE byteval3 = (x < 39) ? *(pMain+1) : 0;
+	const bool bIsDoubleHires40 = (GetVideo().GetVideoMode() & VF_DHIRES) != 0;	// ie. VF_DHIRES=1, VF_HIRES=1, VF_80COL=0 - NTSC.cpp refers to this as "DoubleHires40"
+	const bool bIsVerticalBlend = GetVideo().IsVideoStyle(VS_COLOR_VERTICAL_BLEND);
+	const bool bIsHalfScanLines = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
+	const bool isSWMIXED = GetVideo().VideoGetSWMIXED();
+	const UINT frameBufferWidth = GetVideo().GetFrameBufferWidth();
 
-	if (GetVideo().GetVideoMode() & VF_DHIRES)	// ie. VF_DHIRES=1, VF_HIRES=1, VF_80COL=0 - NTSC.cpp refers to this as "DoubleHires40"
+	bgra_t *pCellAddress = pVideoAddress;
+	for (int i = 0; i < nCells; i++, x++, addr++, pCellAddress += 14)
 	{
-		byteval1 &= 0x7f;
-		byteval2 &= 0x7f;
-		byteval3 &= 0x7f;
-	}
+		uint8_t *pMain = MemGetMainPtr(addr);
+		BYTE byteval1 = (x >  0) ? *(pMain-1) : 0;
+		BYTE byteval2 =            *(pMain);
+		BYTE byteval3 = (x < 39) ? *(pMain+1) : 0;
 
-	if (GetVideo().IsVideoStyle(VS_COLOR_VERTICAL_BLEND))
-	{
-		CopyMixedSource(x, y, SRCOFFS_HIRES+HIRES_COLUMN_OFFSET+((x & 1)*HIRES_COLUMN_SUBUNIT_SIZE), (int)byteval2, pVideoAddress);
-	}
-	else
-	{
-		CopySource(14,2, SRCOFFS_HIRES+HIRES_COLUMN_OFFSET+((x & 1)*HIRES_COLUMN_SUBUNIT_SIZE), (int)byteval2, pVideoAddress);
+		if (bIsDoubleHires40)
+		{
+			byteval1 &= 0x7f;
+			byteval2 &= 0x7f;
+			byteval3 &= 0x7f;
+		}
+
+		if (bIsVerticalBlend)
+		{
+			CopyMixedSource(x, y, SRCOFFS_HIRES+HIRES_COLUMN_OFFSET+((x & 1)*HIRES_COLUMN_SUBUNIT_SIZE), (int)byteval2, pCellAddress, isSWMIXED, bIsHalfScanLines, frameBufferWidth);
+		}
+		else
+		{
+			CopySourceLine(14, SRCOFFS_HIRES+HIRES_COLUMN_OFFSET+((x & 1)*HIRES_COLUMN_SUBUNIT_SIZE), (int)byteval2, pCellAddress);
+		}
 	}
+
+	if (!bIsVerticalBlend)
+		CopySecondScanline(pVideoAddress, nCells*14, bIsHalfScanLines, frameBufferWidth);
 }
 
 //===========================================================================
@@ -650,10 +665,10 @@ void UpdateDHiResCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress, bool u
 //===========================================================================
 // RGB videocards HGR
 
-void UpdateHiResRGBCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress)
+// The first scanline of cell x: 7 pixels, each doubled
+static void UpdateHiResRGBCell(int x, uint16_t addr, UINT32* pDst, const UINT32 (&colors)[2][4], const UINT32 (&bw)[2])
 {
-	const int xpixel = x * 14;
-	int xoffset = x & 1; // offset to start of the 2 bytes
+	const int xoffset = x & 1; // offset to start of the 2 bytes
 	addr -= xoffset;
 
 	uint8_t* pMain = MemGetMainPtr(addr);
@@ -663,93 +678,59 @@ void UpdateHiResRGBCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress)
 	uint8_t byteval2 = *pMain;
 	uint8_t byteval3 = *(pMain + 1);
 	uint8_t byteval4 = (x >= 38 ? 0 : *(pMain + 2));
-	
-	// all 28 bits chained
-	DWORD dwordval = (byteval1 & 0x7F) | ((byteval2 & 0x7F) << 7) | ((byteval3 & 0x7F) << 14) | ((byteval4 & 0x7F) << 21);
-
-	// Extraction of 14 color pixels
-	UINT32 colors[14];
-	int color = 0;
-	DWORD dwordval_tmp = dwordval;
-	dwordval_tmp = dwordval_tmp >> 7;
-	bool offset = (byteval2 & 0x80) ? true : false;
-	for (int i = 0; i < 14; i++)
-	{
-		if (i == 7) offset = (byteval3 & 0x80) ? true : false;
-		color = dwordval_tmp & 0x3;
-		// Two cases because AppleWin's palette is in a strange order
-		if (offset)
-			colors[i] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[1 + color]);
-		else
-			colors[i] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[6 - color]);
-		if (i%2) dwordval_tmp >>= 2;
-	}
-	// Black and White
-	UINT32 bw[2];
-	bw[0] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[0]);
-	bw[1] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[1]);
 
-	DWORD mask  =  0x01C0; //  00|000001 1|1000000
-	DWORD chck1 =  0x0140; //  00|000001 0|1000000
-	DWORD chck2 =  0x0080; //  00|000000 1|0000000
+	// all 28 bits chained
+	const DWORD dwordval = (byteval1 & 0x7F) | ((byteval2 & 0x7F) << 7) | ((byteval3 & 0x7F) << 14) | ((byteval4 & 0x7F) << 21);
 
 	// HIRES render in RGB works on a pixel-basis (1-bit data in framebuffer)
 	// The pixel can be 'color', if it makes a 101 or 010 pattern with the two neighbour bits
 	// In all other cases, it's black if 0 and white if 1
 	// The value of 'color' is defined on a 2-bits basis
+	//
+	// Pixel i (0-13) of the 2 bytes is bit i+7, and it is 'color' if bit i+6 of isColor is set:
+	// a 101 or 010 pattern is a bit which differs from both neighbours
+	const DWORD isColor = (dwordval ^ (dwordval >> 1)) & ((dwordval >> 1) ^ (dwordval >> 2));
 
-	UINT32* pDst = (UINT32*)pVideoAddress;
+	// The palette of the color pixels depends on the high bit of the byte
+	const UINT32* const pColors = colors[((xoffset ? byteval3 : byteval2) & 0x80) ? 1 : 0];
 
-	if (xoffset)
+	for (int i = xoffset*7; i < xoffset*7+7; i++)
 	{
-		// Second byte of the 14 pixels block
-		dwordval = dwordval >> 7;
-		xoffset = 7;
+		const UINT32 color = pColors[(dwordval >> (7 + (i & ~1))) & 0x3];
+		const UINT32 mono = bw[(dwordval >> (7 + i)) & 1];
+		const UINT32 pixel = ((isColor >> (6 + i)) & 1) ? color : mono;
+		*(pDst++) = pixel;
+		*(pDst++) = pixel;
 	}
+}
 
-	for (int i = xoffset; i < xoffset+7; i++)
+// Renders nCells consecutive cells of a scanline, from cell x at addr
+void UpdateHiResRGBCells(int x, int y, uint16_t addr, bgra_t* pVideoAddress, const int nCells)
+{
+	const UINT32* const pPalette = reinterpret_cast<const UINT32*>(g_pPaletteRGB);
+
+	// Two cases because AppleWin's palette is in a strange order
+	const UINT32 colors[2][4] =
 	{
-		if (((dwordval & mask) == chck1) || ((dwordval & mask) == chck2))
-		{
-			// Color pixel
-			*(pDst) = colors[i];
-			*(pDst + 1) = *(pDst);
-			pDst += 2;
-		}
-		else
-		{
-			// B&W pixel
-			*(pDst) = bw[(dwordval & chck2 ? 1 : 0)];
-			*(pDst + 1) = *(pDst);
-			pDst += 2;
-		}
-		// Next pixel
-		dwordval = dwordval >> 1;
-	}
+		{ pPalette[6], pPalette[5], pPalette[4], pPalette[3] },	// high bit clear: g_pPaletteRGB[6 - color]
+		{ pPalette[1], pPalette[2], pPalette[3], pPalette[4] },	// high bit set:   g_pPaletteRGB[1 + color]
+	};
+	// Black and White
+	const UINT32 bw[2] = { pPalette[0], pPalette[1] };
 
-	const bool bIsHalfScanLines = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
+	UINT32* pDst = (UINT32*)pVideoAddress;
+	for (int i = 0; i < nCells; i++, pDst += 14)
+		UpdateHiResRGBCell(x + i, addr + i, pDst, colors, bw);
 
-	// Second line
-	UINT32* pSrc = (UINT32*)pVideoAddress;
-	pDst = pSrc - GetVideo().GetFrameBufferWidth();
-	if (bIsHalfScanLines)
-	{
-		// Scanlines
-		std::fill(pDst, pDst + 14, OPAQUE_BLACK);
-	}
-	else
-	{
-		for (int i = 0; i < 14; i++)
-			*(pDst + i) = *(pSrc + i);
-	}
+	CopySecondScanline(pVideoAddress, nCells*14, GetVideo().IsVideoStyle(VS_HALF_SCANLINES), GetVideo().GetFrameBufferWidth());
 }
 
 static bool g_dhgrLastCellIsColor = true;
 static int g_dhgrLastBit = 0;
 
-void UpdateDHiResCellRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, bool isMixMode, bool isBit7Inversed)
+// The first scanline of cell x: 14 pixels
+static void UpdateDHiResCellRGB(int x, uint16_t addr, UINT32* pDst, bool isMixMode, bool isBit7Inversed)
 {
-	const int xpixel = x * 14;
 	int xoffset = x & 1; // offset to start of the 2 bytes
 	addr -= xoffset;
 
@@ -766,20 +747,19 @@ void UpdateDHiResCellRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, boo
 	DWORD dwordval = (byteval1 & 0x7F) | ((byteval2 & 0x7F) << 7) | ((byteval3 & 0x7F) << 14) | ((byteval4 & 0x7F) << 21);
 
 	// Extraction of 7 color pixels and 7x4 bits
-	int bits[7];
+	const UINT32* const pPalette = reinterpret_cast<const UINT32*>(g_pPaletteRGB);
 	UINT32 colors[7];
-	int color = 0;
 	DWORD dwordval_tmp = dwordval;
 	for (int i = 0; i < 7; i++)
 	{
-		bits[i] = dwordval_tmp & 0xF;
-		color = ((bits[i] & 7) << 1) | ((bits[i] & 8) >> 3); // DHGR colors are rotated 1 bit to the right
-		colors[i] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[12 + color]);
+		const int bits = dwordval_tmp & 0xF;
+		const int color = ((bits & 7) << 1) | ((bits & 8) >> 3); // DHGR colors are rotated 1 bit to the right
+		colors[i] = pPalette[12 + color];
 		dwordval_tmp >>= 4;
 	}
 	UINT32 bw[2];
-	bw[0] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[12 + 0]);
-	bw[1] = *reinterpret_cast<const UINT32*>(&g_pPaletteRGB[12 + 15]);
+	bw[0] = pPalette[12 + 0];
+	bw[1] = pPalette[12 + 15];
 
 	if (isBit7Inversed)
 	{
@@ -801,8 +781,6 @@ void UpdateDHiResCellRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, boo
 	//
 	// (Tested on Le Chat Mauve IIc adapter, which was made under patent of Video-7)
 
-	UINT32* pDst = (UINT32*)pVideoAddress;
-
 	if (xoffset == 0)	// First cell
 	{
 		if ((byteval1 & 0x80) || !isMixMode)
@@ -941,22 +919,16 @@ void UpdateDHiResCellRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, boo
 			g_dhgrLastCellIsColor = false;
 		}
 	}
+}
 
-	const bool bIsHalfScanLines = GetVideo().IsVideoStyle(VS_HALF_SCANLINES);
+// Renders nCells consecutive cells of a scanline, from cell x at addr
+void UpdateDHiResCellsRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, const int nCells, bool isMixMode, bool isBit7Inversed)
+{
+	UINT32* pDst = (UINT32*)pVideoAddress;
+	for (int i = 0; i < nCells; i++, pDst += 14)
+		UpdateDHiResCellRGB(x + i, addr + i, pDst, isMixMode, isBit7Inversed);
 
-	// Second line
-	UINT32* pSrc = (UINT32*)pVideoAddress ;
-	pDst = pSrc - GetVideo().GetFrameBufferWidth();
-	if (bIsHalfScanLines)
-	{
-		// Scanlines
-		std::fill(pDst, pDst + 14, OPAQUE_BLACK);
-	}
-	else
-	{
-		for (int i = 0; i < 14; i++)
-			*(pDst + i) = *(pSrc + i);
-	}
+	CopySecondScanline(pVideoAddress, nCells*14, GetVideo().IsVideoStyle(VS_HALF_SCANLINES), GetVideo().GetFrameBufferWidth());
 }
 
 #if 1
@@ -1172,7 +1144,21 @@ static void V_CreateDIBSections(void)
 	// CREATE THE OFFSET TABLE FOR EACH SCAN LINE IN THE SOURCE IMAGE
 	for (int y = 0; y < MAX_SOURCE_Y; y++)
 		g_aSourceStartofLine[ y ] = g_pSourcePixels + SRCOFFS_TOTAL*((MAX_SOURCE_Y-1) - y);
+}
 
+// The source image & the color mix map are fixed: filled by RGB_CreateVideoTables() or from the video table cache
+void RGB_GetVideoTables(VideoTables_t& tables)
+{
+	V_CreateDIBSections();
+
+	const VideoTable_t sourcePixels = { g_pSourcePixels, SRCOFFS_TOTAL*MAX_SOURCE_Y };
+	const VideoTable_t colorMixMap = { colormixmap, sizeof(colormixmap) };
+	tables.push_back(sourcePixels);
+	tables.push_back(colorMixMap);
+}
+
+void RGB_CreateVideoTables(void)
+{
 	// DRAW THE SOURCE IMAGE INTO THE SOURCE BIT BUFFER
 	memset(g_pSourcePixels, 0, SRCOFFS_TOTAL*MAX_SOURCE_Y);
 
@@ -1185,8 +1171,7 @@ static void V_CreateDIBSections(void)
 
 void VideoInitializeOriginal(baseColors_t pBaseNtscColors)
 {
-	// CREATE THE SOURCE IMAGE AND DRAW INTO THE SOURCE BIT BUFFER
-	V_CreateDIBSections();
+	// NB. The source image is created by RGB_CreateVideoTables()
 
 	// Replace the default palette with true NTSC-generated colors
 	memcpy(&PaletteRGB_NTSC[BLACK], *pBaseNtscColors, sizeof(RGBQUAD) * kNumBaseColors);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Video.h"
+#include "VideoTableCache.h"
 
 // Handling of RGB videocards
 
@@ -13,9 +14,9 @@ enum RGB_Videocard_e
 };
 
 
-void UpdateHiResCell(int x, int y, uint16_t addr, bgra_t *pVideoAddress);
+void UpdateHiResCells(int x, int y, uint16_t addr, bgra_t *pVideoAddress, const int nCells);
 void UpdateDHiResCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress, bool updateAux, bool updateMain);
-void UpdateDHiResCellRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, bool isMixMode, bool isBit7Inversed);
+void UpdateDHiResCellsRGB(int x, int y, uint16_t addr, bgra_t* pVideoAddress, const int nCells, bool isMixMode, bool isBit7Inversed);
 int UpdateDHiRes160Cell (int x, int y, uint16_t addr, bgra_t *pVideoAddress);
 void UpdateLoResCell(int x, int y, uint16_t addr, bgra_t *pVideoAddress);
 void UpdateDLoResCell(int x, int y, uint16_t addr, bgra_t *pVideoAddress);
@@ -23,10 +24,12 @@ void UpdateText40ColorCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress, u
 void UpdateText80ColorCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress, uint8_t bits, uint8_t character);
 void UpdateHiResDuochromeCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress);
 void UpdateDuochromeCell(int h, int w, bgra_t* pVideoAddress, uint8_t bits, uint8_t foreground, uint8_t background);
-void UpdateHiResRGBCell(int x, int y, uint16_t addr, bgra_t* pVideoAddress);
+void UpdateHiResRGBCells(int x, int y, uint16_t addr, bgra_t* pVideoAddress, const int nCells);
 
 const UINT kNumBaseColors = 16;
 typedef bgra_t (*baseColors_t)[kNumBaseColors];
+void RGB_GetVideoTables(VideoTables_t& tables);
+void RGB_CreateVideoTables(void);
 void VideoInitializeOriginal(baseColors_t pBaseNtscColors);
 void VideoSwitchVideocardPalette(RGB_Videocard_e videocard, VideoType_e type);
 
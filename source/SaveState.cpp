@@ -34,10 +34,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Interface.h"
 #include "CardManager.h"
 #include "Debug.h"
+#include "DiskImageWriteBack.h"
 #include "Joystick.h"
 #include "Keyboard.h"
 #include "Memory.h"
 #include "Mockingboard.h"
+#include "Movie.h"
 #include "Pravets.h"
 #include "Speaker.h"
 #include "Speech.h"
@@ -452,6 +454,8 @@ static void Snapshot_LoadState_v2(void)
 
 void Snapshot_LoadState()
 {
+	MovieStop();	// A movie is only valid from its own starting state
+
 	const std::string ext_aws = (".aws");
 	const size_t pos = g_strSaveStatePathname.size() - ext_aws.size();
 	if (g_strSaveStatePathname.find(ext_aws, pos) != std::string::npos)	// find ".aws" at end of pathname
@@ -474,6 +478,9 @@ void Snapshot_LoadState()
 void Snapshot_SaveState(void)
 {
 	LogFileOutput("Saving Save-State to %s\n", g_strSaveStatePathname.c_str());
+
+	GetDiskImageWriteBack().Flush();	// So that the disk images referenced by the save-state are up-to-date
+
 	try
 	{
 		YamlSaveHelper yamlSaveHelper(g_strSaveStatePathname);
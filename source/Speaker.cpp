@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Interface.h"
 #include "Log.h"
 #include "Memory.h"
+#include "PerfCounters.h"
 #include "SoundCore.h"
 #include "YamlHelper.h"
 #include "Riff.h"
@@ -84,6 +85,10 @@ static bool g_bSpkrToggleFlag = false;
 static VOICE SpeakerVoice;
 static bool g_bSpkrAvailable = false;
 
+static SPKR_AudioCaptureCallback g_pfnAudioCapture = NULL;
+static void* g_pAudioCaptureContext = NULL;
+static std::vector<short> g_captureBuffer;	// Not bounded by g_pSpeakerBuffer, which stops filling when the sound buffer does
+
 //-----------------------------------------------------------------------------
 
 // Forward refs:
@@ -332,15 +337,18 @@ static void UpdateRemainderBuffer(ULONG* pnCycleDiff)
 				nSampleMean += (signed long) g_pRemainderBuffer[i];
 			nSampleMean /= (signed long) g_nRemainderBufferSize;
 
+			const short sample = DCFilter( (short)nSampleMean );
 			if(g_nBufferIdx < SPKR_SAMPLE_RATE-1)
-				g_pSpeakerBuffer[g_nBufferIdx++] = DCFilter( (short)nSampleMean );
+				g_pSpeakerBuffer[g_nBufferIdx++] = sample;
+			if (g_pfnAudioCapture)
+				g_captureBuffer.push_back(sample);
 		}
 	}
 }
 
 static void UpdateSpkr()
 {
-  if(!g_bFullSpeed || SoundCore_GetTimerState())
+  if(!g_bFullSpeed || SoundCore_GetTimerState() || g_pfnAudioCapture)
   {
 	  ULONG nCycleDiff = (ULONG) (g_nCumulativeCycles - g_nSpkrLastCycle);
 
@@ -350,8 +358,21 @@ static void UpdateSpkr()
 
 	  ULONG nCyclesRemaining = (ULONG) ((double)nCycleDiff - (double)nNumSamples * g_fClksPerSpkrSample);
 
-	  while((nNumSamples--) && (g_nBufferIdx < SPKR_SAMPLE_RATE-1))
-		g_pSpeakerBuffer[g_nBufferIdx++] = DCFilter(g_nSpeakerData);
+	  if (g_pfnAudioCapture)
+	  {
+		  while(nNumSamples--)
+		  {
+			  const short sample = DCFilter(g_nSpeakerData);
+			  if (g_nBufferIdx < SPKR_SAMPLE_RATE-1)
+				  g_pSpeakerBuffer[g_nBufferIdx++] = sample;
+			  g_captureBuffer.push_back(sample);
+		  }
+	  }
+	  else
+	  {
+		  while((nNumSamples--) && (g_nBufferIdx < SPKR_SAMPLE_RATE-1))
+			g_pSpeakerBuffer[g_nBufferIdx++] = DCFilter(g_nSpeakerData);
+	  }
 
 	  ReinitRemainderBuffer(nCyclesRemaining);	// Partially fill 1Mhz sample buffer
   }
@@ -408,10 +429,7 @@ BYTE __stdcall SpkrToggle (WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
 // Called by ContinueExecution()
 void SpkrUpdate (DWORD totalcycles)
 {
-#ifdef LOG_PERF_TIMINGS
-	extern UINT64 g_timeSpeaker;
-	PerfMarker perfMarker(g_timeSpeaker);
-#endif
+	PerfMarker perfMarker(PERF_SPEAKER);
 
   if(!g_bSpkrToggleFlag)
   {
@@ -447,9 +465,22 @@ void SpkrUpdate (DWORD totalcycles)
 	  _ASSERT(nSamplesUsed <= g_nBufferIdx);
 	  memmove(g_pSpeakerBuffer, &g_pSpeakerBuffer[nSamplesUsed], g_nBufferIdx-nSamplesUsed);	// FIXME-TC: _Size * 2
 	  g_nBufferIdx -= nSamplesUsed;
+
+	  if (g_pfnAudioCapture && !g_captureBuffer.empty())
+	  {
+		  g_pfnAudioCapture(&g_captureBuffer[0], (UINT)g_captureBuffer.size(), g_pAudioCaptureContext);
+		  g_captureBuffer.clear();
+	  }
   }
 }
 
+void Spkr_SetAudioCapture(SPKR_AudioCaptureCallback callback, void* context)
+{
+	g_pfnAudioCapture = callback;
+	g_pAudioCaptureContext = context;
+	g_captureBuffer.clear();
+}
+
 // Called from SoundCore_TimerFunc() for FADE_OUT
 void SpkrUpdate_Timer()
 {
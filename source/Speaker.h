@@ -30,6 +30,9 @@ void    Spkr_Mute();
 void    Spkr_Unmute();
 bool    Spkr_IsActive();
 bool    Spkr_DSInit();
+// Capture: called from SpkrUpdate() with every block of 44.1kHz mono samples, rendered in emulated time (also when full-speed)
+typedef void (*SPKR_AudioCaptureCallback)(const short* pMonoSamples, UINT numSamples, void* context);
+void    Spkr_SetAudioCapture(SPKR_AudioCaptureCallback callback, void* context);
 void    SpkrSaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 void    SpkrLoadSnapshot(class YamlLoadHelper& yamlLoadHelper);
 
@@ -49,3 +49,15 @@ BYTE __stdcall TapeWrite(WORD, WORD address, BYTE, BYTE, ULONG nExecutedCycles)
 {
 	return 0;
 }
+
+//---------------------------------------------------------------------------
+
+UINT TapeGetTrapAddress(void)
+{
+	return 0x10000;	// never matches a 16-bit PC (no tape support)
+}
+
+bool TapeTrap(ULONG nExecutedCycles)
+{
+	return false;
+}
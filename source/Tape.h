@@ -2,3 +2,7 @@
 
 BYTE __stdcall TapeRead(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
 BYTE __stdcall TapeWrite(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles);
+
+// Instant load: the Monitor's READ routine is serviced from the decoded tape (see CPU.cpp's Fetch())
+UINT TapeGetTrapAddress(void);
+bool TapeTrap(ULONG nExecutedCycles);
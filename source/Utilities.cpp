@@ -326,6 +326,10 @@ void LoadConfiguration(bool loadImages)
 	REGLOAD_DEFAULT(TEXT(REGVALUE_ENHANCE_DISK_SPEED), &dwEnhanceDisk, 1);
 	GetCardMgr().GetDisk2CardMgr().SetEnhanceDisk(dwEnhanceDisk ? true : false);
 
+	DWORD dwTurboDisk;
+	REGLOAD_DEFAULT(TEXT(REGVALUE_TURBO_DISK), &dwTurboDisk, 0);
+	GetCardMgr().GetDisk2CardMgr().SetTurboDisk(dwTurboDisk ? true : false);
+
 	//
 
 	RegLoadString(TEXT(REG_CONFIG), TEXT(REGVALUE_PRINTER_FILENAME), 1, szFilename, MAX_PATH, TEXT(""));
@@ -0,0 +1,151 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Cache of the fixed video lookup tables
+ *
+ * File format:
+ *   Header: "AWVT <format version> <AppleWin version> <size of each table>\n"
+ *   Tables: raw, in the order given
+ *   Checksum: FNV-1a of the tables (UINT64, little-endian)
+ *
+ * Author: Various
+ *
+ */
+
+#include "StdAfx.h"
+
+#include "VideoTableCache.h"
+#include "Core.h"
+#include "Log.h"
+
+#include <chrono>
+
+// Bump when the layout of a table or the code generating it changes
+static const UINT VIDEO_TABLE_CACHE_VERSION = 1;
+
+static std::string g_videoTableCacheFilename;
+
+static std::string GetHeader(const VideoTables_t& tables)
+{
+	std::string header = StrFormat("AWVT %u %s", VIDEO_TABLE_CACHE_VERSION, g_VERSIONSTRING.c_str());
+	for (size_t i = 0; i < tables.size(); i++)
+		header += StrFormat(" %u", (UINT)tables[i].size);
+	return header + "\n";
+}
+
+static UINT64 GetChecksum(const VideoTables_t& tables)
+{
+	UINT64 hash = 0xcbf29ce484222325ULL;	// FNV-1a
+	for (size_t i = 0; i < tables.size(); i++)
+	{
+		const BYTE* pData = (const BYTE*)tables[i].pData;
+		for (size_t j = 0; j < tables[i].size; j++)
+		{
+			hash ^= pData[j];
+			hash *= 0x100000001b3ULL;
+		}
+	}
+	return hash;
+}
+
+//===========================================================================
+
+void VideoTableCache_SetFilename(const std::string& filename)
+{
+	g_videoTableCacheFilename = filename;
+}
+
+// NB. On failure the tables may have been partially overwritten: the caller computes them all
+bool VideoTableCache_Load(const VideoTables_t& tables)
+{
+	if (g_videoTableCacheFilename.empty())
+		return false;
+
+	FILE* pFile = fopen(g_videoTableCacheFilename.c_str(), "rb");
+	if (!pFile)
+		return false;
+
+	const std::string header = GetHeader(tables);
+	std::string fileHeader(header.size(), '\0');
+	bool ok = fread(&fileHeader[0], 1, fileHeader.size(), pFile) == fileHeader.size() && fileHeader == header;
+
+	for (size_t i = 0; ok && i < tables.size(); i++)
+		ok = fread(tables[i].pData, 1, tables[i].size, pFile) == tables[i].size;
+
+	BYTE checksum[8];
+	ok = ok && fread(checksum, 1, sizeof(checksum), pFile) == sizeof(checksum);
+	fclose(pFile);
+
+	if (ok)
+	{
+		UINT64 fileChecksum = 0;
+		for (int i = sizeof(checksum) - 1; i >= 0; i--)
+			fileChecksum = (fileChecksum << 8) | checksum[i];
+		ok = fileChecksum == GetChecksum(tables);
+	}
+
+	if (!ok)
+		LogFileOutput("VideoTableCache: '%s' is stale or corrupt\n", g_videoTableCacheFilename.c_str());
+
+	return ok;
+}
+
+// Written to a temporary file then renamed: concurrent instances never see a partial file
+void VideoTableCache_Save(const VideoTables_t& tables)
+{
+	if (g_videoTableCacheFilename.empty())
+		return;
+
+	const std::string tmpFilename = StrFormat("%s.%llu", g_videoTableCacheFilename.c_str(),
+		(unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count());
+
+	FILE* pFile = fopen(tmpFilename.c_str(), "wb");
+	if (!pFile)
+	{
+		LogFileOutput("VideoTableCache: cannot create '%s'\n", tmpFilename.c_str());
+		return;
+	}
+
+	const std::string header = GetHeader(tables);
+	bool ok = fwrite(header.data(), 1, header.size(), pFile) == header.size();
+
+	for (size_t i = 0; ok && i < tables.size(); i++)
+		ok = fwrite(tables[i].pData, 1, tables[i].size, pFile) == tables[i].size;
+
+	BYTE checksum[8];
+	UINT64 hash = GetChecksum(tables);
+	for (size_t i = 0; i < sizeof(checksum); i++, hash >>= 8)
+		checksum[i] = (BYTE)hash;
+	ok = ok && fwrite(checksum, 1, sizeof(checksum), pFile) == sizeof(checksum);
+
+	ok = (fclose(pFile) == 0) && ok;
+
+	if (!ok || rename(tmpFilename.c_str(), g_videoTableCacheFilename.c_str()) != 0)
+	{
+		// eg. on Windows, if another instance has just saved it
+		remove(tmpFilename.c_str());
+		return;
+	}
+
+	LogFileOutput("VideoTableCache: saved '%s'\n", g_videoTableCacheFilename.c_str());
+}
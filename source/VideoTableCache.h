@@ -0,0 +1,18 @@
+#pragma once
+
+// Cache of the fixed video lookup tables (NTSC chroma, RGB source image) in a binary file
+// . These tables only depend on the code: NTSC_VideoInit() loads them if the file is valid, else computes & saves them
+// . The file is keyed on the format version, the AppleWin version and the tables' sizes, and has a checksum
+// . Disabled until VideoTableCache_SetFilename() (eg. by the frontend)
+
+struct VideoTable_t
+{
+	void* pData;
+	size_t size;
+};
+
+typedef std::vector<VideoTable_t> VideoTables_t;
+
+void VideoTableCache_SetFilename(const std::string& filename);
+bool VideoTableCache_Load(const VideoTables_t& tables);
+void VideoTableCache_Save(const VideoTables_t& tables);
@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Mockingboard.h"
 #include "MouseInterface.h"
 #include "ParallelPrinter.h"
+#include "PerfCounters.h"
 #include "Registry.h"
 #include "Riff.h"
 #include "SaveState.h"
@@ -128,9 +129,7 @@ static bool g_uModeStepping_LastGetKey_ScrollLock = false;
 
 static void ContinueExecution(void)
 {
-#ifdef LOG_PERF_TIMINGS
-	PerfMarker* pPerfMarkerTotal = new PerfMarker(g_timeTotal);
-#endif
+	PerfMarker perfMarkerFrame(PERF_FRAME);
 
 	_ASSERT(g_nAppMode == MODE_RUNNING || g_nAppMode == MODE_STEPPING);
 
@@ -247,9 +246,7 @@ static void ContinueExecution(void)
 	const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
 	if (g_dwCyclesThisFrame >= dwClksPerFrame && !GetVideo().VideoGetVblBarEx(g_dwCyclesThisFrame))
 	{
-#ifdef LOG_PERF_TIMINGS
-		PerfMarker perfMarkerVideoRefresh(g_timeVideoRefresh);
-#endif
+		PerfMarker perfMarkerPresent(PERF_PRESENT);
 		g_dwCyclesThisFrame -= dwClksPerFrame;
 
 		if (g_bFullSpeed)
@@ -258,9 +255,8 @@ static void ContinueExecution(void)
 			GetFrame().VideoPresentScreen(); // Just copy the output of our Apple framebuffer to the system Back Buffer
 	}
 
-#ifdef LOG_PERF_TIMINGS
-	delete pPerfMarkerTotal;	// Explicitly call dtor *before* SysClk_WaitTimer()
-#endif
+	perfMarkerFrame.Stop();	// Explicitly stop *before* SysClk_WaitTimer()
+	PerfFrameEnd();
 
 	if ((g_nAppMode == MODE_RUNNING && !g_bFullSpeed) || bModeStepping_WaitTimer)
 	{
@@ -931,6 +927,8 @@ static void Shutdown(void)
 	CoUninitialize();
 	LogFileOutput("Exit: CoUninitialize()\n");
 
+	PerfShutdown();
+
 	LogDone();
 
 	RiffFinishWriteFile();
@@ -0,0 +1,19 @@
+#include "StdAfx.h"
+#include "frontends/benchmark/headlessframe.h"
+
+#include <iostream>
+
+namespace ab2
+{
+
+  void HeadlessFrame::VideoPresentScreen()
+  {
+  }
+
+  int HeadlessFrame::FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType)
+  {
+    std::cerr << lpCaption << ": " << lpText << std::endl;
+    return IDOK;
+  }
+
+}
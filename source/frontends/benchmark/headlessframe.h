@@ -0,0 +1,17 @@
+#pragma once
+
+#include "frontends/common2/commonframe.h"
+#include "frontends/common2/gnuframe.h"
+
+namespace ab2
+{
+
+  // A frame which renders into the framebuffer, but never presents it
+  class HeadlessFrame : public virtual common2::CommonFrame, public common2::GNUFrame
+  {
+  public:
+    void VideoPresentScreen() override;
+    int FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType) override;
+  };
+
+}
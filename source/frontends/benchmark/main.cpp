@@ -0,0 +1,182 @@
+#include "StdAfx.h"
+
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <boost/program_options.hpp>
+
+#include "Common.h"
+#include "Card.h"
+#include "Core.h"
+#include "Registry.h"
+
+#include "linux/context.h"
+#include "linux/paddle.h"
+#include "frontends/common2/ptreeregistry.h"
+#include "frontends/benchmark/headlessframe.h"
+#include "frontends/benchmark/runner.h"
+#include "frontends/benchmark/workloads.h"
+
+namespace po = boost::program_options;
+
+namespace
+{
+
+  struct BenchmarkOptions
+  {
+    bool list = false;
+    std::string filter;
+    std::string output;
+    ab2::RunnerOptions runner;
+    ab2::WorkloadOptions workloads;
+  };
+
+  bool getBenchmarkOptions(int argc, const char * argv [], BenchmarkOptions & options)
+  {
+    po::options_description desc("Apple Emulator benchmark suite");
+    desc.add_options()
+      ("help,h", "Print this help message")
+      ("list,l", "List the workloads and exit")
+      ("filter,f", po::value<std::string>(), "Only run workloads matching this regular expression")
+      ("warmup", po::value<size_t>()->default_value(options.runner.warmup), "Warm-up repetitions (discarded)")
+      ("repeat,r", po::value<size_t>()->default_value(options.runner.repetitions), "Measured repetitions")
+      ("min-time", po::value<double>()->default_value(options.runner.minSeconds), "Minimum duration of a repetition (s)")
+      ("cache-misses", "Count the L1 data cache read misses per unit of work (perf events)")
+      ("output,o", po::value<std::string>(), "Write the JSON results to this file (default: stdout)")
+      ("dsk", po::value<std::string>(), "Disk image for disk2/boot-dsk (default: bin/MASTER.DSK)")
+      ("woz", po::value<std::string>(), "Disk image for disk2/boot-woz")
+      ("movie", po::value<std::string>(), "Recording for movie/<name> (see --movie-record)")
+      ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return false;
+    }
+
+    options.list = vm.count("list");
+    if (vm.count("filter"))
+    {
+      options.filter = vm["filter"].as<std::string>();
+    }
+    if (vm.count("output"))
+    {
+      options.output = vm["output"].as<std::string>();
+    }
+    options.runner.warmup = vm["warmup"].as<size_t>();
+    options.runner.repetitions = vm["repeat"].as<size_t>();
+    options.runner.minSeconds = vm["min-time"].as<double>();
+    options.runner.cacheMisses = vm.count("cache-misses");
+    if (vm.count("dsk"))
+    {
+      options.workloads.dsk = vm["dsk"].as<std::string>();
+    }
+    if (vm.count("woz"))
+    {
+      options.workloads.woz = vm["woz"].as<std::string>();
+    }
+    if (vm.count("movie"))
+    {
+      options.workloads.movie = vm["movie"].as<std::string>();
+    }
+
+    return true;
+  }
+
+  std::shared_ptr<Registry> createBenchmarkRegistry()
+  {
+    // in memory: the benchmark must not depend on (or modify) the user's configuration
+    const std::shared_ptr<common2::PTreeRegistry> registry = std::make_shared<common2::PTreeRegistry>();
+    registry->putDWord(RegGetConfigSlotSection(SLOT4), REGVALUE_CARD_TYPE, CT_MockingboardC);
+    return registry;
+  }
+
+  int run_benchmark(int argc, const char * argv [])
+  {
+    BenchmarkOptions options;
+    if (!getBenchmarkOptions(argc, argv, options))
+      return 1;
+
+    const LoggerContext loggerContext(false);
+    const RegistryContext registryContext(createBenchmarkRegistry());
+    const std::shared_ptr<Paddle> paddle(new Paddle);
+    const std::shared_ptr<ab2::HeadlessFrame> frame(new ab2::HeadlessFrame);
+
+    const Initialisation init(frame, paddle);
+    frame->Begin();
+
+    if (options.workloads.dsk.empty())
+    {
+      // found relative to the executable, like the other resources (see GNUFrame)
+      options.workloads.dsk = g_sProgramDir + "MASTER.DSK";
+    }
+
+    const std::regex filter(options.filter);
+    std::vector<ab2::Result> results;
+
+    for (const ab2::Workload & workload : ab2::createWorkloads(frame, options.workloads))
+    {
+      if (!options.filter.empty() && !std::regex_search(workload.name, filter))
+        continue;
+
+      if (options.list)
+      {
+        std::cout << workload.name << std::endl;
+        continue;
+      }
+
+      std::cerr << workload.name << "... " << std::flush;
+      try
+      {
+        const ab2::Result result = ab2::runWorkload(workload, options.runner);
+        std::cerr << result.mean << " " << result.unit;
+        if (result.cacheMisses >= 0.0)
+        {
+          std::cerr << ", " << result.cacheMisses << " L1D misses/unit";
+        }
+        std::cerr << std::endl;
+        results.push_back(result);
+      }
+      catch (const std::exception & e)
+      {
+        // eg a missing disk image: skip the workload, but keep the others
+        std::cerr << "skipped: " << e.what() << std::endl;
+      }
+    }
+
+    frame->End();
+
+    if (!options.list)
+    {
+      if (options.output.empty())
+      {
+        ab2::writeJSON(std::cout, options.runner, results);
+      }
+      else
+      {
+        std::ofstream os(options.output);
+        ab2::writeJSON(os, options.runner, results);
+      }
+    }
+
+    return 0;
+  }
+
+}
+
+int main(int argc, const char * argv [])
+{
+  try
+  {
+    return run_benchmark(argc, argv);
+  }
+  catch (const std::exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,265 @@
+#include "StdAfx.h"
+#include "frontends/benchmark/runner.h"
+
+#include "linux/version.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+  // L1 data cache read misses of this thread, in user space
+  class CacheMissCounter
+  {
+  public:
+    CacheMissCounter()
+    {
+      perf_event_attr attr = {};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      myFD = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~CacheMissCounter()
+    {
+      if (myFD >= 0)
+      {
+        close(myFD);
+      }
+    }
+
+    // false if the counter is not available (eg /proc/sys/kernel/perf_event_paranoid, virtual machines)
+    bool isValid() const
+    {
+      return myFD >= 0;
+    }
+
+    void start()
+    {
+      ioctl(myFD, PERF_EVENT_IOC_RESET, 0);
+      ioctl(myFD, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t stop()
+    {
+      ioctl(myFD, PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t count = 0;
+      return read(myFD, &count, sizeof(count)) == sizeof(count) ? count : 0;
+    }
+
+  private:
+    int myFD;
+  };
+
+  struct Repetition
+  {
+    double sample;
+    double work;
+    uint64_t cacheMisses;
+  };
+
+  Repetition runRepetition(const ab2::Workload & workload, const ab2::RunnerOptions & options, CacheMissCounter * counter)
+  {
+    if (workload.begin)
+    {
+      workload.begin();
+    }
+
+    double work = 0.0;
+    double elapsed = 0.0;
+
+    if (counter)
+    {
+      counter->start();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    do
+    {
+      work += workload.step();
+      const auto end = std::chrono::steady_clock::now();
+      elapsed = std::chrono::duration<double>(end - start).count();
+    } while (workload.finished ? !workload.finished() : workload.fixedWork > 0.0 ? work < workload.fixedWork : elapsed < options.minSeconds);
+
+    Repetition repetition;
+    repetition.cacheMisses = counter ? counter->stop() : 0;
+    repetition.work = work;
+    repetition.sample = workload.timePerUnit ? elapsed * 1.0e9 / work : work / elapsed;
+    return repetition;
+  }
+
+  void computeStatistics(ab2::Result & result)
+  {
+    const std::vector<double> & samples = result.samples;
+    const size_t n = samples.size();
+    if (n == 0)
+    {
+      return;
+    }
+
+    double sum = 0.0;
+    for (const double sample : samples)
+    {
+      sum += sample;
+    }
+    result.mean = sum / n;
+
+    double squares = 0.0;
+    for (const double sample : samples)
+    {
+      squares += (sample - result.mean) * (sample - result.mean);
+    }
+    result.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;  // sample standard deviation
+
+    const auto minmax = std::minmax_element(samples.begin(), samples.end());
+    result.min = *minmax.first;
+    result.max = *minmax.second;
+  }
+
+  // JSON string literal, quotes included
+  std::string quoteJSON(const std::string & value)
+  {
+    std::string quoted = "\"";
+    for (const char c : value)
+    {
+      switch (c)
+      {
+      case '"':
+        quoted += "\\\"";
+        break;
+      case '\\':
+        quoted += "\\\\";
+        break;
+      case '\n':
+        quoted += "\\n";
+        break;
+      case '\r':
+        quoted += "\\r";
+        break;
+      case '\t':
+        quoted += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          quoted += escaped;
+        }
+        else
+        {
+          quoted += c;  // UTF-8 passes through unchanged
+        }
+        break;
+      }
+    }
+    quoted += "\"";
+    return quoted;
+  }
+
+}
+
+namespace ab2
+{
+
+  Result runWorkload(const Workload & workload, const RunnerOptions & options)
+  {
+    Result result;
+    result.name = workload.name;
+    result.unit = workload.unit;
+
+    if (workload.setup)
+    {
+      workload.setup();
+    }
+
+    std::unique_ptr<CacheMissCounter> counter;
+    if (options.cacheMisses)
+    {
+      counter.reset(new CacheMissCounter);
+      if (!counter->isValid())
+      {
+        counter.reset();
+      }
+    }
+
+    for (size_t i = 0; i < options.warmup; ++i)
+    {
+      runRepetition(workload, options, nullptr);
+    }
+
+    double work = 0.0;
+    uint64_t cacheMisses = 0;
+    for (size_t i = 0; i < options.repetitions; ++i)
+    {
+      const Repetition repetition = runRepetition(workload, options, counter.get());
+      result.samples.push_back(repetition.sample);
+      work += repetition.work;
+      cacheMisses += repetition.cacheMisses;
+    }
+
+    if (counter && work > 0.0)
+    {
+      result.cacheMisses = cacheMisses / work;
+    }
+
+    if (workload.teardown)
+    {
+      workload.teardown();
+    }
+
+    computeStatistics(result);
+    return result;
+  }
+
+  void writeJSON(std::ostream & os, const RunnerOptions & options, const std::vector<Result> & results)
+  {
+    // names can contain arbitrary file names (eg movie/*), so all strings are escaped
+    os << std::setprecision(6);
+    os << "{" << std::endl;
+    os << "  \"version\": " << quoteJSON(getVersion()) << "," << std::endl;
+    os << "  \"warmup\": " << options.warmup << "," << std::endl;
+    os << "  \"repetitions\": " << options.repetitions << "," << std::endl;
+    os << "  \"min_seconds\": " << options.minSeconds << "," << std::endl;
+    os << "  \"workloads\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      const Result & result = results[i];
+      os << "    {";
+      os << "\"name\": " << quoteJSON(result.name) << ", ";
+      os << "\"unit\": " << quoteJSON(result.unit) << ", ";
+      os << "\"mean\": " << result.mean << ", ";
+      os << "\"stddev\": " << result.stddev << ", ";
+      os << "\"min\": " << result.min << ", ";
+      os << "\"max\": " << result.max << ", ";
+      if (result.cacheMisses >= 0.0)
+      {
+        os << "\"l1d_misses_per_unit\": " << result.cacheMisses << ", ";
+      }
+      os << "\"samples\": [";
+      for (size_t j = 0; j < result.samples.size(); ++j)
+      {
+        os << (j ? ", " : "") << result.samples[j];
+      }
+      os << "]}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+  }
+
+}
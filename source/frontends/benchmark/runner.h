@@ -0,0 +1,50 @@
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ab2
+{
+
+  struct Workload
+  {
+    std::string name;
+    std::string unit;                  // of the reported rate, eg "MHz" or "frames/s"
+
+    std::function<void()> setup;       // once, before the warm-up (optional)
+    std::function<void()> begin;       // before each repetition (optional)
+    std::function<double()> step;      // does a slice of work, returns how much (in unit x seconds)
+    std::function<void()> teardown;    // once, after the last repetition (optional)
+    std::function<bool()> finished;    // each repetition runs until true, eg the end of a recording (optional)
+
+    double fixedWork = 0.0;            // > 0: each repetition does (at least) this much work, regardless of the time
+    bool timePerUnit = false;          // report ns per unit of work (eg "ns/cycle"), instead of the rate
+  };
+
+  struct RunnerOptions
+  {
+    size_t warmup = 1;
+    size_t repetitions = 5;
+    double minSeconds = 0.5;           // duration of a repetition (unless the workload has fixedWork)
+    bool cacheMisses = false;          // count the L1 data cache misses (Linux perf events)
+  };
+
+  struct Result
+  {
+    std::string name;
+    std::string unit;
+    std::vector<double> samples;       // rate (or time per unit) of each repetition
+    double mean = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double cacheMisses = -1.0;         // L1 data cache read misses per unit of work (mean), < 0 if not counted
+  };
+
+  Result runWorkload(const Workload & workload, const RunnerOptions & options);
+
+  void writeJSON(std::ostream & os, const RunnerOptions & options, const std::vector<Result> & results);
+
+}
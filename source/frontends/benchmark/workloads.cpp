@@ -0,0 +1,594 @@
+#include "StdAfx.h"
+#include "frontends/benchmark/workloads.h"
+#include "frontends/benchmark/headlessframe.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "DiskImage.h"
+#include "DiskImageHelper.h"
+#include "Interface.h"
+#include "Memory.h"
+#include "Mockingboard.h"
+#include "Movie.h"
+#include "NTSC.h"
+#include "SaveState.h"
+#include "Speaker.h"
+#include "Utilities.h"
+#include "Video.h"
+
+#include <stdexcept>
+#include <unistd.h>
+
+namespace
+{
+
+  const DWORD CPU_SLICE_CYCLES = 100000;
+  const double BOOT_MCYCLES = 5.0;  // ~5s of emulated time: enough for DOS 3.3 to boot and sit at the prompt
+
+  // deterministic content for video memory and block selection
+  class LCG
+  {
+  public:
+    BYTE next()
+    {
+      myState = myState * 1103515245 + 12345;
+      return BYTE(myState >> 16);
+    }
+
+  private:
+    uint32_t myState = 1;
+  };
+
+  // a complete emulation slice, as the frontends do it
+  double emulate(const DWORD cycles, const bool bVideoUpdate)
+  {
+    const DWORD executedCycles = CpuExecute(cycles, bVideoUpdate);
+    g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executedCycles) % NTSC_GetCyclesPerFrame();
+    GetCardMgr().Update(executedCycles);
+    SpkrUpdate(executedCycles);
+    return executedCycles / 1.0e6;
+  }
+
+  std::string createTemporaryFile(const std::string & suffix, const size_t size)
+  {
+    std::string pathname = "/tmp/applebench_XXXXXX" + suffix;
+    const int fd = mkstemps(&pathname[0], suffix.size());
+    if (fd < 0)
+    {
+      throw std::runtime_error("Cannot create temporary file " + pathname);
+    }
+    const std::vector<char> zeros(size, 0);
+    const bool ok = write(fd, zeros.data(), zeros.size()) == ssize_t(zeros.size());
+    close(fd);
+    if (!ok)
+    {
+      throw std::runtime_error("Cannot write temporary file " + pathname);
+    }
+    return pathname;
+  }
+
+  //
+  // Video: full screen redraw of each video mode, for each video type
+  //
+
+  struct VideoModeDesc
+  {
+    const char * name;
+    uint32_t flags;
+  };
+
+  const VideoModeDesc ourVideoModes[] =
+  {
+    {"text40", VF_TEXT},
+    {"text80", VF_TEXT | VF_80COL},
+    {"lores",  0},
+    {"dlores", VF_DHIRES | VF_80COL},
+    {"hgr",    VF_HIRES},
+    {"dhgr",   VF_HIRES | VF_DHIRES | VF_80COL},
+  };
+
+  struct VideoTypeDesc
+  {
+    const char * name;
+    VideoType_e type;
+    VideoStyle_e style;
+  };
+
+  const VideoTypeDesc ourVideoTypes[] =
+  {
+    {"color-tv",          VT_COLOR_TV,            VS_HALF_SCANLINES},
+    {"color-monitor",     VT_COLOR_MONITOR_NTSC,  VS_HALF_SCANLINES},
+    {"color-ideal",       VT_COLOR_IDEALIZED,     VS_HALF_SCANLINES},
+    {"color-ideal-blend", VT_COLOR_IDEALIZED,     VideoStyle_e(VS_HALF_SCANLINES | VS_COLOR_VERTICAL_BLEND)},
+    {"rgb",               VT_COLOR_VIDEOCARD_RGB, VS_HALF_SCANLINES},   // "RGB Card/Monitor"
+    {"rgb-full",          VT_COLOR_VIDEOCARD_RGB, VS_NONE},             // without the 50% scan lines
+    {"mono",              VT_MONO_WHITE,          VS_HALF_SCANLINES},
+  };
+
+  void fillVideoMemory(LCG & lcg, const WORD begin, const WORD end, const size_t stride)
+  {
+    for (WORD addr = begin; addr < end; addr += stride)
+    {
+      *MemGetMainPtr(addr) = lcg.next();
+      *MemGetAuxPtr(addr) = lcg.next();
+    }
+  }
+
+  ab2::Workload createVideoWorkload(const std::shared_ptr<ab2::HeadlessFrame> & frame, const VideoModeDesc & mode, const VideoTypeDesc & type)
+  {
+    const std::shared_ptr<LCG> lcg = std::make_shared<LCG>();
+
+    ab2::Workload workload;
+    workload.name = std::string("video/") + mode.name + "/" + type.name;
+    workload.unit = "frames/s";
+    workload.setup = [frame, mode, type, lcg]()
+    {
+      ResetMachineState();
+      Video & video = GetVideo();
+      video.SetVideoType(type.type);
+      video.SetVideoStyle(type.style);
+      video.SetVideoMode(mode.flags);
+      frame->ApplyVideoModeChange();
+
+      fillVideoMemory(*lcg, 0x0400, 0x0C00, 1);
+      fillVideoMemory(*lcg, 0x2000, 0x6000, 1);
+    };
+    workload.step = [frame, lcg]()
+    {
+      // change 1/8 of the bytes, to simulate an average game
+      fillVideoMemory(*lcg, 0x0400 + (lcg->next() & 7), 0x0C00, 8);
+      fillVideoMemory(*lcg, 0x2000 + (lcg->next() & 7), 0x6000, 8);
+      frame->VideoRedrawScreen();
+      return 1.0;
+    };
+    return workload;
+  }
+
+  // NTSC: cost of the scanner's per-cycle update (g_pFuncUpdateGraphicsScreen), without the frame's overhead
+  ab2::Workload createNTSCWorkload(const std::shared_ptr<ab2::HeadlessFrame> & frame, const VideoModeDesc & mode, const VideoTypeDesc & type)
+  {
+    const UINT cyclesPerStep = 1000;  // must be less than a frame
+    const std::shared_ptr<LCG> lcg = std::make_shared<LCG>();
+
+    ab2::Workload workload;
+    workload.name = std::string("ntsc/") + mode.name + "/" + type.name;
+    workload.unit = "ns/cycle";
+    workload.timePerUnit = true;
+    workload.setup = [frame, mode, type, lcg]()
+    {
+      ResetMachineState();
+      Video & video = GetVideo();
+      video.SetVideoType(type.type);
+      video.SetVideoStyle(type.style);
+      video.SetVideoMode(mode.flags);
+      frame->ApplyVideoModeChange();
+
+      fillVideoMemory(*lcg, 0x0400, 0x0C00, 1);
+      fillVideoMemory(*lcg, 0x2000, 0x6000, 1);
+    };
+    workload.step = [cyclesPerStep]()
+    {
+      NTSC_VideoUpdateCycles(cyclesPerStep);
+      return double(cyclesPerStep);
+    };
+    return workload;
+  }
+
+  //
+  // Memory: soft-switch paging
+  //
+
+  ab2::Workload createPagingWorkload(const std::string & name, const bool viaSoftSwitch)
+  {
+    const UINT callsPerStep = 1000;
+
+    ab2::Workload workload;
+    workload.name = name;
+    workload.unit = "ns/call";
+    workload.timePerUnit = true;
+    workload.setup = []()
+    {
+      ResetMachineState();
+    };
+    workload.step = [viaSoftSwitch, callsPerStep]()
+    {
+      for (UINT i = 0; i < callsPerStep; ++i)
+      {
+        if (viaSoftSwitch)
+        {
+          // RAMRDOFF / RAMRDON: a real mode change every time, so UpdatePaging() is never skipped
+          MemSetPaging(regs.pc, 0xC002 | (i & 1), 1, 0, 0);
+        }
+        else
+        {
+          MemUpdatePaging(FALSE);
+        }
+      }
+      return double(callsPerStep);
+    };
+    workload.teardown = []()
+    {
+      MemSetPaging(regs.pc, 0xC002, 1, 0, 0);
+    };
+    return workload;
+  }
+
+  //
+  // CPU: the CpuSetupBenchmark() opcode mix
+  //
+
+  ab2::Workload createCpuWorkload(const std::string & name, const eCpuType cpu, const bool bVideoUpdate, const bool bHeadless = false)
+  {
+    ab2::Workload workload;
+    workload.name = name;
+    workload.unit = "MHz";
+    workload.setup = [cpu, bHeadless]()
+    {
+      ResetMachineState();
+      SetMainCpu(cpu);
+      SetActiveCpu(cpu);
+      GetVideo().SetVideoMode(VF_HIRES);
+      GetVideo().VideoReinitialize(false);
+      NTSC_SetHeadless(bHeadless);
+    };
+    workload.begin = []()
+    {
+      CpuSetupBenchmark();
+    };
+    workload.step = [bVideoUpdate]()
+    {
+      return CpuExecute(CPU_SLICE_CYCLES, bVideoUpdate) / 1.0e6;
+    };
+    workload.teardown = []()
+    {
+      NTSC_SetHeadless(false);
+      SetMainCpuDefault(GetApple2Type());
+      SetActiveCpu(GetMainCpu());
+    };
+    return workload;
+  }
+
+  //
+  // Disk II: boot from power-on, for a fixed number of cycles
+  //
+
+  ab2::Workload createDiskBootWorkload(const std::string & name, const std::string & filename)
+  {
+    ab2::Workload workload;
+    workload.name = name;
+    workload.unit = "MHz";
+    workload.fixedWork = BOOT_MCYCLES;
+    workload.setup = [filename]()
+    {
+      Disk2InterfaceCard & card = dynamic_cast<Disk2InterfaceCard &>(GetCardMgr().GetRef(SLOT6));
+      const ImageError_e error = card.InsertDisk(DRIVE_1, filename, true, false);
+      if (error != eIMAGE_ERROR_NONE)
+      {
+        throw std::runtime_error("Cannot insert " + filename);
+      }
+    };
+    workload.begin = []()
+    {
+      ResetMachineState();
+    };
+    workload.step = []()
+    {
+      g_bFullSpeed = true;
+      return emulate(NTSC_GetCyclesPerFrame(), false);
+    };
+    workload.teardown = []()
+    {
+      g_bFullSpeed = false;
+      dynamic_cast<Disk2InterfaceCard &>(GetCardMgr().GetRef(SLOT6)).EjectDisk(DRIVE_1);
+    };
+    return workload;
+  }
+
+  //
+  // Mockingboard: both AY8913s playing tones & an envelope, with the tone period rewritten continuously
+  //
+
+  class Assembler
+  {
+  public:
+    void store(const WORD addr, const BYTE value)  // LDA #value : STA addr
+    {
+      myCode.insert(myCode.end(), {0xA9, value, 0x8D, BYTE(addr & 0xFF), BYTE(addr >> 8)});
+    }
+
+    void writeAY(const WORD via, const BYTE reg, const BYTE value)
+    {
+      const WORD ORB = via + 0;  // AY control: BDIR, BC1, /RESET
+      const WORD ORA = via + 1;  // AY data bus
+      store(ORA, reg);
+      store(ORB, 0x07);  // latch address
+      store(ORB, 0x04);  // inactive
+      store(ORA, value);
+      store(ORB, 0x06);  // write
+      store(ORB, 0x04);  // inactive
+    }
+
+    void emit(std::initializer_list<BYTE> bytes)
+    {
+      myCode.insert(myCode.end(), bytes);
+    }
+
+    const std::vector<BYTE> & code() const
+    {
+      return myCode;
+    }
+
+  private:
+    std::vector<BYTE> myCode;
+  };
+
+  const WORD MB_PROGRAM = 0x6000;
+
+  void loadMockingboardProgram()
+  {
+    const WORD vias[] = {0xC400, 0xC480};
+    const BYTE registers[][2] =
+    {
+      {0x00, 0x00}, {0x01, 0x01},  // tone A period
+      {0x02, 0x80}, {0x03, 0x01},  // tone B period
+      {0x04, 0xC0}, {0x05, 0x00},  // tone C period
+      {0x06, 0x10},                // noise period
+      {0x07, 0x30},                // mixer: tones on A,B,C, noise on A
+      {0x08, 0x0F}, {0x09, 0x0F},  // volume A, B
+      {0x0A, 0x10},                // volume C: envelope
+      {0x0B, 0x00}, {0x0C, 0x10},  // envelope period
+      {0x0D, 0x0E},                // envelope shape: triangle
+    };
+
+    Assembler a;
+    for (const WORD via : vias)
+    {
+      a.store(via + 3, 0xFF);  // DDRA
+      a.store(via + 2, 0x07);  // DDRB
+      a.store(via + 0, 0x00);  // reset
+      a.store(via + 0, 0x04);
+      for (const auto & reg : registers)
+      {
+        a.writeAY(via, reg[0], reg[1]);
+      }
+    }
+
+    // loop: sweep tone A's fine period on the 1st AY, with a delay between writes
+    const WORD loop = MB_PROGRAM + a.code().size();
+    a.emit({0xE8});                    // INX
+    a.store(0xC401, 0x00);             // latch reg 0
+    a.store(0xC400, 0x07);
+    a.store(0xC400, 0x04);
+    a.emit({0x8E, 0x01, 0xC4});        // STX $C401
+    a.store(0xC400, 0x06);
+    a.store(0xC400, 0x04);
+    a.emit({0xA0, 0x00});              // LDY #0
+    a.emit({0x88, 0xD0, 0xFD});        // DEY : BNE *-1
+    a.emit({0x4C, BYTE(loop & 0xFF), BYTE(loop >> 8)});  // JMP loop
+
+    const std::vector<BYTE> & code = a.code();
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+      *MemGetMainPtr(MB_PROGRAM + i) = code[i];
+    }
+  }
+
+  ab2::Workload createMockingboardWorkload()
+  {
+    ab2::Workload workload;
+    workload.name = "mockingboard/playback";
+    workload.unit = "MHz";
+    workload.setup = []()
+    {
+      if (GetCardMgr().QuerySlot(SLOT4) != CT_MockingboardC)
+      {
+        throw std::runtime_error("No Mockingboard in slot 4");
+      }
+      ResetMachineState();
+      loadMockingboardProgram();
+      regs.pc = MB_PROGRAM;
+      // render the AY8913s in emulated time, independently of the sound device
+      MB_SetFullSpeedAudio(true);
+    };
+    workload.step = []()
+    {
+      g_bFullSpeed = true;
+      return emulate(NTSC_GetCyclesPerFrame(), false);
+    };
+    workload.teardown = []()
+    {
+      g_bFullSpeed = false;
+      MB_SetFullSpeedAudio(false);
+    };
+    return workload;
+  }
+
+  //
+  // HDD: random 512-byte block reads from a .hdv image
+  //
+
+  ab2::Workload createHarddiskWorkload()
+  {
+    const UINT numBlocks = 2048;  // 1MB
+    const UINT blocksPerStep = 64;
+
+    struct State
+    {
+      std::string filename;
+      ImageInfo * imageInfo = nullptr;
+      LCG lcg;
+    };
+    const std::shared_ptr<State> state = std::make_shared<State>();
+
+    ab2::Workload workload;
+    workload.name = "hdd/read";
+    workload.unit = "blocks/s";
+    workload.setup = [state, numBlocks]()
+    {
+      state->filename = createTemporaryFile(".hdv", numBlocks * HD_BLOCK_SIZE);
+      bool writeProtected = false;
+      std::string filenameInZip;
+      const ImageError_e error = ImageOpen(state->filename, &state->imageInfo, &writeProtected, false, filenameInZip, false);
+      if (error != eIMAGE_ERROR_NONE)
+      {
+        throw std::runtime_error("Cannot open " + state->filename);
+      }
+    };
+    workload.step = [state, numBlocks, blocksPerStep]()
+    {
+      BYTE buffer[HD_BLOCK_SIZE];
+      for (UINT i = 0; i < blocksPerStep; ++i)
+      {
+        const UINT block = ((state->lcg.next() << 8) | state->lcg.next()) % numBlocks;
+        ImageReadBlock(state->imageInfo, block, buffer);
+      }
+      return double(blocksPerStep);
+    };
+    workload.teardown = [state]()
+    {
+      ImageClose(state->imageInfo);
+      state->imageInfo = nullptr;
+      unlink(state->filename.c_str());
+    };
+    return workload;
+  }
+
+  //
+  // Save-state
+  //
+
+  ab2::Workload createSnapshotWorkload(const bool save)
+  {
+    const std::shared_ptr<std::string> filename = std::make_shared<std::string>();
+
+    ab2::Workload workload;
+    workload.name = save ? "snapshot/save" : "snapshot/load";
+    workload.unit = "ops/s";
+    workload.setup = [filename]()
+    {
+      ResetMachineState();
+      *filename = createTemporaryFile(".aws.yaml", 0);
+      Snapshot_SetFilename(*filename);
+      Snapshot_SaveState();
+    };
+    workload.step = [save]()
+    {
+      if (save)
+      {
+        Snapshot_SaveState();
+      }
+      else
+      {
+        Snapshot_LoadState();
+      }
+      return 1.0;
+    };
+    workload.teardown = [filename]()
+    {
+      unlink(filename->c_str());
+    };
+    return workload;
+  }
+
+  //
+  // Movie: replay of a recording, headless and at full speed, verifying the checkpoints
+  //
+
+  ab2::Workload createMovieWorkload(const std::string & filename)
+  {
+    const size_t pos = filename.find_last_of('/');
+
+    ab2::Workload workload;
+    workload.name = "movie/" + (pos == std::string::npos ? filename : filename.substr(pos + 1));
+    workload.unit = "MHz";
+    workload.begin = [filename]()
+    {
+      if (!MovieStartPlayback(filename))
+      {
+        throw std::runtime_error("Cannot play " + filename);
+      }
+    };
+    workload.step = []()
+    {
+      g_bFullSpeed = true;
+      const double mcycles = emulate(CPU_SLICE_CYCLES, false);
+
+      MovieStats stats;
+      MovieGetStats(stats);
+      if (stats.mismatches)
+      {
+        MovieStop();
+        throw std::runtime_error("Checkpoint mismatch at cycle " + std::to_string(stats.firstMismatchCycle));
+      }
+      return mcycles;
+    };
+    workload.finished = []()
+    {
+      return !MovieIsPlaying();
+    };
+    workload.teardown = []()
+    {
+      g_bFullSpeed = false;
+      MovieStop();
+    };
+    return workload;
+  }
+
+}
+
+namespace ab2
+{
+
+  std::vector<Workload> createWorkloads(const std::shared_ptr<HeadlessFrame> & frame, const WorkloadOptions & options)
+  {
+    std::vector<Workload> workloads;
+
+    for (const VideoModeDesc & mode : ourVideoModes)
+    {
+      for (const VideoTypeDesc & type : ourVideoTypes)
+      {
+        workloads.push_back(createVideoWorkload(frame, mode, type));
+      }
+    }
+
+    for (const VideoModeDesc & mode : ourVideoModes)
+    {
+      for (const VideoTypeDesc & type : ourVideoTypes)
+      {
+        workloads.push_back(createNTSCWorkload(frame, mode, type));
+      }
+    }
+
+    workloads.push_back(createPagingWorkload("memory/mem-set-paging", true));
+    workloads.push_back(createPagingWorkload("memory/update-paging", false));
+
+    workloads.push_back(createCpuWorkload("cpu/6502", CPU_6502, false));
+    workloads.push_back(createCpuWorkload("cpu/65c02", CPU_65C02, false));
+    workloads.push_back(createCpuWorkload("cpu/65c02+video", CPU_65C02, true));
+    workloads.push_back(createCpuWorkload("cpu/65c02+headless", CPU_65C02, true, true));
+
+    if (!options.dsk.empty())
+    {
+      workloads.push_back(createDiskBootWorkload("disk2/boot-dsk", options.dsk));
+    }
+    if (!options.woz.empty())
+    {
+      workloads.push_back(createDiskBootWorkload("disk2/boot-woz", options.woz));
+    }
+
+    workloads.push_back(createMockingboardWorkload());
+    workloads.push_back(createHarddiskWorkload());
+    workloads.push_back(createSnapshotWorkload(true));
+    workloads.push_back(createSnapshotWorkload(false));
+
+    if (!options.movie.empty())
+    {
+      workloads.push_back(createMovieWorkload(options.movie));
+    }
+
+    return workloads;
+  }
+
+}
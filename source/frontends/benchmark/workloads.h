@@ -0,0 +1,23 @@
+#pragma once
+
+#include "frontends/benchmark/runner.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ab2
+{
+
+  class HeadlessFrame;
+
+  struct WorkloadOptions
+  {
+    std::string dsk;  // Disk II boot workloads are skipped if the image is not given
+    std::string woz;
+    std::string movie;  // replayed (and verified) by movie/<name>
+  };
+
+  std::vector<Workload> createWorkloads(const std::shared_ptr<HeadlessFrame> & frame, const WorkloadOptions & options);
+
+}
@@ -0,0 +1,399 @@
+#include "StdAfx.h"
+#include "frontends/common2/capture.h"
+#include "frontends/common2/programoptions.h"
+
+#include "Common.h"
+#include "CPU.h"
+#include "Core.h"
+#include "Interface.h"
+#include "Mockingboard.h"
+#include "NTSC.h"
+#include "Speaker.h"
+#include "Video.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+  const size_t maximumQueue = 16;               // items, about 16 frames (and their audio)
+  const size_t maximumAudioLag = SPKR_SAMPLE_RATE / 4;  // before a source which is behind is assumed to be silent
+  const uint64_t maximumFrameLag = 60;          // frames, larger jumps (e.g. a snapshot was loaded) restart the frame clock
+
+  uint64_t hashPixels(const std::vector<uint8_t> & pixels)
+  {
+    // FNV-1a on 64 bit words
+    const uint64_t * words = reinterpret_cast<const uint64_t *>(pixels.data());
+    const size_t n = pixels.size() / sizeof(uint64_t);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < n; ++i)
+    {
+      hash ^= words[i];
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  void writeUint(FILE * file, const uint32_t value, const size_t size)
+  {
+    uint8_t bytes[4];
+    for (size_t i = 0; i < size; ++i)
+    {
+      bytes[i] = uint8_t(value >> (8 * i));
+    }
+    fwrite(bytes, 1, size, file);
+  }
+
+  void writeWavHeader(FILE * file, const uint32_t dataBytes)
+  {
+    const uint32_t channels = 2;
+    fwrite("RIFF", 1, 4, file);
+    writeUint(file, 36 + dataBytes, 4);
+    fwrite("WAVEfmt ", 1, 8, file);
+    writeUint(file, 16, 4);
+    writeUint(file, 1, 2);  // PCM
+    writeUint(file, channels, 2);
+    writeUint(file, SPKR_SAMPLE_RATE, 4);
+    writeUint(file, SPKR_SAMPLE_RATE * channels * sizeof(int16_t), 4);
+    writeUint(file, channels * sizeof(int16_t), 2);
+    writeUint(file, 16, 2);
+    fwrite("data", 1, 4, file);
+    writeUint(file, dataBytes, 4);
+  }
+
+  int16_t clampSample(const int value)
+  {
+    return int16_t(std::max(-32768, std::min(32767, value)));
+  }
+
+}
+
+namespace common2
+{
+
+  Capture::Capture(const std::string & videoFilename, const std::string & audioFilename, const bool vfr)
+    : myVFR(vfr)
+    , myNextFrameCycle(0)
+    , myFrame(0)
+    , myLastHash(0)
+    , myHasLastFrame(false)
+    , myMockingboardActive(false)
+    , myPreviousFullSpeedAudio(MB_GetFullSpeedAudio())
+    , myVideoFile(nullptr)
+    , myTimestampsFile(nullptr)
+    , myAudioFile(nullptr)
+    , myAudioBytes(0)
+    , myWidth(0)
+    , myHeight(0)
+    , myMsPerFrame(0.0)
+    , myStop(false)
+  {
+    if (!videoFilename.empty())
+    {
+      Video & video = GetVideo();
+      myWidth = video.GetFrameBufferBorderlessWidth();
+      myHeight = video.GetFrameBufferBorderlessHeight();
+
+      const UINT cyclesPerFrame = NTSC_GetCyclesPerFrame();
+      myMsPerFrame = 1000.0 * cyclesPerFrame / g_fCurrentCLK6502;
+      myNextFrameCycle = g_nCumulativeCycles + NTSC_GetCyclesUntilVBlank(0);
+
+      myVideoFile = fopen(videoFilename.c_str(), "wb");
+      if (!myVideoFile)
+      {
+        throw std::runtime_error("Cannot create " + videoFilename);
+      }
+      // 4:4:4 to keep the NTSC colour artefacts, BT.601
+      fprintf(myVideoFile, "YUV4MPEG2 W%zu H%zu F%u:%u Ip A1:1 C444\n", myWidth, myHeight, UINT(g_fCurrentCLK6502 + 0.5), cyclesPerFrame);
+
+      if (myVFR)
+      {
+        const std::string timestampsFilename = videoFilename + ".timestamps";
+        myTimestampsFile = fopen(timestampsFilename.c_str(), "w");
+        if (!myTimestampsFile)
+        {
+          fclose(myVideoFile);
+          throw std::runtime_error("Cannot create " + timestampsFilename);
+        }
+        fprintf(myTimestampsFile, "# timecode format v2\n");
+      }
+    }
+
+    if (!audioFilename.empty())
+    {
+      myAudioFile = fopen(audioFilename.c_str(), "wb");
+      if (!myAudioFile)
+      {
+        if (myVideoFile)
+        {
+          fclose(myVideoFile);
+        }
+        if (myTimestampsFile)
+        {
+          fclose(myTimestampsFile);
+        }
+        throw std::runtime_error("Cannot create " + audioFilename);
+      }
+      writeWavHeader(myAudioFile, 0);  // the sizes are filled in at the end
+
+      Spkr_SetAudioCapture(speakerCallback, this);
+      MB_SetAudioCapture(mockingboardCallback, this);
+      // render the Mockingboard in emulated time, also when full speed
+      MB_SetFullSpeedAudio(true);
+    }
+
+    myThread = std::thread(&Capture::writerThread, this);
+  }
+
+  Capture::~Capture()
+  {
+    if (myAudioFile)
+    {
+      Spkr_SetAudioCapture(nullptr, nullptr);
+      MB_SetAudioCapture(nullptr, nullptr);
+      MB_SetFullSpeedAudio(myPreviousFullSpeedAudio);
+      mixAudio(true);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(myMutex);
+      myStop = true;
+    }
+    myNotEmpty.notify_one();
+    myThread.join();
+
+    if (myVideoFile)
+    {
+      fclose(myVideoFile);
+    }
+    if (myTimestampsFile)
+    {
+      fclose(myTimestampsFile);
+    }
+    if (myAudioFile)
+    {
+      fseek(myAudioFile, 0, SEEK_SET);
+      writeWavHeader(myAudioFile, uint32_t(myAudioBytes));
+      fclose(myAudioFile);
+    }
+  }
+
+  void Capture::update(const bool videoUpdated)
+  {
+    if (myVideoFile)
+    {
+      const uint64_t cyclesPerFrame = NTSC_GetCyclesPerFrame();
+      const uint64_t now = g_nCumulativeCycles;
+
+      if (now + cyclesPerFrame < myNextFrameCycle || now > myNextFrameCycle + maximumFrameLag * cyclesPerFrame)
+      {
+        myNextFrameCycle = now + NTSC_GetCyclesUntilVBlank(0);
+      }
+
+      if (now >= myNextFrameCycle)
+      {
+        if (!videoUpdated)
+        {
+          NTSC_VideoRedrawWholeScreen();
+        }
+
+        // if the last slice spanned more than 1 frame, the others are repeats
+        do
+        {
+          captureFrame();
+          myNextFrameCycle += cyclesPerFrame;
+        } while (now >= myNextFrameCycle);
+      }
+    }
+
+    if (myAudioFile)
+    {
+      mixAudio(false);
+    }
+  }
+
+  const Capture::Stats & Capture::getStats() const
+  {
+    return myStats;
+  }
+
+  void Capture::captureFrame()
+  {
+    Item item;
+    item.type = Item::FRAME;
+    item.frame = myFrame++;
+    ++myStats.frames;
+
+    Video & video = GetVideo();
+    const size_t stride = video.GetFrameBufferWidth();
+    const uint32_t * framebuffer = reinterpret_cast<const uint32_t *>(video.GetFrameBuffer());
+
+    item.pixels.resize(myWidth * myHeight * sizeof(uint32_t));
+    uint32_t * pixels = reinterpret_cast<uint32_t *>(item.pixels.data());
+
+    // the framebuffer is bottom-up
+    const uint32_t * row = framebuffer + (video.GetFrameBufferBorderHeight() + myHeight - 1) * stride + video.GetFrameBufferBorderWidth();
+    for (size_t y = 0; y < myHeight; ++y, row -= stride, pixels += myWidth)
+    {
+      std::copy(row, row + myWidth, pixels);
+    }
+
+    const uint64_t hash = hashPixels(item.pixels);
+    if (myHasLastFrame && hash == myLastHash)
+    {
+      ++myStats.duplicates;
+      if (myVFR)
+      {
+        return;
+      }
+      item.type = Item::REPEAT;
+      item.pixels.clear();
+    }
+
+    myLastHash = hash;
+    myHasLastFrame = true;
+    push(std::move(item));
+  }
+
+  void Capture::speakerCallback(const short * samples, uint32_t numSamples, void * context)
+  {
+    Capture * capture = static_cast<Capture *>(context);
+    capture->mySpeaker.insert(capture->mySpeaker.end(), samples, samples + numSamples);
+  }
+
+  void Capture::mockingboardCallback(const short * samples, uint32_t numSamples, void * context)
+  {
+    Capture * capture = static_cast<Capture *>(context);
+    capture->myMockingboard.insert(capture->myMockingboard.end(), samples, samples + 2 * numSamples);
+    capture->myMockingboardActive = true;
+  }
+
+  void Capture::mixAudio(const bool flush)
+  {
+    // both sources run on the emulated clock, but are not updated at the same time:
+    // only mix what is available from both, unless one of them has stopped
+    const size_t speaker = mySpeaker.size();
+    const size_t mockingboard = myMockingboard.size() / 2;
+    const size_t longest = std::max(speaker, mockingboard);
+
+    size_t n = myMockingboardActive ? std::min(speaker, mockingboard) : speaker;
+    if (flush || longest > maximumAudioLag)
+    {
+      n = longest;
+    }
+
+    if (n == 0)
+    {
+      return;
+    }
+
+    Item item;
+    item.type = Item::AUDIO;
+    item.frame = 0;
+    item.samples.resize(2 * n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      const int s = i < speaker ? mySpeaker[i] : 0;
+      const int left = i < mockingboard ? myMockingboard[2 * i] : 0;
+      const int right = i < mockingboard ? myMockingboard[2 * i + 1] : 0;
+      item.samples[2 * i] = clampSample(s + left);
+      item.samples[2 * i + 1] = clampSample(s + right);
+    }
+
+    mySpeaker.erase(mySpeaker.begin(), mySpeaker.begin() + std::min(n, speaker));
+    myMockingboard.erase(myMockingboard.begin(), myMockingboard.begin() + 2 * std::min(n, mockingboard));
+    myStats.audioSamples += n;
+
+    push(std::move(item));
+  }
+
+  void Capture::push(Item && item)
+  {
+    {
+      std::unique_lock<std::mutex> lock(myMutex);
+      myNotFull.wait(lock, [this] { return myQueue.size() < maximumQueue; });
+      myQueue.push_back(std::move(item));
+    }
+    myNotEmpty.notify_one();
+  }
+
+  void Capture::writerThread()
+  {
+    for (;;)
+    {
+      Item item;
+      {
+        std::unique_lock<std::mutex> lock(myMutex);
+        myNotEmpty.wait(lock, [this] { return myStop || !myQueue.empty(); });
+        if (myQueue.empty())
+        {
+          break;
+        }
+        item = std::move(myQueue.front());
+        myQueue.pop_front();
+      }
+      myNotFull.notify_one();
+
+      if (item.type == Item::AUDIO)
+      {
+        writeAudio(item);
+      }
+      else
+      {
+        writeFrame(item);
+      }
+    }
+  }
+
+  void Capture::writeFrame(const Item & item)
+  {
+    const size_t size = myWidth * myHeight;
+
+    if (item.type == Item::FRAME)
+    {
+      myYUV.resize(3 * size);
+      uint8_t * yPlane = myYUV.data();
+      uint8_t * uPlane = yPlane + size;
+      uint8_t * vPlane = uPlane + size;
+
+      const uint8_t * pixel = item.pixels.data();
+      for (size_t i = 0; i < size; ++i, pixel += 4)
+      {
+        // bgra_t
+        const int b = pixel[0];
+        const int g = pixel[1];
+        const int r = pixel[2];
+        yPlane[i] = uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        uPlane[i] = uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        vPlane[i] = uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      }
+    }
+
+    fputs("FRAME\n", myVideoFile);
+    fwrite(myYUV.data(), 1, myYUV.size(), myVideoFile);
+
+    if (myTimestampsFile)
+    {
+      fprintf(myTimestampsFile, "%.3f\n", item.frame * myMsPerFrame);
+    }
+  }
+
+  void Capture::writeAudio(const Item & item)
+  {
+    // WAV is little-endian, as are all the hosts we build for
+    const size_t bytes = item.samples.size() * sizeof(int16_t);
+    fwrite(item.samples.data(), 1, bytes, myAudioFile);
+    myAudioBytes += bytes;
+  }
+
+  std::shared_ptr<Capture> createCapture(const EmulatorOptions & options)
+  {
+    if (options.captureVideoFilename.empty() && options.captureAudioFilename.empty())
+    {
+      return std::shared_ptr<Capture>();
+    }
+    return std::make_shared<Capture>(options.captureVideoFilename, options.captureAudioFilename, options.captureVFR);
+  }
+
+}
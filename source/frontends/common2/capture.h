@@ -0,0 +1,101 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace common2
+{
+
+  struct EmulatorOptions;
+
+  // Streams the emulated video (one frame per Apple frame, as Y4M) and the mixed speaker & Mockingboard audio (as WAV).
+  //
+  // Everything is timed on the emulated clock, so it works the same at full speed and headless.
+  // The emulation thread only copies the framebuffer: the colour conversion and the file I/O are done
+  // by a background thread, fed through a bounded queue (the emulation waits if the writer falls behind, nothing is dropped).
+  //
+  // Identical consecutive frames are detected by hash and not converted again.
+  // With "vfr" they are not written at all, and the presentation time of each written frame goes to
+  // FILE.timestamps (mkvmerge "timecode format v2").
+  class Capture
+  {
+  public:
+    struct Stats
+    {
+      uint64_t frames = 0;
+      uint64_t duplicates = 0;
+      uint64_t audioSamples = 0;
+    };
+
+    Capture(const std::string & videoFilename, const std::string & audioFilename, const bool vfr);
+    ~Capture();
+
+    // call after each CpuExecute()
+    // videoUpdated: if false, the screen is redrawn before it is captured
+    void update(const bool videoUpdated);
+
+    const Stats & getStats() const;
+
+  private:
+    struct Item
+    {
+      enum Type { FRAME, REPEAT, AUDIO };
+      Type type;
+      uint64_t frame;                     // index, for the timestamps
+      std::vector<uint8_t> pixels;        // FRAME: BGRA, top row first
+      std::vector<int16_t> samples;       // AUDIO: stereo
+    };
+
+    static void speakerCallback(const short * samples, uint32_t numSamples, void * context);
+    static void mockingboardCallback(const short * samples, uint32_t numSamples, void * context);
+
+    void captureFrame();
+    void mixAudio(const bool flush);
+    void push(Item && item);
+
+    void writerThread();
+    void writeFrame(const Item & item);
+    void writeAudio(const Item & item);
+
+    const bool myVFR;
+
+    // emulation thread
+    uint64_t myNextFrameCycle;
+    uint64_t myFrame;
+    uint64_t myLastHash;
+    bool myHasLastFrame;
+    std::vector<int16_t> mySpeaker;       // mono
+    std::vector<int16_t> myMockingboard;  // stereo
+    bool myMockingboardActive;
+    bool myPreviousFullSpeedAudio;        // restored at the end
+    Stats myStats;
+
+    // writer thread
+    FILE * myVideoFile;
+    FILE * myTimestampsFile;
+    FILE * myAudioFile;
+    uint64_t myAudioBytes;
+    size_t myWidth;
+    size_t myHeight;
+    double myMsPerFrame;
+    std::vector<uint8_t> myYUV;           // last frame, Y, U & V planes
+
+    std::mutex myMutex;
+    std::condition_variable myNotEmpty;
+    std::condition_variable myNotFull;
+    std::deque<Item> myQueue;
+    bool myStop;
+    std::thread myThread;
+  };
+
+  // nullptr if no capture was requested
+  std::shared_ptr<Capture> createCapture(const EmulatorOptions & options);
+
+}
@@ -8,6 +8,7 @@
 #include <unistd.h>
 
 #include "Log.h"
+#include "Movie.h"
 #include "SaveState.h"
 
 namespace common2
@@ -18,6 +19,19 @@ namespace common2
     Snapshot_LoadState();
   }
 
+  bool CommonFrame::StartMovie(const std::string & recordFilename, const std::string & playFilename)
+  {
+    if (!playFilename.empty())
+    {
+      return MovieStartPlayback(playFilename);
+    }
+    else if (!recordFilename.empty())
+    {
+      return MovieStartRecording(recordFilename);
+    }
+    return true;
+  }
+
   BYTE* CommonFrame::GetResource(WORD id, LPCSTR lpType, DWORD expectedSize)
   {
     myResource.clear();
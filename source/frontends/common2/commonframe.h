@@ -12,6 +12,8 @@ namespace common2
   public:
     BYTE* GetResource(WORD id, LPCSTR lpType, DWORD expectedSize) override;
     virtual void LoadSnapshot();
+    // record or play (at most one of them non empty)
+    virtual bool StartMovie(const std::string & recordFilename, const std::string & playFilename);
 
   protected:
     virtual std::string getResourcePath(const std::string & filename) = 0;
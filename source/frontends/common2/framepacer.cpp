@@ -0,0 +1,197 @@
+#include "StdAfx.h"
+#include "frontends/common2/framepacer.h"
+
+#include "CPU.h"
+#include "Core.h"
+#include "NTSC.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+  const size_t minimumSamples = 30;             // before trusting the measured interval
+  const double emaWeight = 1.0 / 16.0;
+  const double maximumJitter = 0.1;             // as a fraction of the interval
+  const double integerRatioTolerance = 0.005;   // largest clock adjustment, 5000 ppm
+  const size_t maximumCatchUp = 4;              // refreshes executed after a stall
+  const double minimumRefreshHz = 24.0;
+  const double maximumRefreshHz = 500.0;
+
+  // if x is within tolerance of an integer n >= 1, return n, otherwise 0
+  size_t closeToInteger(const double x)
+  {
+    const double n = std::round(x);
+    if (n >= 1.0 && std::fabs(x - n) <= n * integerRatioTolerance)
+    {
+      return static_cast<size_t>(n);
+    }
+    return 0;
+  }
+
+}
+
+namespace common2
+{
+
+  FramePacer::FramePacer(const bool enabled)
+    : myEnabled(enabled)
+    , myHasLastPresent(false)
+    , myInterval(0.0)
+    , myJitter(0.0)
+    , mySamples(0)
+    , myConsecutiveLate(0)
+    , myPendingRefreshes(1)
+    , myCyclesPerRefresh(0.0)
+    , myTargetCycles(0.0)
+    , myHasTarget(false)
+  {
+  }
+
+  void FramePacer::reset()
+  {
+    myHasLastPresent = false;
+    myPendingRefreshes = 1;
+    myHasTarget = false;
+  }
+
+  void FramePacer::framePresented()
+  {
+    const auto now = std::chrono::steady_clock::now();
+
+    if (myHasLastPresent)
+    {
+      const double delta = std::chrono::duration<double, std::micro>(now - myLastPresent).count();
+
+      ++myStats.frames;
+      myStats.maxIntervalMs = std::max(myStats.maxIntervalMs, delta / 1000.0);
+
+      if (mySamples < minimumSamples)
+      {
+        // plain average to start with
+        myInterval = (myInterval * mySamples + delta) / (mySamples + 1);
+        myJitter = (myJitter * mySamples + std::fabs(delta - myInterval)) / (mySamples + 1);
+        ++mySamples;
+        myPendingRefreshes = 1;
+      }
+      else
+      {
+        const double refreshes = std::round(delta / myInterval);
+        if (refreshes <= 1.0 || !myStats.locked)
+        {
+          // once locked, only on-time presents update the estimate, the late ones are outliers
+          myJitter += (std::fabs(delta - myInterval) - myJitter) * emaWeight;
+          myInterval += (delta - myInterval) * emaWeight;
+          myPendingRefreshes = 1;
+          myConsecutiveLate = 0;
+        }
+        else if (++myConsecutiveLate >= minimumSamples)
+        {
+          // the refresh rate has changed (e.g. the window moved to a different display): measure again
+          mySamples = 0;
+          myInterval = 0.0;
+          myJitter = 0.0;
+          myConsecutiveLate = 0;
+          myPendingRefreshes = 1;
+        }
+        else
+        {
+          myStats.missed += static_cast<uint64_t>(refreshes) - 1;
+          myPendingRefreshes = std::min(static_cast<size_t>(refreshes), maximumCatchUp);
+        }
+      }
+
+      updateLock();
+    }
+
+    myLastPresent = now;
+    myHasLastPresent = true;
+  }
+
+  void FramePacer::updateLock()
+  {
+    myStats.refreshHz = myInterval > 0.0 ? 1.0e6 / myInterval : 0.0;
+
+    const bool stable = myEnabled && mySamples >= minimumSamples
+      && myStats.refreshHz >= minimumRefreshHz && myStats.refreshHz <= maximumRefreshHz
+      && myJitter <= myInterval * maximumJitter;
+
+    if (!stable)
+    {
+      myStats.locked = false;
+      myStats.exact = false;
+      myStats.clockAdjustPpm = 0.0;
+      return;
+    }
+
+    const double cyclesPerFrame = NTSC_GetCyclesPerFrame();
+    const double appleHz = g_fCurrentCLK6502 / cyclesPerFrame;
+    const double ratio = myStats.refreshHz / appleHz;
+
+    const size_t refreshesPerFrame = closeToInteger(ratio);
+    const size_t framesPerRefresh = closeToInteger(1.0 / ratio);
+
+    if (refreshesPerFrame)
+    {
+      // e.g. 60Hz, 120Hz: each Apple frame spans exactly n refreshes
+      myCyclesPerRefresh = cyclesPerFrame / refreshesPerFrame;
+      myStats.exact = true;
+    }
+    else if (framesPerRefresh)
+    {
+      // e.g. 30Hz: n Apple frames per refresh
+      myCyclesPerRefresh = cyclesPerFrame * framesPerRefresh;
+      myStats.exact = true;
+    }
+    else
+    {
+      // e.g. 144Hz: there is no cadence to lock to, but every refresh still gets the same slice
+      myCyclesPerRefresh = g_fCurrentCLK6502 / myStats.refreshHz;
+      myStats.exact = false;
+    }
+
+    myStats.locked = true;
+    myStats.clockAdjustPpm = (myCyclesPerRefresh * myStats.refreshHz / g_fCurrentCLK6502 - 1.0) * 1.0e6;
+  }
+
+  bool FramePacer::isLocked() const
+  {
+    return myStats.locked;
+  }
+
+  uint64_t FramePacer::getCyclesTillNextPresent()
+  {
+    const uint64_t currentCycles = g_nCumulativeCycles;
+    if (!myHasTarget)
+    {
+      myTargetCycles = static_cast<double>(currentCycles);
+      myHasTarget = true;
+    }
+
+    myTargetCycles += myCyclesPerRefresh * myPendingRefreshes;
+    myPendingRefreshes = 1;
+
+    const uint64_t targetCycles = static_cast<uint64_t>(myTargetCycles);
+    if (targetCycles > currentCycles)
+    {
+      return targetCycles - currentCycles;
+    }
+    else
+    {
+      // we got ahead (CpuExecute completes the last instruction)
+      return 0;
+    }
+  }
+
+  size_t FramePacer::getRefreshIntervalInMicroseconds() const
+  {
+    return mySamples >= minimumSamples ? static_cast<size_t>(myInterval) : 0;
+  }
+
+  const FramePacer::Stats & FramePacer::getStats() const
+  {
+    return myStats;
+  }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace common2
+{
+
+  // Schedules emulation against the display refresh, measured from the timestamps of the presents.
+  //
+  // Once the refresh interval is stable, each refresh gets a fixed budget of cycles
+  // (instead of a budget derived from the wall clock), so every present shows the same amount of emulated time.
+  // If the display and Apple video rates are close to an integer ratio (e.g. 59.92Hz on 60Hz or 120Hz)
+  // the emulated clock is adjusted by a tiny amount, so that each Apple frame lasts an exact number of refreshes.
+  //
+  // It only makes sense if the present blocks on vsync.
+  class FramePacer
+  {
+  public:
+    struct Stats
+    {
+      uint64_t frames = 0;
+      uint64_t missed = 0;        // refreshes with no present
+      double maxIntervalMs = 0.0;
+      double refreshHz = 0.0;     // measured
+      bool locked = false;
+      bool exact = false;         // integer ratio with the Apple video rate
+      double clockAdjustPpm = 0.0;
+    };
+
+    FramePacer(const bool enabled);
+
+    // forget the timestamp of the last present (after a pause, full speed...)
+    void reset();
+
+    // call immediately after the present returns
+    void framePresented();
+
+    bool isLocked() const;
+
+    // cycles to execute before the next present, including the refreshes missed since the last one
+    uint64_t getCyclesTillNextPresent();
+
+    // measured, 0 if unknown
+    size_t getRefreshIntervalInMicroseconds() const;
+
+    const Stats & getStats() const;
+
+  private:
+    void updateLock();
+
+    const bool myEnabled;
+
+    std::chrono::time_point<std::chrono::steady_clock> myLastPresent;
+    bool myHasLastPresent;
+
+    double myInterval;          // us, EMA of the refresh interval
+    double myJitter;            // us, EMA of the deviation from myInterval
+    size_t mySamples;
+    size_t myConsecutiveLate;
+    size_t myPendingRefreshes;
+
+    double myCyclesPerRefresh;
+    double myTargetCycles;      // g_nCumulativeCycles at the next present, so the CPU overshoot does not accumulate
+    bool myHasTarget;
+
+    Stats myStats;
+  };
+
+}
@@ -0,0 +1,203 @@
+#include "StdAfx.h"
+#include "frontends/common2/gdbpacket.h"
+
+#include <algorithm>
+
+namespace
+{
+
+  const char hexDigits[] = "0123456789abcdef";
+  const char vContPrefix[] = "vCont;";
+
+}
+
+namespace common2
+{
+  namespace gdb
+  {
+
+    void appendHex(std::string & s, const uint8_t value)
+    {
+      s += hexDigits[value >> 4];
+      s += hexDigits[value & 0x0f];
+    }
+
+    int hexValue(const char c)
+    {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      return -1;
+    }
+
+    uint32_t parseHex(const std::string & s, size_t & pos)
+    {
+      uint32_t value = 0;
+      int digit;
+      while (pos < s.size() && (digit = hexValue(s[pos])) >= 0)
+      {
+        value = (value << 4) | digit;
+        ++pos;
+      }
+      return value;
+    }
+
+    bool parseHexBytes(const std::string & s, const size_t pos, std::vector<uint8_t> & data)
+    {
+      if (pos > s.size() || (s.size() - pos) % 2)
+      {
+        return false;
+      }
+      data.clear();
+      for (size_t i = pos; i < s.size(); i += 2)
+      {
+        const int high = hexValue(s[i]);
+        const int low = hexValue(s[i + 1]);
+        if (high < 0 || low < 0)
+        {
+          return false;
+        }
+        data.push_back(uint8_t((high << 4) | low));
+      }
+      return true;
+    }
+
+    bool parseAddressLength(const std::string & s, size_t & pos, uint32_t & address, uint32_t & length, const char separator)
+    {
+      address = parseHex(s, pos);
+      if (pos >= s.size() || s[pos] != ',')
+      {
+        return false;
+      }
+      ++pos;
+      length = parseHex(s, pos);
+      if (separator)
+      {
+        if (pos >= s.size() || s[pos] != separator)
+        {
+          return false;
+        }
+        ++pos;
+      }
+      return true;
+    }
+
+    uint8_t checksum(const std::string & payload)
+    {
+      uint8_t sum = 0;
+      for (const char c : payload)
+      {
+        sum += uint8_t(c);
+      }
+      return sum;
+    }
+
+    std::string makePacket(const std::string & payload)
+    {
+      std::string packet;
+      packet.reserve(payload.size() + 4);
+      packet += '$';
+      packet += payload;
+      packet += '#';
+      appendHex(packet, checksum(payload));
+      return packet;
+    }
+
+    Token readToken(const std::string & input, size_t & pos, std::string & payload)
+    {
+      if (pos >= input.size())
+      {
+        return Token::Incomplete;
+      }
+
+      const char c = input[pos];
+      if (c == '$')
+      {
+        // binary data has '#' escaped
+        const size_t hash = input.find('#', pos + 1);
+        if (hash == std::string::npos || hash + 2 >= input.size())
+        {
+          return Token::Incomplete;
+        }
+        payload = input.substr(pos + 1, hash - pos - 1);
+        const int high = hexValue(input[hash + 1]);
+        const int low = hexValue(input[hash + 2]);
+        pos = hash + 3;
+        return (high >= 0 && low >= 0 && ((high << 4) | low) == checksum(payload)) ? Token::Packet : Token::BadChecksum;
+      }
+
+      ++pos;
+      switch (c)
+      {
+      case '\x03':
+        return Token::Interrupt;
+      case '-':
+        return Token::Nack;
+      default:
+        return Token::Other;
+      }
+    }
+
+    void unescapeBinary(const std::string & s, size_t pos, std::vector<uint8_t> & data)
+    {
+      data.clear();
+      for (; pos < s.size(); ++pos)
+      {
+        if (s[pos] == 0x7d && pos + 1 < s.size())
+        {
+          data.push_back(uint8_t(s[++pos] ^ 0x20));
+        }
+        else
+        {
+          data.push_back(uint8_t(s[pos]));
+        }
+      }
+    }
+
+    bool parseVCont(const std::string & packet, bool & step)
+    {
+      const size_t pos = sizeof(vContPrefix) - 1;
+      if (packet.compare(0, pos, vContPrefix) != 0)
+      {
+        return false;
+      }
+      switch (pos < packet.size() ? packet[pos] : 0)
+      {
+      case 'c':
+      case 'C':
+        step = false;
+        return true;
+      case 's':
+      case 'S':
+        step = true;
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    bool parseBreakpoint(const std::string & packet, Breakpoint & bp)
+    {
+      if (packet.empty() || (packet[0] != 'Z' && packet[0] != 'z'))
+      {
+        return false;
+      }
+
+      size_t pos = 1;
+      bp.type = int(parseHex(packet, pos));
+      if (pos == 1 || bp.type > 4 || pos >= packet.size() || packet[pos++] != ',' ||
+          !parseAddressLength(packet, pos, bp.address, bp.length, 0) || bp.address > 0xffff)
+      {
+        return false;
+      }
+      // for Z0/Z1 the length is the kind of instruction
+      if (bp.type < 2)
+      {
+        bp.length = 1;
+      }
+      bp.length = std::max<uint32_t>(1, std::min<uint32_t>(bp.length, 0x10000 - bp.address));
+      return true;
+    }
+
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace common2
+{
+
+  // The packet layer of the GDB Remote Serial Protocol: framing, checksums and argument parsing.
+  // It does not depend on the emulator, GdbServer applies the result.
+  namespace gdb
+  {
+
+    struct Breakpoint
+    {
+      int type;   // Z type: 0/1 PC, 2/3/4 write/read/access watchpoint
+      uint32_t address;
+      uint32_t length;
+    };
+
+    enum class Token
+    {
+      Incomplete,   // wait for more input
+      Packet,       // "$payload#xx"
+      BadChecksum,  // a packet with the wrong checksum
+      Interrupt,    // Ctrl-C
+      Nack,         // '-': retransmit
+      Other,        // '+' and noise between packets
+    };
+
+    void appendHex(std::string & s, const uint8_t value);
+    int hexValue(const char c);
+
+    // reads hex digits from pos, which is moved after them
+    uint32_t parseHex(const std::string & s, size_t & pos);
+    bool parseHexBytes(const std::string & s, const size_t pos, std::vector<uint8_t> & data);
+
+    // "addr,length" followed by the separator (if not 0), pos is moved after it
+    bool parseAddressLength(const std::string & s, size_t & pos, uint32_t & address, uint32_t & length, const char separator);
+
+    uint8_t checksum(const std::string & payload);
+    std::string makePacket(const std::string & payload);
+
+    // the token at pos, which is moved after it (unless Incomplete)
+    // payload is set for Packet and BadChecksum
+    Token readToken(const std::string & input, size_t & pos, std::string & payload);
+
+    // the binary data of X, from pos to the end of the packet: 0x7d escapes the next byte (^ 0x20)
+    void unescapeBinary(const std::string & s, size_t pos, std::vector<uint8_t> & data);
+
+    // "vCont;action[:thread]...": one thread, so the first action applies
+    // false if it is neither a continue nor a step
+    bool parseVCont(const std::string & packet, bool & step);
+
+    // "Z/z type,addr,kind": the length is at least 1 and does not go past 0xffff (1 for Z0/Z1)
+    bool parseBreakpoint(const std::string & packet, Breakpoint & bp);
+
+  }
+
+}
@@ -0,0 +1,782 @@
+#include "StdAfx.h"
+#include "frontends/common2/gdbserver.h"
+#include "frontends/common2/gdbpacket.h"
+#include "frontends/common2/programoptions.h"
+
+#include "Core.h"
+#include "CPU.h"
+#include "Log.h"
+#include "Memory.h"
+#include "Debugger/Debug.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+using namespace common2::gdb;
+
+namespace
+{
+
+  const size_t maximumPacket = 0x4000;  // advertised to the client, in bytes of payload
+  const size_t maximumOutput = 0x100000;  // unsent replies to a client that stopped reading
+  const int requestTimeoutMs = 1;       // wait for the next request of a burst
+  const std::chrono::milliseconds frameBudget(8);  // time spent serving requests in each update()
+
+  // a, x, y, p, sp, pc
+  const int numberOfRegisters = 6;
+  const size_t registerBytes[numberOfRegisters] = {1, 1, 1, 1, 1, 2};
+
+  const char targetXml[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<feature name=\"org.applewin.6502\">"
+    "<reg name=\"a\" bitsize=\"8\" regnum=\"0\"/>"
+    "<reg name=\"x\" bitsize=\"8\"/>"
+    "<reg name=\"y\" bitsize=\"8\"/>"
+    "<reg name=\"p\" bitsize=\"8\"/>"
+    "<reg name=\"sp\" bitsize=\"8\"/>"
+    "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+    "</feature>"
+    "</target>";
+
+  bool startsWith(const std::string & s, const char * prefix)
+  {
+    return s.compare(0, strlen(prefix), prefix) == 0;
+  }
+
+  void appendRegister(std::string & s, const int n)
+  {
+    switch (n)
+    {
+    case 0: appendHex(s, regs.a); break;
+    case 1: appendHex(s, regs.x); break;
+    case 2: appendHex(s, regs.y); break;
+    case 3: appendHex(s, regs.ps); break;
+    case 4: appendHex(s, uint8_t(regs.sp)); break;
+    case 5: appendHex(s, uint8_t(regs.pc)); appendHex(s, uint8_t(regs.pc >> 8)); break;
+    }
+  }
+
+  // data is little endian, of registerBytes[n]
+  void setRegister(const int n, const uint8_t * data)
+  {
+    switch (n)
+    {
+    case 0: regs.a = data[0]; break;
+    case 1: regs.x = data[0]; break;
+    case 2: regs.y = data[0]; break;
+    case 3: regs.ps = data[0]; break;
+    case 4: regs.sp = 0x0100 | data[0]; break;
+    case 5: regs.pc = data[0] | (data[1] << 8); break;
+    }
+  }
+
+  // nullptr if there is nothing at this address, else [address, address + available) is contiguous
+  BYTE * getMemory(const uint32_t address, uint32_t & available)
+  {
+    const uint32_t offset = address & 0xffff;
+    available = 0x10000 - offset;
+
+    if (address < 0x10000)
+    {
+      return mem + offset;
+    }
+
+    if ((address >> 24) == 0x01)
+    {
+      const UINT bank = (address >> 16) & 0xff;
+      if (bank > 0 && !IsAppleIIeOrAbove(GetApple2Type()))
+      {
+        return nullptr;
+      }
+      // this writes back the dirty pages of the 64K view
+      BYTE * base = MemGetBankPtr(bank);
+      return base ? base + offset : nullptr;
+    }
+
+    return nullptr;
+  }
+
+  BreakpointSource_t getBreakpointSource(const int type)
+  {
+    switch (type)
+    {
+    case 2: return BP_SRC_MEM_WRITE_ONLY;
+    case 3: return BP_SRC_MEM_READ_ONLY;
+    case 4: return BP_SRC_MEM_RW;
+    default: return BP_SRC_REG_PC;
+    }
+  }
+
+}
+
+namespace common2
+{
+
+  GdbServer::GdbServer(const std::string & address, const ChangeMode_t & changeMode)
+    : myChangeMode(changeMode)
+    , myListen(-1)
+    , myClient(-1)
+    , myNoAck(false)
+    , myWaitingForStop(false)
+    , mySignal(SIGTRAP)
+  {
+    if (startsWith(address, "unix:"))
+    {
+      myUnixPath = address.substr(5);
+      sockaddr_un unixAddress = {};
+      if (myUnixPath.empty() || myUnixPath.size() >= sizeof(unixAddress.sun_path))
+      {
+        throw std::runtime_error("GDB: invalid socket path " + myUnixPath);
+      }
+      // a socket left behind by a previous run
+      struct stat st;
+      if (stat(myUnixPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+      {
+        unlink(myUnixPath.c_str());
+      }
+
+      unixAddress.sun_family = AF_UNIX;
+      strcpy(unixAddress.sun_path, myUnixPath.c_str());
+      myListen = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (myListen < 0 || bind(myListen, reinterpret_cast<const sockaddr *>(&unixAddress), sizeof(unixAddress)) != 0)
+      {
+        const std::string error = strerror(errno);
+        if (myListen >= 0) close(myListen);
+        throw std::runtime_error("GDB: cannot listen on " + address + ": " + error);
+      }
+    }
+    else
+    {
+      std::string host = "127.0.0.1";
+      std::string port = address;
+      const size_t colon = address.rfind(':');
+      if (colon != std::string::npos)
+      {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+      }
+
+      sockaddr_in inetAddress = {};
+      inetAddress.sin_family = AF_INET;
+      inetAddress.sin_port = htons(uint16_t(std::stoi(port)));
+      if (inet_pton(AF_INET, host.c_str(), &inetAddress.sin_addr) != 1)
+      {
+        throw std::runtime_error("GDB: invalid address " + host);
+      }
+
+      myListen = socket(AF_INET, SOCK_STREAM, 0);
+      const int reuse = 1;
+      if (myListen >= 0)
+      {
+        setsockopt(myListen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+      }
+      if (myListen < 0 || bind(myListen, reinterpret_cast<const sockaddr *>(&inetAddress), sizeof(inetAddress)) != 0)
+      {
+        const std::string error = strerror(errno);
+        if (myListen >= 0) close(myListen);
+        throw std::runtime_error("GDB: cannot listen on " + address + ": " + error);
+      }
+    }
+
+    listen(myListen, 1);
+    fcntl(myListen, F_SETFL, fcntl(myListen, F_GETFL) | O_NONBLOCK);
+    LogFileOutput("GDB: listening on %s\n", address.c_str());
+  }
+
+  GdbServer::~GdbServer()
+  {
+    disconnect();
+    close(myListen);
+    if (!myUnixPath.empty())
+    {
+      unlink(myUnixPath.c_str());
+    }
+  }
+
+  void GdbServer::update()
+  {
+    if (myClient < 0 && !acceptClient())
+    {
+      return;
+    }
+
+    // while the target is stopped, the client sends bursts of requests (one per answer):
+    // serve them without waiting for the next frame
+    const auto deadline = std::chrono::steady_clock::now() + frameBudget;
+    int timeoutMs = 0;
+    do
+    {
+      if (myWaitingForStop && g_nAppMode == MODE_DEBUG)
+      {
+        myWaitingForStop = false;
+        sendPacket(getStopReply());
+      }
+      if (!receive(timeoutMs))
+      {
+        break;
+      }
+      processInput();
+      timeoutMs = myWaitingForStop ? 0 : requestTimeoutMs;
+    } while (myClient >= 0 && std::chrono::steady_clock::now() < deadline);
+  }
+
+  bool GdbServer::acceptClient()
+  {
+    myClient = accept(myListen, nullptr, nullptr);
+    if (myClient < 0)
+    {
+      return false;
+    }
+
+    // accept() does not pass O_NONBLOCK on: a client that stops reading must not block the emulator
+    fcntl(myClient, F_SETFL, fcntl(myClient, F_GETFL) | O_NONBLOCK);
+    const int noDelay = 1;
+    setsockopt(myClient, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));  // fails harmlessly on a Unix socket
+
+    myInput.clear();
+    myOutput.clear();
+    myLastPacket.clear();
+    myNoAck = false;
+    myWaitingForStop = false;
+    mySignal = SIGTRAP;
+    LogFileOutput("GDB: client connected\n");
+
+    // the client expects a stopped target
+    myChangeMode(MODE_DEBUG);
+    return true;
+  }
+
+  void GdbServer::disconnect()
+  {
+    if (myClient < 0)
+    {
+      return;
+    }
+
+    // best effort for the last reply (eg to "D")
+    flush();
+    close(myClient);
+    myClient = -1;
+    myOutput.clear();
+
+    for (const Breakpoint & bp : myBreakpoints)
+    {
+      DebugBreakpointRemove(getBreakpointSource(bp.type), WORD(bp.address), bp.length);
+    }
+    myBreakpoints.clear();
+    LogFileOutput("GDB: client disconnected\n");
+
+    // detach: let it run
+    if (g_nAppMode == MODE_DEBUG)
+    {
+      myChangeMode(MODE_RUNNING);
+    }
+  }
+
+  bool GdbServer::receive(const int timeoutMs)
+  {
+    pollfd fd = {myClient, short(myOutput.empty() ? POLLIN : POLLIN | POLLOUT), 0};
+    if (poll(&fd, 1, timeoutMs) <= 0)
+    {
+      return false;
+    }
+
+    if (fd.revents & POLLOUT)
+    {
+      if (!flush())
+      {
+        disconnect();
+        return false;
+      }
+      if (!(fd.revents & POLLIN))
+      {
+        return true;
+      }
+    }
+
+    char buffer[4096];
+    const ssize_t n = recv(myClient, buffer, sizeof(buffer), 0);
+    if (n <= 0)
+    {
+      if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+      {
+        return false;
+      }
+      disconnect();
+      return false;
+    }
+    myInput.append(buffer, n);
+    return true;
+  }
+
+  void GdbServer::processInput()
+  {
+    size_t pos = 0;
+    std::string payload;
+    Token token;
+    while (myClient >= 0 && (token = readToken(myInput, pos, payload)) != Token::Incomplete)
+    {
+      switch (token)
+      {
+      case Token::Packet:
+      case Token::BadChecksum:
+        if (!myNoAck)
+        {
+          if (token == Token::BadChecksum)
+          {
+            sendRaw("-");
+            break;
+          }
+          sendRaw("+");
+        }
+        handlePacket(payload);
+        break;
+      case Token::Interrupt:
+        interrupt();
+        break;
+      case Token::Nack:
+        if (!myLastPacket.empty())
+        {
+          sendRaw(myLastPacket);
+        }
+        break;
+      default:
+        // '+' and noise between packets are ignored
+        break;
+      }
+    }
+    myInput.erase(0, pos);
+  }
+
+  void GdbServer::handlePacket(const std::string & packet)
+  {
+    const char command = packet.empty() ? 0 : packet[0];
+    size_t pos = 1;
+
+    switch (command)
+    {
+    case '?':
+      sendPacket(getStopReply());
+      break;
+    case 'g':
+      sendPacket(readRegisters());
+      break;
+    case 'G':
+      {
+        std::vector<uint8_t> data;
+        if (!parseHexBytes(packet, pos, data) || data.size() < 7)
+        {
+          sendPacket("E01");
+          break;
+        }
+        const uint8_t * p = data.data();
+        for (int n = 0; n < numberOfRegisters; p += registerBytes[n], ++n)
+        {
+          setRegister(n, p);
+        }
+        sendPacket("OK");
+        break;
+      }
+    case 'p':
+      {
+        const uint32_t n = parseHex(packet, pos);
+        if (n >= numberOfRegisters)
+        {
+          sendPacket("E01");
+          break;
+        }
+        std::string reply;
+        appendRegister(reply, n);
+        sendPacket(reply);
+        break;
+      }
+    case 'P':
+      {
+        const uint32_t n = parseHex(packet, pos);
+        std::vector<uint8_t> data;
+        if (n >= numberOfRegisters || pos >= packet.size() || packet[pos] != '=' ||
+            !parseHexBytes(packet, pos + 1, data) || data.size() < registerBytes[n])
+        {
+          sendPacket("E01");
+          break;
+        }
+        setRegister(n, data.data());
+        sendPacket("OK");
+        break;
+      }
+    case 'm':
+      {
+        uint32_t address, length;
+        if (!parseAddressLength(packet, pos, address, length, 0))
+        {
+          sendPacket("E01");
+          break;
+        }
+        const std::string reply = readMemory(address, std::min<uint32_t>(length, maximumPacket / 2));
+        sendPacket(reply.empty() && length ? "E14" : reply);
+        break;
+      }
+    case 'M':
+    case 'X':
+      {
+        uint32_t address, length;
+        std::vector<uint8_t> data;
+        if (!parseAddressLength(packet, pos, address, length, command == 'M' ? ':' : 0) ||
+            (command == 'X' && (pos >= packet.size() || packet[pos++] != ':')))
+        {
+          sendPacket("E01");
+          break;
+        }
+        if (command == 'M')
+        {
+          if (!parseHexBytes(packet, pos, data))
+          {
+            sendPacket("E01");
+            break;
+          }
+        }
+        else
+        {
+          unescapeBinary(packet, pos, data);
+        }
+        if (data.size() != length)
+        {
+          sendPacket("E01");
+          break;
+        }
+        sendPacket(writeMemory(address, data) ? "OK" : "E14");
+        break;
+      }
+    case 'c':
+    case 's':
+      if (pos < packet.size())
+      {
+        regs.pc = WORD(parseHex(packet, pos));
+      }
+      resume(command == 's');
+      break;
+    case 'C':
+    case 'S':
+      // the signal has no meaning here
+      resume(command == 'S');
+      break;
+    case 'v':
+      if (packet == "vCont?")
+      {
+        sendPacket("vCont;c;C;s;S");
+      }
+      else if (startsWith(packet, "vCont;"))
+      {
+        handleVCont(packet);
+      }
+      else
+      {
+        sendPacket("");
+      }
+      break;
+    case 'q':
+    case 'Q':
+      handleQuery(packet);
+      break;
+    case 'Z':
+    case 'z':
+      handleBreakpoint(packet);
+      break;
+    case 'H':
+    case 'T':
+      // a single thread
+      sendPacket("OK");
+      break;
+    case 'D':
+      sendPacket("OK");
+      disconnect();
+      break;
+    case 'k':
+      disconnect();
+      break;
+    default:
+      sendPacket("");
+      break;
+    }
+  }
+
+  void GdbServer::handleQuery(const std::string & packet)
+  {
+    if (startsWith(packet, "qSupported"))
+    {
+      char reply[128];
+      snprintf(reply, sizeof(reply), "PacketSize=%zx;qXfer:features:read+;QStartNoAckMode+;vContSupported+", maximumPacket);
+      sendPacket(reply);
+    }
+    else if (packet == "QStartNoAckMode")
+    {
+      sendPacket("OK");
+      myNoAck = true;
+    }
+    else if (startsWith(packet, "qXfer:features:read:target.xml:"))
+    {
+      size_t pos = strlen("qXfer:features:read:target.xml:");
+      uint32_t offset, length;
+      const size_t size = sizeof(targetXml) - 1;
+      if (!parseAddressLength(packet, pos, offset, length, 0) || offset > size)
+      {
+        sendPacket("E01");
+        return;
+      }
+      const size_t n = std::min<size_t>(length, size - offset);
+      sendPacket((offset + n < size ? "m" : "l") + std::string(targetXml + offset, n));
+    }
+    else if (packet == "qAttached")
+    {
+      sendPacket("1");
+    }
+    else if (packet == "qC")
+    {
+      sendPacket("QC1");
+    }
+    else if (packet == "qfThreadInfo")
+    {
+      sendPacket("m1");
+    }
+    else if (packet == "qsThreadInfo")
+    {
+      sendPacket("l");
+    }
+    else if (startsWith(packet, "qSymbol"))
+    {
+      sendPacket("OK");
+    }
+    else
+    {
+      sendPacket("");
+    }
+  }
+
+  void GdbServer::handleBreakpoint(const std::string & packet)
+  {
+    Breakpoint bp;
+    if (!parseBreakpoint(packet, bp))
+    {
+      sendPacket("E01");
+      return;
+    }
+
+    const BreakpointSource_t source = getBreakpointSource(bp.type);
+    if (packet[0] == 'Z')
+    {
+      if (!DebugBreakpointAdd(source, WORD(bp.address), bp.length))
+      {
+        sendPacket("E28");  // no slot left
+        return;
+      }
+      myBreakpoints.push_back(bp);
+    }
+    else
+    {
+      DebugBreakpointRemove(source, WORD(bp.address), bp.length);
+      for (size_t i = 0; i < myBreakpoints.size(); ++i)
+      {
+        const Breakpoint & other = myBreakpoints[i];
+        if (other.type == bp.type && other.address == bp.address && other.length == bp.length)
+        {
+          myBreakpoints.erase(myBreakpoints.begin() + i);
+          break;
+        }
+      }
+    }
+    sendPacket("OK");
+  }
+
+  void GdbServer::handleVCont(const std::string & packet)
+  {
+    bool step;
+    if (!parseVCont(packet, step))
+    {
+      sendPacket("E01");
+      return;
+    }
+    resume(step);
+  }
+
+  void GdbServer::resume(const bool step)
+  {
+    mySignal = SIGTRAP;
+    myWaitingForStop = true;
+    if (step)
+    {
+      if (g_nAppMode != MODE_DEBUG)
+      {
+        myChangeMode(MODE_DEBUG);
+      }
+      // executes 1 instruction synchronously, and goes back to MODE_DEBUG
+      CmdTrace(0);
+    }
+    else
+    {
+      // keeps stepping (and checking the breakpoints) if there are any
+      myChangeMode(MODE_RUNNING);
+    }
+  }
+
+  void GdbServer::interrupt()
+  {
+    if (g_nAppMode != MODE_DEBUG)
+    {
+      mySignal = SIGINT;
+      myWaitingForStop = true;
+      myChangeMode(MODE_DEBUG);
+    }
+  }
+
+  std::string GdbServer::readRegisters() const
+  {
+    std::string reply;
+    for (int n = 0; n < numberOfRegisters; ++n)
+    {
+      appendRegister(reply, n);
+    }
+    return reply;
+  }
+
+  std::string GdbServer::readMemory(const uint32_t address, const uint32_t length) const
+  {
+    uint32_t available;
+    const BYTE * p = getMemory(address, available);
+    if (!p)
+    {
+      return std::string();
+    }
+
+    // a partial read is allowed, up to the end of the bank
+    const uint32_t n = std::min(length, available);
+    std::string reply;
+    reply.reserve(n * 2);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      appendHex(reply, p[i]);
+    }
+    return reply;
+  }
+
+  bool GdbServer::writeMemory(const uint32_t address, const std::vector<uint8_t> & data)
+  {
+    uint32_t available;
+    BYTE * p = getMemory(address, available);
+    if (!p || data.size() > available)
+    {
+      return false;
+    }
+    if (data.empty())
+    {
+      return true;
+    }
+
+    memcpy(p, data.data(), data.size());
+    if (address < 0x10000)
+    {
+      const uint32_t last = address + uint32_t(data.size()) - 1;
+      for (uint32_t page = address >> 8; page <= (last >> 8); ++page)
+      {
+        memdirty[page] = 0xff;
+      }
+    }
+    else
+    {
+      // reload the 64K view from the banks
+      MemUpdatePaging(TRUE);
+    }
+    return true;
+  }
+
+  std::string GdbServer::getStopReply() const
+  {
+    char reply[32];
+    WORD address;
+    const int hit = mySignal == SIGTRAP ? DebugGetBreakpointHit(address) : BP_HIT_NONE;
+
+    const char * watch = (hit & BP_HIT_MEMW) ? "watch" : (hit & BP_HIT_MEMR) ? "rwatch" : (hit & BP_HIT_MEM) ? "awatch" : nullptr;
+    if (watch)
+    {
+      snprintf(reply, sizeof(reply), "T%02x%s:%04x;", mySignal, watch, address);
+    }
+    else
+    {
+      snprintf(reply, sizeof(reply), "S%02x", mySignal);
+    }
+    return reply;
+  }
+
+  void GdbServer::sendPacket(const std::string & payload)
+  {
+    myLastPacket = makePacket(payload);
+    sendRaw(myLastPacket);
+  }
+
+  void GdbServer::sendRaw(const std::string & data)
+  {
+    if (myClient < 0)
+    {
+      return;
+    }
+    myOutput += data;
+    if (!flush())
+    {
+      disconnect();
+    }
+    else if (myOutput.size() > maximumOutput)
+    {
+      LogFileOutput("GDB: client not reading\n");
+      disconnect();
+    }
+  }
+
+  bool GdbServer::flush()
+  {
+    size_t sent = 0;
+    while (sent < myOutput.size())
+    {
+      const ssize_t n = send(myClient, myOutput.data() + sent, myOutput.size() - sent, MSG_NOSIGNAL);
+      if (n < 0)
+      {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+          break;  // the rest goes when poll() reports POLLOUT
+        }
+        if (errno != EINTR)
+        {
+          return false;
+        }
+        continue;
+      }
+      sent += n;
+    }
+    myOutput.erase(0, sent);
+    return true;
+  }
+
+  std::shared_ptr<GdbServer> createGdbServer(const EmulatorOptions & options, const GdbServer::ChangeMode_t & changeMode)
+  {
+    if (options.gdbAddress.empty())
+    {
+      return std::shared_ptr<GdbServer>();
+    }
+    return std::make_shared<GdbServer>(options.gdbAddress, changeMode);
+  }
+
+}
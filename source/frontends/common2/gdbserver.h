@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Common.h"
+#include "frontends/common2/gdbpacket.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace common2
+{
+
+  struct EmulatorOptions;
+
+  // A GDB Remote Serial Protocol stub, driven by the frontend's main loop (no thread).
+  //
+  // Registers: a, x, y, p, sp (8 bit) and pc (16 bit), described in target.xml.
+  // Memory: 0x0000xxxx is the 64K seen by the CPU (as the debugger sees it),
+  //         0x01bbxxxx is RAM bank bb (00 main, 01 aux, 02.. RamWorks).
+  // Z0/Z1 are PC breakpoints, Z2/Z3/Z4 write/read/access watchpoints: they are normal debugger breakpoints.
+  // Execution goes through the debugger modes: "c" leaves the debugger, "s" is the debugger's trace,
+  // Ctrl-C enters the debugger, and a stop is reported when the emulator is back in MODE_DEBUG.
+  class GdbServer
+  {
+  public:
+    typedef std::function<void(const AppMode_e mode)> ChangeMode_t;
+
+    // address: "PORT" (localhost), "HOST:PORT" or "unix:PATH"
+    GdbServer(const std::string & address, const ChangeMode_t & changeMode);
+    ~GdbServer();
+
+    // call once per frame: accepts a client, serves its requests and reports stops
+    void update();
+
+  private:
+    bool acceptClient();
+    void disconnect();
+    bool receive(const int timeoutMs);
+    void processInput();
+    void handlePacket(const std::string & packet);
+    void handleQuery(const std::string & packet);
+    void handleBreakpoint(const std::string & packet);
+    void handleVCont(const std::string & packet);
+    void resume(const bool step);
+    void interrupt();
+
+    std::string readRegisters() const;
+    std::string readMemory(const uint32_t address, const uint32_t length) const;
+    bool writeMemory(const uint32_t address, const std::vector<uint8_t> & data);
+    std::string getStopReply() const;
+
+    void sendPacket(const std::string & payload);
+    void sendRaw(const std::string & data);
+    bool flush();  // false if the client is gone
+
+    const ChangeMode_t myChangeMode;
+    std::string myUnixPath;       // removed on exit
+    int myListen;
+    int myClient;
+
+    std::string myInput;          // received, not yet processed
+    std::string myOutput;         // not yet sent: the client socket is non blocking
+    std::string myLastPacket;     // for a retransmission
+    bool myNoAck;
+    bool myWaitingForStop;        // the client resumed the target
+    int mySignal;                 // of the next stop reply
+    std::vector<gdb::Breakpoint> myBreakpoints;  // set by the client, removed when it goes
+  };
+
+  // nullptr if no server was requested
+  std::shared_ptr<GdbServer> createGdbServer(const EmulatorOptions & options, const GdbServer::ChangeMode_t & changeMode);
+
+}
@@ -6,11 +6,16 @@
 #include <boost/program_options.hpp>
 
 #include "StdAfx.h"
+#include "CPU.h"
 #include "Memory.h"
 #include "Log.h"
 #include "Disk.h"
 #include "Utilities.h"
 #include "Core.h"
+#include "Mockingboard.h"
+#include "PerfCounters.h"
+#include "Riff.h"
+#include "linux/tape.h"
 
 #include <iostream>
 #include <regex>
@@ -41,6 +46,11 @@ namespace
     throw std::runtime_error("Invalid sizes: " + s);
   }
 
+  void mockingboardCapture(const short * samples, UINT numSamples, void * /* context */)
+  {
+    RiffPutSamples(samples, numSamples);
+  }
+
 }
 
 namespace common2
@@ -75,6 +85,13 @@ namespace common2
       ;
     desc.add(diskDesc);
 
+    po::options_description tapeDesc("Tape");
+    tapeDesc.add_options()
+      ("tape", po::value<std::string>(), "Cassette tape (WAV file)")
+      ("tape-instant-load", "Service the Monitor's READ routine from the decoded tape")
+      ;
+    desc.add(tapeDesc);
+
     po::options_description snapshotDesc("Snapshot");
     snapshotDesc.add_options()
       ("state-filename,f", po::value<std::string>(), "Set snapshot filename")
@@ -82,6 +99,13 @@ namespace common2
       ;
     desc.add(snapshotDesc);
 
+    po::options_description movieDesc("Movie");
+    movieDesc.add_options()
+      ("movie-record", po::value<std::string>(), "Record inputs to file (from a snapshot saved as FILE.yaml)")
+      ("movie-play", po::value<std::string>(), "Replay inputs from file and verify the checkpoints")
+      ;
+    desc.add(movieDesc);
+
     po::options_description memoryDesc("Memory");
     memoryDesc.add_options()
       ("memclear", po::value<int>()->default_value(options.memclear), "Memory initialization pattern [0..7]")
@@ -91,8 +115,12 @@ namespace common2
     po::options_description emulatorDesc("Emulator");
     emulatorDesc.add_options()
       ("log", "Log to AppleWin.log")
+      ("log-async", "Log from a background thread (never blocks the emulation)")
+      ("log-structured", "Log as JSON lines (time, cycle, thread & message)")
+      ("log-rate", po::value<int>(), "Log at most N records per second from each call site")
       ("headless", "Headless: disable video (freewheel)")
       ("fixed-speed", "Fixed (non-adaptive) speed")
+      ("no-idle-skip", "Interpret every iteration of keyboard polling loops")
       ("ntsc,nt", "NTSC: execute NTSC code")
       ("benchmark,b", "Benchmark emulator")
       ("rom", po::value<std::string>(), "Custom 12k/16k ROM")
@@ -100,11 +128,40 @@ namespace common2
       ;
     desc.add(emulatorDesc);
 
+    po::options_description audioDesc("Audio");
+    audioDesc.add_options()
+      ("mb-full-speed", "Mockingboard: render audio during full speed")
+      ("mb-wav", po::value<std::string>(), "Mockingboard: capture audio to WAV file")
+      ;
+    desc.add(audioDesc);
+
+    po::options_description captureDesc("Capture");
+    captureDesc.add_options()
+      ("capture-video", po::value<std::string>(), "Capture every emulated frame to Y4M file")
+      ("capture-audio", po::value<std::string>(), "Capture speaker and Mockingboard to WAV file")
+      ("capture-vfr", "Drop repeated frames, and write their timestamps to FILE.timestamps")
+      ;
+    desc.add(captureDesc);
+
+    po::options_description perfDesc("Performance");
+    perfDesc.add_options()
+      ("perf", "Enable performance counters (stats on exit)")
+      ("perf-trace", po::value<std::string>(), "Capture performance counters to Chrome trace-event JSON file")
+      ;
+    desc.add(perfDesc);
+
+    po::options_description debugDesc("Debugger");
+    debugDesc.add_options()
+      ("gdb", po::value<std::string>(), "GDB remote protocol server on PORT, HOST:PORT or unix:PATH")
+      ;
+    desc.add(debugDesc);
+
     po::options_description sdlDesc("SDL");
     sdlDesc.add_options()
       ("sdl-driver", po::value<int>()->default_value(options.sdlDriver), "SDL driver")
       ("gl-swap", po::value<int>()->default_value(options.glSwapInterval), "SDL_GL_SwapInterval")
       ("no-imgui", "Plain SDL2 renderer")
+      ("no-frame-lock", "Do not lock emulation to the display refresh")
       ("geometry", po::value<std::string>(), "WxH[+X+Y]")
       ;
     desc.add(sdlDesc);
@@ -132,6 +189,7 @@ namespace common2
       options.sdlDriver = vm["sdl-driver"].as<int>();
       options.glSwapInterval = vm["gl-swap"].as<int>();
       options.imgui = vm.count("no-imgui") == 0;
+      options.frameLock = vm.count("no-frame-lock") == 0;
 
       if (vm.count("registry"))
       {
@@ -160,6 +218,20 @@ namespace common2
         options.loadSnapshot = false;
       }
 
+      if (vm.count("movie-record"))
+      {
+        options.movieRecordFilename = vm["movie-record"].as<std::string>();
+      }
+
+      if (vm.count("movie-play"))
+      {
+        options.moviePlayFilename = vm["movie-play"].as<std::string>();
+        if (!options.movieRecordFilename.empty())
+        {
+          throw std::runtime_error("Cannot record and play a movie at the same time");
+        }
+      }
+
       if (vm.count("rom"))
       {
         options.customRom = vm["rom"].as<std::string>();
@@ -170,6 +242,12 @@ namespace common2
         options.customRomF8 = vm["f8rom"].as<std::string>();
       }
 
+      if (vm.count("tape"))
+      {
+        options.tapeFilename = vm["tape"].as<std::string>();
+      }
+      options.tapeInstantLoad = vm.count("tape-instant-load") > 0;
+
       const int memclear = vm["memclear"].as<int>();
       if (memclear >=0 && memclear < NUM_MIP)
         options.memclear = memclear;
@@ -177,8 +255,46 @@ namespace common2
       options.benchmark = vm.count("benchmark") > 0;
       options.headless = vm.count("headless") > 0;
       options.log = vm.count("log") > 0;
+      options.logAsync = vm.count("log-async") > 0;
+      options.logStructured = vm.count("log-structured") > 0;
+      if (vm.count("log-rate"))
+      {
+        options.logRateLimit = vm["log-rate"].as<int>();
+      }
       options.ntsc = vm.count("ntsc") > 0;
       options.fixedSpeed = vm.count("fixed-speed") > 0;
+      options.idleLoopSkip = vm.count("no-idle-skip") == 0;
+
+      options.mbFullSpeedAudio = vm.count("mb-full-speed") > 0;
+      if (vm.count("mb-wav"))
+      {
+        options.mbWavFilename = vm["mb-wav"].as<std::string>();
+      }
+
+      if (vm.count("capture-video"))
+      {
+        options.captureVideoFilename = vm["capture-video"].as<std::string>();
+      }
+      if (vm.count("capture-audio"))
+      {
+        options.captureAudioFilename = vm["capture-audio"].as<std::string>();
+        if (!options.mbWavFilename.empty())
+        {
+          throw std::runtime_error("--capture-audio already includes the Mockingboard, do not use it with --mb-wav");
+        }
+      }
+      options.captureVFR = vm.count("capture-vfr") > 0;
+
+      options.perfCounters = vm.count("perf") > 0;
+      if (vm.count("perf-trace"))
+      {
+        options.perfTraceFilename = vm["perf-trace"].as<std::string>();
+      }
+
+      if (vm.count("gdb"))
+      {
+        options.gdbAddress = vm["gdb"].as<std::string>();
+      }
 
       options.paddleSquaring = vm.count("no-squaring") == 0;
       if (vm.count("device-name"))
@@ -246,7 +362,39 @@ namespace common2
       }
     }
 
+    CassetteTape & tape = CassetteTape::instance();
+    tape.setInstantLoad(options.tapeInstantLoad);
+    if (!options.tapeFilename.empty() && !tape.load(options.tapeFilename))
+    {
+      LogFileOutput("Init: Failed to load tape: %s\n", options.tapeFilename.c_str());
+    }
+
+    LogSetStructured(options.logStructured);
+    LogSetRateLimit(std::max(0, options.logRateLimit));
+    LogSetAsync(options.logAsync);
+
     Paddle::setSquaring(options.paddleSquaring);
+
+    CpuSetIdleLoopSkip(options.idleLoopSkip);
+    PerfEnable(options.perfCounters);
+    if (!options.perfTraceFilename.empty())
+    {
+      PerfStartTrace(options.perfTraceFilename);  // written by DestroyEmulator()
+    }
+
+    MB_SetFullSpeedAudio(options.mbFullSpeedAudio);
+    if (!options.mbWavFilename.empty())
+    {
+      // the file is finalised by DestroyEmulator()
+      if (RiffInitWriteFile(options.mbWavFilename.c_str(), 44100, 2) == 0)
+      {
+        MB_SetAudioCapture(mockingboardCapture, nullptr);
+      }
+      else
+      {
+        LogFileOutput("Init: Failed to create Mockingboard WAV file: %s\n", options.mbWavFilename.c_str());
+      }
+    }
   }
 
 }
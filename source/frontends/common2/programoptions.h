@@ -23,12 +23,21 @@ namespace common2
     std::string disk1;
     std::string disk2;
 
+    std::string tapeFilename;
+    bool tapeInstantLoad = false;
+
     std::string snapshotFilename;
     bool loadSnapshot = false;
 
+    std::string movieRecordFilename; // inputs recorded from a new snapshot
+    std::string moviePlayFilename;
+
     int memclear;
 
     bool log = false;
+    bool logAsync = false; // write the log from a background thread
+    bool logStructured = false; // JSON lines
+    int logRateLimit = 0; // records per second per call site, 0 = unlimited
 
     bool benchmark = false;
     bool headless = false;
@@ -45,11 +54,25 @@ namespace common2
     bool run = true;  // false if options include "-h"
 
     bool fixedSpeed = false; // default adaptive
+    bool idleLoopSkip = true; // skip keyboard polling loops
+
+    bool mbFullSpeedAudio = false; // keep rendering the Mockingboard during full speed
+    std::string mbWavFilename; // capture the Mockingboard output
+
+    std::string captureVideoFilename; // Y4M, one frame per emulated frame
+    std::string captureAudioFilename; // WAV, speaker & Mockingboard
+    bool captureVFR = false; // drop duplicated frames (and write their timestamps)
+
+    bool perfCounters = false; // stats are printed on exit
+    std::string perfTraceFilename; // Chrome trace-event JSON, written on exit
+
+    std::string gdbAddress; // GDB remote protocol server: PORT, HOST:PORT or unix:PATH
 
     int sdlDriver = -1; // default = -1 to let SDL choose
     bool imgui = true; // use imgui renderer
     Geometry geometry; // must be initialised with defaults
     int glSwapInterval = 1; // SDL_GL_SetSwapInterval
+    bool frameLock = true; // pace emulation on the (vsync) display refresh
 
     std::string customRomF8;
     std::string customRom;
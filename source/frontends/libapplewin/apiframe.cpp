@@ -0,0 +1,27 @@
+#include "StdAfx.h"
+#include "frontends/libapplewin/apiframe.h"
+
+#include "Log.h"
+
+namespace la2
+{
+
+  void ApiFrame::VideoPresentScreen()
+  {
+  }
+
+  int ApiFrame::FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType)
+  {
+    LogFileOutput("%s: %s\n", lpCaption, lpText);
+    myMessage = std::string(lpCaption) + ": " + lpText;
+    return IDOK;
+  }
+
+  std::string ApiFrame::takeMessage()
+  {
+    std::string message;
+    message.swap(myMessage);
+    return message;
+  }
+
+}
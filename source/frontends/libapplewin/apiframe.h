@@ -0,0 +1,25 @@
+#pragma once
+
+#include "frontends/common2/commonframe.h"
+#include "frontends/common2/gnuframe.h"
+
+#include <string>
+
+namespace la2
+{
+
+  // A frame which renders into the framebuffer, never presents it, and keeps the messages as errors
+  class ApiFrame : public virtual common2::CommonFrame, public common2::GNUFrame
+  {
+  public:
+    void VideoPresentScreen() override;
+    int FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType) override;
+
+    // empty if there was no message since the last call
+    std::string takeMessage();
+
+  private:
+    std::string myMessage;
+  };
+
+}
@@ -0,0 +1,522 @@
+#include "StdAfx.h"
+#include "frontends/libapplewin/applewin.h"
+#include "frontends/libapplewin/apiframe.h"
+#include "frontends/common2/ptreeregistry.h"
+
+#include "CardManager.h"
+#include "Core.h"
+#include "CPU.h"
+#include "Disk.h"
+#include "Harddisk.h"
+#include "Interface.h"
+#include "Memory.h"
+#include "Mockingboard.h"
+#include "NTSC.h"
+#include "SaveState.h"
+#include "Speaker.h"
+#include "Utilities.h"
+#include "Video.h"
+
+#include "linux/context.h"
+#include "linux/keyboard.h"
+#include "linux/paddle.h"
+#include "linux/version.h"
+
+#include <boost/property_tree/ini_parser.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+  std::string ourLastError;
+  bool ourMachineExists = false;
+
+  // in memory, nothing is saved: an embedded emulator must not modify the user's configuration
+  class ApiRegistry : public common2::PTreeRegistry
+  {
+  public:
+    void load(const std::string & filename)
+    {
+      boost::property_tree::ini_parser::read_ini(filename, myINI);
+    }
+  };
+
+  std::shared_ptr<Registry> createRegistry(const char * configFile, const aw_option * options, const size_t count)
+  {
+    const std::shared_ptr<ApiRegistry> registry = std::make_shared<ApiRegistry>();
+    if (configFile)
+    {
+      registry->load(configFile);
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+      const aw_option & option = options[i];
+      if (!option.section || !option.key || !option.value)
+      {
+        throw std::invalid_argument("Invalid option");
+      }
+      registry->putString(option.section, option.key, option.value);
+    }
+    return registry;
+  }
+
+  // exceptions must not cross the C interface
+  template<typename F>
+  int guard(F f)
+  {
+    try
+    {
+      return f();
+    }
+    catch (const std::exception & e)
+    {
+      ourLastError = e.what();
+      return AW_ERROR;
+    }
+  }
+
+  int fail(const std::string & error, const int status = AW_ERROR)
+  {
+    ourLastError = error;
+    return status;
+  }
+
+  Disk2InterfaceCard * getDisk2Card()
+  {
+    CardManager & cardManager = GetCardMgr();
+    return cardManager.QuerySlot(SLOT6) == CT_Disk2 ? dynamic_cast<Disk2InterfaceCard *>(cardManager.GetObj(SLOT6)) : nullptr;
+  }
+
+  // nullptr if there is no such bank
+  BYTE * getBank(const int bank)
+  {
+    if (bank == AW_BANK_CPU)
+    {
+      return mem;
+    }
+    if (bank < 0 || (bank > 0 && !IsAppleIIeOrAbove(GetApple2Type())))
+    {
+      return nullptr;
+    }
+    // this writes back the dirty pages of the 64K view
+    return MemGetBankPtr(bank);
+  }
+
+}
+
+struct aw_machine
+{
+  aw_machine(const char * configFile, const aw_option * options, const size_t count);
+  ~aw_machine();
+
+  uint64_t run(const uint64_t cycles);
+  // the frame's message (if any) is the error
+  int checkMessage();
+
+  static void speakerCallback(const short * samples, uint32_t numSamples, void * context);
+  static void mockingboardCallback(const short * samples, uint32_t numSamples, void * context);
+
+  const LoggerContext loggerContext;
+  const RegistryContext registryContext;
+  const std::shared_ptr<Paddle> paddle;
+  const std::shared_ptr<la2::ApiFrame> frame;
+  const Initialisation initialisation;
+
+  std::vector<int16_t> speaker;       // produced by the last run
+  std::vector<int16_t> mockingboard;
+};
+
+aw_machine::aw_machine(const char * configFile, const aw_option * options, const size_t count)
+  : loggerContext(false)
+  , registryContext(createRegistry(configFile, options, count))
+  , paddle(std::make_shared<Paddle>())
+  , frame(std::make_shared<la2::ApiFrame>())
+  , initialisation(frame, paddle)
+{
+  frame->Begin();
+  // nothing plays the sound buffers: both streams are rendered in emulated time for the callbacks
+  Spkr_SetAudioCapture(speakerCallback, this);
+  MB_SetAudioCapture(mockingboardCallback, this);
+  MB_SetFullSpeedAudio(true);
+}
+
+aw_machine::~aw_machine()
+{
+  NTSC_SetHeadless(false);
+  Spkr_SetAudioCapture(nullptr, nullptr);
+  MB_SetAudioCapture(nullptr, nullptr);
+  MB_SetFullSpeedAudio(false);
+  frame->End();
+}
+
+uint64_t aw_machine::run(const uint64_t cycles)
+{
+  speaker.clear();
+  mockingboard.clear();
+
+  // the cards are updated once per slice, as the frontends do once per frame
+  const UINT cyclesPerFrame = NTSC_GetCyclesPerFrame();
+  const bool bVideoUpdate = true;
+
+  uint64_t executed = 0;
+  while (executed < cycles)
+  {
+    const DWORD slice = DWORD(std::min<uint64_t>(cycles - executed, cyclesPerFrame));
+    const DWORD executedCycles = CpuExecute(slice, bVideoUpdate);
+    g_dwCyclesThisFrame = (g_dwCyclesThisFrame + executedCycles) % cyclesPerFrame;
+    GetCardMgr().Update(executedCycles);
+    SpkrUpdate(executedCycles);
+    executed += executedCycles;
+  }
+  return executed;
+}
+
+int aw_machine::checkMessage()
+{
+  const std::string message = frame->takeMessage();
+  return message.empty() ? AW_OK : fail(message);
+}
+
+void aw_machine::speakerCallback(const short * samples, uint32_t numSamples, void * context)
+{
+  aw_machine * machine = static_cast<aw_machine *>(context);
+  machine->speaker.insert(machine->speaker.end(), samples, samples + numSamples);
+}
+
+void aw_machine::mockingboardCallback(const short * samples, uint32_t numSamples, void * context)
+{
+  aw_machine * machine = static_cast<aw_machine *>(context);
+  machine->mockingboard.insert(machine->mockingboard.end(), samples, samples + 2 * numSamples);
+}
+
+extern "C"
+{
+
+  int aw_api_version(void)
+  {
+    return AW_API_VERSION;
+  }
+
+  const char * aw_version(void)
+  {
+    static const std::string version = getVersion();
+    return version.c_str();
+  }
+
+  const char * aw_last_error(void)
+  {
+    return ourLastError.c_str();
+  }
+
+  aw_machine * aw_create(const char * config_file, const aw_option * options, size_t count)
+  {
+    ourLastError.clear();
+    if (ourMachineExists)
+    {
+      fail("Only one machine per process", AW_BUSY);
+      return nullptr;
+    }
+
+    try
+    {
+      aw_machine * machine = new aw_machine(config_file, options, count);
+      ourMachineExists = true;
+      return machine;
+    }
+    catch (const std::exception & e)
+    {
+      fail(e.what());
+      return nullptr;
+    }
+  }
+
+  void aw_destroy(aw_machine * machine)
+  {
+    if (machine)
+    {
+      delete machine;
+      ourMachineExists = false;
+    }
+  }
+
+  int aw_reset(aw_machine * machine, int power_cycle)
+  {
+    if (!machine)
+      return AW_INVALID;
+
+    return guard([power_cycle]() -> int {
+      if (power_cycle)
+      {
+        ResetMachineState();
+      }
+      else
+      {
+        CtrlReset();
+      }
+      return AW_OK;
+    });
+  }
+
+  int aw_insert_disk(aw_machine * machine, int drive, const char * filename, int write_protected)
+  {
+    if (!machine || !filename || (drive != DRIVE_1 && drive != DRIVE_2))
+      return AW_INVALID;
+
+    return guard([machine, drive, filename, write_protected]() -> int {
+      Disk2InterfaceCard * card = getDisk2Card();
+      if (!card)
+      {
+        return fail("No Disk II card in slot 6");
+      }
+      const ImageError_e error = card->InsertDisk(drive, filename, write_protected != 0, false);
+      machine->frame->takeMessage();  // already reported by the result
+      return error == eIMAGE_ERROR_NONE ? AW_OK : fail(std::string("Cannot insert ") + filename);
+    });
+  }
+
+  int aw_eject_disk(aw_machine * machine, int drive)
+  {
+    if (!machine || (drive != DRIVE_1 && drive != DRIVE_2))
+      return AW_INVALID;
+
+    return guard([drive]() -> int {
+      Disk2InterfaceCard * card = getDisk2Card();
+      if (!card)
+      {
+        return fail("No Disk II card in slot 6");
+      }
+      card->EjectDisk(drive);
+      return AW_OK;
+    });
+  }
+
+  int aw_insert_hdd(aw_machine * machine, int drive, const char * filename)
+  {
+    if (!machine || !filename || (drive != HARDDISK_1 && drive != HARDDISK_2))
+      return AW_INVALID;
+
+    return guard([machine, drive, filename]() -> int {
+      CardManager & cardManager = GetCardMgr();
+      if (cardManager.QuerySlot(SLOT7) != CT_GenericHDD)
+      {
+        cardManager.Insert(SLOT7, CT_GenericHDD);
+      }
+      HarddiskInterfaceCard * card = dynamic_cast<HarddiskInterfaceCard *>(cardManager.GetObj(SLOT7));
+      const bool ok = card && card->Insert(drive, filename);
+      machine->frame->takeMessage();
+      return ok ? AW_OK : fail(std::string("Cannot insert ") + filename);
+    });
+  }
+
+  int aw_load_snapshot(aw_machine * machine, const char * filename)
+  {
+    if (!machine || !filename)
+      return AW_INVALID;
+
+    return guard([machine, filename]() -> int {
+      machine->frame->takeMessage();
+      Snapshot_SetFilename(filename);
+      machine->frame->LoadSnapshot();
+      return machine->checkMessage();
+    });
+  }
+
+  int aw_save_snapshot(aw_machine * machine, const char * filename)
+  {
+    if (!machine || !filename)
+      return AW_INVALID;
+
+    return guard([machine, filename]() -> int {
+      machine->frame->takeMessage();
+      Snapshot_SetFilename(filename);
+      Snapshot_SaveState();
+      return machine->checkMessage();
+    });
+  }
+
+  uint64_t aw_run(aw_machine * machine, uint64_t cycles)
+  {
+    if (!machine)
+      return 0;
+
+    try
+    {
+      return machine->run(cycles);
+    }
+    catch (const std::exception & e)
+    {
+      fail(e.what());
+      return 0;
+    }
+  }
+
+  uint64_t aw_run_until(aw_machine * machine, uint64_t max_cycles, uint32_t slice_cycles, aw_stop_fn stop, void * context)
+  {
+    if (!machine || !stop || !slice_cycles)
+      return 0;
+
+    // the audio of the whole run is kept
+    std::vector<int16_t> speaker, mockingboard;
+    uint64_t executed = 0;
+    while (executed < max_cycles)
+    {
+      executed += machine->run(std::min<uint64_t>(slice_cycles, max_cycles - executed));
+      speaker.insert(speaker.end(), machine->speaker.begin(), machine->speaker.end());
+      mockingboard.insert(mockingboard.end(), machine->mockingboard.begin(), machine->mockingboard.end());
+      if (stop(machine, context))
+      {
+        break;
+      }
+    }
+    machine->speaker.swap(speaker);
+    machine->mockingboard.swap(mockingboard);
+    return executed;
+  }
+
+  uint64_t aw_get_cycles(aw_machine * machine)
+  {
+    return machine ? g_nCumulativeCycles : 0;
+  }
+
+  int aw_set_headless(aw_machine * machine, int headless)
+  {
+    if (!machine)
+      return AW_INVALID;
+
+    NTSC_SetHeadless(headless != 0);
+    return AW_OK;
+  }
+
+  int aw_get_framebuffer(aw_machine * machine, aw_framebuffer * framebuffer)
+  {
+    if (!machine || !framebuffer)
+      return AW_INVALID;
+
+    if (NTSC_IsHeadless())
+    {
+      NTSC_VideoRedrawWholeScreen();
+    }
+
+    // rows are stored bottom up
+    Video & video = GetVideo();
+    const size_t pitch = video.GetFrameBufferWidth() * sizeof(bgra_t);
+    const size_t topRow = video.GetFrameBufferHeight() - 1 - video.GetFrameBufferBorderHeight();
+    framebuffer->pixels = video.GetFrameBuffer() + topRow * pitch + video.GetFrameBufferBorderWidth() * sizeof(bgra_t);
+    framebuffer->width = video.GetFrameBufferBorderlessWidth();
+    framebuffer->height = video.GetFrameBufferBorderlessHeight();
+    framebuffer->pitch = -ptrdiff_t(pitch);
+    return AW_OK;
+  }
+
+  int aw_get_audio(aw_machine * machine, aw_audio * audio)
+  {
+    if (!machine || !audio)
+      return AW_INVALID;
+
+    audio->sample_rate = SPKR_SAMPLE_RATE;
+    audio->speaker = machine->speaker.data();
+    audio->speaker_samples = machine->speaker.size();
+    audio->mockingboard = machine->mockingboard.data();
+    audio->mockingboard_samples = machine->mockingboard.size() / 2;
+    return AW_OK;
+  }
+
+  int aw_get_registers(aw_machine * machine, aw_registers * registers)
+  {
+    if (!machine || !registers)
+      return AW_INVALID;
+
+    registers->a = regs.a;
+    registers->x = regs.x;
+    registers->y = regs.y;
+    registers->p = regs.ps;
+    registers->sp = uint8_t(regs.sp);
+    registers->pc = regs.pc;
+    return AW_OK;
+  }
+
+  int aw_set_registers(aw_machine * machine, const aw_registers * registers)
+  {
+    if (!machine || !registers)
+      return AW_INVALID;
+
+    regs.a = registers->a;
+    regs.x = registers->x;
+    regs.y = registers->y;
+    regs.ps = registers->p;
+    regs.sp = 0x0100 | registers->sp;
+    regs.pc = registers->pc;
+    return AW_OK;
+  }
+
+  int aw_read_memory(aw_machine * machine, int bank, uint16_t address, void * buffer, size_t length)
+  {
+    const BYTE * base = machine && buffer ? getBank(bank) : nullptr;
+    if (!base || address + length > 0x10000)
+      return AW_INVALID;
+
+    memcpy(buffer, base + address, length);
+    return AW_OK;
+  }
+
+  int aw_write_memory(aw_machine * machine, int bank, uint16_t address, const void * buffer, size_t length)
+  {
+    BYTE * base = machine && buffer ? getBank(bank) : nullptr;
+    if (!base || address + length > 0x10000)
+      return AW_INVALID;
+
+    if (length)
+    {
+      memcpy(base + address, buffer, length);
+      if (bank == AW_BANK_CPU)
+      {
+        for (size_t page = address >> 8; page <= (address + length - 1) >> 8; ++page)
+        {
+          memdirty[page] = 0xff;
+        }
+      }
+      else
+      {
+        // reload the 64K view from the banks
+        MemUpdatePaging(TRUE);
+      }
+    }
+    return AW_OK;
+  }
+
+  uint8_t aw_peek(aw_machine * machine, uint16_t address)
+  {
+    return machine ? mem[address] : 0;
+  }
+
+  void aw_poke(aw_machine * machine, uint16_t address, uint8_t value)
+  {
+    if (machine)
+    {
+      mem[address] = value;
+      memdirty[address >> 8] = 0xff;
+    }
+  }
+
+  int aw_key(aw_machine * machine, uint8_t key)
+  {
+    if (!machine)
+      return AW_INVALID;
+
+    addKeyToBuffer(key);
+    return AW_OK;
+  }
+
+  int aw_type(aw_machine * machine, const char * text)
+  {
+    if (!machine || !text)
+      return AW_INVALID;
+
+    addTextToBuffer(text);
+    return AW_OK;
+  }
+
+}
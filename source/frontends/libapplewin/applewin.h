@@ -0,0 +1,123 @@
+#ifndef APPLEWIN_H
+#define APPLEWIN_H
+
+/*
+ * libapplewin: the emulator as a component.
+ *
+ * The emulator keeps its state in globals: there is at most one machine per process,
+ * and all the calls must come from the same thread.
+ * Functions returning int return AW_OK (0) or a negative error, see aw_last_error().
+ * Pointers returned by the library stay valid until the next call that runs the machine.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AW_API_VERSION 2
+
+#define AW_EXPORT __attribute__((visibility("default")))
+
+enum
+{
+  AW_OK = 0,
+  AW_ERROR = -1,         /* see aw_last_error() */
+  AW_BUSY = -2,          /* a machine already exists */
+  AW_INVALID = -3,       /* invalid argument */
+};
+
+enum
+{
+  AW_BANK_CPU = -1,      /* the 64K seen by the CPU, banks 0.. are RAM (0 main, 1 aux, 2.. RamWorks) */
+};
+
+typedef struct aw_machine aw_machine;
+
+/* a registry value, as in the configuration file ([section] key=value) */
+typedef struct aw_option
+{
+  const char * section;
+  const char * key;
+  const char * value;
+} aw_option;
+
+typedef struct aw_registers
+{
+  uint8_t a;
+  uint8_t x;
+  uint8_t y;
+  uint8_t p;
+  uint8_t sp;            /* in page 1 */
+  uint16_t pc;
+} aw_registers;
+
+/* BGRA, no border, top row first */
+typedef struct aw_framebuffer
+{
+  const uint8_t * pixels;
+  int width;
+  int height;
+  ptrdiff_t pitch;       /* bytes from one row to the next (negative) */
+} aw_framebuffer;
+
+/* 16 bit signed samples produced by the last run, their number follows the emulated cycles */
+typedef struct aw_audio
+{
+  int sample_rate;
+  const int16_t * speaker;           /* mono */
+  size_t speaker_samples;
+  const int16_t * mockingboard;      /* stereo, interleaved */
+  size_t mockingboard_samples;       /* per channel */
+} aw_audio;
+
+/* checked by aw_run_until() after each slice, non zero to stop */
+typedef int (*aw_stop_fn)(aw_machine * machine, void * context);
+
+AW_EXPORT int aw_api_version(void);
+AW_EXPORT const char * aw_version(void);
+/* of the last failed call (also of aw_create()), empty if none */
+AW_EXPORT const char * aw_last_error(void);
+
+/* config_file: read only, as ~/.applewin/applewin.conf (NULL for the defaults), then the options are applied */
+AW_EXPORT aw_machine * aw_create(const char * config_file, const aw_option * options, size_t count);
+AW_EXPORT void aw_destroy(aw_machine * machine);
+/* power_cycle: 0 for Ctrl-Reset */
+AW_EXPORT int aw_reset(aw_machine * machine, int power_cycle);
+
+/* Disk II in slot 6, drive 0 or 1 */
+AW_EXPORT int aw_insert_disk(aw_machine * machine, int drive, const char * filename, int write_protected);
+AW_EXPORT int aw_eject_disk(aw_machine * machine, int drive);
+/* hard disk in slot 7 (the card is added if needed), drive 0 or 1 */
+AW_EXPORT int aw_insert_hdd(aw_machine * machine, int drive, const char * filename);
+AW_EXPORT int aw_load_snapshot(aw_machine * machine, const char * filename);
+AW_EXPORT int aw_save_snapshot(aw_machine * machine, const char * filename);
+
+/* both return the number of cycles executed (at least the requested number, to the end of the instruction) */
+AW_EXPORT uint64_t aw_run(aw_machine * machine, uint64_t cycles);
+AW_EXPORT uint64_t aw_run_until(aw_machine * machine, uint64_t max_cycles, uint32_t slice_cycles, aw_stop_fn stop, void * context);
+AW_EXPORT uint64_t aw_get_cycles(aw_machine * machine);
+
+/* headless: the video timing (floating bus, VBL) is kept, but the frame is only rendered by aw_get_framebuffer() */
+AW_EXPORT int aw_set_headless(aw_machine * machine, int headless);     /* since API version 2 */
+AW_EXPORT int aw_get_framebuffer(aw_machine * machine, aw_framebuffer * framebuffer);
+AW_EXPORT int aw_get_audio(aw_machine * machine, aw_audio * audio);
+
+AW_EXPORT int aw_get_registers(aw_machine * machine, aw_registers * registers);
+AW_EXPORT int aw_set_registers(aw_machine * machine, const aw_registers * registers);
+AW_EXPORT int aw_read_memory(aw_machine * machine, int bank, uint16_t address, void * buffer, size_t length);
+AW_EXPORT int aw_write_memory(aw_machine * machine, int bank, uint16_t address, const void * buffer, size_t length);
+AW_EXPORT uint8_t aw_peek(aw_machine * machine, uint16_t address);
+AW_EXPORT void aw_poke(aw_machine * machine, uint16_t address, uint8_t value);
+
+/* Apple keys (ASCII, 0x0d for Return), queued and delivered as the machine reads them */
+AW_EXPORT int aw_key(aw_machine * machine, uint8_t key);
+AW_EXPORT int aw_type(aw_machine * machine, const char * text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
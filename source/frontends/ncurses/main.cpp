@@ -14,12 +14,15 @@
 #include "SaveState.h"
 #include "Utilities.h"
 #include "Interface.h"
+#include "PerfCounters.h"
+#include "Speaker.h"
 
 #include "linux/benchmark.h"
 #include "linux/paddle.h"
 #include "linux/context.h"
 #include "frontends/common2/fileregistry.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/capture.h"
 #include "frontends/common2/utils.h"
 #include "frontends/ncurses/world.h"
 #include "frontends/ncurses/nframe.h"
@@ -27,8 +30,10 @@
 
 namespace
 {
-  bool ContinueExecution(const common2::EmulatorOptions & options, const std::shared_ptr<na2::NFrame> & frame)
+  bool ContinueExecution(const common2::EmulatorOptions & options, const std::shared_ptr<na2::NFrame> & frame,
+                         const std::shared_ptr<common2::Capture> & capture)
   {
+    PerfMarker perfMarkerFrame(PERF_FRAME);
     const auto start = std::chrono::steady_clock::now();
 
     const double fUsecPerSec        = 1.e6;
@@ -43,8 +48,9 @@ namespace
 
     const DWORD uCyclesToExecute = fExecutionPeriodClks;
 
-    const bool bVideoUpdate = options.ntsc;
-    g_bFullSpeed = !bVideoUpdate;
+    // without --ntsc, the video is headless (see EnterMessageLoop())
+    // g_bFullSpeed is left alone: the captured speaker & Mockingboard audio follow the emulated cycles at any speed
+    const bool bVideoUpdate = true;
 
     const DWORD uActualCyclesExecuted = CpuExecute(uCyclesToExecute, bVideoUpdate);
     g_dwCyclesThisFrame += uActualCyclesExecuted;
@@ -53,6 +59,13 @@ namespace
 
     cardManager.Update(uActualCyclesExecuted);
 
+    if (capture)
+    {
+      // applen has no audio output: the speaker is only rendered for the capture
+      SpkrUpdate(uActualCyclesExecuted);
+      capture->update(options.ntsc);
+    }
+
     const int key = ProcessKeyboard(frame);
 
     switch (key)
@@ -100,10 +113,13 @@ namespace
       g_dwCyclesThisFrame = g_dwCyclesThisFrame % dwClksPerFrame;
       if (!options.headless)
       {
+        PerfMarker perfMarkerPresent(PERF_PRESENT);
         frame->VideoPresentScreen();
       }
     }
 
+    perfMarkerFrame.Stop();  // before sleeping
+
     if (!options.headless)
     {
       const auto end = std::chrono::steady_clock::now();
@@ -130,11 +146,18 @@ namespace
     }
   }
 
-  void EnterMessageLoop(const common2::EmulatorOptions & options, const std::shared_ptr<na2::NFrame> & frame)
+  void EnterMessageLoop(const common2::EmulatorOptions & options, const std::shared_ptr<na2::NFrame> & frame,
+                        const std::shared_ptr<common2::Capture> & capture)
   {
-    while (ContinueExecution(options, frame))
+    // the screen is drawn from the memory: the NTSC video only keeps its timing (floating bus, VBL)
+    NTSC_SetHeadless(!options.ntsc);
+
+    while (ContinueExecution(options, frame, capture))
     {
+      PerfFrameEnd();
     }
+
+    NTSC_SetHeadless(false);
   }
 
   int run_ncurses(int argc, const char * argv [])
@@ -160,6 +183,13 @@ namespace
       frame->LoadSnapshot();
     }
 
+    if (!frame->StartMovie(options.movieRecordFilename, options.moviePlayFilename))
+    {
+      std::cerr << "Failed to start the movie" << std::endl;
+    }
+
+    std::shared_ptr<common2::Capture> capture = common2::createCapture(options);
+
     na2::SetCtrlCHandler(options.headless);
 
     if (options.benchmark)
@@ -169,8 +199,9 @@ namespace
     }
     else
     {
-      EnterMessageLoop(options, frame);
+      EnterMessageLoop(options, frame, capture);
     }
+    capture.reset();  // before the emulator is destroyed
     frame->End();
 
     return 0;
@@ -22,19 +22,26 @@ Emulator::~Emulator()
     delete ui;
 }
 
+void Emulator::setWorker(EmulatorWorker * worker)
+{
+    ui->video->setWorker(worker);
+}
+
 void Emulator::refreshScreen(const bool force)
 {
+    ui->video->publishFrame();
+
     if (force)
     {
         ui->video->repaint();
     }
     else
     {
-        ui->video->update();
+        ui->video->requestUpdate();
     }
 }
 
-bool Emulator::saveScreen(const QString & filename) const
+bool Emulator::saveScreen(const QString & filename)
 {
     return ui->video->getScreen().save(filename);
 }
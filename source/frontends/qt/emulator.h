@@ -4,6 +4,7 @@
 #include <QFrame>
 
 class QMdiSubWindow;
+class EmulatorWorker;
 
 namespace Ui {
 class Emulator;
@@ -17,10 +18,12 @@ public:
     explicit Emulator(QWidget *parent = nullptr);
     ~Emulator();
 
+    void setWorker(EmulatorWorker * worker);
+
     void redrawScreen();    // regenerate image and repaint
-    void refreshScreen(const bool force);
+    void refreshScreen(const bool force);   // force is only allowed on the GUI thread
 
-    bool saveScreen(const QString & filename) const;
+    bool saveScreen(const QString & filename);
     void loadVideoSettings();
     void unloadVideoSettings();
     void displayLogo();
@@ -0,0 +1,235 @@
+#include "emulatorworker.h"
+
+#include "StdAfx.h"
+#include "Common.h"
+#include "CardManager.h"
+#include "Core.h"
+#include "Disk.h"
+#include "CPU.h"
+#include "NTSC.h"
+#include "Speaker.h"
+
+#include "qdirectsound.h"
+#include "qtframe.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <algorithm>
+
+namespace
+{
+
+    qint64 emulatorTimeInMS()
+    {
+        const double timeInSeconds = g_nCumulativeCycles / g_fCurrentCLK6502;
+        const qint64 timeInMS = timeInSeconds * 1000;
+        return timeInMS;
+    }
+
+}
+
+EmulatorWorker::EmulatorWorker(const std::shared_ptr<QtFrame> & frame) :
+    myFrame(frame),
+    myTimerID(0),
+    myMsGap(0),
+    myMsFullSpeed(0),
+    myCpuTimeReference(0),
+    myQuestion(nullptr),
+    myAnswered(false),
+    myAnswer(0)
+{
+}
+
+void EmulatorWorker::execute(const std::function<void()> & function)
+{
+    if (QThread::currentThread() == thread())
+    {
+        function();
+        return;
+    }
+
+    // the function might ask a question (e.g. a disk swap while the drive is on),
+    // so the GUI thread waits for either the end of the function or a question, rather than blocking on the connection
+    bool done = false;
+    QMetaObject::invokeMethod(this, [this, &function, &done]()
+    {
+        function();
+        std::lock_guard<std::mutex> guard(myQuestionMutex);
+        done = true;
+        myQuestionCondition.notify_all();
+    }, Qt::QueuedConnection);
+
+    std::unique_lock<std::mutex> lock(myQuestionMutex);
+    while (!done)
+    {
+        myQuestionCondition.wait(lock, [this, &done]() { return done || myQuestion; });
+        answerQuestion(lock);
+    }
+}
+
+int EmulatorWorker::ask(const std::function<int()> & question)
+{
+    std::unique_lock<std::mutex> lock(myQuestionMutex);
+    myQuestion = &question;
+    myAnswered = false;
+
+    // the GUI thread is either waiting in execute(), or running its event loop
+    myQuestionCondition.notify_all();
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [this]()
+    {
+        std::unique_lock<std::mutex> guiLock(myQuestionMutex);
+        answerQuestion(guiLock);
+    }, Qt::QueuedConnection);
+
+    myQuestionCondition.wait(lock, [this]() { return myAnswered; });
+    return myAnswer;
+}
+
+void EmulatorWorker::answerQuestion(std::unique_lock<std::mutex> & lock)
+{
+    // GUI thread, the question has not been picked up yet
+    if (!myQuestion)
+    {
+        return;
+    }
+
+    const std::function<int()> * question = myQuestion;
+    myQuestion = nullptr;
+
+    lock.unlock();
+    const int answer = (*question)();
+    lock.lock();
+
+    myAnswer = answer;
+    myAnswered = true;
+    myQuestionCondition.notify_all();
+}
+
+void EmulatorWorker::post(const std::function<void()> & input)
+{
+    std::lock_guard<std::mutex> guard(myInputMutex);
+    myInput.push_back(input);
+}
+
+void EmulatorWorker::processInput()
+{
+    {
+        std::lock_guard<std::mutex> guard(myInputMutex);
+        myInputToProcess.swap(myInput);
+    }
+
+    for (const std::function<void()> & input : myInputToProcess)
+    {
+        input();
+    }
+    myInputToProcess.clear();
+}
+
+void EmulatorWorker::start(const int msGap, const int msFullSpeed)
+{
+    stop();
+
+    myMsGap = msGap;
+    myMsFullSpeed = msFullSpeed;
+    myTimerID = startTimer(myMsGap, Qt::PreciseTimer);
+    restartTimeCounters();
+}
+
+void EmulatorWorker::stop()
+{
+    if (myTimerID)
+    {
+        restartTimeCounters();
+        killTimer(myTimerID);
+        myTimerID = 0;
+    }
+}
+
+void EmulatorWorker::restartTimeCounters()
+{
+    // let them restart next time
+    QDirectSound::stop();
+    myElapsedTimer.invalidate();
+}
+
+void EmulatorWorker::timerEvent(QTimerEvent *)
+{
+    QDirectSound::start();
+
+    processInput();
+
+    if (!myElapsedTimer.isValid())
+    {
+        myElapsedTimer.start();
+        myCpuTimeReference = emulatorTimeInMS();
+    }
+
+    // target x ms ahead of where we are now, which is when the timer should be called again
+    const qint64 target = myElapsedTimer.elapsed() + myMsGap;
+    const qint64 current = emulatorTimeInMS() - myCpuTimeReference;
+    if (current > target)
+    {
+        // we got ahead of the timer by a lot
+
+        // just check if we got something to write
+        QDirectSound::writeAudio();
+
+        // wait next call
+        return;
+    }
+
+    const qint64 maximumToRum = 10 * myMsGap;  // just to avoid crazy times (e.g. debugging)
+    const qint64 toRun = std::min(target - current, maximumToRum);
+    const double fUsecPerSec        = 1.e6;
+    const qint64 nExecutionPeriodUsec = 1000 * toRun;
+
+    const double fExecutionPeriodClks = g_fCurrentCLK6502 * (double(nExecutionPeriodUsec) / fUsecPerSec);
+    const DWORD uCyclesToExecute = fExecutionPeriodClks;
+
+    const bool bVideoUpdate = true;
+
+    CardManager & cardManager = GetCardMgr();
+
+    int count = 0;
+    qint64 presented = myElapsedTimer.elapsed();
+    const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
+    do
+    {
+        if (count > 0)
+        {
+            // full speed: keep the input and the screen going at the normal pace
+            processInput();
+
+            const qint64 now = myElapsedTimer.elapsed();
+            if (now >= presented + myMsGap)
+            {
+                myFrame->VideoPresentScreen();
+                presented = now;
+            }
+        }
+
+        const DWORD uActualCyclesExecuted = CpuExecute(uCyclesToExecute, bVideoUpdate);
+        g_dwCyclesThisFrame += uActualCyclesExecuted;
+        cardManager.Update(uActualCyclesExecuted);
+        SpkrUpdate(uActualCyclesExecuted);
+
+        // in case we run more than 1 frame
+        g_dwCyclesThisFrame = g_dwCyclesThisFrame % dwClksPerFrame;
+        ++count;
+    }
+    while (cardManager.GetDisk2CardMgr().IsConditionForFullSpeed() && (myElapsedTimer.elapsed() < target + myMsFullSpeed));
+
+    // just publish each time, to make it simpler
+    // we run @ 60 fps anyway
+    myFrame->VideoPresentScreen();
+
+    if (count > 1)  // 1 is the non-full speed case
+    {
+        restartTimeCounters();
+    }
+    else
+    {
+        QDirectSound::writeAudio();
+    }
+}
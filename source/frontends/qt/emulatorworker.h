@@ -0,0 +1,71 @@
+#ifndef EMULATORWORKER_H
+#define EMULATORWORKER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class QtFrame;
+
+// Runs the emulator on the thread it is moved to.
+//
+// Anything that changes the machine must run on that thread:
+// the GUI thread uses execute() for commands (reboot, snapshots, options...)
+// and post() for input events, which are delivered between 2 slices, even at full speed.
+// Frames go the other way through QVideo's triple buffer, and questions (message boxes) through ask().
+class EmulatorWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EmulatorWorker(const std::shared_ptr<QtFrame> & frame);
+
+    // runs the function on the emulator thread and waits for it
+    // (answering any question the function asks meanwhile)
+    void execute(const std::function<void()> & function);
+
+    // thread safe, the input is processed by the emulator thread before the next slice
+    void post(const std::function<void()> & input);
+
+    // only on the emulator thread: runs the question on the GUI thread and waits for the answer
+    int ask(const std::function<int()> & question);
+
+    // only on the emulator thread
+    void start(const int msGap, const int msFullSpeed);
+    void stop();
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    void processInput();
+    void restartTimeCounters();
+    void answerQuestion(std::unique_lock<std::mutex> & lock);
+
+    std::shared_ptr<QtFrame> myFrame;
+
+    int myTimerID;
+    int myMsGap;
+    int myMsFullSpeed;
+
+    QElapsedTimer myElapsedTimer;
+    qint64 myCpuTimeReference;
+
+    std::mutex myInputMutex;
+    std::vector<std::function<void()>> myInput;
+    std::vector<std::function<void()>> myInputToProcess;
+
+    // the GUI thread picks up the question either in execute() or from its event loop
+    std::mutex myQuestionMutex;
+    std::condition_variable myQuestionCondition;
+    const std::function<int()> * myQuestion;
+    bool myAnswered;
+    int myAnswer;
+};
+
+#endif // EMULATORWORKER_H
@@ -1,8 +1,9 @@
 #include "gamepadpaddle.h"
+#include "emulatorworker.h"
 
 #include <QGamepad>
 
-std::shared_ptr<Paddle> GamepadPaddle::fromName(const QString & name)
+std::shared_ptr<Paddle> GamepadPaddle::fromName(const QString & name, EmulatorWorker * worker)
 {
     if (name.isEmpty())
     {
@@ -17,7 +18,7 @@ std::shared_ptr<Paddle> GamepadPaddle::fromName(const QString & name)
         if (name == manager->gamepadName(id))
         {
             const std::shared_ptr<QGamepad> gamepad(new QGamepad(id));
-            std::shared_ptr<Paddle> paddle(new GamepadPaddle(gamepad));
+            std::shared_ptr<Paddle> paddle(new GamepadPaddle(gamepad, worker));
             return paddle;
         }
     }
@@ -25,9 +26,21 @@ std::shared_ptr<Paddle> GamepadPaddle::fromName(const QString & name)
     return nullptr;
 }
 
-GamepadPaddle::GamepadPaddle(const std::shared_ptr<QGamepad> & gamepad) : myGamepad(gamepad)
+GamepadPaddle::GamepadPaddle(const std::shared_ptr<QGamepad> & gamepad, EmulatorWorker * worker) : myGamepad(gamepad), myState(std::make_shared<State>())
 {
+    // not shared yet: the initial state is read directly
+    myState->buttons[0] = myGamepad->buttonA();
+    myState->buttons[1] = myGamepad->buttonB();
+    myState->axes[0] = myGamepad->axisLeftX();
+    myState->axes[1] = myGamepad->axisLeftY();
 
+    // the posted input keeps the state alive, even if it arrives after the paddle has been replaced
+    const std::shared_ptr<State> state = myState;
+    QGamepad * source = myGamepad.get();
+    QObject::connect(source, &QGamepad::buttonAChanged, source, [worker, state](bool value) { worker->post([state, value]() { state->buttons[0] = value; }); });
+    QObject::connect(source, &QGamepad::buttonBChanged, source, [worker, state](bool value) { worker->post([state, value]() { state->buttons[1] = value; }); });
+    QObject::connect(source, &QGamepad::axisLeftXChanged, source, [worker, state](double value) { worker->post([state, value]() { state->axes[0] = value; }); });
+    QObject::connect(source, &QGamepad::axisLeftYChanged, source, [worker, state](double value) { worker->post([state, value]() { state->axes[1] = value; }); });
 }
 
 bool GamepadPaddle::getButton(int i) const
@@ -35,9 +48,8 @@ bool GamepadPaddle::getButton(int i) const
     switch (i)
     {
     case 0:
-        return myGamepad->buttonA();
     case 1:
-        return myGamepad->buttonB();
+        return myState->buttons[i];
     default:
         return 0;
     }
@@ -49,10 +61,8 @@ double GamepadPaddle::getAxis(int i) const
     switch (i)
     {
     case 0:
-        value = myGamepad->axisLeftX();
-        break;
     case 1:
-        value = myGamepad->axisLeftY();
+        value = myState->axes[i];
         break;
     default:
         value = 0.0;
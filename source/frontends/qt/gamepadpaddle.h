@@ -3,20 +3,30 @@
 
 #include "linux/paddle.h"
 
+class EmulatorWorker;
 class QGamepad;
 class QString;
 
+// The QGamepad lives on the GUI thread: its changes are posted to the emulator thread,
+// which only reads the last snapshot of the axes and buttons.
 class GamepadPaddle : public Paddle
 {
 public:
-    static std::shared_ptr<Paddle> fromName(const QString & name);
+    static std::shared_ptr<Paddle> fromName(const QString & name, EmulatorWorker * worker);
 
     bool getButton(int i) const override;
     double getAxis(int i) const override;
 
 private:
-    GamepadPaddle(const std::shared_ptr<QGamepad> & gamepad);
+    struct State
+    {
+        bool buttons[2];
+        double axes[2];
+    };
+
+    GamepadPaddle(const std::shared_ptr<QGamepad> & gamepad, EmulatorWorker * worker);
     const std::shared_ptr<QGamepad> myGamepad;
+    const std::shared_ptr<State> myState;  // only used by the emulator thread, once the paddle is installed
 };
 
 #endif // GAMEPADPADDLE_H
@@ -24,6 +24,7 @@
 #include "linux/context.h"
 
 #include "emulator.h"
+#include "emulatorworker.h"
 #include "memorycontainer.h"
 #include "qdirectsound.h"
 #include "gamepadpaddle.h"
@@ -70,13 +71,6 @@ namespace
      *
      */
 
-    qint64 emulatorTimeInMS()
-    {
-        const double timeInSeconds = g_nCumulativeCycles / g_fCurrentCLK6502;
-        const qint64 timeInMS = timeInSeconds * 1000;
-        return timeInMS;
-    }
-
 }
 
 
@@ -99,7 +93,6 @@ QApple::PauseEmulator::~PauseEmulator()
 
 QApple::QApple(QWidget *parent) :
     QMainWindow(parent),
-    myTimerID(0),
     ui(new Ui::QApple)
 {
     ui->setupUi(this);
@@ -127,28 +120,43 @@ QApple::QApple(QWidget *parent) :
     myFrame.reset(new QtFrame(emulator, myEmulatorWindow));
     SetFrame(myFrame);
 
+    myWorker = new EmulatorWorker(myFrame);
+    myWorker->moveToThread(&myEmulatorThread);
+    connect(&myEmulatorThread, &QThread::finished, myWorker, &QObject::deleteLater);
+    emulator->setWorker(myWorker);
+    myFrame->setWorker(myWorker);
+    myEmulatorThread.start();
+
     readSettings();
 
     myOptions = GlobalOptions::fromQSettings();
     reloadOptions();
 
     on_actionPause_triggered();
-    initialiseEmulator();
-    myFrame->Begin();
+    myWorker->execute([this]()
+    {
+        initialiseEmulator();
+        myFrame->Begin();
+    });
 
     setAcceptDrops(true);
 }
 
 QApple::~QApple()
 {
+    myEmulatorThread.quit();
+    myEmulatorThread.wait();
     delete ui;
 }
 
 void QApple::closeEvent(QCloseEvent * event)
 {
-    stopTimer();
-    myFrame->End();
-    QDirectSound::stop();
+    myWorker->execute([this]()
+    {
+        myWorker->stop();
+        myFrame->End();
+        QDirectSound::stop();
+    });
 
     QSettings settings;
     settings.setValue("QApple/window/geometry", saveGeometry().toBase64());
@@ -177,100 +185,25 @@ void QApple::startEmulator()
     ui->actionStart->trigger();
 }
 
-void QApple::on_timer()
-{
-    QDirectSound::start();
-
-    if (!myElapsedTimer.isValid())
-    {
-        myElapsedTimer.start();
-        myCpuTimeReference = emulatorTimeInMS();
-    }
-
-    // target x ms ahead of where we are now, which is when the timer should be called again
-    const qint64 target = myElapsedTimer.elapsed() + myOptions.msGap;
-    const qint64 current = emulatorTimeInMS() - myCpuTimeReference;
-    if (current > target)
-    {
-        // we got ahead of the timer by a lot
-
-        // just check if we got something to write
-        QDirectSound::writeAudio();
-
-        // wait next call
-        return;
-    }
-
-    const qint64 maximumToRum = 10 * myOptions.msGap;  // just to avoid crazy times (e.g. debugging)
-    const qint64 toRun = std::min(target - current, maximumToRum);
-    const double fUsecPerSec        = 1.e6;
-    const qint64 nExecutionPeriodUsec = 1000 * toRun;
-
-    const double fExecutionPeriodClks = g_fCurrentCLK6502 * (double(nExecutionPeriodUsec) / fUsecPerSec);
-    const DWORD uCyclesToExecute = fExecutionPeriodClks;
-
-    const bool bVideoUpdate = true;
-
-    CardManager & cardManager = GetCardMgr();
-
-    int count = 0;
-    const UINT dwClksPerFrame = NTSC_GetCyclesPerFrame();
-    do
-    {
-        const DWORD uActualCyclesExecuted = CpuExecute(uCyclesToExecute, bVideoUpdate);
-        g_dwCyclesThisFrame += uActualCyclesExecuted;
-        cardManager.Update(uActualCyclesExecuted);
-        SpkrUpdate(uActualCyclesExecuted);
-
-        // in case we run more than 1 frame
-        g_dwCyclesThisFrame = g_dwCyclesThisFrame % dwClksPerFrame;
-        ++count;
-    }
-    while (cardManager.GetDisk2CardMgr().IsConditionForFullSpeed() && (myElapsedTimer.elapsed() < target + myOptions.msFullSpeed));
-
-    // just repaint each time, to make it simpler
-    // we run @ 60 fps anyway
-    myFrame->VideoPresentScreen();
-
-    if (count > 1)  // 1 is the non-full speed case
-    {
-        restartTimeCounters();
-    }
-    else
-    {
-        QDirectSound::writeAudio();
-    }
-}
-
-void QApple::stopTimer()
+void QApple::stopEmulator()
 {
-    if (myTimerID)
-    {
-        restartTimeCounters();
-        killTimer(myTimerID);
-        myTimerID = 0;
-    }
-}
-
-void QApple::restartTimeCounters()
-{
-    // let them restart next time
-    QDirectSound::stop();
-    myElapsedTimer.invalidate();
+    // when this returns, the emulator thread is idle
+    myWorker->execute([this]() { myWorker->stop(); });
 }
 
 void QApple::on_actionStart_triggered()
 {
     // always restart with the same timer gap that was last used
-    myTimerID = startTimer(myOptions.msGap, Qt::PreciseTimer);
+    const int msGap = myOptions.msGap;
+    const int msFullSpeed = myOptions.msFullSpeed;
+    myWorker->execute([this, msGap, msFullSpeed]() { myWorker->start(msGap, msFullSpeed); });
     ui->actionPause->setEnabled(true);
     ui->actionStart->setEnabled(false);
-    restartTimeCounters();
 }
 
 void QApple::on_actionPause_triggered()
 {
-    stopTimer();
+    stopEmulator();
     ui->actionPause->setEnabled(false);
     ui->actionStart->setEnabled(true);
 }
@@ -296,12 +229,19 @@ void QApple::on_actionReboot_triggered()
 
     emit endEmulator();
     mySaveStateLabel->clear();
-    myFrame->Restart();
-    myFrame->VideoPresentScreen();
+    myWorker->execute([this]()
+    {
+        myFrame->Restart();
+        myFrame->VideoPresentScreen();
+    });
 }
 
 void QApple::on_actionBenchmark_triggered()
 {
+    // the benchmark needs to paint synchronously, so it runs on the GUI thread,
+    // while the emulator thread is paused (and it does not touch the sound buffers)
+    PauseEmulator pause(this);
+
     // call repaint as we really want to for a paintEvent() so we can time it properly
     // if video is based on OpenGLWidget, this is not enough though,
     // and benchmark results are bad.
@@ -311,11 +251,6 @@ void QApple::on_actionBenchmark_triggered()
     on_actionReboot_triggered();
 }
 
-void QApple::timerEvent(QTimerEvent *)
-{
-    on_timer();
-}
-
 void QApple::on_actionMemory_triggered()
 {
     MemoryContainer * container = new MemoryContainer(ui->mdiArea);
@@ -337,7 +272,7 @@ void QApple::on_actionOptions_triggered()
     PauseEmulator pause(this);
 
     PreferenceData currentData;
-    getAppleWinPreferences(currentData);
+    myWorker->execute([&currentData]() { getAppleWinPreferences(currentData); });
     currentData.options = myOptions;
 
     QSettings settings; // the function will "modify" it
@@ -346,7 +281,7 @@ void QApple::on_actionOptions_triggered()
     if (myPreferences->exec())
     {
         const PreferenceData newData = myPreferences->getData();
-        setAppleWinPreferences(myFrame, currentData, newData);
+        myWorker->execute([this, &currentData, &newData]() { setAppleWinPreferences(myFrame, currentData, newData); });
         myOptions.setData(newData.options);
         reloadOptions();
     }
@@ -354,16 +289,24 @@ void QApple::on_actionOptions_triggered()
 
 void QApple::reloadOptions()
 {
-    myFrame->FrameRefreshStatus(DRAW_TITLE);
+    // the gamepad must be created (and destroyed) on the GUI thread, its state is posted to the emulator thread
+    std::shared_ptr<const Paddle> paddle = GamepadPaddle::fromName(myOptions.gamepadName, myWorker);
+    const bool gamepadSquaring = myOptions.gamepadSquaring;
+    const int audioLatency = myOptions.audioLatency;
+
+    myWorker->execute([this, &paddle, gamepadSquaring, audioLatency]()
+    {
+        myFrame->FrameRefreshStatus(DRAW_TITLE);
 
-    Paddle::instance = GamepadPaddle::fromName(myOptions.gamepadName);
-    Paddle::setSquaring(myOptions.gamepadSquaring);
-    QDirectSound::setOptions(myOptions.audioLatency);
+        Paddle::instance.swap(paddle);
+        Paddle::setSquaring(gamepadSquaring);
+        QDirectSound::setOptions(audioLatency);
+    });
 }
 
 void QApple::on_actionSave_state_triggered()
 {
-    Snapshot_SaveState();
+    myWorker->execute([]() { Snapshot_SaveState(); });
 }
 
 void QApple::on_actionLoad_state_triggered()
@@ -372,20 +315,26 @@ void QApple::on_actionLoad_state_triggered()
 
     emit endEmulator();
 
-    const std::string & filename = Snapshot_GetFilename();
+    QString filePath;
+    myWorker->execute([this, &filePath]()
+    {
+        const std::string & filename = Snapshot_GetFilename();
+
+        const QFileInfo file(QString::fromStdString(filename));
+        const QString path = file.absolutePath();
+        // this is useful as snapshots from the test
+        // have relative disk location
+        SetCurrentImageDir(path.toStdString().c_str());
 
-    const QFileInfo file(QString::fromStdString(filename));
-    const QString path = file.absolutePath();
-    // this is useful as snapshots from the test
-    // have relative disk location
-    SetCurrentImageDir(path.toStdString().c_str());
+        Snapshot_LoadState();
 
-    Snapshot_LoadState();
+        myFrame->FrameRefreshStatus(DRAW_TITLE);
+        myFrame->VideoPresentScreen();
 
-    myFrame->FrameRefreshStatus(DRAW_TITLE);
-    myFrame->VideoPresentScreen();
+        filePath = file.filePath();
+    });
 
-    QString message = QString("State file: %1").arg(file.filePath());
+    QString message = QString("State file: %1").arg(filePath);
     mySaveStateLabel->setText(message);
 }
 
@@ -440,12 +389,16 @@ void QApple::on_actionScreenshot_triggered()
 void QApple::on_actionSwap_disks_triggered()
 {
     PauseEmulator pause(this);
-    CardManager & cardManager = GetCardMgr();
 
-    if (cardManager.QuerySlot(SLOT6) == CT_Disk2)
+    myWorker->execute([]()
     {
-        dynamic_cast<Disk2InterfaceCard*>(cardManager.GetObj(SLOT6))->DriveSwap();
-    }
+        CardManager & cardManager = GetCardMgr();
+
+        if (cardManager.QuerySlot(SLOT6) == CT_Disk2)
+        {
+            dynamic_cast<Disk2InterfaceCard*>(cardManager.GetObj(SLOT6))->DriveSwap();
+        }
+    });
 }
 
 void QApple::on_actionLoad_state_from_triggered()
@@ -468,7 +421,7 @@ void QApple::on_actionLoad_state_from_triggered()
 
 void QApple::on_actionNext_video_mode_triggered()
 {
-    myFrame->CycleVideoType();
+    myWorker->execute([this]() { myFrame->CycleVideoType(); });
 }
 
 void QApple::loadStateFile(const QString & filename)
@@ -478,7 +431,8 @@ void QApple::loadStateFile(const QString & filename)
     // use case is:
     // later, when we change dir to allow loading of disks relative to the yamls file,
     // a snapshot relative path would be lost
-    Snapshot_SetFilename(path.absoluteFilePath().toStdString().c_str());
+    const std::string absoluteFilename = path.absoluteFilePath().toStdString();
+    myWorker->execute([&absoluteFilename]() { Snapshot_SetFilename(absoluteFilename); });
     ui->actionLoad_state->trigger();
 }
 
@@ -3,7 +3,7 @@
 
 
 #include <QMainWindow>
-#include <QElapsedTimer>
+#include <QThread>
 #include <QAudio>
 
 #include <memory>
@@ -14,6 +14,7 @@
 class QMdiSubWindow;
 class Preferences;
 class QtFrame;
+class EmulatorWorker;
 
 namespace Ui {
 class QApple;
@@ -39,7 +40,6 @@ public slots:
 
 protected:
     void closeEvent(QCloseEvent *event) override;
-    void timerEvent(QTimerEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dropEvent(QDropEvent *event) override;
 
@@ -59,8 +59,6 @@ private slots:
 
     void on_actionBenchmark_triggered();
 
-    void on_timer();
-
     void on_actionMemory_triggered();
 
     void on_actionOptions_triggered();
@@ -99,19 +97,19 @@ private:
     };
 
     void readSettings();
-    void stopTimer();
-    void restartTimeCounters();
+    void stopEmulator();
     void reloadOptions();
 
-    int myTimerID;
     Preferences * myPreferences;
 
     QLabel * mySaveStateLabel;
 
     std::shared_ptr<QtFrame> myFrame;
-    QElapsedTimer myElapsedTimer;
     QMdiSubWindow * myEmulatorWindow;
-    qint64 myCpuTimeReference;
+
+    // the emulator runs on its own thread, the GUI thread only presents the frames
+    QThread myEmulatorThread;
+    EmulatorWorker * myWorker;
 
     GlobalOptions myOptions;
 
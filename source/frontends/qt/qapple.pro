@@ -22,7 +22,8 @@ SOURCES += main.cpp\
     preferences.cpp \
     gamepadpaddle.cpp \
     viewbuffer.cpp \
-    qtframe.cpp
+    qtframe.cpp \
+    emulatorworker.cpp
 
 HEADERS  += qapple.h \
     emulator.h \
@@ -36,6 +37,8 @@ HEADERS  += qapple.h \
     gamepadpaddle.h \
     viewbuffer.h \
     qtframe.h \
+    emulatorworker.h \
+    triplebuffer.h \
     applicationname.h
 
 FORMS    += qapple.ui \
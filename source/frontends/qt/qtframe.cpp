@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 #include "qtframe.h"
 #include "emulator.h"
+#include "emulatorworker.h"
 
 #include "Core.h"
 #include "Utilities.h"
@@ -12,12 +13,29 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QStandardPaths>
+#include <QThread>
 
-QtFrame::QtFrame(Emulator * emulator, QMdiSubWindow * window) : myEmulator(emulator), myWindow(window), myForceRepaint(false)
+namespace
+{
+
+    // the frame is used by the emulator thread, widgets can only be touched by the GUI thread
+    bool isGuiThread(const QObject * object)
+    {
+        return QThread::currentThread() == object->thread();
+    }
+
+}
+
+QtFrame::QtFrame(Emulator * emulator, QMdiSubWindow * window) : myEmulator(emulator), myWorker(nullptr), myWindow(window), myForceRepaint(false)
 {
 
 }
 
+void QtFrame::setWorker(EmulatorWorker * worker)
+{
+    myWorker = worker;
+}
+
 void QtFrame::SetForceRepaint(const bool force)
 {
     myForceRepaint = force;
@@ -33,7 +51,9 @@ void QtFrame::FrameRefreshStatus(int drawflags)
     if (drawflags & DRAW_TITLE)
     {
         GetAppleWindowTitle();
-        myWindow->setWindowTitle(QString::fromStdString(g_pAppTitle));
+        const QString title = QString::fromStdString(g_pAppTitle);
+        QMdiSubWindow * window = myWindow;
+        QMetaObject::invokeMethod(window, [window, title]() { window->setWindowTitle(title); }, Qt::AutoConnection);
     }
 }
 
@@ -61,13 +81,19 @@ void QtFrame::Set43Ratio()
     myEmulator->set43AspectRatio(myWindow);
 }
 
-bool QtFrame::saveScreen(const QString & filename) const
+bool QtFrame::saveScreen(const QString & filename)
 {
     return myEmulator->saveScreen(filename);
 }
 
 int QtFrame::FrameMessageBox(LPCSTR lpText, LPCSTR lpCaption, UINT uType)
 {
+    if (!isGuiThread(myWindow))
+    {
+        // the message box is shown by the GUI thread, the emulator thread waits for the answer
+        return myWorker->ask([this, lpText, lpCaption, uType]() { return FrameMessageBox(lpText, lpCaption, uType); });
+    }
+
     QMessageBox::StandardButtons buttons = QMessageBox::Ok;
     if (uType & MB_YESNO)
     {
@@ -7,6 +7,7 @@
 #include <QString>
 
 class Emulator;
+class EmulatorWorker;
 class QMdiSubWindow;
 
 class QtFrame : public LinuxFrame
@@ -24,13 +25,15 @@ public:
     BYTE* GetResource(WORD id, LPCSTR lpType, DWORD expectedSize) override;
     std::string Video_GetScreenShotFolder() const override;
 
+    void setWorker(EmulatorWorker * worker);
     void SetForceRepaint(const bool force);
     void SetZoom(const int x);
     void Set43Ratio();
-    bool saveScreen(const QString & filename) const;
+    bool saveScreen(const QString & filename);
 
 private:
     Emulator * myEmulator;
+    EmulatorWorker * myWorker;
     QMdiSubWindow * myWindow;
     bool myForceRepaint;
 
@@ -13,13 +13,22 @@
 #include "Video.h"
 #include "Interface.h"
 
-QVideo::QVideo(QWidget *parent) : QVIDEO_BASECLASS(parent)
+#include "emulatorworker.h"
+
+#include <cstring>
+
+QVideo::QVideo(QWidget *parent) : QVIDEO_BASECLASS(parent), myWorker(nullptr), myUpdatePending(false), myFrameBuffer(nullptr)
 {
     this->setMouseTracking(true);
 
     myLogo = QImage(":/resources/APPLEWINLOGO.BMP").mirrored(false, true);
 }
 
+void QVideo::setWorker(EmulatorWorker * worker)
+{
+    myWorker = worker;
+}
+
 void QVideo::loadVideoSettings()
 {
     Video & video = GetVideo();
@@ -48,10 +57,11 @@ QImage QVideo::getScreenImage() const
     return frameBuffer;
 }
 
-QImage QVideo::getScreen() const
+QImage QVideo::getScreen()
 {
-    QImage frameBuffer = getScreenImage();
-    QImage screen = frameBuffer.copy(mySX, mySY, mySW, mySH);
+    myFrames.update();
+    const VideoFrame & frame = myFrames.front();
+    QImage screen = frame.image.copy(frame.screen);
 
     return screen;
 }
@@ -64,13 +74,49 @@ void QVideo::displayLogo()
     painter.drawImage(myLogoX, myLogoY, myLogo);
 }
 
+void QVideo::publishFrame()
+{
+    if (!myFrameBuffer)
+    {
+        return;
+    }
+
+    // copy the frame as it is now, so the emulator can carry on writing to the framebuffer
+    VideoFrame & frame = myFrames.back();
+    if (frame.image.width() != myWidth || frame.image.height() != myHeight)
+    {
+        frame.image = QImage(myWidth, myHeight, QImage::Format_ARGB32_Premultiplied);
+    }
+    memcpy(frame.image.bits(), myFrameBuffer, frame.image.sizeInBytes());
+    frame.screen = QRect(mySX, mySY, mySW, mySH);
+
+    myFrames.publish();
+}
+
+void QVideo::requestUpdate()
+{
+    // a single pending update is enough, it paints the latest frame
+    if (!myUpdatePending.exchange(true))
+    {
+        QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+    }
+}
+
 void QVideo::paintEvent(QPaintEvent *)
 {
-    QImage frameBuffer = getScreenImage();
+    myUpdatePending = false;
+    myFrames.update();
 
+    const VideoFrame & frame = myFrames.front();
+    if (frame.image.isNull())
+    {
+        return;
+    }
+
+    const QRect & screen = frame.screen;
     const QSize actual = size();
-    const double scaleX = double(actual.width()) / mySW;
-    const double scaleY = double(actual.height()) / mySH;
+    const double scaleX = double(actual.width()) / screen.width();
+    const double scaleY = double(actual.height()) / screen.height();
 
     // then paint it on the widget with scale
     {
@@ -80,7 +126,7 @@ void QVideo::paintEvent(QPaintEvent *)
         const QTransform transform(scaleX, 0.0, 0.0, -scaleY, 0.0, actual.height());
         painter.setTransform(transform);
 
-        painter.drawImage(0, 0, frameBuffer, mySX, mySY, mySW, mySH);
+        painter.drawImage(0, 0, frame.image, screen.x(), screen.y(), screen.width(), screen.height());
     }
 }
 
@@ -112,10 +158,10 @@ void QVideo::keyReleaseEvent(QKeyEvent *event)
         switch (key)
         {
         case Qt::Key_AltGr:
-            Paddle::setButtonReleased(Paddle::ourOpenApple);
+            myWorker->post([]() { Paddle::setButtonReleased(Paddle::ourOpenApple); });
             return;
         case Qt::Key_Menu:
-            Paddle::setButtonReleased(Paddle::ourSolidApple);
+            myWorker->post([]() { Paddle::setButtonReleased(Paddle::ourSolidApple); });
             return;
         }
     }
@@ -132,10 +178,10 @@ void QVideo::keyPressEvent(QKeyEvent *event)
         switch (key)
         {
         case Qt::Key_AltGr:
-            Paddle::setButtonPressed(Paddle::ourOpenApple);
+            myWorker->post([]() { Paddle::setButtonPressed(Paddle::ourOpenApple); });
             return;
         case Qt::Key_Menu:
-            Paddle::setButtonPressed(Paddle::ourSolidApple);
+            myWorker->post([]() { Paddle::setButtonPressed(Paddle::ourSolidApple); });
             return;
         }
     }
@@ -209,7 +255,7 @@ void QVideo::keyPressEvent(QKeyEvent *event)
 
     if (ch)
     {
-        addKeyToBuffer(ch);
+        myWorker->post([ch]() { addKeyToBuffer(ch); });
     }
     else
     {
@@ -219,71 +265,72 @@ void QVideo::keyPressEvent(QKeyEvent *event)
 
 void QVideo::mouseMoveEvent(QMouseEvent *event)
 {
-    CardManager & cardManager = GetCardMgr();
+    // relative position, the mouse card is only accessed by the emulator thread
+    const QPointF p = event->localPos();
+    const QSize s = size();
+    const double x = p.x() / s.width();
+    const double y = p.y() / s.height();
 
-    if (cardManager.IsMouseCardInstalled() && cardManager.GetMouseCard()->IsActiveAndEnabled())
+    myWorker->post([x, y]()
     {
-        int iX, iMinX, iMaxX;
-        int iY, iMinY, iMaxY;
-        cardManager.GetMouseCard()->GetXY(iX, iMinX, iMaxX, iY, iMinY, iMaxY);
+        CardManager & cardManager = GetCardMgr();
 
-        const QPointF p = event->localPos();
-        const QSize s = size();
+        if (cardManager.IsMouseCardInstalled() && cardManager.GetMouseCard()->IsActiveAndEnabled())
+        {
+            int iX, iMinX, iMaxX;
+            int iY, iMinY, iMaxY;
+            cardManager.GetMouseCard()->GetXY(iX, iMinX, iMaxX, iY, iMinY, iMaxY);
 
-        const int newX = lround((p.x() / s.width()) * (iMaxX - iMinX) + iMinX);
-        const int newY = lround((p.y() / s.height()) * (iMaxY - iMinY) + iMinY);
+            const int newX = lround(x * (iMaxX - iMinX) + iMinX);
+            const int newY = lround(y * (iMaxY - iMinY) + iMinY);
 
-        const int dx = newX - iX;
-        const int dy = newY - iY;
+            const int dx = newX - iX;
+            const int dy = newY - iY;
 
-        int outOfBoundsX;
-        int outOfBoundsY;
-        cardManager.GetMouseCard()->SetPositionRel(dx, dy, &outOfBoundsX, &outOfBoundsY);
+            int outOfBoundsX;
+            int outOfBoundsY;
+            cardManager.GetMouseCard()->SetPositionRel(dx, dy, &outOfBoundsX, &outOfBoundsY);
+        }
+    });
 
-        event->accept();
-    }
+    event->accept();
 }
 
-void QVideo::mousePressEvent(QMouseEvent *event)
+namespace
 {
-    CardManager & cardManager = GetCardMgr();
 
-    if (cardManager.IsMouseCardInstalled() && cardManager.GetMouseCard()->IsActiveAndEnabled())
+    void setMouseButton(const Qt::MouseButton button, const eBUTTONSTATE state)
     {
-        Qt::MouseButton button = event->button();
-        switch (button)
+        CardManager & cardManager = GetCardMgr();
+
+        if (cardManager.IsMouseCardInstalled() && cardManager.GetMouseCard()->IsActiveAndEnabled())
         {
-        case Qt::LeftButton:
-            cardManager.GetMouseCard()->SetButton(BUTTON0, BUTTON_DOWN);
-            break;
-        case Qt::RightButton:
-            cardManager.GetMouseCard()->SetButton(BUTTON1, BUTTON_DOWN);
-            break;
-        default:
-            break;
+            switch (button)
+            {
+            case Qt::LeftButton:
+                cardManager.GetMouseCard()->SetButton(BUTTON0, state);
+                break;
+            case Qt::RightButton:
+                cardManager.GetMouseCard()->SetButton(BUTTON1, state);
+                break;
+            default:
+                break;
+            }
         }
-        event->accept();
     }
+
 }
 
-void QVideo::mouseReleaseEvent(QMouseEvent *event)
+void QVideo::mousePressEvent(QMouseEvent *event)
 {
-    CardManager & cardManager = GetCardMgr();
+    const Qt::MouseButton button = event->button();
+    myWorker->post([button]() { setMouseButton(button, BUTTON_DOWN); });
+    event->accept();
+}
 
-    if (cardManager.IsMouseCardInstalled() && cardManager.GetMouseCard()->IsActiveAndEnabled())
-    {
-        Qt::MouseButton button = event->button();
-        switch (button)
-        {
-        case Qt::LeftButton:
-            cardManager.GetMouseCard()->SetButton(BUTTON0, BUTTON_UP);
-            break;
-        case Qt::RightButton:
-            cardManager.GetMouseCard()->SetButton(BUTTON1, BUTTON_UP);
-            break;
-        default:
-            break;
-        }
-        event->accept();
-    }
+void QVideo::mouseReleaseEvent(QMouseEvent *event)
+{
+    const Qt::MouseButton button = event->button();
+    myWorker->post([button]() { setMouseButton(button, BUTTON_UP); });
+    event->accept();
 }
@@ -2,20 +2,36 @@
 #define QVIDEO_H
 
 #include <QOpenGLWidget>
+#include <QImage>
+#include <QRect>
+
+#include <atomic>
+
+#include "triplebuffer.h"
 
 #define QVIDEO_BASECLASS QOpenGLWidget
 //#define QVIDEO_BASECLASS QWidget
 
+class EmulatorWorker;
+
 class QVideo : public QVIDEO_BASECLASS
 {
     Q_OBJECT
 public:
     explicit QVideo(QWidget *parent = nullptr);
 
-    QImage getScreen() const;
+    void setWorker(EmulatorWorker * worker);
+
+    QImage getScreen();
+
+    // emulator thread
     void loadVideoSettings();
     void unloadVideoSettings();
     void displayLogo();
+    void publishFrame();
+
+    // any thread, the published frame is painted by the GUI thread
+    void requestUpdate();
 
 signals:
 
@@ -32,6 +48,17 @@ protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
 
 private:
+    struct VideoFrame
+    {
+        QImage image;
+        QRect screen;   // without the border
+    };
+
+    EmulatorWorker * myWorker;
+
+    TripleBuffer<VideoFrame> myFrames;
+    std::atomic<bool> myUpdatePending;
+
     QImage myLogo;
 
     int mySX;
@@ -0,0 +1,56 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free exchange of values between one producer and one consumer thread.
+// The producer fills back() and publishes it, the consumer picks up the latest published value
+// with update() and reads front(): neither ever waits for the other, intermediate values are dropped.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : myBack(0), myMiddle(1), myFront(2)
+    {
+    }
+
+    // producer
+    T & back()
+    {
+        return myBuffers[myBack];
+    }
+
+    void publish()
+    {
+        myBack = myMiddle.exchange(myBack | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // consumer, true if front() has changed
+    bool update()
+    {
+        if (!(myMiddle.load(std::memory_order_relaxed) & FRESH))
+        {
+            return false;
+        }
+
+        myFront = myMiddle.exchange(myFront, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T & front() const
+    {
+        return myBuffers[myFront];
+    }
+
+private:
+    static constexpr int INDEX = 0x3;
+    static constexpr int FRESH = 0x4;  // the middle buffer has not been seen by the consumer yet
+
+    T myBuffers[3];
+
+    int myBack;
+    std::atomic<int> myMiddle;
+    int myFront;
+};
+
+#endif // TRIPLEBUFFER_H
@@ -409,6 +409,13 @@ namespace sa2
             REGSAVE(TEXT(REGVALUE_ENHANCE_DISK_SPEED), (DWORD)enhancedSpeed);
           }
 
+          bool turboDisk = cardManager.GetDisk2CardMgr().GetTurboDisk();
+          if (ImGui::Checkbox("Turbo disk (DOS 3.3 & ProDOS)", &turboDisk))
+          {
+            cardManager.GetDisk2CardMgr().SetTurboDisk(turboDisk);
+            REGSAVE(TEXT(REGVALUE_TURBO_DISK), (DWORD)turboDisk);
+          }
+
           ImGui::Separator();
 
           size_t dragAndDropSlot;
@@ -681,8 +688,15 @@ namespace sa2
 
             ImGui::LabelText("Filename", "%s", info.filename.c_str());
             ImGui::LabelText("Frequency", "%d Hz", info.frequency);
+            ImGui::LabelText("Records", "%zu (%zu bytes)", info.records, info.bytes);
             ImGui::LabelText("Auto Play", "%s", "ON");
 
+            bool instantLoad = tape.getInstantLoad();
+            if (ImGui::Checkbox("Instant load (Monitor READ)", &instantLoad))
+            {
+              tape.setInstantLoad(instantLoad);
+            }
+
             ImGui::Separator();
 
             if (ImGui::Button("Rewind"))
@@ -778,6 +792,85 @@ namespace sa2
     ImGui::End();
   }
 
+  void ImGuiSettings::showPerformance(SDLFrame * frame)
+  {
+    if (ImGui::Begin("Performance", &myShowPerformance, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+      bool enabled = g_bPerfEnabled;
+      if (ImGui::Checkbox("Enabled", &enabled))
+      {
+        PerfEnable(enabled);
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Reset"))
+      {
+        PerfReset();
+      }
+      ImGui::SameLine();
+      ImGui::Text("%u frames", PerfGetNumFrames());
+
+      if (PerfIsTracing())
+      {
+        if (ImGui::Button("Stop trace"))
+        {
+          PerfStopTrace();
+        }
+        ImGui::SameLine();
+        ImGui::TextUnformatted(myPerfTraceFilename);
+      }
+      else
+      {
+        if (ImGui::Button("Start trace"))
+        {
+          PerfStartTrace(myPerfTraceFilename);
+        }
+        ImGui::SameLine();
+        ImGui::InputText("Chrome trace", myPerfTraceFilename, sizeof(myPerfTraceFilename));
+      }
+
+      PerfGetHistory(PERF_FRAME, myPerfHistory);
+      ImGui::PlotHistogram("Frame (us)", myPerfHistory.data(), int(myPerfHistory.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 80));
+
+      PerfGetStats(myPerfStats);
+      if (ImGui::BeginTable("Performance", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+      {
+        ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Last us", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("p50 us", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("p95 us", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("p99 us", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        for (const PerfStats & stats : myPerfStats)
+        {
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Indent(stats.depth * ImGui::GetStyle().IndentSpacing);
+          ImGui::TextUnformatted(stats.name);
+          ImGui::Unindent(stats.depth * ImGui::GetStyle().IndentSpacing);
+          ImGui::TableNextColumn();
+          ImGui::Text("%.1f", stats.lastFrameUs);
+          ImGui::TableNextColumn();
+          ImGui::Text("%.1f", stats.p50Us);
+          ImGui::TableNextColumn();
+          ImGui::Text("%.1f", stats.p95Us);
+          ImGui::TableNextColumn();
+          ImGui::Text("%.1f", stats.p99Us);
+          ImGui::TableNextColumn();
+          ImGui::Text("%llu", (unsigned long long)stats.calls);
+        }
+        ImGui::EndTable();
+      }
+
+      ImGui::Separator();
+      const common2::FramePacer::Stats & pacing = frame->GetFramePacer().getStats();
+      ImGui::Text("Frame pacing: %s, %.3f Hz, %+.0f ppm", pacing.locked ? (pacing.exact ? "locked" : "fixed slices") : "unlocked", pacing.refreshHz, pacing.clockAdjustPpm);
+      ImGui::Text("Frames: %llu, missed: %llu, max interval: %.1f ms", (unsigned long long)pacing.frames, (unsigned long long)pacing.missed, pacing.maxIntervalMs);
+    }
+    ImGui::End();
+  }
+
   void ImGuiSettings::show(SDLFrame * frame)
   {
     if (myShowSettings)
@@ -800,6 +893,11 @@ namespace sa2
       showAboutWindow();
     }
 
+    if (myShowPerformance)
+    {
+      showPerformance(frame);
+    }
+
     if (myShowDemo)
     {
       ImGui::ShowDemoWindow(&myShowDemo);
@@ -817,6 +915,7 @@ namespace sa2
       {
         ImGui::MenuItem("Settings", nullptr, &myShowSettings);
         ImGui::MenuItem("Memory", nullptr, &myShowMemory);
+        ImGui::MenuItem("Performance", nullptr, &myShowPerformance);
         if (ImGui::MenuItem("Debugger", nullptr, &myShowDebugger) && myShowDebugger)
         {
           frame->ChangeMode(MODE_DEBUG);
@@ -865,12 +964,26 @@ namespace sa2
 
         for (i = 0; i < banks.size(); ++i)
         {
-          if (ImGui::BeginTabItem(banks[i].name.c_str()))
+          const ImGuiTabItemFlags flags = (static_cast<int>(i) == myMemorySelectTab) ? ImGuiTabItemFlags_SetSelected : 0;
+          if (ImGui::BeginTabItem(banks[i].name.c_str(), nullptr, flags))
           {
             myMemoryEditors[i].DrawContents(banks[i].basePtr, banks[i].length, banks[i].baseAddr);
             ImGui::EndTabItem();
           }
         }
+        myMemorySelectTab = -1;
+
+        if (ImGui::BeginTabItem("Search"))
+        {
+          drawMemorySearch();
+          ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Cheat"))
+        {
+          drawCheatFinder();
+          ImGui::EndTabItem();
+        }
 
         ImGui::EndTabBar();
       }
@@ -878,6 +991,151 @@ namespace sa2
     ImGui::End();
   }
 
+  void ImGuiSettings::drawMemoryMatch(const MemoryMatch_t & match)
+  {
+    const std::vector<MemoryRegion_t> & regions = MemorySearchGetRegions();
+    const MemoryRegion_t & region = regions[match.m_iRegion];
+
+    char label[32];
+    sprintf(label, "%s:%04X", region.m_sName.c_str(), match.m_nAddress);
+    if (ImGui::Selectable(label, false, ImGuiSelectableFlags_SpanAllColumns) && region.m_nBank >= 0)
+    {
+      // the tabs are: Memory, Cx ROM, Bank 0, Bank 1, ...
+      myMemorySelectTab = 2 + region.m_nBank;
+      if (myMemorySelectTab < static_cast<int>(myMemoryEditors.size()))
+      {
+        myMemoryEditors[myMemorySelectTab].GotoAddrAndHighlight(match.m_nAddress, match.m_nAddress + 1);
+      }
+    }
+  }
+
+  void ImGuiSettings::drawMemorySearch()
+  {
+    ImGui::TextUnformatted("Main, aux, RamWorks and language card banks");
+    const bool enter = ImGui::InputText("Pattern", mySearchPattern, sizeof(mySearchPattern), ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    HelpMarker("Hex bytes, ? any byte, ?? any number of bytes, x? / ?x a nibble, \"ASCII text\", 'Apple text'");
+
+    ImGui::SameLine();
+    if (ImGui::Button("Search") || enter)
+    {
+      MemorySearchValues_t values;
+      mySearchMatches.clear();
+      if (MemorySearchParse(mySearchPattern, values))
+      {
+        MemorySearchAll(values, mySearchMatches, ourMaxMatches);
+      }
+    }
+
+    ImGui::Text("Matches: %d%s", static_cast<int>(mySearchMatches.size()), mySearchMatches.size() >= ourMaxMatches ? "+" : "");
+
+    if (ImGui::BeginTable("Search", 1, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+    {
+      ImGui::TableSetupScrollFreeze(0, 1);
+      ImGui::TableSetupColumn("Bank:Address");
+      ImGui::TableHeadersRow();
+
+      for (const MemoryMatch_t & match : mySearchMatches)
+      {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        drawMemoryMatch(match);
+      }
+      ImGui::EndTable();
+    }
+  }
+
+  void ImGuiSettings::drawCheatFinder()
+  {
+    if (ImGui::Button("New search"))
+    {
+      CheatReset();
+    }
+
+    const int candidates = CheatGetCount();
+    if (candidates == CHEAT_NOT_STARTED)
+    {
+      ImGui::SameLine();
+      ImGui::TextUnformatted("snapshot all the memory, then narrow down the bytes that follow the game");
+      return;
+    }
+
+    ImGui::SameLine();
+    ImGui::Text("Candidates: %d", candidates);
+
+    int result = candidates;
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 4);
+    ImGui::InputScalar("Value", ImGuiDataType_U8, &myCheatValue, nullptr, nullptr, "%02X", ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    if (ImGui::Button("=="))
+    {
+      result = CheatFilter(CHEAT_EQUAL, myCheatValue);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("!="))
+    {
+      result = CheatFilter(CHEAT_NOT_EQUAL, myCheatValue);
+    }
+    ImGui::SameLine();
+    ImGui::TextUnformatted("|");
+    ImGui::SameLine();
+    if (ImGui::Button("Changed"))
+    {
+      result = CheatFilter(CHEAT_CHANGED);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Same"))
+    {
+      result = CheatFilter(CHEAT_UNCHANGED);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Increased"))
+    {
+      result = CheatFilter(CHEAT_INCREASED);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Decreased"))
+    {
+      result = CheatFilter(CHEAT_DECREASED);
+    }
+
+    if (result == CHEAT_NOT_STARTED)
+    {
+      // the memory configuration has changed
+      return;
+    }
+
+    // the whole memory is not worth listing
+    if (result > static_cast<int>(ourMaxMatches))
+    {
+      return;
+    }
+
+    std::vector<CheatMatch_t> matches;
+    CheatGetMatches(matches, ourMaxMatches);
+
+    if (ImGui::BeginTable("Cheat", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+    {
+      ImGui::TableSetupScrollFreeze(0, 1);
+      ImGui::TableSetupColumn("Bank:Address");
+      ImGui::TableSetupColumn("Previous");
+      ImGui::TableSetupColumn("Now");
+      ImGui::TableHeadersRow();
+
+      for (const CheatMatch_t & match : matches)
+      {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        drawMemoryMatch(match);
+        ImGui::TableNextColumn();
+        ImGui::Text("%02X", match.m_nPrevious);
+        ImGui::TableNextColumn();
+        ImGui::Text("%02X", match.m_nValue);
+      }
+      ImGui::EndTable();
+    }
+  }
+
   void ImGuiSettings::drawDisassemblyTable(SDLFrame * frame)
   {
     const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_ScrollY;
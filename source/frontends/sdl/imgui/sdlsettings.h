@@ -4,6 +4,7 @@
 #include "frontends/sdl/sdirectsound.h"
 #include "Debugger/Debug.h"
 #include "Debugger/Debugger_Console.h"
+#include "PerfCounters.h"
 
 #include <unordered_map>
 
@@ -28,6 +29,7 @@ namespace sa2
     bool myShowDebugger = false;
     bool mySyncCPU = true;
     bool myShowAbout = false;
+    bool myShowPerformance = false;
 
     bool myScrollConsole = true;
     char myInputBuffer[CONSOLE_WIDTH] = "";
@@ -39,15 +41,29 @@ namespace sa2
     std::unordered_map<DWORD, uint64_t> myAddressCycles;
 
     std::vector<MemoryEditor> myMemoryEditors;
+    int myMemorySelectTab = -1;
+
+    static constexpr size_t ourMaxMatches = 1024;
+    char mySearchPattern[256] = "";
+    std::vector<MemoryMatch_t> mySearchMatches;
+    uint8_t myCheatValue = 0;
 
     std::vector<SoundInfo> myAudioInfo;
 
+    std::vector<PerfStats> myPerfStats;
+    std::vector<float> myPerfHistory;
+    char myPerfTraceFilename[256] = "applewin-trace.json";
+
     void showSettings(SDLFrame* frame);
     void showDebugger(SDLFrame* frame);
     void showMemory();
     void showAboutWindow();
+    void showPerformance(SDLFrame* frame);
 
     void drawDisassemblyTable(SDLFrame * frame);
+    void drawMemoryMatch(const MemoryMatch_t & match);
+    void drawMemorySearch();
+    void drawCheatFinder();
     void drawConsole();
     void drawRegisters();
     void drawAnnunciators();
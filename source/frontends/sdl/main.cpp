@@ -11,6 +11,8 @@
 #include "frontends/common2/fileregistry.h"
 #include "frontends/common2/utils.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/capture.h"
+#include "frontends/common2/gdbserver.h"
 #include "frontends/common2/timer.h"
 #include "frontends/sdl/gamepad.h"
 #include "frontends/sdl/sdirectsound.h"
@@ -19,11 +21,13 @@
 #include "frontends/sdl/renderer/sdlrendererframe.h"
 #include "frontends/sdl/imgui/sdlimguiframe.h"
 
+#include "Common.h"
 #include "CardManager.h"
 #include "Core.h"
 #include "Log.h"
 #include "CPU.h"
 #include "NTSC.h"
+#include "PerfCounters.h"
 #include "SaveState.h"
 #include "Interface.h"
 
@@ -102,6 +106,19 @@ void run_sdl(int argc, const char * argv [])
     frame->LoadSnapshot();
   }
 
+  if (!frame->StartMovie(options.movieRecordFilename, options.moviePlayFilename))
+  {
+    std::cerr << "Failed to start the movie" << std::endl;
+  }
+
+  std::shared_ptr<common2::Capture> capture = common2::createCapture(options);
+  frame->SetCapture(capture);
+
+  const auto changeMode = [&frame](const AppMode_e mode) {
+                            frame->ChangeMode(mode);
+                          };
+  std::shared_ptr<common2::GdbServer> gdb = common2::createGdbServer(options, changeMode);
+
   std::cerr << "Default GL swap interval: " << SDL_GL_GetSwapInterval() << std::endl;
 
   const int fps = getRefreshRate();
@@ -145,10 +162,15 @@ void run_sdl(int argc, const char * argv [])
     do
     {
       frameTimer.tic();
+      PerfMarker perfMarkerFrame(PERF_FRAME);
 
       eventTimer.tic();
       sa2::writeAudio();
       frame->ProcessEvents(quit);
+      if (gdb)
+      {
+        gdb->update();
+      }
       eventTimer.toc();
 
       cpuTimer.tic();
@@ -159,9 +181,13 @@ void run_sdl(int argc, const char * argv [])
       {
         // in full speed VideoRedrawScreenDuringFullSpeed is called inside SDLFrame::Execute
         refreshScreenTimer.tic();
+        PerfMarker perfMarkerPresent(PERF_PRESENT);
         frame->VideoPresentScreen();
         refreshScreenTimer.toc();
+        frame->FramePresented();
       }
+      perfMarkerFrame.Stop();
+      PerfFrameEnd();
       frameTimer.toc();
     } while (!quit);
 
@@ -177,8 +203,23 @@ void run_sdl(int argc, const char * argv [])
     const double actualClock = g_nCumulativeCycles / timeInSeconds;
     std::cerr << "Expected clock: " << g_fCurrentCLK6502 << " Hz, " << g_nCumulativeCycles / g_fCurrentCLK6502 << " s" << std::endl;
     std::cerr << "Actual clock:   " << actualClock << " Hz, " << timeInSeconds << " s" << std::endl;
+
+    const common2::FramePacer::Stats & pacing = frame->GetFramePacer().getStats();
+    std::cerr << "Frame pacing:   " << pacing.frames << " frames, " << pacing.missed << " missed, max " << pacing.maxIntervalMs << " ms, "
+              << pacing.refreshHz << " Hz, " << (pacing.locked ? (pacing.exact ? "locked " : "fixed slices ") : "unlocked ")
+              << pacing.clockAdjustPpm << " ppm" << std::endl;
+    if (capture)
+    {
+      const common2::Capture::Stats & stats = capture->getStats();
+      std::cerr << "Capture:        " << stats.frames << " frames, " << stats.duplicates << " repeated, "
+                << stats.audioSamples / double(SPKR_SAMPLE_RATE) << " s of audio" << std::endl;
+    }
     sa2::stopAudio();
   }
+  // the capture must be finalised before the emulator is destroyed
+  frame->SetCapture(nullptr);
+  capture.reset();
+  gdb.reset();
   frame->End();
 #endif
 }
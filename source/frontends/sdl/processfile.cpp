@@ -47,6 +47,13 @@ namespace
 
   void insertTape(sa2::SDLFrame * frame, const char * filename)
   {
+    // PCM WAVs are streamed and demodulated without loading the whole file
+    if (CassetteTape::instance().load(filename))
+    {
+      return;
+    }
+
+    // other formats supported by SDL
     SDL_AudioSpec wavSpec;
     Uint32 wavLength;
     Uint8 *wavBuffer;
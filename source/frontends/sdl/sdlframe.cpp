@@ -4,6 +4,7 @@
 #include "frontends/sdl/utils.h"
 #include "frontends/sdl/sdirectsound.h"
 #include "frontends/common2/programoptions.h"
+#include "frontends/common2/capture.h"
 #include "frontends/common2/utils.h"
 
 #include "CardManager.h"
@@ -133,6 +134,8 @@ namespace sa2
     , myDragAndDropDrive(DRIVE_1)
     , myScrollLockFullSpeed(false)
     , mySpeed(options.fixedSpeed)
+    // the pacer relies on the present blocking on vsync (the SDL renderer always uses SDL_RENDERER_PRESENTVSYNC)
+    , myFramePacer(options.frameLock && !options.headless && !options.fixedSpeed && (!options.imgui || options.glSwapInterval != 0))
   {
   }
 
@@ -585,6 +588,11 @@ namespace sa2
       GetCardMgr().Update(executedCycles);
       SpkrUpdate(executedCycles);
 
+      if (myCapture)
+      {
+        myCapture->update(bVideoUpdate);
+      }
+
       g_dwCyclesThisFrame += executedCycles;
       if (g_dwCyclesThisFrame >= dwClksPerFrame)
       {
@@ -602,7 +610,18 @@ namespace sa2
   void SDLFrame::ExecuteInRunningMode(const size_t msNextFrame)
   {
     SetFullSpeed(CanDoFullSpeed());
-    const uint64_t cyclesToExecute = mySpeed.getCyclesTillNext(msNextFrame * 1000);  // this checks g_bFullSpeed
+    uint64_t cyclesToExecute;
+    if (!g_bFullSpeed && myFramePacer.isLocked())
+    {
+      cyclesToExecute = myFramePacer.getCyclesTillNextPresent();
+    }
+    else
+    {
+      // prefer the measured refresh interval to the integer ms hint
+      const size_t measured = myFramePacer.getRefreshIntervalInMicroseconds();
+      const size_t microseconds = measured ? measured : msNextFrame * 1000;
+      cyclesToExecute = mySpeed.getCyclesTillNext(microseconds);  // this checks g_bFullSpeed
+    }
     Execute(cyclesToExecute);
   }
 
@@ -638,9 +657,33 @@ namespace sa2
     };
   }
 
+  void SDLFrame::FramePresented()
+  {
+    if (g_nAppMode == MODE_RUNNING && !g_bFullSpeed)
+    {
+      const bool wasLocked = myFramePacer.isLocked();
+      myFramePacer.framePresented();
+      if (wasLocked && !myFramePacer.isLocked())
+      {
+        // back to the wall clock
+        mySpeed.reset();
+      }
+    }
+    else
+    {
+      myFramePacer.reset();
+    }
+  }
+
+  const common2::FramePacer & SDLFrame::GetFramePacer() const
+  {
+    return myFramePacer;
+  }
+
   void SDLFrame::ResetSpeed()
   {
     mySpeed.reset();
+    myFramePacer.reset();
   }
 
   void SDLFrame::ChangeMode(const AppMode_e mode)
@@ -696,6 +739,7 @@ namespace sa2
         MB_Unmute();
         setGLSwapInterval(myTargetGLSwap);
         mySpeed.reset();
+        myFramePacer.reset();
       }
       g_bFullSpeed = value;
     }
@@ -730,7 +774,23 @@ namespace sa2
   {
     common2::CommonFrame::LoadSnapshot();
     mySpeed.reset();
+    myFramePacer.reset();
+    ResetHardware();
+  }
+
+  void SDLFrame::SetCapture(const std::shared_ptr<common2::Capture> & capture)
+  {
+    myCapture = capture;
+  }
+
+  bool SDLFrame::StartMovie(const std::string & recordFilename, const std::string & playFilename)
+  {
+    // both reload the starting state
+    const bool ok = common2::CommonFrame::StartMovie(recordFilename, playFilename);
+    mySpeed.reset();
+    myFramePacer.reset();
     ResetHardware();
+    return ok;
   }
 
 }
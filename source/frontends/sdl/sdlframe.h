@@ -4,11 +4,13 @@
 #include "Configuration/Config.h"
 #include "frontends/common2/commonframe.h"
 #include "frontends/common2/speed.h"
+#include "frontends/common2/framepacer.h"
 #include <SDL.h>
 
 namespace common2
 {
   struct EmulatorOptions;
+  class Capture;
 }
 
 namespace sa2
@@ -29,14 +31,18 @@ namespace sa2
     void ProcessEvents(bool &quit);
 
     void ExecuteOneFrame(const size_t msNextFrame);
+    void FramePresented();
     void ChangeMode(const AppMode_e mode);
     void SingleStep();
     void ResetHardware();
     bool HardwareChanged() const;
     virtual void ResetSpeed();
     void LoadSnapshot() override;
+    void SetCapture(const std::shared_ptr<common2::Capture> & capture);
+    bool StartMovie(const std::string & recordFilename, const std::string & playFilename) override;
 
     const std::shared_ptr<SDL_Window> & GetWindow() const;
+    const common2::FramePacer & GetFramePacer() const;
 
     void getDragDropSlotAndDrive(size_t & slot, size_t & drive) const;
     void setDragDropSlotAndDrive(const size_t slot, const size_t drive);
@@ -76,6 +82,8 @@ namespace sa2
     bool myScrollLockFullSpeed;
 
     common2::Speed mySpeed;
+    common2::FramePacer myFramePacer;
+    std::shared_ptr<common2::Capture> myCapture;
 
     std::shared_ptr<SDL_Window> myWindow;
 
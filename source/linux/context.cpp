@@ -15,18 +15,60 @@
 #include "CPU.h"
 #include "ParallelPrinter.h"
 #include "Riff.h"
+#include "PerfCounters.h"
 #include "SaveState.h"
 #include "Memory.h"
 #include "Speaker.h"
 #include "MouseInterface.h"
 #include "Mockingboard.h"
+#include "Movie.h"
 #include "Uthernet1.h"
 #include "Uthernet2.h"
+#include "VideoTableCache.h"
+
+#include <sys/stat.h>
 
 
 namespace
 {
   std::shared_ptr<FrameBase> sg_LinuxFrame;
+
+  bool makeDirectory(const std::string & dir)
+  {
+    const int status = mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    return !status || (errno == EEXIST);
+  }
+
+  // $XDG_CACHE_HOME/applewin, or ~/.cache/applewin, empty if neither can be used
+  std::string getCacheDirectory()
+  {
+    std::string cacheDir;
+    const char * xdgCacheHome = getenv("XDG_CACHE_HOME");
+    const char * homeDir = getenv("HOME");
+    if (xdgCacheHome && *xdgCacheHome)
+    {
+      cacheDir = xdgCacheHome;
+    }
+    else if (homeDir && *homeDir)
+    {
+      cacheDir = std::string(homeDir) + "/.cache";
+    }
+    else
+    {
+      return std::string();
+    }
+
+    const std::string dir = cacheDir + "/applewin";
+    if (makeDirectory(cacheDir) && makeDirectory(dir))
+    {
+      return dir;
+    }
+    else
+    {
+      LogFileOutput("No video table cache. Cannot create %s: %s\n", dir.c_str(), strerror(errno));
+      return std::string();
+    }
+  }
 }
 
 IPropertySheet& GetPropertySheet()
@@ -110,6 +152,12 @@ void InitialiseEmulator()
 
   g_bFullSpeed = false;
 
+  const std::string cacheDir = getCacheDirectory();
+  if (!cacheDir.empty())
+  {
+    VideoTableCache_SetFilename(cacheDir + "/video-tables.bin");
+  }
+
   GetVideo().SetVidHD(false);
   LoadConfiguration(true);
   SetCurrentCLK6502();
@@ -132,6 +180,8 @@ void InitialiseEmulator()
 
 void DestroyEmulator()
 {
+  MovieStop();
+
   CardManager & cardManager = GetCardMgr();
   cardManager.Destroy();
 
@@ -144,4 +194,5 @@ void DestroyEmulator()
   CpuDestroy();
   DebugDestroy();
   RiffFinishWriteFile();
+  PerfShutdown();
 }
@@ -2,6 +2,8 @@
 #include "linux/keyboard.h"
 
 #include "Core.h"
+#include "Keyboard.h"
+#include "Movie.h"
 #include "YamlHelper.h"
 
 #include <queue>
@@ -14,6 +16,15 @@ namespace
 }
 
 void addKeyToBuffer(BYTE key)
+{
+  // while a movie is playing, the host keyboard is ignored
+  if (MovieFilterKey(key))
+  {
+    keys.push(key);
+  }
+}
+
+void KeybQueueKeycode(BYTE key)
 {
   keys.push(key);
 }
@@ -82,7 +93,7 @@ void KeybLoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT version)
     keywaiting = yamlLoadHelper.LoadBool(SS_YAML_KEY_KEYWAITING);
 
   keys = std::queue<BYTE>();
-  addKeyToBuffer(keycode);
+  keys.push(keycode);
 
   yamlLoadHelper.PopMap();
 }
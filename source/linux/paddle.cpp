@@ -6,6 +6,7 @@
 #include "Memory.h"
 #include "Common.h"
 #include "CPU.h"
+#include "Movie.h"
 
 namespace
 {
@@ -107,6 +108,8 @@ BYTE __stdcall JoyReadButton(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG uExe
     }
   }
 
+  pressed = MovieFilterButton(addr - Paddle::ourOpenApple, pressed, uExecutedCycles);
+
   return MemReadFloatingBus(pressed, uExecutedCycles);
 }
 
@@ -117,12 +120,13 @@ BYTE __stdcall JoyReadPosition(WORD pc, WORD address, BYTE bWrite, BYTE d, ULONG
   CpuCalcCycles(uExecutedCycles);
   BOOL nPdlCntrActive = 0;
 
-  if (Paddle::instance)
+  if (nJoyNum == 0)
   {
-    if (nJoyNum == 0)
+    int axis = address & 1;
+    // -1: no paddle
+    int pdl = MovieFilterPaddle(axis, Paddle::instance ? Paddle::instance->getAxisValue(axis) : -1, uExecutedCycles);
+    if (pdl >= 0)
     {
-      int axis = address & 1;
-      int pdl = Paddle::instance->getAxisValue(axis);
       // This is from KEGS. It helps games like Championship Lode Runner & Boulderdash
       if (pdl >= 255)
 	pdl = 280;
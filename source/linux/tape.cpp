@@ -8,7 +8,126 @@
 #include "Pravets.h"
 #include "CPU.h"
 
-#include <limits>
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+
+  // Apple cassette format, in microseconds per half-cycle
+  // header tone: 770Hz (650us), sync: 200us + 250us, bit 0: 250us, bit 1: 500us
+  const double HEADER_MIN = 550.0;
+  const double HEADER_MAX = 900.0;
+  const double SYNC_MAX = 400.0;
+  // full cycles, as measured by the ROM
+  const double BIT_MIN = 300.0;
+  const double BIT_THRESHOLD = 750.0;
+  const double BIT_MAX = 1200.0;
+
+  const size_t MIN_HEADER_HALF_CYCLES = 64;
+
+  // Monitor ROM
+  const WORD MONITOR_READ = 0xFEFD;
+  const BYTE READ_SIGNATURE[] = { 0x20, 0xFA, 0xFC, 0xA9, 0x16 };  // JSR RD2BIT; LDA #$16
+  const WORD ZP_A1 = 0x3C;
+  const WORD ZP_A2 = 0x3E;
+  const WORD ZP_CHKSUM = 0x2E;
+
+  const UINT NO_TRAP_ADDRESS = 0x10000;  // never matches a 16-bit PC
+
+  uint16_t readLE16(const uint8_t * p)
+  {
+    return p[0] | (p[1] << 8);
+  }
+
+  uint32_t readLE32(const uint8_t * p)
+  {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+  }
+
+  WORD readWord(const WORD addr)
+  {
+    return mem[addr] | (mem[(WORD)(addr + 1)] << 8);
+  }
+
+  void writeByte(const WORD addr, const BYTE value)
+  {
+    memdirty[addr >> 8] = 0xFF;
+    LPBYTE page = memwrite[addr >> 8];
+    if (page)
+      *(page + (addr & 0xFF)) = value;
+  }
+
+}
+
+// Finds the positions where the (linearly interpolated) wave crosses the thresholds.
+// TAPEIN only changes there, so these positions are all that is needed to play the tape.
+class CassetteTape::EdgeDetector
+{
+public:
+  EdgeDetector(std::vector<double> & edges)
+    : myEdges(edges)
+    , myThreshold(CassetteTape::myThreshold + 0.5)  // sampled values are rounded
+    , myPrevious(0.0)
+    , myPosition(0)
+    , myLevel(1)
+  {
+  }
+
+  // in units of tape_data_t
+  void add(const double value)
+  {
+    // threshold not needed for https://asciiexpress.net
+    // but probably necessary for a real audio file
+    //
+    // this has been tested on all formats from https://asciiexpress.net
+    //
+    // we are extracting the sign bit (set for negative numbers)
+    // this is really important for the asymmetric wave in https://asciiexpress.net/diskserver/
+    // not so much for the other cases
+    if (myLevel && value > myThreshold)
+    {
+      myEdges.push_back(crossing(myThreshold, value));
+      myLevel = 0;
+    }
+    else if (!myLevel && value < -myThreshold)
+    {
+      myEdges.push_back(crossing(-myThreshold, value));
+      myLevel = 1;
+    }
+    // else leave it unchanged to the previous value
+    myPrevious = value;
+    ++myPosition;
+  }
+
+  // returns the number of samples
+  size_t finish()
+  {
+    // past the end of the tape, TAPEIN reads as a negative wave
+    if (!myLevel)
+    {
+      myEdges.push_back(myPosition - 1);
+      myLevel = 1;
+    }
+    return myPosition;
+  }
+
+private:
+  double crossing(const double threshold, const double value) const
+  {
+    if (myPosition == 0)
+    {
+      return 0.0;
+    }
+    return (myPosition - 1) + (threshold - myPrevious) / (value - myPrevious);
+  }
+
+  std::vector<double> & myEdges;
+  const double myThreshold;
+  double myPrevious;
+  size_t myPosition;
+  BYTE myLevel;
+};
 
 CassetteTape & CassetteTape::instance()
 {
@@ -16,71 +135,251 @@ CassetteTape & CassetteTape::instance()
   return tape;
 }
 
-void CassetteTape::setData(const std::string & filename, const std::vector<tape_data_t> & data, const int frequency)
+void CassetteTape::reset(const std::string & filename, const int frequency)
 {
   myFilename = filename;
-  myData = data;
   myFrequency = frequency;
-  myIsPlaying = false;
+  myEdges.clear();
+  myRecords.clear();
+  mySize = 0;
+  rewind();
 }
 
-void CassetteTape::eject()
+void CassetteTape::setData(const std::string & filename, const std::vector<tape_data_t> & data, const int frequency)
 {
-  myData.clear();
-}
+  reset(filename, frequency);
 
-void CassetteTape::rewind()
-{
-  myIsPlaying = false;
+  EdgeDetector detector(myEdges);
+  for (const tape_data_t value : data)
+  {
+    detector.add(value);
+  }
+  mySize = detector.finish();
+
+  decodeRecords();
 }
 
-BYTE CassetteTape::getBitValue(const tape_data_t val)
+bool CassetteTape::load(const std::string & filename)
 {
-  // threshold not needed for https://asciiexpress.net
-  // but probably necessary for a real audio file
-  //
-  // this has been tested on all formats from https://asciiexpress.net
-  //
-  // we are extracting the sign bit (set for negative numbers)
-  // this is really important for the asymmetric wave in https://asciiexpress.net/diskserver/
-  // not so much for the other cases
-  if (val > myThreshold)
+  FILE * file = fopen(filename.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  uint8_t header[12];
+  bool ok = fread(header, 1, sizeof(header), file) == sizeof(header)
+    && memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0;
+
+  size_t channels = 0;
+  size_t bits = 0;
+  int frequency = 0;
+  bool data = false;
+
+  while (ok && !data)
   {
-    myLastBit = 0;
+    uint8_t chunk[8];
+    if (fread(chunk, 1, sizeof(chunk), file) != sizeof(chunk))
+    {
+      ok = false;
+      break;
+    }
+    const uint32_t size = readLE32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0)
+    {
+      uint8_t fmt[16];
+      ok = size >= sizeof(fmt) && fread(fmt, 1, sizeof(fmt), file) == sizeof(fmt);
+      if (ok)
+      {
+        const uint16_t format = readLE16(fmt);  // PCM or WAVE_FORMAT_EXTENSIBLE
+        channels = readLE16(fmt + 2);
+        frequency = readLE32(fmt + 4);
+        bits = readLE16(fmt + 14);
+        ok = (format == 1 || format == 0xFFFE) && channels > 0 && frequency > 0 && (bits == 8 || bits == 16);
+        ok = ok && fseek(file, (size - sizeof(fmt)) + (size & 1), SEEK_CUR) == 0;
+      }
+    }
+    else if (memcmp(chunk, "data", 4) == 0)
+    {
+      ok = channels > 0;
+      data = true;
+
+      reset(filename, frequency);
+      EdgeDetector detector(myEdges);
+
+      // mixed down to mono, in units of tape_data_t
+      const size_t bytesPerFrame = channels * bits / 8;
+      const double scale = (bits == 8 ? 1.0 : 1.0 / 256.0) / channels;
+
+      std::vector<uint8_t> buffer(bytesPerFrame * 16384);
+      size_t remaining = size / bytesPerFrame;
+      while (ok && remaining)
+      {
+        const size_t frames = fread(buffer.data(), bytesPerFrame, std::min(remaining, buffer.size() / bytesPerFrame), file);
+        if (frames == 0)
+        {
+          break;  // truncated file: play what is there
+        }
+        remaining -= frames;
+
+        const uint8_t * p = buffer.data();
+        for (size_t i = 0; i < frames; ++i)
+        {
+          int sum = 0;
+          for (size_t j = 0; j < channels; ++j)
+          {
+            if (bits == 8)
+            {
+              sum += int(*p) - 128;
+              p += 1;
+            }
+            else
+            {
+              sum += int16_t(readLE16(p));
+              p += 2;
+            }
+          }
+          detector.add(sum * scale);
+        }
+      }
+      mySize = detector.finish();
+    }
+    else
+    {
+      ok = fseek(file, size + (size & 1), SEEK_CUR) == 0;
+    }
   }
-  else if (val < -myThreshold)
+
+  fclose(file);
+
+  if (!ok || !data)
   {
-    myLastBit = 1;
+    eject();
+    return false;
   }
-  // else leave it unchanged to the previous value
-  return myLastBit;
+
+  decodeRecords();
+  return true;
 }
 
-CassetteTape::tape_data_t CassetteTape::getCurrentWave(size_t & pos) const
+void CassetteTape::decodeRecords()
 {
-  if (myIsPlaying)
+  myRecords.clear();
+
+  const double usPerSample = 1000000.0 / myFrequency;
+  const auto halfCycle = [this, usPerSample](const size_t i)
   {
-    const double delta = g_nCumulativeCycles - myBaseCycles;
-    const double position = delta / g_fCurrentCLK6502 * myFrequency;
-    pos = static_cast<size_t>(position);
+    return (myEdges[i + 1] - myEdges[i]) * usPerSample;
+  };
+
+  const size_t numberOfHalfCycles = myEdges.empty() ? 0 : myEdges.size() - 1;
 
-    if (pos + 1 < myData.size())
+  size_t i = 0;
+  while (i < numberOfHalfCycles)
+  {
+    // header tone
+    size_t header = 0;
+    while (i + header < numberOfHalfCycles && halfCycle(i + header) >= HEADER_MIN && halfCycle(i + header) <= HEADER_MAX)
     {
-      // linear interpolation
-      const double reminder = position - pos;
-      const double value = (1.0 - reminder) * myData[pos] + reminder * myData[pos + 1];
-      return lround(value);
+      ++header;
     }
-    else
+    if (header < MIN_HEADER_HALF_CYCLES)
     {
-      pos = myData.size() - 1;
+      i += std::max<size_t>(header, 1);
+      continue;
     }
+    i += header;
+
+    // sync bit: the ROM waits for a short half-cycle, then skips the next one
+    if (i + 2 > numberOfHalfCycles || halfCycle(i) > SYNC_MAX)
+    {
+      continue;
+    }
+    i += 2;
+
+    // data, MSB first, 1 full cycle per bit, until something else is found
+    Record record;
+    record.start = myEdges[i];
+    record.end = record.start;
+    BYTE value = 0;
+    size_t bit = 0;
+    while (i + 2 <= numberOfHalfCycles)
+    {
+      const double fullCycle = halfCycle(i) + halfCycle(i + 1);
+      if (fullCycle < BIT_MIN || fullCycle > BIT_MAX)
+      {
+        break;
+      }
+      i += 2;
+
+      value = (value << 1) | (fullCycle >= BIT_THRESHOLD ? 1 : 0);
+      if (++bit == 8)
+      {
+        record.data.push_back(value);
+        record.end = myEdges[i];
+        value = 0;
+        bit = 0;
+      }
+    }
+
+    if (!record.data.empty())
+    {
+      myRecords.push_back(std::move(record));
+    }
+  }
+}
+
+void CassetteTape::eject()
+{
+  reset(std::string(), 0);
+}
+
+void CassetteTape::rewind()
+{
+  myIsPlaying = false;
+  myNextEdge = 0;
+  myLastBit = 1;
+}
+
+void CassetteTape::setInstantLoad(const bool instantLoad)
+{
+  myInstantLoad = instantLoad;
+}
+
+bool CassetteTape::getInstantLoad() const
+{
+  return myInstantLoad;
+}
+
+double CassetteTape::getPosition() const
+{
+  if (myIsPlaying)
+  {
+    const double delta = double(int64_t(g_nCumulativeCycles) - myBaseCycles);
+    return delta / g_fCurrentCLK6502 * myFrequency;
   }
   else
   {
-    pos = 0;
+    return 0.0;
   }
-  return std::numeric_limits<tape_data_t>::min();
+}
+
+BYTE CassetteTape::getLevel(const double position)
+{
+  // TAPEIN is read in order, so the cursor only moves a few edges at a time
+  if (myNextEdge > 0 && myEdges[myNextEdge - 1] > position)
+  {
+    myNextEdge = std::upper_bound(myEdges.begin(), myEdges.end(), position) - myEdges.begin();
+  }
+  while (myNextEdge < myEdges.size() && myEdges[myNextEdge] <= position)
+  {
+    ++myNextEdge;
+  }
+
+  // each edge toggles the level, starting with a negative wave
+  myLastBit = 1 ^ (myNextEdge & 1);
+  return myLastBit;
 }
 
 BYTE CassetteTape::getValue(const ULONG nExecutedCycles)
@@ -94,20 +393,88 @@ BYTE CassetteTape::getValue(const ULONG nExecutedCycles)
     myBaseCycles = g_nCumulativeCycles;
   }
 
-  size_t pos;
-  const tape_data_t val = getCurrentWave(pos);
-  const BYTE highBit = getBitValue(val);
-
-  return highBit;
+  return getLevel(getPosition());
 }
 
 void CassetteTape::getTapeInfo(TapeInfo & info) const
 {
   info.filename = myFilename;
-  const tape_data_t val = getCurrentWave(info.pos);
+  info.size = mySize;
+  info.pos = mySize ? std::min(static_cast<size_t>(getPosition()), mySize - 1) : 0;
   info.bit = myLastBit;
-  info.size = myData.size();
   info.frequency = myFrequency;
+  info.records = myRecords.size();
+  info.bytes = 0;
+  for (const Record & record : myRecords)
+  {
+    info.bytes += record.data.size();
+  }
+}
+
+UINT CassetteTape::getTrapAddress() const
+{
+  if (!myInstantLoad || myRecords.empty())
+    return NO_TRAP_ADDRESS;
+
+  if (memcmp(mem + MONITOR_READ, READ_SIGNATURE, sizeof(READ_SIGNATURE)) != 0)
+    return NO_TRAP_ADDRESS;
+
+  return MONITOR_READ;
+}
+
+// Returns true if the call was serviced: regs.pc is then the address pushed by the caller's JSR.
+// Only the next record on the tape is considered: if it does not fit, or its checksum is wrong,
+// the real routine runs (and reports the error).
+bool CassetteTape::trap(const ULONG nExecutedCycles)
+{
+  CpuCalcCycles(nExecutedCycles);
+
+  const double position = getPosition();
+  const auto it = std::find_if(myRecords.begin(), myRecords.end(),
+    [position](const Record & record) { return record.start >= position; });
+  if (it == myRecords.end())
+    return false;
+
+  const Record & record = *it;
+
+  // READ stores at least 1 byte, from A1 to A2, followed by the checksum
+  const WORD a1 = readWord(ZP_A1);
+  const WORD a2 = readWord(ZP_A2);
+  const size_t size = a2 >= a1 ? a2 - a1 + 1 : 1;
+  if (record.data.size() < size + 1)
+    return false;
+
+  BYTE checksum = 0xFF;
+  for (size_t i = 0; i < size; ++i)
+  {
+    checksum ^= record.data[i];
+  }
+  if (checksum != record.data[size])
+    return false;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    writeByte((WORD)(a1 + i), record.data[i]);
+  }
+  const WORD end = (WORD)(a1 + size);  // as left by NXTA1
+  writeByte(ZP_A1, end & 0xFF);
+  writeByte(ZP_A1 + 1, end >> 8);
+  writeByte(ZP_CHKSUM, checksum);
+
+  // the tape has moved past the record
+  const double cycles = record.end / myFrequency * g_fCurrentCLK6502;
+  myBaseCycles = int64_t(g_nCumulativeCycles) - static_cast<int64_t>(cycles);
+  myIsPlaying = true;
+  getLevel(getPosition());
+
+  // Return to the caller, as RTS would (less the final increment, which is done by the opcode fetch)
+  regs.sp = 0x100 | ((regs.sp + 1) & 0xFF);
+  WORD returnAddr = mem[regs.sp];
+  regs.sp = 0x100 | ((regs.sp + 1) & 0xFF);
+  returnAddr |= mem[regs.sp] << 8;
+  regs.pc = returnAddr;
+
+  return true;
 }
 
 BYTE __stdcall TapeRead(WORD pc, WORD address, BYTE, BYTE, ULONG nExecutedCycles)	// $C060 TAPEIN
@@ -124,3 +491,13 @@ BYTE __stdcall TapeWrite(WORD, WORD address, BYTE, BYTE, ULONG nExecutedCycles)
 {
   return 0;
 }
+
+UINT TapeGetTrapAddress(void)
+{
+  return CassetteTape::instance().getTrapAddress();
+}
+
+bool TapeTrap(ULONG nExecutedCycles)
+{
+  return CassetteTape::instance().trap(nExecutedCycles);
+}
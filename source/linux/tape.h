@@ -1,14 +1,21 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <cstdint>
 
+// The wave is demodulated once, when the tape is inserted:
+// . TAPEIN only needs the positions of the level transitions (edges), so the samples are never kept
+// . the Apple cassette format (header tone, sync bit, 0/1 bits) is then decoded from the edges into records,
+//   which are used to service the Monitor's READ routine directly (instant load)
 class CassetteTape
 {
 public:
 
   typedef int8_t tape_data_t;
 
+  // WAV (8 or 16 bit PCM), streamed from the file
+  bool load(const std::string & filename);
   void setData(const std::string & filename, const std::vector<tape_data_t> & data, const int frequency);
   BYTE getValue(const ULONG nExecutedCycles);
 
@@ -19,23 +26,47 @@ public:
     size_t pos;
     int frequency;
     uint8_t bit;
+    size_t records;   // decoded
+    size_t bytes;
   };
 
   void getTapeInfo(TapeInfo & info) const;
   void eject();
   void rewind();
 
+  void setInstantLoad(const bool instantLoad);
+  bool getInstantLoad() const;
+
+  // Monitor READ ($FEFD)
+  UINT getTrapAddress() const;
+  bool trap(const ULONG nExecutedCycles);
+
   static CassetteTape & instance();
 
 private:
-  BYTE getBitValue(const tape_data_t val);
-  tape_data_t getCurrentWave(size_t & pos) const;
+  struct Record
+  {
+    double start;   // in samples, first data edge
+    double end;     // in samples, after the last complete byte
+    std::vector<uint8_t> data;
+  };
+
+  class EdgeDetector;
+
+  void reset(const std::string & filename, const int frequency);
+  void decodeRecords();
+  double getPosition() const;   // in samples
+  BYTE getLevel(const double position);
 
-  std::vector<tape_data_t> myData;
+  std::vector<double> myEdges;  // in samples, the level is toggled at each edge
+  std::vector<Record> myRecords;
+  size_t mySize = 0;            // in samples
+  size_t myNextEdge = 0;        // cursor in myEdges
 
-  uint64_t myBaseCycles;
+  int64_t myBaseCycles;        // negative if the tape was moved ahead of the emulation (instant load)
   int myFrequency;
   bool myIsPlaying = false;
+  bool myInstantLoad = false;
   BYTE myLastBit = 1; // negative wave
   std::string myFilename; // just for info
 
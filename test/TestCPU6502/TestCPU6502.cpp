@@ -1,5 +1,7 @@
 #include "stdafx.h"
 
+#include <chrono>
+
 #include "../../source/Windows/AppleWin.h"
 #include "../../source/CPU.h"
 #include "../../source/Memory.h"
@@ -53,6 +55,7 @@ static __forceinline void DoIrqProfiling(DWORD uCycles)
 
 static __forceinline void CheckSynchronousInterruptSources(UINT cycles, ULONG uExecutedCycles)
 {
+	g_SynchronousEventMgr.Update(cycles, uExecutedCycles);
 }
 
 static __forceinline bool NMI(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn, BOOL& flagv, BOOL& flagz)
@@ -72,34 +75,73 @@ DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles)
 }
 
 // From NTSC.cpp
+static ULONG g_videoCycles = 0;
+
 void NTSC_VideoUpdateCycles( long cycles6502 )
 {
+	g_videoCycles += cycles6502;
+}
+
+UINT NTSC_GetCyclesPerFrame(void)
+{
+	return 17030;
+}
+
+// From Keyboard.cpp
+static BYTE g_keyData = 0;	// no key pressed
+
+BYTE KeybReadData(void)
+{
+	return g_keyData;
 }
 
+// From CPU.cpp
+static volatile UINT32 g_bmIRQ = 0;
+static volatile UINT32 g_bmNMI = 0;
+
 //-------------------------------------
 
 #include "../../source/CPU/cpu_general.inl"
 #include "../../source/CPU/cpu_instructions.inl"
+#include "../../source/CPU/cpu_idleloop.inl"
 
-#define READ _READ_WITH_IO_F8xx
-#define WRITE(a) _WRITE_WITH_IO_F8xx(a)
-#define HEATMAP_X(pc)
-
-#include "../../source/CPU/cpu6502.h"  // MOS 6502
+struct MemoryAccess
+{
+	static __forceinline BYTE Read(WORD addr, ULONG uExecutedCycles) { return _READ; }
+	static __forceinline void Write(WORD addr, BYTE value, ULONG uExecutedCycles) { _WRITE(value); }
+	static __forceinline void Execute(WORD pc) {}
+	static __forceinline void IdleLoop(WORD pc, ULONG& uExecutedCycles, const DWORD uTotalCycles, const bool bVideoUpdate) {}
+};
 
-#undef READ
-#undef WRITE
+struct MemoryAccess_With_IO_F8xx : public MemoryAccess
+{
+	static __forceinline BYTE Read(WORD addr, ULONG uExecutedCycles) { return _READ_WITH_IO_F8xx; }
+	static __forceinline void Write(WORD addr, BYTE value, ULONG uExecutedCycles) { _WRITE_WITH_IO_F8xx(value); }
+};
 
-//-------
+// As CPU.cpp's RunAccess: skips the idle loops
+template <class Memory>
+struct IdleLoopAccess : public Memory
+{
+	static __forceinline void IdleLoop(WORD pc, ULONG& uExecutedCycles, const DWORD uTotalCycles, const bool bVideoUpdate)
+	{
+		if (pc == g_uIdleLoopPC)
+			IdleLoopSkip(uExecutedCycles, uTotalCycles, bVideoUpdate);
+	}
+};
 
-#define READ _READ
-#define WRITE(a) _WRITE(a)
+#define READ Access::Read(addr, uExecutedCycles)
+#define WRITE(a) Access::Write(addr, (BYTE)(a), uExecutedCycles);
+#define HEATMAP_X(pc) Access::Execute(pc)
+#define IDLE_LOOP_X(pc) Access::IdleLoop(pc, uExecutedCycles, uTotalCycles, bVideoUpdate)
 
+#include "../../source/CPU/cpu6502.h"  // MOS 6502
 #include "../../source/CPU/cpu65C02.h"  // WDC 65C02
 
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef IDLE_LOOP_X
 
 //-------------------------------------
 
@@ -129,14 +171,26 @@ void reset(void)
 
 DWORD TestCpu6502(DWORD uTotalCycles)
 {
-	return Cpu6502(uTotalCycles, true);
+	return Cpu6502<MemoryAccess_With_IO_F8xx, true, true>(uTotalCycles);
 }
 
 DWORD TestCpu65C02(DWORD uTotalCycles)
 {
-	return Cpu65C02(uTotalCycles, true);
+	return Cpu65C02<MemoryAccess, true, true>(uTotalCycles);
 }
 
+DWORD TestCpu6502IdleLoop(DWORD uTotalCycles)
+{
+	return Cpu6502<IdleLoopAccess<MemoryAccess_With_IO_F8xx>, true, true>(uTotalCycles);
+}
+
+DWORD TestCpu65C02IdleLoop(DWORD uTotalCycles)
+{
+	return Cpu65C02<IdleLoopAccess<MemoryAccess>, true, true>(uTotalCycles);
+}
+
+typedef DWORD (*TestCpuFunc)(DWORD uTotalCycles);
+
 //-------------------------------------
 
 int GH264_test(void)
@@ -1316,6 +1370,281 @@ int SyncEvents_test(void)
 	return 0;
 }
 
+//-------------------------------------
+// Idle loop skip: the skipped iterations must leave the machine (and the SyncEvents) exactly as executing them would
+
+static UINT g_keyReads = 0;
+
+// $C00x, as Memory.cpp's IO_Annunciator() / KeybReadData()
+BYTE __stdcall IdleLoopKeyRead(WORD pc, WORD addr, BYTE bWrite, BYTE d, ULONG nExecutedCycles)
+{
+	g_keyReads++;
+	IdleLoopCandidate(pc - 3);
+	return KeybReadData();
+}
+
+// Monitor's KEYIN ($FD1B): counts in $4E/$4F until a key is pressed
+static void IdleLoopKeyin(void)
+{
+	reset();
+	const BYTE code[] = {
+		0xE6, 0x4E,			// 300: INC $4E
+		0xD0, 0x02,			// 302: BNE $306
+		0xE6, 0x4F,			// 304: INC $4F
+		0x2C, 0x00, 0xC0,	// 306: BIT $C000
+		0x10, 0xF5,			// 309: BPL $300
+	};
+	memcpy(mem+0x300, code, sizeof(code));
+	mem[0x4E] = 0xF0;		// carry into $4F early on
+	mem[0x4F] = 0x12;
+
+	IORead[0] = IdleLoopKeyRead;
+	g_keyData = 0;
+	g_keyReads = 0;
+	g_videoCycles = 0;
+	g_uIdleLoopPC = kNoIdleLoopPC;
+}
+
+static ULONG g_idleLoopEventCycles = 0;
+static UINT g_idleLoopEventCount = 0;
+
+int IdleLoopCB(int id, int cycles, ULONG uExecutedCycles)
+{
+	g_idleLoopEventCycles = uExecutedCycles;
+	g_idleLoopEventCount++;
+	return 0;	// one-shot
+}
+
+// Runs KEYIN for one batch with a pending SyncEvent
+static DWORD IdleLoopSyncEventRun(TestCpuFunc cpu, const DWORD uTotalCycles, const int eventCycles)
+{
+	IdleLoopKeyin();
+
+	g_idleLoopEventCycles = 0;
+	g_idleLoopEventCount = 0;
+	SyncEvent syncEvent(0, eventCycles, IdleLoopCB);
+	g_SynchronousEventMgr.Insert(&syncEvent);
+
+	const DWORD cycles = cpu(uTotalCycles);
+
+	if (syncEvent.m_active)
+		g_SynchronousEventMgr.Remove(0);
+
+	return cycles;
+}
+
+static int IdleLoopSyncEvent(TestCpuFunc cpu, TestCpuFunc cpuIdleLoop)
+{
+	const DWORD uTotalCycles = 100000;
+	const int eventCycles = 54321;
+
+	const DWORD cycles = IdleLoopSyncEventRun(cpu, uTotalCycles, eventCycles);
+	const ULONG eventAt = g_idleLoopEventCycles;
+	const UINT keyReads = g_keyReads;
+	if (g_idleLoopEventCount != 1) return 1;
+	if (eventAt < (ULONG)eventCycles) return 1;
+	if (g_videoCycles != cycles) return 1;
+
+	const DWORD cyclesIdleLoop = IdleLoopSyncEventRun(cpuIdleLoop, uTotalCycles, eventCycles);
+	if (g_idleLoopEventCount != 1) return 1;
+	if (g_idleLoopEventCycles != eventAt) return 1;		// same cycle, not early
+	if (cyclesIdleLoop != cycles) return 1;
+	if (g_videoCycles != cycles) return 1;				// the skipped cycles are given to the video once
+	if (g_keyReads >= keyReads) return 1;				// and the loop was skipped
+
+	return 0;
+}
+
+int IdleLoop_SyncEvent_test(void)
+{
+	int res = IdleLoopSyncEvent(TestCpu6502, TestCpu6502IdleLoop);
+	if (res) return res;
+
+	return IdleLoopSyncEvent(TestCpu65C02, TestCpu65C02IdleLoop);
+}
+
+// Both loops from cpu_idleloop.inl, (a) without and (b) with a counter
+static void IdleLoopSetup(const bool hasCounter)
+{
+	IdleLoopKeyin();
+	if (!hasCounter)
+	{
+		const BYTE code[] = {
+			0xAD, 0x00, 0xC0,	// 300: LDA $C000
+			0x10, 0xFB,			// 303: BPL $300
+		};
+		memcpy(mem+0x300, code, sizeof(code));
+	}
+}
+
+static int IdleLoopCompare(TestCpuFunc cpu, TestCpuFunc cpuIdleLoop, const bool hasCounter, const DWORD uTotalCycles)
+{
+	IdleLoopSetup(hasCounter);
+	const DWORD cycles = cpu(uTotalCycles);
+	const regsrec expected = regs;
+	const BYTE counterLo = mem[0x4E];
+	const BYTE counterHi = mem[0x4F];
+	const UINT keyReads = g_keyReads;
+
+	IdleLoopSetup(hasCounter);
+	if (cpuIdleLoop(uTotalCycles) != cycles) return 1;
+	if (g_videoCycles != cycles) return 1;
+	if (regs.a != expected.a || regs.x != expected.x || regs.y != expected.y) return 1;
+	if (regs.ps != expected.ps || regs.sp != expected.sp || regs.pc != expected.pc) return 1;
+	if (mem[0x4E] != counterLo || mem[0x4F] != counterHi) return 1;
+	if (uTotalCycles > 1000 && g_keyReads >= keyReads) return 1;	// the loop was skipped
+
+	return 0;
+}
+
+// Every batch must end in the same state with or without the skip
+int IdleLoop_test(void)
+{
+	const DWORD batches[] = { 0, 1, 7, 11, 100, 1000, 17030, 100000, 1000000 };
+
+	for (UINT i=0; i<sizeof(batches)/sizeof(batches[0]); i++)
+	{
+		for (UINT hasCounter=0; hasCounter<2; hasCounter++)
+		{
+			int res = IdleLoopCompare(TestCpu6502, TestCpu6502IdleLoop, hasCounter != 0, batches[i]);
+			if (res) return res;
+
+			res = IdleLoopCompare(TestCpu65C02, TestCpu65C02IdleLoop, hasCounter != 0, batches[i]);
+			if (res) return res;
+		}
+	}
+
+	return 0;
+}
+
+//-------------------------------------
+// Micro-benchmark: host time per emulated instruction, for each opcode
+// . Each opcode is repeated (with fixed operands) to fill a block, which loops back with a JMP
+// . Operands: zp=$80, abs=$2000, (zp)->$2000, X=Y=0, branches to the next instruction (taken or not)
+// . Opcodes which can't be repeated in-line (BRK, RTI, RTS, JMP (ind), JMP (abs,X) & the 6502 jams) are skipped
+
+const WORD kBenchCode = 0x0400;		// code block: $0400..~$1B80
+const WORD kBenchData = 0x2000;
+const BYTE kBenchZp = 0x80;
+const UINT kBenchInstructions = 2000;
+
+static bool BenchIsBranch(BYTE op, bool is65C02)
+{
+	return (op & 0x1F) == 0x10 || (is65C02 && op == 0x80);
+}
+
+static bool BenchIsSkipped(BYTE op, bool is65C02)
+{
+	switch (op)
+	{
+	case 0x00: case 0x40: case 0x60: case 0x6C:
+		return true;
+	case 0x7C:
+		return is65C02;
+	}
+
+	return !is65C02 && (op & 0x0F) == 0x02 && (op & 0x90) != 0x80;	// HLT: x2 (except 82, A2, C2, E2)
+}
+
+static void BenchResetData(void)
+{
+	memset(mem, 0, 0x200);
+	memset(mem+kBenchData, 0, 0x200);
+	mem[kBenchZp+0] = kBenchData & 0xff;
+	mem[kBenchZp+1] = kBenchData >> 8;
+}
+
+// Instruction length, from single-stepping one instance
+static UINT BenchGetLength(BYTE op, bool is65C02, TestCpuFunc cpu)
+{
+	if (BenchIsBranch(op, is65C02))
+		return 2;
+	if (op == 0x20 || op == 0x4C)	// JSR, JMP abs
+		return 3;
+
+	BenchResetData();
+	reset();
+	mem[regs.pc+0] = op;
+	mem[regs.pc+1] = kBenchZp;
+	mem[regs.pc+2] = kBenchData >> 8;
+	cpu(0);
+	return regs.pc - 0x300;
+}
+
+static double BenchOpcode(BYTE op, bool is65C02, TestCpuFunc cpu, UINT& cyclesPerOpcode)
+{
+	const UINT len = BenchGetLength(op, is65C02, cpu);
+
+	WORD addr = kBenchCode;
+	for (UINT i=0; i<kBenchInstructions; i++)
+	{
+		const WORD next = addr + len;
+		mem[addr] = op;
+		if (len == 2)
+			mem[addr+1] = BenchIsBranch(op, is65C02) ? 0x00 : kBenchZp;
+		if (len == 3)
+		{
+			const bool isJump = (op == 0x20 || op == 0x4C);
+			mem[addr+1] = isJump ? (next & 0xff) : (kBenchData & 0xff);
+			mem[addr+2] = isJump ? (next >> 8) : (kBenchData >> 8);
+		}
+		addr = next;
+	}
+	mem[addr+0] = 0x4C;	// JMP kBenchCode
+	mem[addr+1] = kBenchCode & 0xff;
+	mem[addr+2] = kBenchCode >> 8;
+
+	BenchResetData();
+	reset();
+	regs.pc = kBenchCode;
+	cyclesPerOpcode = cpu(0);
+
+	const DWORD cyclesPerBlock = kBenchInstructions * cyclesPerOpcode + 3;
+	const UINT blocks = 1 + 2000000 / cyclesPerBlock;	// ~2M cycles
+
+	BenchResetData();
+	reset();
+	regs.pc = kBenchCode;
+
+	const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	const DWORD cycles = cpu(blocks * cyclesPerBlock);
+	const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	const double instructions = double(cycles) * (kBenchInstructions + 1) / cyclesPerBlock;
+	const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	return ns / instructions;
+}
+
+static void BenchCpu(const char* name, bool is65C02, TestCpuFunc cpu)
+{
+	printf("%s\n", name);
+	printf("op  len cyc  ns/instr ns/cycle\n");
+
+	double total = 0.0;
+	UINT count = 0;
+	for (UINT op=0; op<256; op++)
+	{
+		if (BenchIsSkipped(op, is65C02))
+			continue;
+
+		UINT cycles = 0;
+		const double ns = BenchOpcode(op, is65C02, cpu, cycles);
+		printf("%02X  %u   %u  %8.2f %8.2f\n", op, BenchGetLength(op, is65C02, cpu), cycles, ns, ns / cycles);
+
+		total += ns;
+		count++;
+	}
+
+	printf("mean %.2f ns/instr over %u opcodes\n\n", total / count, count);
+}
+
+int Bench(void)
+{
+	BenchCpu("6502", false, TestCpu6502);
+	BenchCpu("65C02", true, TestCpu65C02);
+	return 0;
+}
+
 //-------------------------------------
 
 int _tmain(int argc, _TCHAR* argv[])
@@ -1345,5 +1674,14 @@ int _tmain(int argc, _TCHAR* argv[])
 	res = SyncEvents_test();
 	if (res) return res;
 
+	res = IdleLoop_test();
+	if (res) return res;
+
+	res = IdleLoop_SyncEvent_test();
+	if (res) return res;
+
+	if (argc > 1 && _tcscmp(argv[1], TEXT("-bench")) == 0)
+		return Bench();
+
 	return 0;
 }
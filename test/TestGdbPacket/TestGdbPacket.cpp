@@ -0,0 +1,178 @@
+// Tests of the GDB Remote Serial Protocol packet layer (used by the Linux frontends' gdbserver)
+
+#include "StdAfx.h"
+#include "frontends/common2/gdbpacket.h"
+
+using namespace common2::gdb;
+
+//-------------------------------------
+
+int Checksum_test(void)
+{
+	if (checksum("") != 0x00) return 1;
+	if (checksum("OK") != 0x9a) return 1;
+	if (makePacket("OK") != "$OK#9a") return 1;
+	if (makePacket("") != "$#00") return 1;
+
+	// modulo 256
+	if (checksum(std::string(3, '\xff')) != 0xfd) return 1;
+
+	return 0;
+}
+
+//-------------------------------------
+
+int ReadToken_test(void)
+{
+	std::string payload;
+	size_t pos = 0;
+
+	// ack, packet (either case of hex digits), Ctrl-C, nack
+	const std::string input = "+$OK#9a$OK#9A\x03-";
+	if (readToken(input, pos, payload) != Token::Other || pos != 1) return 1;
+	if (readToken(input, pos, payload) != Token::Packet || payload != "OK" || pos != 7) return 1;
+	if (readToken(input, pos, payload) != Token::Packet || payload != "OK" || pos != 13) return 1;
+	if (readToken(input, pos, payload) != Token::Interrupt) return 1;
+	if (readToken(input, pos, payload) != Token::Nack) return 1;
+	if (readToken(input, pos, payload) != Token::Incomplete || pos != input.size()) return 1;
+
+	// bad checksums still consume the packet
+	pos = 0;
+	if (readToken("$OK#9b", pos, payload) != Token::BadChecksum || payload != "OK" || pos != 6) return 1;
+	pos = 0;
+	if (readToken("$OK#zz", pos, payload) != Token::BadChecksum || pos != 6) return 1;
+
+	// incomplete packets leave pos alone
+	const char * incomplete[] = { "$", "$OK", "$OK#", "$OK#9" };
+	for (const char * s : incomplete)
+	{
+		pos = 0;
+		if (readToken(s, pos, payload) != Token::Incomplete || pos != 0) return 1;
+	}
+
+	return 0;
+}
+
+//-------------------------------------
+
+int Hex_test(void)
+{
+	size_t pos = 1;
+	if (parseHex("m1fA,", pos) != 0x1fa || pos != 4) return 1;
+
+	std::vector<uint8_t> data;
+	if (!parseHexBytes("M00ff7D", 1, data) || data.size() != 3 || data[0] != 0x00 || data[1] != 0xff || data[2] != 0x7d) return 1;
+	if (parseHexBytes("M0", 1, data)) return 1;		// odd length
+	if (parseHexBytes("Mzz", 1, data)) return 1;	// not hex
+	if (parseHexBytes("M", 2, data)) return 1;		// past the end
+
+	uint32_t address, length;
+	pos = 1;
+	if (!parseAddressLength("M300,2:a9ff", pos, address, length, ':') || address != 0x300 || length != 2 || pos != 7) return 1;
+	pos = 1;
+	if (parseAddressLength("M300:2", pos, address, length, ':')) return 1;
+	pos = 1;
+	if (parseAddressLength("M300,2", pos, address, length, ':')) return 1;
+
+	std::string s;
+	appendHex(s, 0xa9);
+	appendHex(s, 0x05);
+	if (s != "a905") return 1;
+
+	return 0;
+}
+
+//-------------------------------------
+
+int UnescapeBinary_test(void)
+{
+	std::vector<uint8_t> data;
+
+	// '#', '$', '}' and '*' are sent as 0x7d followed by the byte ^ 0x20
+	const std::string packet = std::string("X300,5:") + "\x7d\x03" + "\x7d\x04" + "\x7d\x5d" + "\x7d\x0a" + "A";
+	unescapeBinary(packet, 7, data);
+	if (data.size() != 5) return 1;
+	if (data[0] != '#' || data[1] != '$' || data[2] != 0x7d || data[3] != '*' || data[4] != 'A') return 1;
+
+	// a trailing escape character is kept as is
+	unescapeBinary("X0,1:\x7d", 5, data);
+	if (data.size() != 1 || data[0] != 0x7d) return 1;
+
+	// no data
+	unescapeBinary("X0,0:", 5, data);
+	if (!data.empty()) return 1;
+
+	return 0;
+}
+
+//-------------------------------------
+
+int VCont_test(void)
+{
+	bool step = true;
+	if (!parseVCont("vCont;c", step) || step) return 1;
+	if (!parseVCont("vCont;C05:1", step) || step) return 1;
+	if (!parseVCont("vCont;s:1;c", step) || !step) return 1;
+	if (!parseVCont("vCont;S05", step) || !step) return 1;
+
+	if (parseVCont("vCont;t", step)) return 1;
+	if (parseVCont("vCont;", step)) return 1;
+	if (parseVCont("vCont?", step)) return 1;
+	if (parseVCont("vKill;1", step)) return 1;
+
+	return 0;
+}
+
+//-------------------------------------
+
+int Breakpoint_test(void)
+{
+	Breakpoint bp;
+
+	// Z0/Z1: the length is the kind of instruction
+	if (!parseBreakpoint("Z0,300,3", bp) || bp.type != 0 || bp.address != 0x300 || bp.length != 1) return 1;
+	if (!parseBreakpoint("z1,fffc,2", bp) || bp.type != 1 || bp.address != 0xfffc || bp.length != 1) return 1;
+
+	// watchpoints
+	if (!parseBreakpoint("Z2,400,10", bp) || bp.type != 2 || bp.address != 0x400 || bp.length != 0x10) return 1;
+	if (!parseBreakpoint("z3,c000,1", bp) || bp.type != 3 || bp.address != 0xc000 || bp.length != 1) return 1;
+	if (!parseBreakpoint("Z4,2000,0", bp) || bp.type != 4 || bp.length != 1) return 1;	// at least 1
+	if (!parseBreakpoint("Z2,fff0,100", bp) || bp.length != 0x10) return 1;			// up to 0xffff
+
+	// invalid
+	if (parseBreakpoint("Z5,300,1", bp)) return 1;
+	if (parseBreakpoint("Z,300,1", bp)) return 1;
+	if (parseBreakpoint("Z0;300,1", bp)) return 1;
+	if (parseBreakpoint("Z0,300", bp)) return 1;
+	if (parseBreakpoint("Z0,10000,1", bp)) return 1;
+	if (parseBreakpoint("m300,1", bp)) return 1;
+
+	return 0;
+}
+
+//-------------------------------------
+
+int main(int argc, char* argv[])
+{
+	int res = 1;
+
+	res = Checksum_test();
+	if (res) return res;
+
+	res = ReadToken_test();
+	if (res) return res;
+
+	res = Hex_test();
+	if (res) return res;
+
+	res = UnescapeBinary_test();
+	if (res) return res;
+
+	res = VCont_test();
+	if (res) return res;
+
+	res = Breakpoint_test();
+	if (res) return res;
+
+	return 0;
+}